@@ -10,10 +10,21 @@ class GameConfig {
     std::uint16_t metrics_port_;
     double tick_rate_;
     std::string database_dsn_;
+    std::string profile_data_dir_;
+    std::string redis_host_;
+    std::uint16_t redis_port_;
+    std::string map_file_;
+    std::uint32_t websocket_deflate_players_;
+    std::uint32_t websocket_max_connections_;
+    std::uint32_t websocket_handshakes_per_second_;
 
    public:
     GameConfig(std::uint16_t port, std::uint16_t metrics_port, double tick_rate,
-               std::string database_dsn);
+               std::string database_dsn, std::string profile_data_dir = {},
+               std::string redis_host = {}, std::uint16_t redis_port = 6379,
+               std::string map_file = {}, std::uint32_t websocket_deflate_players = 0,
+               std::uint32_t websocket_max_connections = 0,
+               std::uint32_t websocket_handshakes_per_second = 0);
 
     static GameConfig FromEnv();
 
@@ -21,6 +32,21 @@ class GameConfig {
     std::uint16_t metrics_port() const noexcept { return metrics_port_; }
     double tick_rate() const noexcept { return tick_rate_; }
     const std::string& database_dsn() const noexcept { return database_dsn_; }
+    // Empty disables the on-disk profile journal.
+    const std::string& profile_data_dir() const noexcept { return profile_data_dir_; }
+    // Empty keeps the matchmaking queue and leaderboard in process memory.
+    const std::string& redis_host() const noexcept { return redis_host_; }
+    std::uint16_t redis_port() const noexcept { return redis_port_; }
+    // Static obstacle map (see StaticGeometry); empty leaves the arena an open plane.
+    const std::string& map_file() const noexcept { return map_file_; }
+    // Expected concurrent players, used to size permessage-deflate for text clients; 0 turns
+    // compression off.
+    std::uint32_t websocket_deflate_players() const noexcept { return websocket_deflate_players_; }
+    // Admission limits for WebSocket clients; 0 leaves a limit off.
+    std::uint32_t websocket_max_connections() const noexcept { return websocket_max_connections_; }
+    std::uint32_t websocket_handshakes_per_second() const noexcept {
+        return websocket_handshakes_per_second_;
+    }
 };
 
 }  // namespace arena60
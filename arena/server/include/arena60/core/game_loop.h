@@ -9,6 +9,8 @@
 #include <thread>
 #include <vector>
 
+#include "arena60/core/metrics_registry.h"
+
 namespace arena60 {
 
 struct TickInfo {
@@ -31,6 +33,7 @@ class GameLoop {
     double TargetDelta() const noexcept;
     double CurrentTickRate() const;
     std::vector<double> LastDurations() const;
+    void RegisterMetrics(MetricsRegistry& registry) const;
     std::string PrometheusSnapshot() const;
 
    private:
@@ -50,6 +53,12 @@ class GameLoop {
     mutable std::mutex metrics_mutex_;
     std::vector<double> last_durations_;
     std::uint64_t tick_counter_{0};
+
+    // Exported metrics, written by the tick thread without taking metrics_mutex_.
+    Gauge tick_rate_gauge_;
+    Gauge tick_duration_gauge_;
+    Counter ticks_total_;
+    Histogram tick_work_seconds_;
 };
 
 }  // namespace arena60
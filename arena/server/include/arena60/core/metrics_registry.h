@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace arena60 {
+
+// Metric primitives are plain atomics so hot paths update them without taking any lock.
+
+class Counter {
+   public:
+    void Increment(std::uint64_t amount = 1) noexcept {
+        value_.fetch_add(amount, std::memory_order_relaxed);
+    }
+    std::uint64_t Value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+class Gauge {
+   public:
+    void Set(double value) noexcept { value_.store(value, std::memory_order_relaxed); }
+    void Add(double delta) noexcept;
+    double Value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<double> value_{0.0};
+};
+
+class Histogram {
+   public:
+    // bounds are ascending upper bounds; the +Inf bucket is implicit.
+    explicit Histogram(std::vector<double> bounds);
+
+    void Observe(double value) noexcept;
+
+    const std::vector<double>& bounds() const noexcept { return bounds_; }
+    // Non-cumulative count for bucket i; i == bounds().size() is the +Inf bucket.
+    std::uint64_t BucketCount(std::size_t i) const noexcept;
+    std::uint64_t Count() const noexcept;
+    double Sum() const noexcept;
+
+   private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+    std::atomic<double> sum_{0.0};
+};
+
+// Scrape-side view over metrics owned by the components that update them. Names may carry a
+// label set ("family{key=\"value\"}"); series of one family must be registered consecutively
+// so the family gets a single TYPE line. Registered metrics must outlive the registry.
+class MetricsRegistry {
+   public:
+    void Register(std::string name, const Counter& counter);
+    void Register(std::string name, const Gauge& gauge);
+    void Register(std::string name, const Histogram& histogram);
+
+    // Appends the Prometheus text exposition to out. Formatting uses std::to_chars into a stack
+    // buffer, so a caller that reuses out allocates nothing once its capacity has grown.
+    void AppendTo(std::string& out) const;
+    std::string Serialize() const;
+
+   private:
+    enum class Kind { kCounter, kGauge, kHistogram };
+
+    struct Entry {
+        std::string family;
+        std::string labels;  // without braces; empty when unlabelled
+        Kind kind;
+        const void* metric;
+    };
+
+    void Add(std::string name, Kind kind, const void* metric);
+
+    // Guards entries_ against concurrent registration; never taken by metric updates.
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+}  // namespace arena60
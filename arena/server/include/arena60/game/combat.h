@@ -2,7 +2,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <string>
 #include <vector>
 
@@ -36,18 +35,23 @@ struct CombatEvent {
     std::uint64_t tick{0};
 };
 
+// Fixed-size ring of the most recent combat events, kept for debugging only. A capacity of zero
+// disables recording entirely.
 class CombatLog {
    public:
     explicit CombatLog(std::size_t capacity = 32);
 
     void Add(const CombatEvent& event);
+    // Returns events oldest first.
     std::vector<CombatEvent> Snapshot() const;
     std::size_t Size() const noexcept;
     std::size_t Capacity() const noexcept;
+    bool Enabled() const noexcept { return capacity_ > 0; }
 
    private:
     std::size_t capacity_;
-    std::deque<CombatEvent> events_;
+    std::vector<CombatEvent> events_;
+    std::size_t next_{0};
 };
 
 }  // namespace arena60
@@ -0,0 +1,56 @@
+#pragma once
+
+namespace arena60 {
+
+// Rule sets for BasicGameSession. A compile-time rule set exposes its tunables as static
+// constexpr functions, so each game mode gets movement and collision loops with the constants
+// folded in. RuntimeRules answers the same calls from member fields for experimentation.
+
+struct StandardRules {
+    static constexpr double PlayerSpeed() noexcept { return 5.0; }         // meters per second
+    static constexpr double PlayerRadius() noexcept { return 0.5; }        // meters
+    static constexpr int MaxHealth() noexcept { return 100; }              // hit points
+    static constexpr double FireCooldown() noexcept { return 0.1; }        // seconds
+    static constexpr double SpawnOffset() noexcept { return 0.3; }         // meters
+    static constexpr int DamagePerHit() noexcept { return 20; }            // hit points
+    static constexpr double ProjectileSpeed() noexcept { return 30.0; }    // meters per second
+    static constexpr double ProjectileLifetime() noexcept { return 1.5; }  // seconds
+    static constexpr double ProjectileRadius() noexcept { return 0.2; }    // meters
+    // Whether projectiles from different owners destroy each other on contact.
+    static constexpr bool ProjectilesCollide() noexcept { return false; }
+};
+
+// Twice the rate of fire at half the damage, with faster, shorter-lived projectiles.
+struct RapidFireRules : StandardRules {
+    static constexpr double FireCooldown() noexcept { return 0.05; }
+    static constexpr int DamagePerHit() noexcept { return 10; }
+    static constexpr double ProjectileSpeed() noexcept { return 45.0; }
+    static constexpr double ProjectileLifetime() noexcept { return 0.75; }
+};
+
+// Defaults match StandardRules.
+struct RuntimeRules {
+    double player_speed{StandardRules::PlayerSpeed()};
+    double player_radius{StandardRules::PlayerRadius()};
+    int max_health{StandardRules::MaxHealth()};
+    double fire_cooldown{StandardRules::FireCooldown()};
+    double spawn_offset{StandardRules::SpawnOffset()};
+    int damage_per_hit{StandardRules::DamagePerHit()};
+    double projectile_speed{StandardRules::ProjectileSpeed()};
+    double projectile_lifetime{StandardRules::ProjectileLifetime()};
+    double projectile_radius{StandardRules::ProjectileRadius()};
+    bool projectiles_collide{StandardRules::ProjectilesCollide()};
+
+    double PlayerSpeed() const noexcept { return player_speed; }
+    double PlayerRadius() const noexcept { return player_radius; }
+    int MaxHealth() const noexcept { return max_health; }
+    double FireCooldown() const noexcept { return fire_cooldown; }
+    double SpawnOffset() const noexcept { return spawn_offset; }
+    int DamagePerHit() const noexcept { return damage_per_hit; }
+    double ProjectileSpeed() const noexcept { return projectile_speed; }
+    double ProjectileLifetime() const noexcept { return projectile_lifetime; }
+    double ProjectileRadius() const noexcept { return projectile_radius; }
+    bool ProjectilesCollide() const noexcept { return projectiles_collide; }
+};
+
+}  // namespace arena60
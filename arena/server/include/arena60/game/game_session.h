@@ -1,22 +1,47 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "arena60/core/metrics_registry.h"
 #include "arena60/game/combat.h"
+#include "arena60/game/game_rules.h"
 #include "arena60/game/movement.h"
 #include "arena60/game/player_state.h"
 #include "arena60/game/projectile.h"
+#include "arena60/game/static_geometry.h"
 
 namespace arena60 {
 
-class GameSession {
+// Running per-player combat counters, maintained as hits and deaths happen.
+struct PlayerCombatTotals {
+    std::string player_id;
+    std::uint32_t shots_fired{0};
+    std::uint32_t hits_landed{0};
+    std::uint32_t kills{0};
+    std::uint32_t deaths{0};
+    std::uint64_t damage_dealt{0};
+    std::uint64_t damage_taken{0};
+};
+
+// Rules is one of the rule sets in game_rules.h. The member definitions live in
+// game_session.cpp and are instantiated there for each supported rule set.
+template <typename Rules>
+class BasicGameSession {
    public:
-    explicit GameSession(double tick_rate);
+    // combat_log_capacity > 0 keeps a debugging ring of recent hit/death events.
+    explicit BasicGameSession(double tick_rate, std::size_t combat_log_capacity = 0,
+                              Rules rules = {});
+
+    // Obstacles that block movement and projectiles; null (the default) is an open plane.
+    void SetStaticGeometry(std::shared_ptr<const StaticGeometry> geometry);
 
     void UpsertPlayer(const std::string& player_id);
     void RemovePlayer(const std::string& player_id);
@@ -30,8 +55,12 @@ class GameSession {
 
     std::vector<CombatEvent> ConsumeDeathEvents();
     std::vector<CombatEvent> CombatLogSnapshot() const;
+    std::vector<PlayerCombatTotals> CombatTotalsSnapshot() const;
+    // Neither call takes mutex_: the counters are atomics updated in place by the tick.
+    void RegisterMetrics(MetricsRegistry& registry) const;
     std::string MetricsSnapshot() const;
     std::size_t ActiveProjectileCount() const;
+    const Rules& rules() const noexcept { return rules_; }
 
    private:
     struct PlayerRuntimeState {
@@ -42,26 +71,50 @@ class GameSession {
         int shots_fired{0};
         int hits_landed{0};
         int deaths{0};
+        std::uint32_t kills{0};
+        std::uint64_t damage_dealt{0};
+        std::uint64_t damage_taken{0};
     };
 
     void AppendCombatEvent(const CombatEvent& event);
+    void MovePlayerLocked(PlayerState& state, double dx, double dy) const;
     bool TrySpawnProjectile(PlayerRuntimeState& runtime, const MovementInput& input);
     void UpdateProjectilesLocked(std::uint64_t tick, double delta_seconds);
+    void CollideProjectilesLocked(double delta_seconds);
 
-    double speed_per_second_;
+    const Rules rules_;
     double elapsed_time_{0.0};
     std::uint64_t projectile_counter_{0};
     CombatLog combat_log_;
 
+    std::shared_ptr<const StaticGeometry> geometry_;
     std::vector<Projectile> projectiles_;
+    struct SweptProjectile {
+        std::uint32_t index;
+        double min_x;  // x extent of the projectile's path this tick, radius included
+        double max_x;
+    };
+    std::vector<SweptProjectile> sweep_order_;  // scratch for CollideProjectilesLocked
     std::vector<CombatEvent> pending_deaths_;
-    std::uint64_t projectiles_spawned_total_{0};
-    std::uint64_t projectiles_hits_total_{0};
-    std::uint64_t players_dead_total_{0};
-    std::uint64_t collisions_checked_total_{0};
+    Gauge projectiles_active_;
+    Counter projectiles_spawned_total_;
+    Counter projectiles_hits_total_;
+    Counter players_dead_total_;
+    Counter collisions_checked_total_;
+    Counter projectiles_blocked_total_;
+    Counter projectiles_intercepted_total_;
 
     mutable std::mutex mutex_;
     std::unordered_map<std::string, PlayerRuntimeState> players_;
 };
 
+extern template class BasicGameSession<StandardRules>;
+extern template class BasicGameSession<RapidFireRules>;
+extern template class BasicGameSession<RuntimeRules>;
+
+using GameSession = BasicGameSession<StandardRules>;
+using RapidFireGameSession = BasicGameSession<RapidFireRules>;
+// Rules read from fields at run time; slower, for trying values without a rebuild.
+using TunableGameSession = BasicGameSession<RuntimeRules>;
+
 }  // namespace arena60
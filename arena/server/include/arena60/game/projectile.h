@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "arena60/game/game_rules.h"
+
 namespace arena60 {
 
 class Projectile {
@@ -9,8 +11,13 @@ class Projectile {
     Projectile(std::string id, std::string owner_id, double x, double y, double dir_x, double dir_y,
                double spawn_time_seconds);
 
+    // The untemplated overloads use StandardRules.
     void Advance(double delta_seconds);
     bool IsExpired(double now_seconds) const;
+    template <typename Rules>
+    void Advance(double delta_seconds, const Rules& rules);
+    template <typename Rules>
+    bool IsExpired(double now_seconds, const Rules& rules) const;
     void Deactivate();
 
     const std::string& id() const noexcept;
@@ -35,10 +42,23 @@ class Projectile {
     double dir_y_;
     double spawn_time_;
     bool active_{true};
-
-    static constexpr double kSpeed_ = 30.0;    // meters per second
-    static constexpr double kLifetime_ = 1.5;  // seconds
-    static constexpr double kRadius_ = 0.2;    // meters
 };
 
+template <typename Rules>
+void Projectile::Advance(double delta_seconds, const Rules& rules) {
+    if (!active_) {
+        return;
+    }
+    x_ += dir_x_ * rules.ProjectileSpeed() * delta_seconds;
+    y_ += dir_y_ * rules.ProjectileSpeed() * delta_seconds;
+}
+
+template <typename Rules>
+bool Projectile::IsExpired(double now_seconds, const Rules& rules) const {
+    if (!active_) {
+        return true;
+    }
+    return (now_seconds - spawn_time_) >= rules.ProjectileLifetime();
+}
+
 }  // namespace arena60
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace arena60 {
+
+struct Aabb {
+    double min_x{0.0};
+    double min_y{0.0};
+    double max_x{0.0};
+    double max_y{0.0};
+};
+
+struct SweepHit {
+    bool hit{false};
+    double fraction{1.0};  // of the requested displacement travelled before contact
+    double normal_x{0.0};
+    double normal_y{0.0};
+};
+
+// Immutable set of axis-aligned obstacles with a bounding volume hierarchy for sweep queries.
+// Circles are swept against boxes grown by the radius, so corners collide as squares; that is at
+// most radius * (sqrt(2) - 1) conservative and keeps every test a slab test.
+//
+// Map files are plain text, one directive per line, '#' starting a comment:
+//   box <min_x> <min_y> <max_x> <max_y>      solid obstacle
+//   bounds <min_x> <min_y> <max_x> <max_y>   four walls enclosing the playable area
+class StaticGeometry {
+   public:
+    StaticGeometry() = default;
+    explicit StaticGeometry(std::vector<Aabb> boxes);
+
+    // Replace the current shapes; false (with the offending line on stderr) on a parse error.
+    bool Load(std::istream& input);
+    bool LoadFromFile(const std::string& path);
+
+    // First contact of a circle of the given radius moving from (x, y) by (dx, dy). Boxes the
+    // circle already overlaps are ignored, so anything stuck inside a wall can still leave it.
+    SweepHit SweepCircle(double x, double y, double dx, double dy, double radius) const;
+    bool OverlapsCircle(double x, double y, double radius) const;
+
+    bool empty() const noexcept { return boxes_.empty(); }
+    std::size_t size() const noexcept { return boxes_.size(); }
+    const std::vector<Aabb>& boxes() const noexcept { return boxes_; }
+    std::size_t node_count() const noexcept { return nodes_.size(); }
+
+   private:
+    struct Node {
+        Aabb bounds;
+        std::uint32_t first{0};  // leaf: first box; interior: index of the second child
+        std::uint32_t count{0};  // boxes in a leaf, 0 for interior nodes
+    };
+
+    void Build();
+    std::uint32_t BuildRange(std::uint32_t first, std::uint32_t count);
+
+    std::vector<Aabb> boxes_;
+    std::vector<Node> nodes_;
+};
+
+}  // namespace arena60
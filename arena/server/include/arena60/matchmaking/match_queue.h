@@ -1,16 +1,19 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
-#include <iostream>
 #include <list>
 #include <map>
 #include <memory>
-#include <ostream>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "arena60/matchmaking/match_request.h"
+#include "arena60/storage/redis_client.h"
 
 namespace arena60 {
 
@@ -28,6 +31,12 @@ class MatchQueue {
     virtual std::vector<QueuedPlayer> FetchOrdered() const = 0;
     virtual std::size_t Size() const = 0;
     virtual std::string Snapshot() const = 0;
+
+    // Removes each pair whose players are both still queued and reports which pairs were
+    // claimed. The default checks both players against one FetchOrdered before removing either;
+    // remote queues override it to claim every pair atomically in one round trip.
+    virtual std::vector<bool> ClaimPairs(
+        const std::vector<std::pair<std::string, std::string>>& pairs);
 };
 
 class InMemoryMatchQueue : public MatchQueue {
@@ -53,19 +62,59 @@ class InMemoryMatchQueue : public MatchQueue {
     std::unordered_map<std::string, std::pair<int, typename Bucket::iterator>> index_;
 };
 
+// Queue kept in Redis as a sorted set ordered by (elo, order) plus a hash of request details.
+// FetchOrdered and ClaimPairs are Lua scripts, loaded once and run by digest with EVALSHA, so a
+// matching pass costs two round trips no matter how many players are queued or matched.
 class RedisMatchQueue : public MatchQueue {
    public:
-    explicit RedisMatchQueue(std::ostream& stream = std::cout);
+    // Returns {ids, payloads} for the whole queue in score order. HMGET runs in chunks because
+    // unpack() of the whole queue would overflow the Lua stack (about 8000 values).
+    static constexpr const char* kFetchScript =
+        "local ids = redis.call('ZRANGE', KEYS[1], 0, -1)\n"
+        "local payloads = {}\n"
+        "for i = 1, #ids, 1000 do\n"
+        "  local chunk = redis.call('HMGET', KEYS[2], unpack(ids, i, math.min(i + 999, #ids)))\n"
+        "  for j = 1, #chunk do payloads[#payloads + 1] = chunk[j] end\n"
+        "end\n"
+        "return {ids, payloads}\n";
+    // ARGV holds player pairs; returns 1 per pair claimed, 0 if either player already left.
+    static constexpr const char* kClaimPairsScript =
+        "local claimed = {}\n"
+        "for i = 1, #ARGV, 2 do\n"
+        "  local a, b = ARGV[i], ARGV[i + 1]\n"
+        "  if redis.call('ZSCORE', KEYS[1], a) and redis.call('ZSCORE', KEYS[1], b) then\n"
+        "    redis.call('ZREM', KEYS[1], a, b)\n"
+        "    redis.call('HDEL', KEYS[2], a, b)\n"
+        "    claimed[#claimed + 1] = 1\n"
+        "  else\n"
+        "    claimed[#claimed + 1] = 0\n"
+        "  end\n"
+        "end\n"
+        "return claimed\n";
+
+    explicit RedisMatchQueue(std::shared_ptr<RedisClient> client,
+                             std::string key_prefix = "matchmaking");
 
     void Upsert(const MatchRequest& request, std::uint64_t order) override;
     bool Remove(const std::string& player_id) override;
     std::vector<QueuedPlayer> FetchOrdered() const override;
     std::size_t Size() const override;
     std::string Snapshot() const override;
+    std::vector<bool> ClaimPairs(
+        const std::vector<std::pair<std::string, std::string>>& pairs) override;
 
    private:
-    std::ostream* stream_;
-    InMemoryMatchQueue fallback_;
+    // Runs script by its cached digest. A Redis restart or SCRIPT FLUSH forgets loaded scripts,
+    // so a NOSCRIPT reply loads them again and retries once.
+    std::optional<RedisReply> EvalScript(std::size_t script,
+                                         const RedisCommand& keys_and_args) const;
+    bool LoadScripts() const;
+
+    std::shared_ptr<RedisClient> client_;
+    const std::string queue_key_;
+    const std::string requests_key_;
+    mutable std::mutex scripts_mutex_;
+    mutable std::array<std::string, 2> script_digests_;
 };
 
 }  // namespace arena60
@@ -9,12 +9,15 @@
 #include <string>
 #include <vector>
 
+#include "arena60/core/metrics_registry.h"
 #include "arena60/matchmaking/match.h"
 #include "arena60/matchmaking/match_notification_channel.h"
 #include "arena60/matchmaking/match_queue.h"
 
 namespace arena60 {
 
+// Enqueue, Cancel and RunMatching call into the queue under mutex_; with a RedisMatchQueue that
+// means blocking round trips, so callers drive them from a worker rather than the network thread.
 class Matchmaker {
    public:
     explicit Matchmaker(std::shared_ptr<MatchQueue> queue);
@@ -26,12 +29,13 @@ class Matchmaker {
 
     std::vector<Match> RunMatching(std::chrono::steady_clock::time_point now);
 
+    // Reads atomics only; never contends with RunMatching for mutex_.
+    void RegisterMetrics(MetricsRegistry& registry) const;
     std::string MetricsSnapshot() const;
 
     MatchNotificationChannel& notification_channel() { return notifications_; }
 
    private:
-    void ObserveWaitLocked(double seconds);
     static std::string ResolveRegion(const MatchRequest& lhs, const MatchRequest& rhs);
 
     std::shared_ptr<MatchQueue> queue_;
@@ -41,14 +45,11 @@ class Matchmaker {
 
     std::uint64_t order_counter_{0};
     std::uint64_t match_counter_{0};
-    std::uint64_t matches_created_{0};
-    std::size_t last_queue_size_{0};
 
     static constexpr std::array<double, 6> kWaitBuckets{{0.0, 5.0, 10.0, 20.0, 40.0, 80.0}};
-    std::array<std::uint64_t, kWaitBuckets.size()> wait_bucket_counts_{};
-    std::uint64_t wait_overflow_count_{0};
-    double wait_sum_{0.0};
-    std::uint64_t wait_count_{0};
+    Gauge queue_size_;
+    Counter matches_created_;
+    Histogram wait_seconds_;
 };
 
 }  // namespace arena60
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "arena60/core/metrics_registry.h"
+
+namespace arena60 {
+
+// Zero leaves the corresponding limit off.
+struct AdmissionOptions {
+    // Open connections, counted from accept until the session is destroyed.
+    std::size_t max_connections{0};
+    // Token bucket for new handshakes: refill rate and capacity.
+    double handshakes_per_second{0.0};
+    double handshake_burst{1.0};
+    // New connections are shed while the latest tick reached the io_context later than this.
+    double max_tick_lateness_seconds{0.0};
+};
+
+enum class AdmissionDecision { kAdmit, kAtCapacity, kTickLate, kRateLimited };
+
+// Decides whether a freshly accepted socket may go on to the WebSocket handshake, which is the
+// expensive part of a connection for the io_context. Admit and ObserveTickLateness run on the
+// io_context; Release may run on whichever thread drops the last session reference.
+class AdmissionController {
+   public:
+    explicit AdmissionController(AdmissionOptions options = {});
+
+    // Checks capacity, then tick lateness, then takes a handshake token; an admitted connection
+    // must be released once.
+    AdmissionDecision Admit(std::chrono::steady_clock::time_point now);
+    void Release() noexcept;
+
+    // How long after its frame start the latest tick was handled on the io_context.
+    void ObserveTickLateness(double seconds) noexcept;
+
+    std::size_t open_connections() const noexcept {
+        return open_.load(std::memory_order_relaxed);
+    }
+    void RegisterMetrics(MetricsRegistry& registry) const;
+
+   private:
+    bool TakeToken(std::chrono::steady_clock::time_point now);
+
+    const AdmissionOptions options_;
+    double tokens_;
+    std::chrono::steady_clock::time_point refilled_at_{};
+    std::atomic<std::size_t> open_{0};
+    double tick_lateness_seconds_{0.0};
+
+    Gauge open_connections_;
+    Counter admitted_;
+    Counter rejected_capacity_;
+    Counter rejected_tick_late_;
+    Counter rejected_rate_;
+    Histogram tick_lateness_;
+};
+
+}  // namespace arena60
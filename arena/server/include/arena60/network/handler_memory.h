@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace arena60 {
+
+// A few reusable blocks for the intermediate state of one chain of asynchronous operations.
+// Asio frees an operation's state before invoking its handler, so a chain that keeps a single
+// operation in flight cycles through the same blocks; a composed operation holds up to kSlots
+// at once. Requests that are too large, or arrive with every block taken, use the global heap.
+class HandlerMemory {
+   public:
+    static constexpr std::size_t kSlots = 3;
+    static constexpr std::size_t kSlotSize = 1024;
+
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* Allocate(std::size_t size) {
+        if (size <= kSlotSize) {
+            for (std::size_t i = 0; i < kSlots; ++i) {
+                if (!in_use_[i]) {
+                    in_use_[i] = true;
+                    return &slots_[i];
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void Deallocate(void* pointer) noexcept {
+        for (std::size_t i = 0; i < kSlots; ++i) {
+            if (pointer == &slots_[i]) {
+                in_use_[i] = false;
+                return;
+            }
+        }
+        ::operator delete(pointer);
+    }
+
+    std::size_t slots_in_use() const noexcept {
+        std::size_t count = 0;
+        for (bool used : in_use_) {
+            count += used ? 1 : 0;
+        }
+        return count;
+    }
+
+   private:
+    using Slot = std::aligned_storage_t<kSlotSize, alignof(std::max_align_t)>;
+
+    Slot slots_[kSlots];
+    bool in_use_[kSlots]{};
+};
+
+// Allocator view of a HandlerMemory, exposed by completion handlers as their allocator_type so
+// Asio and Beast place operation state in the block.
+template <typename T>
+class HandlerAllocator {
+   public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept : memory_(&memory) {}
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(memory_->Allocate(sizeof(T) * n)); }
+    void deallocate(T* pointer, std::size_t /*n*/) noexcept { memory_->Deallocate(pointer); }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ != other.memory_;
+    }
+
+   private:
+    template <typename>
+    friend class HandlerAllocator;
+
+    HandlerMemory* memory_;
+};
+
+}  // namespace arena60
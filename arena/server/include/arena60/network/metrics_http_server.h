@@ -4,11 +4,20 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/http.hpp>
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <memory>
 
 namespace arena60 {
 
+struct HttpConnectionLimits {
+    // Connections with no request in flight are closed after this long.
+    std::chrono::milliseconds idle_timeout{5000};
+    // Responses after this many requests on one connection carry Connection: close.
+    std::size_t max_requests_per_connection{100};
+};
+
 class MetricsHttpServer : public std::enable_shared_from_this<MetricsHttpServer> {
    public:
     using RequestHandler =
@@ -16,7 +25,7 @@ class MetricsHttpServer : public std::enable_shared_from_this<MetricsHttpServer>
             const boost::beast::http::request<boost::beast::http::string_body>&)>;
 
     MetricsHttpServer(boost::asio::io_context& io_context, std::uint16_t port,
-                      RequestHandler handler);
+                      RequestHandler handler, HttpConnectionLimits limits = {});
     ~MetricsHttpServer();
 
     void Start();
@@ -24,6 +33,9 @@ class MetricsHttpServer : public std::enable_shared_from_this<MetricsHttpServer>
 
     std::uint16_t Port() const;
 
+    std::uint64_t ConnectionsAccepted() const noexcept;
+    std::uint64_t RequestsServed() const noexcept;
+
    private:
     class Session;
 
@@ -33,6 +45,9 @@ class MetricsHttpServer : public std::enable_shared_from_this<MetricsHttpServer>
     boost::asio::ip::tcp::acceptor acceptor_;
     std::atomic<bool> running_{false};
     RequestHandler handler_;
+    HttpConnectionLimits limits_;
+    std::atomic<std::uint64_t> connections_accepted_{0};
+    std::atomic<std::uint64_t> requests_served_{0};
 };
 
 }  // namespace arena60
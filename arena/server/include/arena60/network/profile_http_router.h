@@ -1,17 +1,22 @@
 #pragma once
 
+#include <atomic>
 #include <boost/beast/http.hpp>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
 
+#include "arena60/network/profile_response_cache.h"
 #include "arena60/stats/player_profile_service.h"
 
 namespace arena60 {
 
 class ProfileHttpRouter {
    public:
-    using MetricsProvider = std::function<std::string()>;
+    // Appends Prometheus text to the response body, which is rendered in place rather than
+    // copied out of an intermediate buffer.
+    using MetricsProvider = std::function<void(std::string& out)>;
 
     ProfileHttpRouter(MetricsProvider metrics_provider,
                       std::shared_ptr<PlayerProfileService> profile_service);
@@ -29,10 +34,17 @@ class ProfileHttpRouter {
         const boost::beast::http::request<boost::beast::http::string_body>& request,
         std::size_t limit) const;
 
+    boost::beast::http::response<boost::beast::http::string_body> RespondCached(
+        const boost::beast::http::request<boost::beast::http::string_body>& request,
+        const CachedResponse& cached) const;
+
     static std::size_t ParseLimit(const std::string& query);
 
     MetricsProvider metrics_provider_;
     std::shared_ptr<PlayerProfileService> profile_service_;
+    std::unique_ptr<ProfileResponseCache> response_cache_;
+    // Size of the last scrape, reserved up front so rendering does not regrow the body.
+    mutable std::atomic<std::size_t> metrics_size_hint_{0};
 };
 
 }  // namespace arena60
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "arena60/stats/player_profile_service.h"
+
+namespace arena60 {
+
+struct CachedResponse {
+    std::uint64_t generation{0};
+    std::string body;
+    std::string etag;
+};
+
+// Pre-rendered JSON bodies for the profile endpoints. Entries are tagged with the profile
+// service generation they were rendered at; a hit only reads an atomic and the cache's own lock,
+// so popular routes never contend with RecordMatch on the profile shards.
+class ProfileResponseCache {
+   public:
+    explicit ProfileResponseCache(std::shared_ptr<PlayerProfileService> profile_service);
+
+    std::shared_ptr<const CachedResponse> Leaderboard(std::size_t limit);
+    // Returns nullptr when the player has no profile; misses are not cached.
+    std::shared_ptr<const CachedResponse> Profile(const std::string& player_id);
+
+    std::uint64_t hits() const noexcept { return hits_.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const noexcept { return misses_.load(std::memory_order_relaxed); }
+
+    std::string MetricsSnapshot() const;
+
+   private:
+    static constexpr std::size_t kMaxProfileEntries = 4096;
+
+    static std::shared_ptr<const CachedResponse> Render(std::uint64_t generation,
+                                                        std::string body);
+
+    std::shared_ptr<PlayerProfileService> profile_service_;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::size_t, std::shared_ptr<const CachedResponse>> leaderboards_;
+    std::unordered_map<std::string, std::shared_ptr<const CachedResponse>> profiles_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+}  // namespace arena60
@@ -3,8 +3,10 @@
 #include <atomic>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -13,20 +15,46 @@
 #include <vector>
 
 #include "arena60/core/game_loop.h"
+#include "arena60/core/metrics_registry.h"
 #include "arena60/game/game_session.h"
+#include "arena60/network/admission_controller.h"
 #include "arena60/stats/match_stats.h"
 
 namespace arena60 {
 
+// permessage-deflate for text clients, negotiated with those that offer it. Beast ends every
+// compressed message with a full flush, which clears the match state, so each state line is
+// compressed on its own: about 7% smaller for 5-10 us of io_context time per message.
+struct WebSocketCompression {
+    bool enabled{false};
+    // LZ77 window, 9..15, offered for both directions. State lines are far shorter than the
+    // smallest window, and a larger one only costs memory on both ends.
+    int window_bits{9};
+    // Hash table size, 1..9. The table is cleared after every message, so larger is slower.
+    int mem_level{2};
+    int level{6};  // 1 (fastest) ..9 (smallest)
+    // Keeping the window between messages gains nothing after a full flush; turning it off lets
+    // clients release their inflate window.
+    bool context_takeover{false};
+
+    // Settings picked by test_websocket_deflate_perf for a server expecting this many
+    // concurrent players; off when none are expected or when compressing every state line
+    // would take more than about a quarter of a 60 Hz tick.
+    static WebSocketCompression ForPlayers(std::size_t players);
+};
+
 class WebSocketServer : public std::enable_shared_from_this<WebSocketServer> {
    public:
     WebSocketServer(boost::asio::io_context& io_context, std::uint16_t port, GameSession& session,
-                    GameLoop& loop);
+                    GameLoop& loop, WebSocketCompression compression = {},
+                    AdmissionOptions admission = {});
     ~WebSocketServer();
 
     void Start();
     void Stop();
 
+    // Registers the server's and the game session's metrics.
+    void RegisterMetrics(MetricsRegistry& registry) const;
     std::string MetricsSnapshot() const;
     std::uint16_t Port() const;
 
@@ -38,13 +66,17 @@ class WebSocketServer : public std::enable_shared_from_this<WebSocketServer> {
     class ClientSession;
 
     void DoAccept();
-    void BroadcastState(std::uint64_t tick, double delta_seconds);
+    void RetryAcceptAfterBackoff();
+    void BroadcastState(const TickInfo& info);
     void RegisterClient(const std::string& player_id, std::shared_ptr<ClientSession> client);
     void UnregisterClient(const std::string& player_id);
 
     boost::asio::io_context& io_context_;
     boost::asio::ip::tcp::acceptor acceptor_;
     std::atomic<bool> running_{false};
+    // Accept errors such as EMFILE re-arm the acceptor after a delay that doubles per failure.
+    boost::asio::steady_timer accept_timer_;
+    std::chrono::milliseconds accept_backoff_{0};
 
     GameSession& session_;
     GameLoop& loop_;
@@ -56,7 +88,18 @@ class WebSocketServer : public std::enable_shared_from_this<WebSocketServer> {
     mutable std::mutex clients_mutex_;
     std::unordered_map<std::string, std::weak_ptr<ClientSession>> clients_;
     std::uint64_t last_broadcast_tick_{0};
-    std::atomic<std::uint32_t> connection_count_{0};
+    Gauge connections_;
+    AdmissionController admission_;
+
+    const WebSocketCompression compression_;
+    // Message bytes before compression and framing, and bytes handed to sockets.
+    Counter payload_bytes_;
+    Counter wire_bytes_;
+    Gauge compression_ratio_;  // wire bytes per payload byte
+    // Time spent compressing and framing outgoing messages, collected from the write paths and
+    // observed once per tick.
+    std::atomic<std::uint64_t> send_nanoseconds_{0};
+    Histogram send_seconds_per_tick_;
 
     MatchStatsCollector match_stats_collector_;
 };
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
@@ -13,15 +16,23 @@
 
 namespace arena60 {
 
+class RedisClient;
+
 class LeaderboardStore {
    public:
     virtual ~LeaderboardStore() = default;
 
     virtual void Upsert(const std::string& player_id, int score) = 0;
     virtual void Erase(const std::string& player_id) = 0;
+    // Batched forms; remote stores override them to send one command per batch.
+    virtual void UpsertMany(const std::vector<std::pair<std::string, int>>& entries);
+    virtual void EraseMany(const std::vector<std::string>& player_ids);
     virtual std::vector<std::pair<std::string, int>> TopN(std::size_t limit) const = 0;
     virtual std::optional<int> Get(const std::string& player_id) const = 0;
     virtual std::size_t Size() const = 0;
+    // Changes whenever reads may return different data without a write through this store, e.g.
+    // when a remote store's cached snapshot is refreshed. Local stores never change it.
+    virtual std::uint64_t Version() const noexcept { return 0; }
 };
 
 class InMemoryLeaderboardStore : public LeaderboardStore {
@@ -39,13 +50,49 @@ class InMemoryLeaderboardStore : public LeaderboardStore {
     std::map<int, std::set<std::string>, std::greater<int>> ordered_;
 };
 
+// Sorted-set leaderboard in Redis. Writes are pipelined without waiting for their replies.
+// TopN and Size never wait on Redis: they answer from a snapshot of the top entries and the
+// entry count, and start an asynchronous refresh (one at a time) once a write through this
+// store, refresh_interval or a larger limit makes it stale. A refresh shares the connection
+// with earlier writes, so it observes them; Version() moves when it lands.
 class RedisLeaderboardStore : public LeaderboardStore {
    public:
+    explicit RedisLeaderboardStore(
+        std::shared_ptr<RedisClient> client, std::string key = "leaderboard",
+        std::chrono::milliseconds refresh_interval = std::chrono::seconds(1));
+
     void Upsert(const std::string& player_id, int score) override;
     void Erase(const std::string& player_id) override;
+    void UpsertMany(const std::vector<std::pair<std::string, int>>& entries) override;
+    void EraseMany(const std::vector<std::string>& player_ids) override;
     std::vector<std::pair<std::string, int>> TopN(std::size_t limit) const override;
     std::optional<int> Get(const std::string& player_id) const override;
     std::size_t Size() const override;
+    std::uint64_t Version() const noexcept override;
+
+   private:
+    // Shared with in-flight refresh callbacks, which may outlive the store.
+    struct Snapshot {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, int>> top;
+        std::size_t size{0};
+        std::size_t fetched{0};  // entries the last refresh asked for
+        std::size_t wanted{0};   // entries the next refresh asks for
+        std::uint64_t writes{0};
+        std::uint64_t writes_seen{0};
+        std::chrono::steady_clock::time_point refreshed_at{};
+        bool refreshed{false};
+        bool refreshing{false};
+        std::atomic<std::uint64_t> version{0};
+    };
+
+    void MaybeRefresh(std::size_t limit) const;
+    void NoteWrite();
+
+    std::shared_ptr<RedisClient> client_;
+    const std::string key_;
+    const std::chrono::milliseconds refresh_interval_;
+    std::shared_ptr<Snapshot> snapshot_;
 };
 
 }  // namespace arena60
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
-#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -40,11 +43,30 @@ struct PlayerProfile {
     double Accuracy() const noexcept;
 };
 
+// Receives the post-match state of every player a RecordMatch(es) call touched. Called while the
+// players' shards are still locked, so per-player notifications arrive in update order.
+class ProfileChangeSink {
+   public:
+    virtual ~ProfileChangeSink() = default;
+
+    virtual void OnProfilesChanged(const std::vector<PlayerProfile>& profiles) = 0;
+};
+
 class PlayerProfileService {
    public:
     explicit PlayerProfileService(std::shared_ptr<LeaderboardStore> leaderboard_store);
 
+    // Must be set before matches are recorded; not synchronized with RecordMatch.
+    void SetChangeSink(std::shared_ptr<ProfileChangeSink> sink);
+
     void RecordMatch(const MatchResult& result);
+    // Equivalent to calling RecordMatch for each result in order, but takes each shard lock and
+    // the leaderboard lock once for the whole batch and upserts each player's rating once.
+    void RecordMatches(const std::vector<MatchResult>& results);
+    // Overwrites a player's aggregate with persisted state; used during recovery.
+    void RestoreProfile(const PlayerProfile& profile);
+    // Visits every profile; each shard is read-locked while its profiles are visited.
+    void ForEachProfile(const std::function<void(const PlayerProfile&)>& visitor) const;
 
     std::optional<PlayerProfile> GetProfile(const std::string& player_id) const;
     std::vector<PlayerProfile> TopProfiles(std::size_t limit) const;
@@ -54,6 +76,10 @@ class PlayerProfileService {
 
     std::string MetricsSnapshot() const;
 
+    // Bumped after every recorded match or batch, and whenever the leaderboard store's snapshot
+    // moves; response caches compare against it to detect staleness.
+    std::uint64_t Generation() const noexcept;
+
    private:
     struct AggregateStats {
         std::uint64_t matches{0};
@@ -68,16 +94,39 @@ class PlayerProfileService {
         int rating{1200};
     };
 
+    // Aggregates are striped across shards by player id hash so that recording a match only
+    // contends with readers and writers touching the same players.
+    static constexpr std::size_t kShardCount = 16;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, AggregateStats> aggregates;
+    };
+
+    // A profile updated by the current batch; pointers stay valid while its shard is locked.
+    struct TouchedProfile {
+        const std::string* player_id;
+        AggregateStats* aggregate;
+    };
+
+    static std::size_t ShardIndex(const std::string& player_id) noexcept;
+
+    void RecordBatch(const MatchResult* results, std::size_t count);
+
     PlayerProfile BuildProfileUnsafe(const std::string& player_id,
                                      const AggregateStats& stats) const;
 
     std::shared_ptr<LeaderboardStore> leaderboard_;
+    std::shared_ptr<ProfileChangeSink> change_sink_;
     EloRatingCalculator calculator_;
 
-    mutable std::mutex mutex_;
-    std::unordered_map<std::string, AggregateStats> aggregates_;
-    std::uint64_t matches_recorded_total_{0};
-    std::uint64_t rating_updates_total_{0};
+    std::array<Shard, kShardCount> shards_;
+    // Leaderboard stores are not thread-safe; lock order is shards (ascending) then leaderboard.
+    mutable std::shared_mutex leaderboard_mutex_;
+    std::atomic<std::uint64_t> matches_recorded_total_{0};
+    std::atomic<std::uint64_t> rating_updates_total_{0};
+    std::atomic<std::uint64_t> leaderboard_upserts_total_{0};
+    std::atomic<std::uint64_t> generation_{0};
 };
 
 }  // namespace arena60
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/stats/player_profile_service.h"
+
+namespace arena60 {
+
+struct ProfileJournalOptions {
+    // Group-commit window: matches recorded within one interval share a single fdatasync.
+    std::chrono::milliseconds fsync_interval{20};
+    std::chrono::milliseconds checkpoint_interval{std::chrono::minutes(5)};
+    std::uint64_t checkpoint_wal_bytes{64ull * 1024 * 1024};
+};
+
+// Persists profile aggregates as a binary snapshot plus an append-only WAL of the rows each
+// RecordMatch changed. Rows carry absolute values, so replaying them is idempotent and a WAL
+// rotated during a checkpoint can safely be replayed on top of a newer snapshot.
+//
+// Directory layout: profiles.snapshot, profiles.wal and, while a checkpoint is in flight,
+// profiles.wal.old. A match is durable once the next group commit has run, i.e. at most
+// fsync_interval after RecordMatch returns.
+class ProfileJournal : public ProfileChangeSink {
+   public:
+    explicit ProfileJournal(std::string directory, ProfileJournalOptions options = {});
+    ~ProfileJournal() override;
+
+    // Loads the snapshot (mmap) and replays the WAL into the service. Must run before Start and
+    // before any match is recorded. Missing files mean an empty journal; returns false only when
+    // the snapshot is unreadable or corrupt.
+    bool Recover(PlayerProfileService& service);
+    // Opens the WAL for appending (dropping any torn tail found by Recover) and starts the
+    // background group-commit/checkpoint thread. The caller registers the journal as the
+    // service's change sink; Start fails if Recover has not run.
+    bool Start(std::shared_ptr<PlayerProfileService> service);
+    // Commits whatever is pending and joins the background thread.
+    void Stop();
+
+    void OnProfilesChanged(const std::vector<PlayerProfile>& profiles) override;
+
+    // Writes and fdatasyncs pending WAL frames.
+    bool Flush();
+    // Rotates the WAL, writes a fresh snapshot and discards the rotated WAL.
+    bool Checkpoint();
+
+    std::uint64_t LogicalBytes() const noexcept;
+    std::uint64_t WalBytesWritten() const noexcept;
+    std::uint64_t SnapshotBytesWritten() const noexcept;
+    std::uint64_t FsyncsTotal() const noexcept;
+    std::uint64_t CheckpointsTotal() const noexcept;
+    // Snapshot records plus WAL rows applied by Recover.
+    std::uint64_t RecordsRecovered() const noexcept;
+
+    std::string MetricsSnapshot() const;
+
+   private:
+    void Run();
+    bool FlushPendingLocked();
+    bool OpenWalLocked();
+    bool WriteSnapshot(const PlayerProfileService& service);
+
+    const std::string directory_;
+    const ProfileJournalOptions options_;
+    std::weak_ptr<PlayerProfileService> service_;
+
+    // Guards pending_ and the thread lifecycle; held only while encoding or swapping buffers.
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;
+    bool stop_requested_{false};
+    std::thread thread_;
+
+    // Serializes checkpoints; taken before io_mutex_.
+    std::mutex checkpoint_mutex_;
+    // Guards the WAL descriptor. Snapshot export runs without it so group commits continue.
+    std::mutex io_mutex_;
+    int wal_fd_{-1};
+    std::uint64_t wal_valid_bytes_{0};
+    std::uint64_t wal_bytes_since_checkpoint_{0};
+    bool recovered_{false};
+    bool checkpoint_on_start_{false};
+
+    std::atomic<std::uint64_t> logical_bytes_{0};
+    std::atomic<std::uint64_t> wal_bytes_{0};
+    std::atomic<std::uint64_t> snapshot_bytes_{0};
+    std::atomic<std::uint64_t> fsyncs_total_{0};
+    std::atomic<std::uint64_t> checkpoints_total_{0};
+    std::atomic<std::uint64_t> checkpoint_failures_total_{0};
+    std::atomic<std::uint64_t> records_recovered_{0};
+    std::atomic<double> recovery_seconds_{0.0};
+    std::atomic<double> last_checkpoint_seconds_{0.0};
+};
+
+}  // namespace arena60
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "arena60/stats/match_stats.h"
+
+namespace arena60 {
+
+class MatchResultSink {
+   public:
+    virtual ~MatchResultSink() = default;
+
+    // Returns false if the batch should be retried; replaying a written match must be harmless.
+    virtual bool RecordMatchResults(const std::vector<MatchResult>& results) = 0;
+};
+
+struct MatchResultWriterOptions {
+    std::size_t queue_capacity{4096};
+    std::size_t max_batch_size{64};
+    std::chrono::milliseconds initial_backoff{100};
+    std::chrono::milliseconds max_backoff{5000};
+};
+
+// Queues finished matches and drains them in batches on the given executor, so a burst of
+// matches shares pipelines and a transient database failure delays results instead of losing
+// them: a failed batch goes back to the front of the queue and is retried with backoff. Only
+// queue overflow, or a failure after Stop, drops results (counted).
+class MatchResultWriter : public std::enable_shared_from_this<MatchResultWriter> {
+   public:
+    MatchResultWriter(boost::asio::any_io_executor executor, std::shared_ptr<MatchResultSink> sink,
+                      MatchResultWriterOptions options = {});
+
+    bool Enqueue(MatchResult result);
+    // Cuts any backoff short for one last attempt; results still failing after that are dropped.
+    void Stop();
+
+    std::size_t QueueDepth() const;
+    std::uint64_t ResultsWritten() const noexcept;
+    std::uint64_t ResultsDropped() const noexcept;
+    std::uint64_t RetriesTotal() const noexcept;
+
+    std::string MetricsSnapshot() const;
+
+   private:
+    void Drain();
+
+    boost::asio::any_io_executor executor_;
+    std::shared_ptr<MatchResultSink> sink_;
+    const MatchResultWriterOptions options_;
+
+    mutable std::mutex mutex_;
+    std::deque<MatchResult> queue_;
+    boost::asio::steady_timer retry_timer_;
+    std::chrono::milliseconds backoff_{0};
+    bool draining_{false};
+    bool stopping_{false};
+
+    std::atomic<std::uint64_t> written_total_{0};
+    std::atomic<std::uint64_t> dropped_queue_full_total_{0};
+    std::atomic<std::uint64_t> dropped_write_failed_total_{0};
+    std::atomic<std::uint64_t> retries_total_{0};
+    std::atomic<std::uint64_t> batches_total_{0};
+};
+
+}  // namespace arena60
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <libpq-fe.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace arena60 {
+
+struct PostgresPoolOptions {
+    std::size_t size{4};
+    std::chrono::milliseconds acquire_timeout{200};
+    // Minimum spacing between reconnect attempts for one slot, so a dead database is not hammered.
+    std::chrono::milliseconds reconnect_backoff{1000};
+};
+
+class PostgresConnectionPool {
+   public:
+    // Exclusive use of one pooled connection; returned to the pool on destruction.
+    class Lease {
+       public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        explicit operator bool() const noexcept { return conn_ != nullptr; }
+        PGconn* get() const noexcept { return conn_; }
+
+        // Prepares the statement on this connection the first time it is used.
+        bool EnsurePrepared(const char* name, const char* sql, int param_count);
+        // Forces a reconnect the next time this slot is handed out.
+        void MarkBroken() noexcept { broken_ = true; }
+
+       private:
+        friend class PostgresConnectionPool;
+        Lease(PostgresConnectionPool* pool, std::size_t index, PGconn* conn);
+        void Release() noexcept;
+
+        PostgresConnectionPool* pool_{nullptr};
+        std::size_t index_{0};
+        PGconn* conn_{nullptr};
+        bool broken_{false};
+    };
+
+    explicit PostgresConnectionPool(std::string dsn, PostgresPoolOptions options = {});
+    ~PostgresConnectionPool();
+
+    // Opens every slot; returns the number of healthy connections.
+    std::size_t Connect();
+    void Close();
+
+    // Returns an empty lease if no healthy connection is available within acquire_timeout.
+    Lease Acquire();
+
+    // Pings idle connections and reconnects broken ones; returns the healthy count.
+    std::size_t HealthCheck();
+
+    std::size_t HealthyCount() const;
+    std::size_t Size() const noexcept { return slots_.size(); }
+    std::uint64_t ReconnectsTotal() const noexcept;
+
+   private:
+    struct ConnDeleter {
+        void operator()(PGconn* conn) const noexcept;
+    };
+
+    struct Slot {
+        std::unique_ptr<PGconn, ConnDeleter> conn;
+        bool in_use{false};
+        bool healthy{false};
+        std::chrono::steady_clock::time_point next_reconnect{};
+        std::unordered_set<std::string> prepared;
+    };
+
+    // Must be called with the slot marked in_use but without holding mutex_.
+    bool ReconnectSlot(Slot& slot);
+    void ReturnSlot(std::size_t index, bool broken) noexcept;
+
+    const std::string dsn_;
+    const PostgresPoolOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_cv_;
+    std::vector<Slot> slots_;
+    std::atomic<std::uint64_t> reconnects_total_{0};
+};
+
+}  // namespace arena60
@@ -1,24 +1,45 @@
 #pragma once
 
-#include <libpq-fe.h>
-
+#include <array>
 #include <atomic>
-#include <memory>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#include "arena60/stats/match_stats.h"
+#include "arena60/storage/match_result_writer.h"
+#include "arena60/storage/postgres_connection_pool.h"
+#include "arena60/storage/session_event_writer.h"
 
 namespace arena60 {
 
-class PostgresStorage {
+// Expected schema:
+//   session_events(player_id, event_type, created_at)
+//   match_results(match_id PRIMARY KEY, winner_id, loser_id, completed_at)
+//   player_match_stats(match_id, player_id, shots_fired, hits_landed, kills, deaths,
+//                      damage_dealt, damage_taken)
+class PostgresStorage : public SessionEventSink, public MatchResultSink {
    public:
-    explicit PostgresStorage(std::string dsn);
-    ~PostgresStorage();
+    explicit PostgresStorage(std::string dsn, PostgresPoolOptions pool_options = {});
+    ~PostgresStorage() override;
 
     bool Connect();
     void Disconnect();
 
-    bool IsConnected() const noexcept;
+    bool IsConnected() const;
 
     bool RecordSessionEvent(const std::string& player_id, const std::string& event);
+    // Inserts the batch with one prepared unnest() statement; reconnects if the link is down.
+    bool WriteSessionEvents(const std::vector<SessionEvent>& events) override;
+    // Writes every match and its per-player stats in one libpq pipeline. Each match commits or
+    // fails on its own, and replaying one that already committed writes nothing, so a failed
+    // batch can be retried whole.
+    bool RecordMatchResults(const std::vector<MatchResult>& results) override;
+
+    // Pings idle pooled connections and reconnects broken ones.
+    std::size_t HealthCheck();
 
     std::string MetricsSnapshot() const;
     double LastQueryDurationSeconds() const noexcept;
@@ -26,13 +47,25 @@ class PostgresStorage {
     const std::string& dsn() const noexcept { return dsn_; }
 
    private:
-    struct ConnDeleter {
-        void operator()(PGconn* conn) const noexcept;
+    static constexpr std::array<double, 8> kDurationBuckets{
+        {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.1, 0.5}};
+
+    struct DurationHistogram {
+        std::array<std::uint64_t, kDurationBuckets.size()> bucket_counts{};
+        std::uint64_t overflow_count{0};
+        double sum{0.0};
+        std::uint64_t count{0};
     };
 
+    void ObserveQuery(const char* statement, double seconds);
+
     std::string dsn_;
-    std::unique_ptr<PGconn, ConnDeleter> connection_;
+    PostgresConnectionPool pool_;
     std::atomic<double> last_query_seconds_{0.0};
+
+    mutable std::mutex metrics_mutex_;
+    std::map<std::string, DurationHistogram> query_durations_;
+    std::uint64_t pipeline_failures_total_{0};
 };
 
 }  // namespace arena60
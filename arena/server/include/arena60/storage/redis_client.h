@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace arena60 {
+
+struct RedisReply {
+    enum class Type { kSimpleString, kError, kInteger, kBulkString, kNil, kArray };
+
+    Type type{Type::kNil};
+    std::string str;  // simple string, error message or bulk string payload
+    std::int64_t integer{0};
+    std::vector<RedisReply> elements;
+
+    bool IsError() const noexcept { return type == Type::kError; }
+};
+
+using RedisCommand = std::vector<std::string>;
+
+// Encodes a command as a RESP2 array of bulk strings.
+void AppendRespCommand(std::string& out, const RedisCommand& command);
+
+// Incremental RESP2 decoder: feed raw socket bytes, then pull complete replies.
+class RespParser {
+   public:
+    enum class Result { kReply, kIncomplete, kError };
+
+    void Feed(const char* data, std::size_t size);
+    Result Next(RedisReply& reply);
+    void Reset();
+
+   private:
+    Result Parse(std::size_t& pos, RedisReply& reply, int depth) const;
+
+    std::string buffer_;
+    std::size_t consumed_{0};
+};
+
+struct RedisClientOptions {
+    std::string host{"127.0.0.1"};
+    std::uint16_t port{6379};
+    std::chrono::milliseconds connect_timeout{500};
+    std::chrono::milliseconds command_timeout{500};
+    // After a failed connect, further attempts fail fast until the backoff expires; it doubles
+    // per consecutive failure up to the max and resets once a connect succeeds.
+    std::chrono::milliseconds reconnect_backoff_min{100};
+    std::chrono::milliseconds reconnect_backoff_max{5000};
+};
+
+// Single-connection RESP2 client. Socket I/O runs asynchronously on the client's own thread;
+// commands from any caller are appended to one outgoing buffer and written back to back, and
+// replies are matched to callers in FIFO order. Fire-and-forget writes therefore stay ordered
+// ahead of later reads on the same client. Only one connect is in flight at a time; commands
+// issued while disconnected start it, wait for it and fail together if it does not succeed.
+class RedisClient {
+   public:
+    // ok is false when the connection failed before every reply arrived. Invoked on the client's
+    // I/O thread, so callbacks must not block on Execute.
+    using Callback = std::function<void(bool ok, std::vector<RedisReply> replies)>;
+
+    explicit RedisClient(RedisClientOptions options = {});
+    ~RedisClient();
+
+    RedisClient(const RedisClient&) = delete;
+    RedisClient& operator=(const RedisClient&) = delete;
+
+    // Blocks until the shared connect attempt finishes; false during the reconnect backoff.
+    bool Connect();
+    void Close();
+    bool IsConnected() const noexcept;
+
+    // Sends all commands as one pipeline; callback receives one reply per command, in order.
+    void AsyncExecute(std::vector<RedisCommand> commands, Callback callback);
+    // Blocking wrapper around AsyncExecute; returns nullopt on connection failure or once
+    // command_timeout (plus connect_timeout while disconnected) elapses.
+    std::optional<std::vector<RedisReply>> Execute(std::vector<RedisCommand> commands);
+    std::optional<RedisReply> ExecuteOne(RedisCommand command);
+
+    // One per AsyncExecute/Execute call: the round trips a caller waits for.
+    std::uint64_t PipelinesTotal() const noexcept;
+    std::uint64_t CommandsTotal() const noexcept;
+    // Socket writes; below PipelinesTotal when concurrent pipelines were coalesced.
+    std::uint64_t WritesTotal() const noexcept;
+    std::uint64_t ErrorsTotal() const noexcept;
+
+    std::string MetricsSnapshot() const;
+
+   private:
+    enum class State { kDisconnected, kConnecting, kConnected };
+
+    struct PendingPipeline {
+        std::size_t expected;
+        std::vector<RedisReply> replies;
+        Callback callback;
+    };
+
+    void StartConnect();
+    void FinishConnect(std::uint64_t attempt, const boost::system::error_code& ec);
+    void DoWrite();
+    void DoRead();
+    void FailAll();
+
+    const RedisClientOptions options_;
+
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::ip::tcp::resolver resolver_;
+    boost::asio::steady_timer connect_timer_;
+    std::thread thread_;
+
+    // I/O-thread state.
+    State state_{State::kDisconnected};
+    std::uint64_t connect_attempt_{0};
+    std::vector<std::function<void(bool)>> connect_waiters_;
+    std::chrono::milliseconds backoff_{0};
+    std::chrono::steady_clock::time_point retry_at_{};
+    std::deque<PendingPipeline> pending_;
+    std::string outgoing_;
+    std::string in_flight_;
+    bool writing_{false};
+    RespParser parser_;
+    std::array<char, 16384> read_buffer_{};
+
+    std::atomic<bool> connected_{false};
+    std::atomic<std::uint64_t> pipelines_total_{0};
+    std::atomic<std::uint64_t> commands_total_{0};
+    std::atomic<std::uint64_t> writes_total_{0};
+    std::atomic<std::uint64_t> errors_total_{0};
+};
+
+}  // namespace arena60
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace arena60 {
+
+struct SessionEvent {
+    std::string player_id;
+    std::string event_type;
+    std::chrono::system_clock::time_point created_at;
+};
+
+class SessionEventSink {
+   public:
+    virtual ~SessionEventSink() = default;
+
+    // Persists the whole batch atomically; returns false if it should be retried.
+    virtual bool WriteSessionEvents(const std::vector<SessionEvent>& events) = 0;
+};
+
+struct SessionEventWriterOptions {
+    std::size_t queue_capacity{8192};
+    std::size_t max_batch_size{256};
+    std::chrono::milliseconds flush_interval{100};
+    std::uint32_t max_retries{3};
+    std::chrono::milliseconds initial_backoff{50};
+    std::chrono::milliseconds max_backoff{1000};
+};
+
+// Moves session event persistence off the io_context thread. Enqueue never blocks on the
+// database: events go onto a bounded queue (overflow is dropped and counted) and a background
+// thread flushes them in batches when max_batch_size is reached or flush_interval elapses.
+class SessionEventWriter {
+   public:
+    SessionEventWriter(std::shared_ptr<SessionEventSink> sink,
+                       SessionEventWriterOptions options = {});
+    ~SessionEventWriter();
+
+    void Start();
+    // Flushes whatever is still queued (one attempt per batch) and joins the writer thread.
+    void Stop();
+
+    bool Enqueue(const std::string& player_id, const std::string& event_type);
+
+    std::size_t QueueDepth() const;
+    std::uint64_t EventsWritten() const noexcept;
+    std::uint64_t EventsDropped() const noexcept;
+    std::uint64_t RetriesTotal() const noexcept;
+
+    std::string MetricsSnapshot() const;
+
+   private:
+    void Run();
+    bool WriteWithRetry(const std::vector<SessionEvent>& batch);
+
+    std::shared_ptr<SessionEventSink> sink_;
+    const SessionEventWriterOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<SessionEvent> queue_;
+    bool stop_requested_{false};
+    std::thread thread_;
+
+    std::atomic<std::uint64_t> enqueued_total_{0};
+    std::atomic<std::uint64_t> written_total_{0};
+    std::atomic<std::uint64_t> dropped_queue_full_total_{0};
+    std::atomic<std::uint64_t> dropped_write_failed_total_{0};
+    std::atomic<std::uint64_t> retries_total_{0};
+    std::atomic<std::uint64_t> batches_total_{0};
+    std::atomic<double> last_batch_seconds_{0.0};
+};
+
+}  // namespace arena60
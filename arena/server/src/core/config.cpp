@@ -7,6 +7,9 @@ namespace {
 constexpr double kDefaultTickRate = 60.0;
 constexpr std::uint16_t kDefaultPort = 8080;
 constexpr std::uint16_t kDefaultMetricsPort = 9090;
+constexpr std::uint16_t kDefaultRedisPort = 6379;
+constexpr std::uint32_t kDefaultMaxConnections = 4096;
+constexpr std::uint32_t kDefaultHandshakesPerSecond = 200;
 constexpr const char* kDefaultDsn = "postgresql://localhost:5432/arena60";
 
 double ParseDoubleOrDefault(const char* value, double fallback) {
@@ -34,29 +37,72 @@ std::uint16_t ParsePortOrDefault(const char* value, std::uint16_t fallback) {
         return fallback;
     }
 }
+
+std::uint32_t ParseCountOrDefault(const char* value, std::uint32_t fallback) {
+    if (!value) {
+        return fallback;
+    }
+    try {
+        const long long parsed = std::stoll(value);
+        if (parsed < 0 || parsed > 0xffffffffLL) {
+            return fallback;
+        }
+        return static_cast<std::uint32_t>(parsed);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
 }  // namespace
 
 namespace arena60 {
 
 GameConfig::GameConfig(std::uint16_t port, std::uint16_t metrics_port, double tick_rate,
-                       std::string database_dsn)
+                       std::string database_dsn, std::string profile_data_dir,
+                       std::string redis_host, std::uint16_t redis_port, std::string map_file,
+                       std::uint32_t websocket_deflate_players,
+                       std::uint32_t websocket_max_connections,
+                       std::uint32_t websocket_handshakes_per_second)
     : port_(port),
       metrics_port_(metrics_port),
       tick_rate_(tick_rate),
-      database_dsn_(std::move(database_dsn)) {}
+      database_dsn_(std::move(database_dsn)),
+      profile_data_dir_(std::move(profile_data_dir)),
+      redis_host_(std::move(redis_host)),
+      redis_port_(redis_port),
+      map_file_(std::move(map_file)),
+      websocket_deflate_players_(websocket_deflate_players),
+      websocket_max_connections_(websocket_max_connections),
+      websocket_handshakes_per_second_(websocket_handshakes_per_second) {}
 
 GameConfig GameConfig::FromEnv() {
     const char* env_port = std::getenv("ARENA60_PORT");
     const char* env_metrics_port = std::getenv("ARENA60_METRICS_PORT");
     const char* env_tick = std::getenv("ARENA60_TICK_RATE");
     const char* env_dsn = std::getenv("ARENA60_DATABASE_DSN");
+    const char* env_profile_dir = std::getenv("ARENA60_PROFILE_DATA_DIR");
+    const char* env_redis_host = std::getenv("ARENA60_REDIS_HOST");
+    const char* env_redis_port = std::getenv("ARENA60_REDIS_PORT");
+    const char* env_map_file = std::getenv("ARENA60_MAP_FILE");
+    const char* env_deflate_players = std::getenv("ARENA60_WS_DEFLATE_PLAYERS");
+    const char* env_max_connections = std::getenv("ARENA60_WS_MAX_CONNECTIONS");
+    const char* env_handshake_rate = std::getenv("ARENA60_WS_HANDSHAKES_PER_SECOND");
 
     const auto port = ParsePortOrDefault(env_port, kDefaultPort);
     const auto metrics_port = ParsePortOrDefault(env_metrics_port, kDefaultMetricsPort);
     const auto tick_rate = ParseDoubleOrDefault(env_tick, kDefaultTickRate);
     const std::string dsn = env_dsn ? env_dsn : kDefaultDsn;
 
-    return GameConfig{port, metrics_port, tick_rate, dsn};
+    const std::string profile_dir = env_profile_dir ? env_profile_dir : "";
+    const std::string redis_host = env_redis_host ? env_redis_host : "";
+    const auto redis_port = ParsePortOrDefault(env_redis_port, kDefaultRedisPort);
+    const std::string map_file = env_map_file ? env_map_file : "";
+    const auto deflate_players = ParseCountOrDefault(env_deflate_players, 0);
+    const auto max_connections = ParseCountOrDefault(env_max_connections, kDefaultMaxConnections);
+    const auto handshake_rate =
+        ParseCountOrDefault(env_handshake_rate, kDefaultHandshakesPerSecond);
+
+    return GameConfig{port, metrics_port, tick_rate, dsn, profile_dir, redis_host, redis_port,
+                      map_file, deflate_players, max_connections, handshake_rate};
 }
 
 }  // namespace arena60
@@ -2,12 +2,16 @@
 
 #include <cmath>
 #include <iostream>
-#include <sstream>
 
 namespace arena60 {
 
 GameLoop::GameLoop(double tick_rate)
-    : tick_rate_(tick_rate), target_delta_(std::chrono::duration<double>(1.0 / tick_rate)) {}
+    : tick_rate_(tick_rate),
+      target_delta_(std::chrono::duration<double>(1.0 / tick_rate)),
+      tick_work_seconds_({0.001, 0.002, 0.004, 0.008, 0.016, 0.033, 0.066}) {
+    tick_rate_gauge_.Set(tick_rate_);
+    tick_duration_gauge_.Set(target_delta_.count());
+}
 
 GameLoop::~GameLoop() {
     Stop();
@@ -69,20 +73,17 @@ std::vector<double> GameLoop::LastDurations() const {
     return last_durations_;
 }
 
+void GameLoop::RegisterMetrics(MetricsRegistry& registry) const {
+    registry.Register("game_tick_rate", tick_rate_gauge_);
+    registry.Register("game_tick_duration_seconds", tick_duration_gauge_);
+    registry.Register("game_ticks_total", ticks_total_);
+    registry.Register("game_tick_work_seconds", tick_work_seconds_);
+}
+
 std::string GameLoop::PrometheusSnapshot() const {
-    std::ostringstream oss;
-    oss << "# TYPE game_tick_rate gauge\n";
-    oss << "game_tick_rate " << CurrentTickRate() << "\n";
-    double last_duration = TargetDelta();
-    {
-        std::lock_guard<std::mutex> lk(metrics_mutex_);
-        if (!last_durations_.empty()) {
-            last_duration = last_durations_.back();
-        }
-    }
-    oss << "# TYPE game_tick_duration_seconds gauge\n";
-    oss << "game_tick_duration_seconds " << last_duration << "\n";
-    return oss.str();
+    MetricsRegistry registry;
+    RegisterMetrics(registry);
+    return registry.Serialize();
 }
 
 void GameLoop::Run() {
@@ -109,6 +110,15 @@ void GameLoop::Run() {
             }
         }
 
+        tick_work_seconds_.Observe(std::chrono::duration<double>(
+                                       std::chrono::steady_clock::now() - frame_start)
+                                       .count());
+        ticks_total_.Increment();
+        tick_duration_gauge_.Set(delta_seconds);
+        if (delta_seconds > 0.0) {
+            tick_rate_gauge_.Set(1.0 / delta_seconds);
+        }
+
         previous = frame_start;
         next_frame += target_delta_;
 
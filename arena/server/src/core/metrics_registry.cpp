@@ -0,0 +1,182 @@
+#include "arena60/core/metrics_registry.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace arena60 {
+
+namespace {
+
+void AppendUint(std::string& out, std::uint64_t value) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendDouble(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out.append("NaN");
+        return;
+    }
+    if (std::isinf(value)) {
+        out.append(value > 0 ? "+Inf" : "-Inf");
+        return;
+    }
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void AppendSeriesName(std::string& out, const std::string& family, const char* suffix,
+                      const std::string& labels) {
+    out.append(family);
+    out.append(suffix);
+    if (!labels.empty()) {
+        out.push_back('{');
+        out.append(labels);
+        out.push_back('}');
+    }
+    out.push_back(' ');
+}
+
+void AppendBucket(std::string& out, const std::string& family, const std::string& labels,
+                  double bound, std::uint64_t cumulative) {
+    out.append(family);
+    out.append("_bucket{");
+    if (!labels.empty()) {
+        out.append(labels);
+        out.push_back(',');
+    }
+    out.append("le=\"");
+    AppendDouble(out, bound);
+    out.append("\"} ");
+    AppendUint(out, cumulative);
+    out.push_back('\n');
+}
+
+}  // namespace
+
+void Gauge::Add(double delta) noexcept {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(std::make_unique<std::atomic<std::uint64_t>[]>(bounds_.size() + 1)) {
+    for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::Observe(double value) noexcept {
+    const auto index = static_cast<std::size_t>(
+        std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    double current = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t Histogram::BucketCount(std::size_t i) const noexcept {
+    return buckets_[i].load(std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::Count() const noexcept {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+        total += BucketCount(i);
+    }
+    return total;
+}
+
+double Histogram::Sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+
+void MetricsRegistry::Register(std::string name, const Counter& counter) {
+    Add(std::move(name), Kind::kCounter, &counter);
+}
+
+void MetricsRegistry::Register(std::string name, const Gauge& gauge) {
+    Add(std::move(name), Kind::kGauge, &gauge);
+}
+
+void MetricsRegistry::Register(std::string name, const Histogram& histogram) {
+    Add(std::move(name), Kind::kHistogram, &histogram);
+}
+
+void MetricsRegistry::Add(std::string name, Kind kind, const void* metric) {
+    Entry entry{std::move(name), {}, kind, metric};
+    const auto brace = entry.family.find('{');
+    if (brace != std::string::npos) {
+        const auto close = entry.family.rfind('}');
+        entry.labels = entry.family.substr(brace + 1, close == std::string::npos
+                                                          ? std::string::npos
+                                                          : close - brace - 1);
+        entry.family.resize(brace);
+    }
+    std::lock_guard<std::mutex> lk(mutex_);
+    entries_.push_back(std::move(entry));
+}
+
+void MetricsRegistry::AppendTo(std::string& out) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    const std::string* previous_family = nullptr;
+    for (const auto& entry : entries_) {
+        if (!previous_family || *previous_family != entry.family) {
+            out.append("# TYPE ");
+            out.append(entry.family);
+            switch (entry.kind) {
+                case Kind::kCounter:
+                    out.append(" counter\n");
+                    break;
+                case Kind::kGauge:
+                    out.append(" gauge\n");
+                    break;
+                case Kind::kHistogram:
+                    out.append(" histogram\n");
+                    break;
+            }
+            previous_family = &entry.family;
+        }
+        switch (entry.kind) {
+            case Kind::kCounter:
+                AppendSeriesName(out, entry.family, "", entry.labels);
+                AppendUint(out, static_cast<const Counter*>(entry.metric)->Value());
+                out.push_back('\n');
+                break;
+            case Kind::kGauge:
+                AppendSeriesName(out, entry.family, "", entry.labels);
+                AppendDouble(out, static_cast<const Gauge*>(entry.metric)->Value());
+                out.push_back('\n');
+                break;
+            case Kind::kHistogram: {
+                const auto& histogram = *static_cast<const Histogram*>(entry.metric);
+                const auto& bounds = histogram.bounds();
+                std::uint64_t cumulative = 0;
+                for (std::size_t i = 0; i < bounds.size(); ++i) {
+                    cumulative += histogram.BucketCount(i);
+                    AppendBucket(out, entry.family, entry.labels, bounds[i], cumulative);
+                }
+                cumulative += histogram.BucketCount(bounds.size());
+                AppendBucket(out, entry.family, entry.labels, INFINITY, cumulative);
+                AppendSeriesName(out, entry.family, "_sum", entry.labels);
+                AppendDouble(out, histogram.Sum());
+                out.push_back('\n');
+                AppendSeriesName(out, entry.family, "_count", entry.labels);
+                AppendUint(out, cumulative);
+                out.push_back('\n');
+                break;
+            }
+        }
+    }
+}
+
+std::string MetricsRegistry::Serialize() const {
+    std::string out;
+    AppendTo(out);
+    return out;
+}
+
+}  // namespace arena60
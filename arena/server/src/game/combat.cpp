@@ -25,20 +25,31 @@ bool HealthComponent::ApplyDamage(int amount) {
 
 void HealthComponent::Reset() { current_ = max_; }
 
-CombatLog::CombatLog(std::size_t capacity) : capacity_(capacity) {}
+CombatLog::CombatLog(std::size_t capacity) : capacity_(capacity) { events_.reserve(capacity_); }
 
 void CombatLog::Add(const CombatEvent& event) {
     if (capacity_ == 0) {
         return;
     }
-    events_.push_back(event);
-    if (events_.size() > capacity_) {
-        events_.pop_front();
+    if (events_.size() < capacity_) {
+        events_.push_back(event);
+    } else {
+        events_[next_] = event;
     }
+    next_ = (next_ + 1) % capacity_;
 }
 
 std::vector<CombatEvent> CombatLog::Snapshot() const {
-    return std::vector<CombatEvent>(events_.begin(), events_.end());
+    if (events_.size() < capacity_) {
+        return events_;
+    }
+    std::vector<CombatEvent> ordered;
+    ordered.reserve(events_.size());
+    ordered.insert(ordered.end(), events_.begin() + static_cast<std::ptrdiff_t>(next_),
+                   events_.end());
+    ordered.insert(ordered.end(), events_.begin(),
+                   events_.begin() + static_cast<std::ptrdiff_t>(next_));
+    return ordered;
 }
 
 std::size_t CombatLog::Size() const noexcept { return events_.size(); }
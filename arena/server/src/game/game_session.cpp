@@ -8,21 +8,31 @@
 
 namespace arena60 {
 
+template <typename Rules>
+BasicGameSession<Rules>::BasicGameSession(double /*tick_rate*/, std::size_t combat_log_capacity,
+                                          Rules rules)
+    : rules_(rules), combat_log_(combat_log_capacity) {}
+
 namespace {
-constexpr double kPlayerSpeed = 5.0;   // meters per second
-constexpr double kPlayerRadius = 0.5;  // meters
-constexpr double kFireCooldown = 0.1;  // seconds (10 shots per second)
-constexpr double kSpawnOffset = 0.3;   // meters
-constexpr int kDamagePerHit = 20;      // hit points per collision
+// Gap left between a mover and the face it stopped against, so the next sweep starts outside.
+constexpr double kContactSkin = 1e-4;  // meters
+// Faces a move may slide along; two settles a mover into an axis-aligned corner.
+constexpr int kSlidePasses = 2;
 }  // namespace
 
-GameSession::GameSession(double /*tick_rate*/) : speed_per_second_(kPlayerSpeed), combat_log_(32) {}
+template <typename Rules>
+void BasicGameSession<Rules>::SetStaticGeometry(std::shared_ptr<const StaticGeometry> geometry) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    geometry_ = std::move(geometry);
+}
 
-void GameSession::UpsertPlayer(const std::string& player_id) {
+template <typename Rules>
+void BasicGameSession<Rules>::UpsertPlayer(const std::string& player_id) {
     std::lock_guard<std::mutex> lk(mutex_);
     auto& runtime = players_[player_id];
     if (runtime.state.player_id.empty()) {
         runtime.state.player_id = player_id;
+        runtime.health = HealthComponent(rules_.MaxHealth());
         runtime.state.x = 0.0;
         runtime.state.y = 0.0;
         runtime.state.facing_radians = 0.0;
@@ -30,6 +40,9 @@ void GameSession::UpsertPlayer(const std::string& player_id) {
         runtime.shots_fired = 0;
         runtime.hits_landed = 0;
         runtime.deaths = 0;
+        runtime.kills = 0;
+        runtime.damage_dealt = 0;
+        runtime.damage_taken = 0;
         runtime.state.shots_fired = 0;
         runtime.state.hits_landed = 0;
         runtime.state.deaths = 0;
@@ -41,7 +54,8 @@ void GameSession::UpsertPlayer(const std::string& player_id) {
     runtime.last_fire_time = std::numeric_limits<double>::lowest();
 }
 
-void GameSession::RemovePlayer(const std::string& player_id) {
+template <typename Rules>
+void BasicGameSession<Rules>::RemovePlayer(const std::string& player_id) {
     std::lock_guard<std::mutex> lk(mutex_);
     players_.erase(player_id);
     projectiles_.erase(std::remove_if(projectiles_.begin(), projectiles_.end(),
@@ -49,10 +63,12 @@ void GameSession::RemovePlayer(const std::string& player_id) {
                                           return projectile.owner_id() == player_id;
                                       }),
                        projectiles_.end());
+    projectiles_active_.Set(static_cast<double>(projectiles_.size()));
 }
 
-void GameSession::ApplyInput(const std::string& player_id, const MovementInput& input,
-                             double delta_seconds) {
+template <typename Rules>
+void BasicGameSession<Rules>::ApplyInput(const std::string& player_id,
+                                         const MovementInput& input, double delta_seconds) {
     std::lock_guard<std::mutex> lk(mutex_);
     auto it = players_.find(player_id);
     if (it == players_.end()) {
@@ -90,20 +106,21 @@ void GameSession::ApplyInput(const std::string& player_id, const MovementInput&
             dy /= magnitude;
         }
 
-        const double distance = speed_per_second_ * delta_seconds;
-        state.x += dx * distance;
-        state.y += dy * distance;
+        const double distance = rules_.PlayerSpeed() * delta_seconds;
+        MovePlayerLocked(state, dx * distance, dy * distance);
     }
 
     TrySpawnProjectile(runtime, input);
 }
 
-void GameSession::Tick(std::uint64_t tick, double delta_seconds) {
+template <typename Rules>
+void BasicGameSession<Rules>::Tick(std::uint64_t tick, double delta_seconds) {
     std::lock_guard<std::mutex> lk(mutex_);
     UpdateProjectilesLocked(tick, delta_seconds);
 }
 
-PlayerState GameSession::GetPlayer(const std::string& player_id) const {
+template <typename Rules>
+PlayerState BasicGameSession<Rules>::GetPlayer(const std::string& player_id) const {
     std::lock_guard<std::mutex> lk(mutex_);
     auto it = players_.find(player_id);
     if (it == players_.end()) {
@@ -112,7 +129,8 @@ PlayerState GameSession::GetPlayer(const std::string& player_id) const {
     return it->second.state;
 }
 
-std::vector<PlayerState> GameSession::Snapshot() const {
+template <typename Rules>
+std::vector<PlayerState> BasicGameSession<Rules>::Snapshot() const {
     std::lock_guard<std::mutex> lk(mutex_);
     std::vector<PlayerState> states;
     states.reserve(players_.size());
@@ -122,46 +140,101 @@ std::vector<PlayerState> GameSession::Snapshot() const {
     return states;
 }
 
-std::vector<CombatEvent> GameSession::ConsumeDeathEvents() {
+template <typename Rules>
+std::vector<CombatEvent> BasicGameSession<Rules>::ConsumeDeathEvents() {
     std::lock_guard<std::mutex> lk(mutex_);
     std::vector<CombatEvent> events = std::move(pending_deaths_);
     pending_deaths_.clear();
     return events;
 }
 
-std::vector<CombatEvent> GameSession::CombatLogSnapshot() const {
+template <typename Rules>
+std::vector<CombatEvent> BasicGameSession<Rules>::CombatLogSnapshot() const {
     std::lock_guard<std::mutex> lk(mutex_);
     return combat_log_.Snapshot();
 }
 
-std::string GameSession::MetricsSnapshot() const {
+template <typename Rules>
+std::vector<PlayerCombatTotals> BasicGameSession<Rules>::CombatTotalsSnapshot() const {
     std::lock_guard<std::mutex> lk(mutex_);
-    std::ostringstream oss;
-    const auto active_projectiles =
-        std::count_if(projectiles_.begin(), projectiles_.end(),
-                      [](const Projectile& projectile) { return projectile.active(); });
-    oss << "# TYPE projectiles_active gauge\n";
-    oss << "projectiles_active " << active_projectiles << "\n";
-    oss << "# TYPE projectiles_spawned_total counter\n";
-    oss << "projectiles_spawned_total " << projectiles_spawned_total_ << "\n";
-    oss << "# TYPE projectiles_hits_total counter\n";
-    oss << "projectiles_hits_total " << projectiles_hits_total_ << "\n";
-    oss << "# TYPE players_dead_total counter\n";
-    oss << "players_dead_total " << players_dead_total_ << "\n";
-    oss << "# TYPE collisions_checked_total counter\n";
-    oss << "collisions_checked_total " << collisions_checked_total_ << "\n";
-    return oss.str();
+    std::vector<PlayerCombatTotals> totals;
+    totals.reserve(players_.size());
+    for (const auto& kv : players_) {
+        const PlayerRuntimeState& runtime = kv.second;
+        PlayerCombatTotals entry;
+        entry.player_id = runtime.state.player_id;
+        entry.shots_fired = static_cast<std::uint32_t>(runtime.shots_fired);
+        entry.hits_landed = static_cast<std::uint32_t>(runtime.hits_landed);
+        entry.kills = runtime.kills;
+        entry.deaths = static_cast<std::uint32_t>(runtime.deaths);
+        entry.damage_dealt = runtime.damage_dealt;
+        entry.damage_taken = runtime.damage_taken;
+        totals.push_back(std::move(entry));
+    }
+    return totals;
 }
 
-std::size_t GameSession::ActiveProjectileCount() const {
+template <typename Rules>
+void BasicGameSession<Rules>::RegisterMetrics(MetricsRegistry& registry) const {
+    registry.Register("projectiles_active", projectiles_active_);
+    registry.Register("projectiles_spawned_total", projectiles_spawned_total_);
+    registry.Register("projectiles_hits_total", projectiles_hits_total_);
+    registry.Register("players_dead_total", players_dead_total_);
+    registry.Register("collisions_checked_total", collisions_checked_total_);
+    registry.Register("projectiles_blocked_total", projectiles_blocked_total_);
+    registry.Register("projectiles_intercepted_total", projectiles_intercepted_total_);
+}
+
+template <typename Rules>
+std::string BasicGameSession<Rules>::MetricsSnapshot() const {
+    MetricsRegistry registry;
+    RegisterMetrics(registry);
+    return registry.Serialize();
+}
+
+template <typename Rules>
+std::size_t BasicGameSession<Rules>::ActiveProjectileCount() const {
     std::lock_guard<std::mutex> lk(mutex_);
     return std::count_if(projectiles_.begin(), projectiles_.end(),
                          [](const Projectile& projectile) { return projectile.active(); });
 }
 
-void GameSession::AppendCombatEvent(const CombatEvent& event) { combat_log_.Add(event); }
+template <typename Rules>
+void BasicGameSession<Rules>::AppendCombatEvent(const CombatEvent& event) {
+    combat_log_.Add(event);
+}
 
-bool GameSession::TrySpawnProjectile(PlayerRuntimeState& runtime, const MovementInput& input) {
+template <typename Rules>
+void BasicGameSession<Rules>::MovePlayerLocked(PlayerState& state, double dx, double dy) const {
+    if (!geometry_ || geometry_->empty()) {
+        state.x += dx;
+        state.y += dy;
+        return;
+    }
+    for (int pass = 0; pass < kSlidePasses && (dx != 0.0 || dy != 0.0); ++pass) {
+        const SweepHit hit =
+            geometry_->SweepCircle(state.x, state.y, dx, dy, rules_.PlayerRadius());
+        if (!hit.hit) {
+            state.x += dx;
+            state.y += dy;
+            return;
+        }
+        const double length = std::sqrt(dx * dx + dy * dy);
+        const double travel = std::max(0.0, hit.fraction - kContactSkin / length);
+        state.x += dx * travel;
+        state.y += dy * travel;
+        // Keep the rest of the move minus its component into the face.
+        dx *= 1.0 - travel;
+        dy *= 1.0 - travel;
+        const double into = dx * hit.normal_x + dy * hit.normal_y;
+        dx -= into * hit.normal_x;
+        dy -= into * hit.normal_y;
+    }
+}
+
+template <typename Rules>
+bool BasicGameSession<Rules>::TrySpawnProjectile(PlayerRuntimeState& runtime,
+                                                 const MovementInput& input) {
     if (!input.fire || !runtime.state.is_alive) {
         return false;
     }
@@ -172,7 +245,7 @@ bool GameSession::TrySpawnProjectile(PlayerRuntimeState& runtime, const Movement
         return false;
     }
 
-    if ((elapsed_time_ - runtime.last_fire_time) < kFireCooldown) {
+    if ((elapsed_time_ - runtime.last_fire_time) < rules_.FireCooldown()) {
         return false;
     }
 
@@ -180,8 +253,18 @@ bool GameSession::TrySpawnProjectile(PlayerRuntimeState& runtime, const Movement
 
     const double dir_x = input.mouse_x / aim_magnitude;
     const double dir_y = input.mouse_y / aim_magnitude;
-    const double spawn_x = runtime.state.x + dir_x * kSpawnOffset;
-    const double spawn_y = runtime.state.y + dir_y * kSpawnOffset;
+    const double spawn_x = runtime.state.x + dir_x * rules_.SpawnOffset();
+    const double spawn_y = runtime.state.y + dir_y * rules_.SpawnOffset();
+    ++runtime.shots_fired;
+    runtime.state.shots_fired = runtime.shots_fired;
+    // A shot fired point-blank into a wall is spent without ever entering the world.
+    if (geometry_ && geometry_->SweepCircle(runtime.state.x, runtime.state.y,
+                                            spawn_x - runtime.state.x, spawn_y - runtime.state.y,
+                                            rules_.ProjectileRadius())
+                         .hit) {
+        projectiles_blocked_total_.Increment();
+        return true;
+    }
 
     std::ostringstream id_stream;
     id_stream << "projectile-" << ++projectile_counter_;
@@ -190,22 +273,41 @@ bool GameSession::TrySpawnProjectile(PlayerRuntimeState& runtime, const Movement
     std::cout << "projectile spawn " << projectile.id() << " owner=" << runtime.state.player_id
               << std::endl;
     projectiles_.push_back(std::move(projectile));
-    ++projectiles_spawned_total_;
-    ++runtime.shots_fired;
-    runtime.state.shots_fired = runtime.shots_fired;
+    projectiles_spawned_total_.Increment();
+    projectiles_active_.Add(1.0);
     return true;
 }
 
-void GameSession::UpdateProjectilesLocked(std::uint64_t tick, double delta_seconds) {
+template <typename Rules>
+void BasicGameSession<Rules>::UpdateProjectilesLocked(std::uint64_t tick, double delta_seconds) {
     elapsed_time_ += delta_seconds;
 
+    const bool has_geometry = geometry_ && !geometry_->empty();
+    std::uint64_t blocked = 0;
     for (auto& projectile : projectiles_) {
-        projectile.Advance(delta_seconds);
-        if (projectile.IsExpired(elapsed_time_)) {
+        const double start_x = projectile.x();
+        const double start_y = projectile.y();
+        projectile.Advance(delta_seconds, rules_);
+        if (has_geometry && projectile.active() &&
+            geometry_
+                ->SweepCircle(start_x, start_y, projectile.x() - start_x,
+                              projectile.y() - start_y, rules_.ProjectileRadius())
+                .hit) {
+            projectile.Deactivate();
+            ++blocked;
+            continue;
+        }
+        if (projectile.IsExpired(elapsed_time_, rules_)) {
             projectile.Deactivate();
         }
     }
+    projectiles_blocked_total_.Increment(blocked);
+    if (rules_.ProjectilesCollide()) {
+        CollideProjectilesLocked(delta_seconds);
+    }
 
+    const int damage = rules_.DamagePerHit();
+    const double radius_sum = rules_.ProjectileRadius() + rules_.PlayerRadius();
     std::uint64_t pairs_checked = 0;
     for (auto& projectile : projectiles_) {
         if (!projectile.active()) {
@@ -219,33 +321,36 @@ void GameSession::UpdateProjectilesLocked(std::uint64_t tick, double delta_secon
             ++pairs_checked;
             const double dx = projectile.x() - runtime.state.x;
             const double dy = projectile.y() - runtime.state.y;
-            const double radius_sum = projectile.radius() + kPlayerRadius;
             if (std::abs(dx) > radius_sum || std::abs(dy) > radius_sum) {
                 continue;
             }
             const double distance_sq = dx * dx + dy * dy;
             if (distance_sq <= radius_sum * radius_sum) {
                 projectile.Deactivate();
-                CombatEvent hit_event;
-                hit_event.type = CombatEventType::Hit;
-                hit_event.shooter_id = projectile.owner_id();
-                hit_event.target_id = runtime.state.player_id;
-                hit_event.projectile_id = projectile.id();
-                hit_event.damage = kDamagePerHit;
-                hit_event.tick = tick;
-                AppendCombatEvent(hit_event);
-                std::cout << "hit " << hit_event.shooter_id << "->" << hit_event.target_id
-                          << " dmg=" << hit_event.damage << std::endl;
-                ++projectiles_hits_total_;
-
-                const bool died = runtime.health.ApplyDamage(kDamagePerHit);
+                if (combat_log_.Enabled()) {
+                    CombatEvent hit_event;
+                    hit_event.type = CombatEventType::Hit;
+                    hit_event.shooter_id = projectile.owner_id();
+                    hit_event.target_id = runtime.state.player_id;
+                    hit_event.projectile_id = projectile.id();
+                    hit_event.damage = damage;
+                    hit_event.tick = tick;
+                    AppendCombatEvent(hit_event);
+                }
+                std::cout << "hit " << projectile.owner_id() << "->" << runtime.state.player_id
+                          << " dmg=" << damage << std::endl;
+                projectiles_hits_total_.Increment();
+
+                const bool died = runtime.health.ApplyDamage(damage);
                 runtime.state.health = runtime.health.current();
                 runtime.state.is_alive = runtime.health.is_alive();
+                runtime.damage_taken += static_cast<std::uint64_t>(damage);
 
                 auto shooter_it = players_.find(projectile.owner_id());
                 if (shooter_it != players_.end()) {
                     ++shooter_it->second.hits_landed;
                     shooter_it->second.state.hits_landed = shooter_it->second.hits_landed;
+                    shooter_it->second.damage_dealt += static_cast<std::uint64_t>(damage);
                 }
 
                 if (died && !runtime.death_announced) {
@@ -258,9 +363,12 @@ void GameSession::UpdateProjectilesLocked(std::uint64_t tick, double delta_secon
                     death_event.tick = tick;
                     pending_deaths_.push_back(death_event);
                     AppendCombatEvent(death_event);
-                    ++players_dead_total_;
+                    players_dead_total_.Increment();
                     ++runtime.deaths;
                     runtime.state.deaths = runtime.deaths;
+                    if (shooter_it != players_.end()) {
+                        ++shooter_it->second.kills;
+                    }
                     std::cout << "death " << runtime.state.player_id << std::endl;
                 }
                 break;
@@ -268,12 +376,75 @@ void GameSession::UpdateProjectilesLocked(std::uint64_t tick, double delta_secon
         }
     }
 
-    collisions_checked_total_ += pairs_checked;
+    collisions_checked_total_.Increment(pairs_checked);
 
     projectiles_.erase(
         std::remove_if(projectiles_.begin(), projectiles_.end(),
                        [](const Projectile& projectile) { return !projectile.active(); }),
         projectiles_.end());
+    projectiles_active_.Set(static_cast<double>(projectiles_.size()));
 }
 
+template <typename Rules>
+void BasicGameSession<Rules>::CollideProjectilesLocked(double delta_seconds) {
+    // Projectiles close at up to twice their speed, several diameters per tick, so pairs are
+    // tested at their closest approach along this tick's paths rather than at end positions.
+    // Sweep and prune on the paths' x extents keeps the pair count near linear.
+    const double radius = rules_.ProjectileRadius();
+    const double step = rules_.ProjectileSpeed() * delta_seconds;
+    sweep_order_.clear();
+    for (std::size_t i = 0; i < projectiles_.size(); ++i) {
+        const Projectile& projectile = projectiles_[i];
+        if (!projectile.active()) {
+            continue;
+        }
+        const double start_x = projectile.x() - projectile.direction_x() * step;
+        sweep_order_.push_back(SweptProjectile{static_cast<std::uint32_t>(i),
+                                               std::min(start_x, projectile.x()) - radius,
+                                               std::max(start_x, projectile.x()) + radius});
+    }
+    std::sort(sweep_order_.begin(), sweep_order_.end(),
+              [](const SweptProjectile& lhs, const SweptProjectile& rhs) {
+                  return lhs.min_x < rhs.min_x;
+              });
+    const double diameter_sq = 4.0 * radius * radius;
+    std::uint64_t intercepted = 0;
+    for (std::size_t i = 0; i < sweep_order_.size(); ++i) {
+        Projectile& first = projectiles_[sweep_order_[i].index];
+        for (std::size_t j = i + 1; j < sweep_order_.size() && first.active(); ++j) {
+            if (sweep_order_[j].min_x > sweep_order_[i].max_x) {
+                break;
+            }
+            Projectile& second = projectiles_[sweep_order_[j].index];
+            if (!second.active() || second.owner_id() == first.owner_id()) {
+                continue;
+            }
+            // Relative position at the end of the tick and relative displacement over it.
+            const double end_x = second.x() - first.x();
+            const double end_y = second.y() - first.y();
+            const double move_x = (second.direction_x() - first.direction_x()) * step;
+            const double move_y = (second.direction_y() - first.direction_y()) * step;
+            const double start_x = end_x - move_x;
+            const double start_y = end_y - move_y;
+            const double move_sq = move_x * move_x + move_y * move_y;
+            double t = 1.0;
+            if (move_sq > 0.0) {
+                t = std::clamp(-(start_x * move_x + start_y * move_y) / move_sq, 0.0, 1.0);
+            }
+            const double closest_x = start_x + move_x * t;
+            const double closest_y = start_y + move_y * t;
+            if (closest_x * closest_x + closest_y * closest_y <= diameter_sq) {
+                first.Deactivate();
+                second.Deactivate();
+                intercepted += 2;
+            }
+        }
+    }
+    projectiles_intercepted_total_.Increment(intercepted);
+}
+
+template class BasicGameSession<StandardRules>;
+template class BasicGameSession<RapidFireRules>;
+template class BasicGameSession<RuntimeRules>;
+
 }  // namespace arena60
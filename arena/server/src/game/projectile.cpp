@@ -26,19 +26,10 @@ Projectile::Projectile(std::string id, std::string owner_id, double x, double y,
     dir_y_ /= magnitude;
 }
 
-void Projectile::Advance(double delta_seconds) {
-    if (!active_) {
-        return;
-    }
-    x_ += dir_x_ * kSpeed_ * delta_seconds;
-    y_ += dir_y_ * kSpeed_ * delta_seconds;
-}
+void Projectile::Advance(double delta_seconds) { Advance(delta_seconds, StandardRules{}); }
 
 bool Projectile::IsExpired(double now_seconds) const {
-    if (!active_) {
-        return true;
-    }
-    return (now_seconds - spawn_time_) >= kLifetime_;
+    return IsExpired(now_seconds, StandardRules{});
 }
 
 void Projectile::Deactivate() { active_ = false; }
@@ -59,10 +50,10 @@ double Projectile::spawn_time() const noexcept { return spawn_time_; }
 
 bool Projectile::active() const noexcept { return active_; }
 
-double Projectile::radius() const noexcept { return kRadius_; }
+double Projectile::radius() const noexcept { return StandardRules::ProjectileRadius(); }
 
-double Projectile::Speed() noexcept { return kSpeed_; }
+double Projectile::Speed() noexcept { return StandardRules::ProjectileSpeed(); }
 
-double Projectile::Lifetime() noexcept { return kLifetime_; }
+double Projectile::Lifetime() noexcept { return StandardRules::ProjectileLifetime(); }
 
 }  // namespace arena60
@@ -0,0 +1,309 @@
+#include "arena60/game/static_geometry.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace arena60 {
+
+namespace {
+
+constexpr std::uint32_t kLeafSize = 4;
+constexpr std::size_t kMaxStackDepth = 64;
+constexpr double kWallThickness = 1.0;  // meters, for walls generated by "bounds"
+constexpr double kParallelEpsilon = 1e-12;
+
+Aabb Grow(const Aabb& box, double radius) {
+    return Aabb{box.min_x - radius, box.min_y - radius, box.max_x + radius, box.max_y + radius};
+}
+
+Aabb Union(const Aabb& lhs, const Aabb& rhs) {
+    return Aabb{std::min(lhs.min_x, rhs.min_x), std::min(lhs.min_y, rhs.min_y),
+                std::max(lhs.max_x, rhs.max_x), std::max(lhs.max_y, rhs.max_y)};
+}
+
+bool StrictlyContains(const Aabb& box, double x, double y) {
+    return x > box.min_x && x < box.max_x && y > box.min_y && y < box.max_y;
+}
+
+// The swept centre's path, (x, y) + t * (dx, dy) for t in [0, 1], with the reciprocals every
+// slab test needs computed once per query.
+struct Segment {
+    Segment(double x_in, double y_in, double dx_in, double dy_in)
+        : x(x_in),
+          y(y_in),
+          dx(dx_in),
+          dy(dy_in),
+          inv_dx(std::abs(dx_in) < kParallelEpsilon ? 0.0 : 1.0 / dx_in),
+          inv_dy(std::abs(dy_in) < kParallelEpsilon ? 0.0 : 1.0 / dy_in) {}
+
+    double x, y, dx, dy, inv_dx, inv_dy;
+};
+
+// Clips the segment's parameter range to one slab. Returns false once the range is empty.
+bool ClipAxis(double origin, double delta, double inverse, double slab_min, double slab_max,
+              double& t_enter, double& t_exit, bool& entered_on_axis, double& entry_sign) {
+    if (inverse == 0.0) {
+        return origin >= slab_min && origin <= slab_max;
+    }
+    double t_near = (slab_min - origin) * inverse;
+    double t_far = (slab_max - origin) * inverse;
+    if (t_near > t_far) {
+        std::swap(t_near, t_far);
+    }
+    if (t_near > t_enter) {
+        t_enter = t_near;
+        entered_on_axis = true;
+        entry_sign = delta > 0.0 ? -1.0 : 1.0;
+    }
+    t_exit = std::min(t_exit, t_far);
+    return t_enter <= t_exit;
+}
+
+// Whether the segment, cut off at limit, passes through the box; used to cull BVH nodes, so
+// starting inside counts as entering at t = 0.
+bool SegmentTouches(const Aabb& box, const Segment& segment, double limit, double& t_enter) {
+    double enter = 0.0;
+    double exit = limit;
+    bool unused_axis = false;
+    double unused_sign = 0.0;
+    if (!ClipAxis(segment.x, segment.dx, segment.inv_dx, box.min_x, box.max_x, enter, exit,
+                  unused_axis, unused_sign) ||
+        !ClipAxis(segment.y, segment.dy, segment.inv_dy, box.min_y, box.max_y, enter, exit,
+                  unused_axis, unused_sign)) {
+        return false;
+    }
+    t_enter = enter;
+    return true;
+}
+
+// Entry of the segment into a grown obstacle, with the normal of the face it enters through.
+bool SegmentEnters(const Aabb& box, const Segment& segment, double limit, SweepHit& hit) {
+    if (StrictlyContains(box, segment.x, segment.y)) {
+        return false;
+    }
+    double enter = -std::numeric_limits<double>::infinity();
+    double exit = std::numeric_limits<double>::infinity();
+    bool entered_x = false;
+    bool entered_y = false;
+    double sign_x = 0.0;
+    double sign_y = 0.0;
+    if (!ClipAxis(segment.x, segment.dx, segment.inv_dx, box.min_x, box.max_x, enter, exit,
+                  entered_x, sign_x) ||
+        !ClipAxis(segment.y, segment.dy, segment.inv_dy, box.min_y, box.max_y, enter, exit,
+                  entered_y, sign_y)) {
+        return false;
+    }
+    if (enter < 0.0 || enter >= limit || exit <= 0.0) {
+        return false;
+    }
+    hit.hit = true;
+    hit.fraction = enter;
+    // y is clipped second and only claims the entry when it enters later than x did.
+    if (entered_y) {
+        hit.normal_x = 0.0;
+        hit.normal_y = sign_y;
+    } else {
+        hit.normal_x = sign_x;
+        hit.normal_y = 0.0;
+    }
+    return true;
+}
+
+std::string Trim(const std::string& line) {
+    const auto comment = line.find('#');
+    std::string text = line.substr(0, comment);
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+}  // namespace
+
+StaticGeometry::StaticGeometry(std::vector<Aabb> boxes) : boxes_(std::move(boxes)) { Build(); }
+
+bool StaticGeometry::Load(std::istream& input) {
+    std::vector<Aabb> boxes;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(input, line)) {
+        ++line_number;
+        const std::string text = Trim(line);
+        if (text.empty()) {
+            continue;
+        }
+        std::istringstream fields(text);
+        std::string directive;
+        Aabb box;
+        std::string extra;
+        fields >> directive;
+        if (directive != "box" && directive != "bounds") {
+            std::cerr << "map line " << line_number << ": unknown directive '" << directive
+                      << "'" << std::endl;
+            return false;
+        }
+        const bool parsed = static_cast<bool>(fields >> box.min_x >> box.min_y >> box.max_x >>
+                                              box.max_y) &&
+                            !(fields >> extra);
+        if (!parsed || box.min_x > box.max_x || box.min_y > box.max_y) {
+            std::cerr << "map line " << line_number << ": expected '" << directive
+                      << " min_x min_y max_x max_y', got '" << text << "'" << std::endl;
+            return false;
+        }
+        if (directive == "box") {
+            boxes.push_back(box);
+        } else {
+            const double t = kWallThickness;
+            boxes.push_back({box.min_x - t, box.min_y - t, box.min_x, box.max_y + t});
+            boxes.push_back({box.max_x, box.min_y - t, box.max_x + t, box.max_y + t});
+            boxes.push_back({box.min_x, box.min_y - t, box.max_x, box.min_y});
+            boxes.push_back({box.min_x, box.max_y, box.max_x, box.max_y + t});
+        }
+    }
+    boxes_ = std::move(boxes);
+    Build();
+    return true;
+}
+
+bool StaticGeometry::LoadFromFile(const std::string& path) {
+    std::ifstream input(path);
+    if (!input) {
+        std::cerr << "failed to open map file " << path << std::endl;
+        return false;
+    }
+    return Load(input);
+}
+
+SweepHit StaticGeometry::SweepCircle(double x, double y, double dx, double dy,
+                                     double radius) const {
+    SweepHit best;
+    const Segment segment(x, y, dx, dy);
+    double root_t = 0.0;
+    if (nodes_.empty() ||
+        !SegmentTouches(Grow(nodes_[0].bounds, radius), segment, best.fraction, root_t)) {
+        return best;
+    }
+    // Entries carry the segment's entry time into the node so nodes beyond a closer hit found
+    // after they were pushed are skipped without another slab test.
+    struct Pending {
+        std::uint32_t index;
+        double t_enter;
+    };
+    std::array<Pending, kMaxStackDepth> stack;
+    std::size_t depth = 0;
+    stack[depth++] = Pending{0, root_t};
+    while (depth > 0) {
+        const Pending pending = stack[--depth];
+        if (pending.t_enter >= best.fraction) {
+            continue;
+        }
+        const Node& node = nodes_[pending.index];
+        if (node.count > 0) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                SegmentEnters(Grow(boxes_[i], radius), segment, best.fraction, best);
+            }
+            continue;
+        }
+        // Children sit at index + 1 and node.first; the closer one is pushed last.
+        Pending closer{pending.index + 1, 0.0};
+        Pending farther{node.first, 0.0};
+        const bool closer_hit = SegmentTouches(Grow(nodes_[closer.index].bounds, radius), segment,
+                                               best.fraction, closer.t_enter);
+        const bool farther_hit = SegmentTouches(Grow(nodes_[farther.index].bounds, radius),
+                                                segment, best.fraction, farther.t_enter);
+        if (closer_hit && farther_hit) {
+            if (farther.t_enter < closer.t_enter) {
+                std::swap(closer, farther);
+            }
+            stack[depth++] = farther;
+            stack[depth++] = closer;
+        } else if (closer_hit) {
+            stack[depth++] = closer;
+        } else if (farther_hit) {
+            stack[depth++] = farther;
+        }
+    }
+    return best;
+}
+
+bool StaticGeometry::OverlapsCircle(double x, double y, double radius) const {
+    if (nodes_.empty()) {
+        return false;
+    }
+    std::array<std::uint32_t, kMaxStackDepth> stack;
+    std::size_t depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const std::uint32_t index = stack[--depth];
+        const Node& node = nodes_[index];
+        if (!StrictlyContains(Grow(node.bounds, radius), x, y)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[depth++] = node.first;
+            stack[depth++] = index + 1;
+            continue;
+        }
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+            if (StrictlyContains(Grow(boxes_[i], radius), x, y)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void StaticGeometry::Build() {
+    nodes_.clear();
+    if (boxes_.empty()) {
+        return;
+    }
+    nodes_.reserve(2 * (boxes_.size() / kLeafSize + 1));
+    BuildRange(0, static_cast<std::uint32_t>(boxes_.size()));
+}
+
+std::uint32_t StaticGeometry::BuildRange(std::uint32_t first, std::uint32_t count) {
+    const auto index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(Node{});
+    Aabb bounds = boxes_[first];
+    Aabb centroids{bounds.min_x + bounds.max_x, bounds.min_y + bounds.max_y,
+                   bounds.min_x + bounds.max_x, bounds.min_y + bounds.max_y};
+    for (std::uint32_t i = first + 1; i < first + count; ++i) {
+        const Aabb& box = boxes_[i];
+        bounds = Union(bounds, box);
+        const double cx = box.min_x + box.max_x;
+        const double cy = box.min_y + box.max_y;
+        centroids = Union(centroids, Aabb{cx, cy, cx, cy});
+    }
+    nodes_[index].bounds = bounds;
+    if (count <= kLeafSize) {
+        nodes_[index].first = first;
+        nodes_[index].count = count;
+        return index;
+    }
+
+    // Median split on the longest centroid axis keeps the tree balanced, so depth stays close to
+    // log2(n / kLeafSize) and the fixed traversal stack cannot overflow.
+    const bool split_x = (centroids.max_x - centroids.min_x) >= (centroids.max_y - centroids.min_y);
+    const std::uint32_t half = count / 2;
+    std::nth_element(boxes_.begin() + first, boxes_.begin() + first + half,
+                     boxes_.begin() + first + count, [split_x](const Aabb& lhs, const Aabb& rhs) {
+                         return split_x ? lhs.min_x + lhs.max_x < rhs.min_x + rhs.max_x
+                                        : lhs.min_y + lhs.max_y < rhs.min_y + rhs.max_y;
+                     });
+    BuildRange(first, half);
+    const std::uint32_t second = BuildRange(first + half, count - half);
+    nodes_[index].first = second;
+    nodes_[index].count = 0;
+    return index;
+}
+
+}  // namespace arena60
@@ -1,17 +1,22 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/beast/http.hpp>
+#include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <functional>
 #include <iostream>
 #include <memory>
-#include <sstream>
+#include <string>
 
 #include "arena60/core/config.h"
 #include "arena60/core/game_loop.h"
+#include "arena60/core/metrics_registry.h"
 #include "arena60/game/game_session.h"
+#include "arena60/game/static_geometry.h"
 #include "arena60/matchmaking/match_queue.h"
 #include "arena60/matchmaking/matchmaker.h"
 #include "arena60/network/metrics_http_server.h"
@@ -19,7 +24,11 @@
 #include "arena60/network/websocket_server.h"
 #include "arena60/stats/leaderboard_store.h"
 #include "arena60/stats/player_profile_service.h"
+#include "arena60/stats/profile_journal.h"
+#include "arena60/storage/match_result_writer.h"
 #include "arena60/storage/postgres_storage.h"
+#include "arena60/storage/redis_client.h"
+#include "arena60/storage/session_event_writer.h"
 
 int main() {
     using namespace arena60;
@@ -28,43 +37,119 @@ int main() {
     std::cout << "Arena60 Game Server starting on port " << config.port() << std::endl;
 
     GameSession session(config.tick_rate());
+    if (!config.map_file().empty()) {
+        auto geometry = std::make_shared<StaticGeometry>();
+        if (geometry->LoadFromFile(config.map_file())) {
+            std::cout << "Loaded " << geometry->size() << " obstacles from " << config.map_file()
+                      << std::endl;
+            session.SetStaticGeometry(std::move(geometry));
+        } else {
+            std::cerr << "Map unavailable; the arena stays an open plane." << std::endl;
+        }
+    }
     GameLoop loop(config.tick_rate());
-    PostgresStorage storage(config.database_dsn());
-    if (!storage.Connect()) {
+    auto storage = std::make_shared<PostgresStorage>(config.database_dsn());
+    if (!storage->Connect()) {
         std::cerr << "Failed to connect to Postgres at startup; continuing in degraded mode."
                   << std::endl;
     }
+    SessionEventWriter session_events(storage);
+    session_events.Start();
+    // Match persistence and pool health checks run here so libpq never blocks the io_context.
+    boost::asio::thread_pool storage_pool(1);
+    auto match_results = std::make_shared<MatchResultWriter>(storage_pool.get_executor(), storage);
+    // Queue updates and matching passes run here, in posting order, because a RedisMatchQueue
+    // waits on round trips while Matchmaker holds its mutex.
+    boost::asio::thread_pool matchmaking_pool(1);
 
     boost::asio::io_context io_context;
-    auto match_queue = std::make_shared<InMemoryMatchQueue>();
+    std::shared_ptr<RedisClient> redis;
+    std::shared_ptr<MatchQueue> match_queue = std::make_shared<InMemoryMatchQueue>();
+    std::shared_ptr<LeaderboardStore> leaderboard = std::make_shared<InMemoryLeaderboardStore>();
+    if (!config.redis_host().empty()) {
+        RedisClientOptions redis_options;
+        redis_options.host = config.redis_host();
+        redis_options.port = config.redis_port();
+        redis = std::make_shared<RedisClient>(redis_options);
+        if (redis->Connect()) {
+            match_queue = std::make_shared<RedisMatchQueue>(redis);
+            leaderboard = std::make_shared<RedisLeaderboardStore>(redis);
+        } else {
+            std::cerr << "Redis unavailable at " << config.redis_host() << ':'
+                      << config.redis_port() << "; matchmaking and leaderboard stay in memory."
+                      << std::endl;
+            redis.reset();
+        }
+    }
     auto matchmaker = std::make_shared<Matchmaker>(match_queue);
-    auto leaderboard = std::make_shared<InMemoryLeaderboardStore>();
     auto profile_service = std::make_shared<PlayerProfileService>(leaderboard);
-    auto server = std::make_shared<WebSocketServer>(io_context, config.port(), session, loop);
+    std::shared_ptr<ProfileJournal> profile_journal;
+    if (!config.profile_data_dir().empty()) {
+        profile_journal = std::make_shared<ProfileJournal>(config.profile_data_dir());
+        if (profile_journal->Recover(*profile_service) && profile_journal->Start(profile_service)) {
+            profile_service->SetChangeSink(profile_journal);
+            std::cout << "Recovered " << profile_journal->RecordsRecovered()
+                      << " profile records from " << config.profile_data_dir() << std::endl;
+        } else {
+            std::cerr << "Profile journal unavailable; profiles will not survive a restart."
+                      << std::endl;
+            profile_journal.reset();
+        }
+    }
+    AdmissionOptions admission;
+    admission.max_connections = config.websocket_max_connections();
+    admission.handshakes_per_second = config.websocket_handshakes_per_second();
+    // A tenth of a second's worth of handshakes may arrive at once.
+    admission.handshake_burst = std::max(1.0, admission.handshakes_per_second / 10.0);
+    // Shed new connections once broadcasts fall half a tick behind.
+    admission.max_tick_lateness_seconds = 0.5 / config.tick_rate();
+    auto server = std::make_shared<WebSocketServer>(
+        io_context, config.port(), session, loop,
+        WebSocketCompression::ForPlayers(config.websocket_deflate_players()), admission);
     server->SetLifecycleHandlers(
         [&, matchmaker](const std::string& player_id) {
-            matchmaker->Enqueue(MatchRequest{player_id, 1200, std::chrono::steady_clock::now()});
-            if (!storage.RecordSessionEvent(player_id, "start")) {
-                std::cerr << "Failed to record session start for " << player_id << std::endl;
+            MatchRequest request{player_id, 1200, std::chrono::steady_clock::now()};
+            boost::asio::post(matchmaking_pool,
+                              [matchmaker, request]() { matchmaker->Enqueue(request); });
+            if (!session_events.Enqueue(player_id, "start")) {
+                std::cerr << "Session event queue full; dropped start for " << player_id
+                          << std::endl;
             }
         },
         [&, matchmaker](const std::string& player_id) {
-            matchmaker->Cancel(player_id);
-            if (!storage.RecordSessionEvent(player_id, "end")) {
-                std::cerr << "Failed to record session end for " << player_id << std::endl;
+            boost::asio::post(matchmaking_pool,
+                              [matchmaker, player_id]() { matchmaker->Cancel(player_id); });
+            if (!session_events.Enqueue(player_id, "end")) {
+                std::cerr << "Session event queue full; dropped end for " << player_id
+                          << std::endl;
             }
         });
-    server->SetMatchCompletedCallback(
-        [profile_service](const MatchResult& result) { profile_service->RecordMatch(result); });
+    server->SetMatchCompletedCallback([profile_service,
+                                       match_results](const MatchResult& result) {
+        profile_service->RecordMatch(result);
+        if (!match_results->Enqueue(result)) {
+            std::cerr << "Match result queue full; dropped " << result.match_id() << std::endl;
+        }
+    });
 
-    auto metrics_provider = [&, server, profile_service]() {
-        std::ostringstream oss;
-        oss << loop.PrometheusSnapshot();
-        oss << server->MetricsSnapshot();
-        oss << storage.MetricsSnapshot();
-        oss << matchmaker->MetricsSnapshot();
-        oss << profile_service->MetricsSnapshot();
-        return oss.str();
+    // Tick, connection and matchmaking metrics are lock-free atomics read through the registry;
+    // the remaining providers are off the hot path and still render their own text.
+    MetricsRegistry metrics_registry;
+    loop.RegisterMetrics(metrics_registry);
+    server->RegisterMetrics(metrics_registry);
+    matchmaker->RegisterMetrics(metrics_registry);
+    auto metrics_provider = [&, profile_service](std::string& out) {
+        metrics_registry.AppendTo(out);
+        out.append(storage->MetricsSnapshot());
+        out.append(session_events.MetricsSnapshot());
+        out.append(match_results->MetricsSnapshot());
+        out.append(profile_service->MetricsSnapshot());
+        if (profile_journal) {
+            out.append(profile_journal->MetricsSnapshot());
+        }
+        if (redis) {
+            out.append(redis->MetricsSnapshot());
+        }
     };
     auto router = std::make_shared<ProfileHttpRouter>(metrics_provider, profile_service);
     MetricsHttpServer::RequestHandler http_handler =
@@ -76,7 +161,7 @@ int main() {
 
     auto matchmaking_timer = std::make_shared<boost::asio::steady_timer>(io_context);
     std::function<void(const boost::system::error_code&)> matchmaking_tick;
-    matchmaking_tick = [matchmaking_timer, matchmaker,
+    matchmaking_tick = [matchmaking_timer, matchmaker, &io_context, &matchmaking_pool,
                         &matchmaking_tick](const boost::system::error_code& ec) {
         if (ec == boost::asio::error::operation_aborted) {
             return;
@@ -85,14 +170,35 @@ int main() {
             std::cerr << "matchmaking timer error: " << ec.message() << std::endl;
             return;
         }
-        matchmaker->RunMatching(std::chrono::steady_clock::now());
-        matchmaker->notification_channel().Drain();
-        matchmaking_timer->expires_after(std::chrono::milliseconds(200));
-        matchmaking_timer->async_wait(matchmaking_tick);
+        // The timer is re-armed once the pass finishes, so a slow Redis stretches the interval
+        // instead of queueing passes behind each other.
+        boost::asio::post(matchmaking_pool, [matchmaking_timer, matchmaker, &io_context,
+                                             &matchmaking_tick]() {
+            matchmaker->RunMatching(std::chrono::steady_clock::now());
+            matchmaker->notification_channel().Drain();
+            boost::asio::post(io_context, [matchmaking_timer, &matchmaking_tick]() {
+                matchmaking_timer->expires_after(std::chrono::milliseconds(200));
+                matchmaking_timer->async_wait(matchmaking_tick);
+            });
+        });
     };
     matchmaking_timer->expires_after(std::chrono::milliseconds(200));
     matchmaking_timer->async_wait(matchmaking_tick);
 
+    auto health_timer = std::make_shared<boost::asio::steady_timer>(io_context);
+    std::function<void(const boost::system::error_code&)> health_tick;
+    health_tick = [health_timer, storage, &storage_pool,
+                   &health_tick](const boost::system::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        boost::asio::post(storage_pool, [storage]() { storage->HealthCheck(); });
+        health_timer->expires_after(std::chrono::seconds(10));
+        health_timer->async_wait(health_tick);
+    };
+    health_timer->expires_after(std::chrono::seconds(10));
+    health_timer->async_wait(health_tick);
+
     boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
     signals.async_wait([&](const boost::system::error_code& /*ec*/, int /*signal*/) {
         std::cout << "Signal received. Shutting down." << std::endl;
@@ -100,6 +206,7 @@ int main() {
         metrics_server->Stop();
         loop.Stop();
         matchmaking_timer->cancel();
+        health_timer->cancel();
         io_context.stop();
     });
 
@@ -112,6 +219,13 @@ int main() {
 
     loop.Stop();
     loop.Join();
+    matchmaking_pool.join();
+    session_events.Stop();
+    match_results->Stop();
+    storage_pool.join();
+    if (profile_journal) {
+        profile_journal->Stop();
+    }
 
     std::cout << "Arena60 Game Server stopped" << std::endl;
     return 0;
@@ -1,8 +1,13 @@
 #include "arena60/matchmaking/match_queue.h"
 
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "arena60/storage/redis_client.h"
 
 namespace arena60 {
 
@@ -87,32 +92,244 @@ std::string InMemoryMatchQueue::Snapshot() const {
     return oss.str();
 }
 
-RedisMatchQueue::RedisMatchQueue(std::ostream& stream) : stream_(&stream) {}
+std::vector<bool> MatchQueue::ClaimPairs(
+    const std::vector<std::pair<std::string, std::string>>& pairs) {
+    std::vector<bool> claimed;
+    claimed.reserve(pairs.size());
+    if (pairs.empty()) {
+        return claimed;
+    }
+    // Check both players before removing either so a pair whose partner already left does not
+    // take the remaining player out of the queue with it.
+    std::unordered_set<std::string> queued;
+    for (const auto& player : FetchOrdered()) {
+        queued.insert(player.request.player_id());
+    }
+    for (const auto& pair : pairs) {
+        const bool both = pair.first != pair.second && queued.count(pair.first) != 0 &&
+                          queued.count(pair.second) != 0;
+        if (both) {
+            Remove(pair.first);
+            Remove(pair.second);
+            queued.erase(pair.first);
+            queued.erase(pair.second);
+        }
+        claimed.push_back(both);
+    }
+    return claimed;
+}
 
-void RedisMatchQueue::Upsert(const MatchRequest& request, std::uint64_t order) {
-    if (stream_) {
-        (*stream_) << "ZADD matchmaking_queue " << request.elo() << ' ' << request.player_id()
-                   << std::endl;
+namespace {
+
+constexpr std::size_t kFetchScriptIndex = 0;
+constexpr std::size_t kClaimPairsScriptIndex = 1;
+constexpr std::array<const char*, 2> kScripts{
+    {RedisMatchQueue::kFetchScript, RedisMatchQueue::kClaimPairsScript}};
+
+constexpr int kMaxScoredElo = 8191;
+constexpr std::uint64_t kOrderMask = (std::uint64_t{1} << 40) - 1;
+
+// elo in the high 13 bits and arrival order in the low 40 keeps the score below 2^53, so
+// Redis' double scores order (elo, order) exactly like InMemoryMatchQueue.
+std::string QueueScore(int elo, std::uint64_t order) {
+    const auto clamped = static_cast<std::uint64_t>(std::clamp(elo, 0, kMaxScoredElo));
+    return std::to_string((clamped << 40) | (order & kOrderMask));
+}
+
+std::string EncodeRequest(const MatchRequest& request, std::uint64_t order) {
+    std::ostringstream oss;
+    oss << request.elo() << ' ' << order << ' '
+        << request.enqueued_at().time_since_epoch().count() << ' '
+        << request.preferred_region();
+    return oss.str();
+}
+
+bool DecodeRequest(const std::string& player_id, const std::string& payload,
+                   QueuedPlayer& player) {
+    std::istringstream iss(payload);
+    int elo = 0;
+    std::uint64_t order = 0;
+    std::chrono::steady_clock::rep ticks = 0;
+    std::string region;
+    if (!(iss >> elo >> order >> ticks >> region)) {
+        return false;
     }
-    fallback_.Upsert(request, order);
+    const std::chrono::steady_clock::time_point enqueued_at{
+        std::chrono::steady_clock::duration(ticks)};
+    player = QueuedPlayer{MatchRequest(player_id, elo, enqueued_at, std::move(region)), order};
+    return true;
+}
+
+}  // namespace
+
+RedisMatchQueue::RedisMatchQueue(std::shared_ptr<RedisClient> client, std::string key_prefix)
+    : client_(std::move(client)),
+      queue_key_(key_prefix + ":queue"),
+      requests_key_(key_prefix + ":requests") {
+    if (!client_) {
+        throw std::invalid_argument("RedisMatchQueue requires a client");
+    }
+    // Failure here is not fatal: the first EvalScript loads them instead.
+    LoadScripts();
+}
+
+void RedisMatchQueue::Upsert(const MatchRequest& request, std::uint64_t order) {
+    std::vector<RedisCommand> commands;
+    commands.push_back({"ZADD", queue_key_, QueueScore(request.elo(), order), request.player_id()});
+    commands.push_back({"HSET", requests_key_, request.player_id(), EncodeRequest(request, order)});
+    client_->AsyncExecute(std::move(commands), [](bool ok, std::vector<RedisReply> replies) {
+        if (!ok) {
+            std::cerr << "redis match queue upsert failed: connection lost" << std::endl;
+            return;
+        }
+        for (const auto& reply : replies) {
+            if (reply.IsError()) {
+                std::cerr << "redis match queue upsert failed: " << reply.str << std::endl;
+            }
+        }
+    });
 }
 
 bool RedisMatchQueue::Remove(const std::string& player_id) {
-    if (stream_) {
-        (*stream_) << "ZREM matchmaking_queue " << player_id << std::endl;
+    std::vector<RedisCommand> commands;
+    commands.push_back({"ZREM", queue_key_, player_id});
+    commands.push_back({"HDEL", requests_key_, player_id});
+    const auto replies = client_->Execute(std::move(commands));
+    if (!replies || replies->empty()) {
+        return false;
     }
-    return fallback_.Remove(player_id);
+    const auto& removed = replies->front();
+    return removed.type == RedisReply::Type::kInteger && removed.integer == 1;
 }
 
 std::vector<QueuedPlayer> RedisMatchQueue::FetchOrdered() const {
-    if (stream_) {
-        (*stream_) << "ZRANGE matchmaking_queue 0 -1 WITHSCORES" << std::endl;
+    std::vector<QueuedPlayer> ordered;
+    const auto reply = EvalScript(kFetchScriptIndex, {"2", queue_key_, requests_key_});
+    if (!reply || reply->type != RedisReply::Type::kArray || reply->elements.size() != 2) {
+        if (reply && reply->IsError()) {
+            std::cerr << "redis match queue fetch failed: " << reply->str << std::endl;
+        }
+        return ordered;
     }
-    return fallback_.FetchOrdered();
+    const auto& ids = reply->elements[0].elements;
+    const auto& payloads = reply->elements[1].elements;
+    ordered.reserve(ids.size());
+    QueuedPlayer player{MatchRequest("", 0, {}), 0};
+    for (std::size_t i = 0; i < ids.size() && i < payloads.size(); ++i) {
+        // A nil payload means the hash and the sorted set were edited out of band; skip the
+        // player rather than match it with made-up data.
+        if (payloads[i].type != RedisReply::Type::kBulkString ||
+            !DecodeRequest(ids[i].str, payloads[i].str, player)) {
+            continue;
+        }
+        ordered.push_back(std::move(player));
+    }
+    // Scores clamp elo to [0, 8191]; re-sort so out-of-range ratings still order exactly.
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const QueuedPlayer& lhs, const QueuedPlayer& rhs) {
+                         if (lhs.request.elo() == rhs.request.elo()) {
+                             return lhs.order < rhs.order;
+                         }
+                         return lhs.request.elo() < rhs.request.elo();
+                     });
+    return ordered;
+}
+
+std::size_t RedisMatchQueue::Size() const {
+    const auto reply = client_->ExecuteOne({"ZCARD", queue_key_});
+    if (!reply || reply->type != RedisReply::Type::kInteger) {
+        return 0;
+    }
+    return static_cast<std::size_t>(reply->integer);
+}
+
+std::string RedisMatchQueue::Snapshot() const {
+    std::ostringstream oss;
+    bool first = true;
+    for (const auto& player : FetchOrdered()) {
+        if (!first) {
+            oss << ",";
+        }
+        first = false;
+        oss << player.request.player_id() << ':' << player.request.elo();
+    }
+    return oss.str();
+}
+
+std::vector<bool> RedisMatchQueue::ClaimPairs(
+    const std::vector<std::pair<std::string, std::string>>& pairs) {
+    std::vector<bool> claimed(pairs.size(), false);
+    if (pairs.empty()) {
+        return claimed;
+    }
+    RedisCommand keys_and_args{"2", queue_key_, requests_key_};
+    keys_and_args.reserve(keys_and_args.size() + pairs.size() * 2);
+    for (const auto& pair : pairs) {
+        keys_and_args.push_back(pair.first);
+        keys_and_args.push_back(pair.second);
+    }
+    const auto reply = EvalScript(kClaimPairsScriptIndex, keys_and_args);
+    if (!reply || reply->type != RedisReply::Type::kArray) {
+        if (reply && reply->IsError()) {
+            std::cerr << "redis match queue claim failed: " << reply->str << std::endl;
+        }
+        return claimed;
+    }
+    for (std::size_t i = 0; i < claimed.size() && i < reply->elements.size(); ++i) {
+        claimed[i] = reply->elements[i].integer == 1;
+    }
+    return claimed;
 }
 
-std::size_t RedisMatchQueue::Size() const { return fallback_.Size(); }
+std::optional<RedisReply> RedisMatchQueue::EvalScript(std::size_t script,
+                                                       const RedisCommand& keys_and_args) const {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::string digest;
+        {
+            std::lock_guard<std::mutex> lk(scripts_mutex_);
+            digest = script_digests_[script];
+        }
+        if (digest.empty()) {
+            if (!LoadScripts()) {
+                return std::nullopt;
+            }
+            std::lock_guard<std::mutex> lk(scripts_mutex_);
+            digest = script_digests_[script];
+        }
+        RedisCommand command{"EVALSHA", std::move(digest)};
+        command.insert(command.end(), keys_and_args.begin(), keys_and_args.end());
+        auto reply = client_->ExecuteOne(std::move(command));
+        if (attempt == 0 && reply && reply->IsError() && reply->str.rfind("NOSCRIPT", 0) == 0) {
+            std::lock_guard<std::mutex> lk(scripts_mutex_);
+            script_digests_ = {};
+            continue;
+        }
+        return reply;
+    }
+    return std::nullopt;
+}
 
-std::string RedisMatchQueue::Snapshot() const { return fallback_.Snapshot(); }
+bool RedisMatchQueue::LoadScripts() const {
+    std::vector<RedisCommand> commands;
+    for (const char* script : kScripts) {
+        commands.push_back({"SCRIPT", "LOAD", script});
+    }
+    const auto replies = client_->Execute(std::move(commands));
+    if (!replies || replies->size() != kScripts.size()) {
+        return false;
+    }
+    std::array<std::string, 2> digests;
+    for (std::size_t i = 0; i < kScripts.size(); ++i) {
+        const auto& reply = (*replies)[i];
+        if (reply.type != RedisReply::Type::kBulkString) {
+            std::cerr << "redis match queue script load failed: " << reply.str << std::endl;
+            return false;
+        }
+        digests[i] = reply.str;
+    }
+    std::lock_guard<std::mutex> lk(scripts_mutex_);
+    script_digests_ = std::move(digests);
+    return true;
+}
 
 }  // namespace arena60
@@ -4,10 +4,12 @@
 #include <iostream>
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 
 namespace arena60 {
 
-Matchmaker::Matchmaker(std::shared_ptr<MatchQueue> queue) : queue_(std::move(queue)) {}
+Matchmaker::Matchmaker(std::shared_ptr<MatchQueue> queue)
+    : queue_(std::move(queue)), wait_seconds_({kWaitBuckets.begin(), kWaitBuckets.end()}) {}
 
 void Matchmaker::SetMatchCreatedCallback(std::function<void(const Match&)> callback) {
     std::lock_guard<std::mutex> lk(mutex_);
@@ -19,8 +21,8 @@ void Matchmaker::Enqueue(const MatchRequest& request) {
     {
         std::lock_guard<std::mutex> lk(mutex_);
         queue_->Upsert(request, ++order_counter_);
-        last_queue_size_ = queue_->Size();
-        queue_size = last_queue_size_;
+        queue_size = queue_->Size();
+        queue_size_.Set(static_cast<double>(queue_size));
     }
     std::cout << "matchmaking enqueue " << request.player_id() << " elo=" << request.elo()
               << " size=" << queue_size << std::endl;
@@ -32,8 +34,8 @@ bool Matchmaker::Cancel(const std::string& player_id) {
     {
         std::lock_guard<std::mutex> lk(mutex_);
         removed = queue_->Remove(player_id);
-        last_queue_size_ = queue_->Size();
-        queue_size = last_queue_size_;
+        queue_size = queue_->Size();
+        queue_size_.Set(static_cast<double>(queue_size));
     }
     if (removed) {
         std::cout << "matchmaking cancel " << player_id << " size=" << queue_size << std::endl;
@@ -48,6 +50,7 @@ std::vector<Match> Matchmaker::RunMatching(std::chrono::steady_clock::time_point
         std::lock_guard<std::mutex> lk(mutex_);
         auto ordered = queue_->FetchOrdered();
         std::unordered_set<std::string> used;
+        std::vector<std::pair<std::size_t, std::size_t>> pairings;
         for (std::size_t i = 0; i < ordered.size(); ++i) {
             const auto& candidate = ordered[i];
             const auto& request = candidate.request;
@@ -77,13 +80,29 @@ std::vector<Match> Matchmaker::RunMatching(std::chrono::steady_clock::time_point
             if (partner_index >= ordered.size()) {
                 continue;
             }
-            const auto& partner = ordered[partner_index].request;
-            queue_->Remove(request.player_id());
-            queue_->Remove(partner.player_id());
             used.insert(request.player_id());
-            used.insert(partner.player_id());
+            used.insert(ordered[partner_index].request.player_id());
+            pairings.emplace_back(i, partner_index);
+        }
 
-            ++matches_created_;
+        // Claim every pairing in one queue call so a remote queue costs one round trip per pass
+        // instead of two per match; a pairing is dropped if either player cancelled meanwhile.
+        std::vector<std::pair<std::string, std::string>> ids;
+        ids.reserve(pairings.size());
+        for (const auto& pairing : pairings) {
+            ids.emplace_back(ordered[pairing.first].request.player_id(),
+                             ordered[pairing.second].request.player_id());
+        }
+        const auto claimed = queue_->ClaimPairs(ids);
+        std::size_t claimed_count = 0;
+        for (std::size_t k = 0; k < pairings.size(); ++k) {
+            if (k >= claimed.size() || !claimed[k]) {
+                continue;
+            }
+            ++claimed_count;
+            const auto& request = ordered[pairings[k].first].request;
+            const auto& partner = ordered[pairings[k].second].request;
+            matches_created_.Increment();
             const int average_elo = (request.elo() + partner.elo()) / 2;
             std::ostringstream id_stream;
             id_stream << "match-" << ++match_counter_;
@@ -91,10 +110,10 @@ std::vector<Match> Matchmaker::RunMatching(std::chrono::steady_clock::time_point
                         now, ResolveRegion(request, partner));
             matches.push_back(match);
 
-            ObserveWaitLocked(request.WaitSeconds(now));
-            ObserveWaitLocked(partner.WaitSeconds(now));
+            wait_seconds_.Observe(request.WaitSeconds(now));
+            wait_seconds_.Observe(partner.WaitSeconds(now));
         }
-        last_queue_size_ = queue_->Size();
+        queue_size_.Set(static_cast<double>(ordered.size() - 2 * claimed_count));
         callback = callback_;
     }
 
@@ -110,41 +129,16 @@ std::vector<Match> Matchmaker::RunMatching(std::chrono::steady_clock::time_point
     return matches;
 }
 
-std::string Matchmaker::MetricsSnapshot() const {
-    std::lock_guard<std::mutex> lk(mutex_);
-    std::ostringstream oss;
-    oss << "# TYPE matchmaking_queue_size gauge\n";
-    oss << "matchmaking_queue_size " << last_queue_size_ << "\n";
-    oss << "# TYPE matchmaking_matches_total counter\n";
-    oss << "matchmaking_matches_total " << matches_created_ << "\n";
-    oss << "# TYPE matchmaking_wait_seconds histogram\n";
-    std::uint64_t cumulative = 0;
-    for (std::size_t i = 0; i < kWaitBuckets.size(); ++i) {
-        cumulative += wait_bucket_counts_[i];
-        oss << "matchmaking_wait_seconds_bucket{le=\"" << kWaitBuckets[i] << "\"} " << cumulative
-            << "\n";
-    }
-    cumulative += wait_overflow_count_;
-    oss << "matchmaking_wait_seconds_bucket{le=\"+Inf\"} " << cumulative << "\n";
-    oss << "matchmaking_wait_seconds_sum " << wait_sum_ << "\n";
-    oss << "matchmaking_wait_seconds_count " << wait_count_ << "\n";
-    return oss.str();
+void Matchmaker::RegisterMetrics(MetricsRegistry& registry) const {
+    registry.Register("matchmaking_queue_size", queue_size_);
+    registry.Register("matchmaking_matches_total", matches_created_);
+    registry.Register("matchmaking_wait_seconds", wait_seconds_);
 }
 
-void Matchmaker::ObserveWaitLocked(double seconds) {
-    wait_sum_ += seconds;
-    ++wait_count_;
-    bool bucket_found = false;
-    for (std::size_t i = 0; i < kWaitBuckets.size(); ++i) {
-        if (seconds <= kWaitBuckets[i]) {
-            ++wait_bucket_counts_[i];
-            bucket_found = true;
-            break;
-        }
-    }
-    if (!bucket_found) {
-        ++wait_overflow_count_;
-    }
+std::string Matchmaker::MetricsSnapshot() const {
+    MetricsRegistry registry;
+    RegisterMetrics(registry);
+    return registry.Serialize();
 }
 
 std::string Matchmaker::ResolveRegion(const MatchRequest& lhs, const MatchRequest& rhs) {
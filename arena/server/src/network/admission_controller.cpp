@@ -0,0 +1,65 @@
+#include "arena60/network/admission_controller.h"
+
+#include <algorithm>
+
+namespace arena60 {
+
+AdmissionController::AdmissionController(AdmissionOptions options)
+    : options_(options),
+      tokens_(options.handshake_burst),
+      tick_lateness_({0.001, 0.002, 0.004, 0.008, 0.016, 0.032, 0.064}) {}
+
+AdmissionDecision AdmissionController::Admit(std::chrono::steady_clock::time_point now) {
+    if (options_.max_connections > 0 && open_connections() >= options_.max_connections) {
+        rejected_capacity_.Increment();
+        return AdmissionDecision::kAtCapacity;
+    }
+    if (options_.max_tick_lateness_seconds > 0.0 &&
+        tick_lateness_seconds_ > options_.max_tick_lateness_seconds) {
+        rejected_tick_late_.Increment();
+        return AdmissionDecision::kTickLate;
+    }
+    if (options_.handshakes_per_second > 0.0 && !TakeToken(now)) {
+        rejected_rate_.Increment();
+        return AdmissionDecision::kRateLimited;
+    }
+    open_.fetch_add(1, std::memory_order_relaxed);
+    open_connections_.Add(1.0);
+    admitted_.Increment();
+    return AdmissionDecision::kAdmit;
+}
+
+void AdmissionController::Release() noexcept {
+    open_.fetch_sub(1, std::memory_order_relaxed);
+    open_connections_.Add(-1.0);
+}
+
+void AdmissionController::ObserveTickLateness(double seconds) noexcept {
+    tick_lateness_seconds_ = seconds;
+    tick_lateness_.Observe(seconds);
+}
+
+void AdmissionController::RegisterMetrics(MetricsRegistry& registry) const {
+    registry.Register("websocket_open_connections", open_connections_);
+    registry.Register("websocket_admitted_total", admitted_);
+    registry.Register("websocket_rejected_total{reason=\"capacity\"}", rejected_capacity_);
+    registry.Register("websocket_rejected_total{reason=\"tick_late\"}", rejected_tick_late_);
+    registry.Register("websocket_rejected_total{reason=\"rate\"}", rejected_rate_);
+    registry.Register("websocket_tick_lateness_seconds", tick_lateness_);
+}
+
+bool AdmissionController::TakeToken(std::chrono::steady_clock::time_point now) {
+    if (refilled_at_ != std::chrono::steady_clock::time_point{}) {
+        const double elapsed = std::chrono::duration<double>(now - refilled_at_).count();
+        tokens_ = std::min(options_.handshake_burst,
+                           tokens_ + std::max(0.0, elapsed) * options_.handshakes_per_second);
+    }
+    refilled_at_ = now;
+    if (tokens_ < 1.0) {
+        return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+}
+
+}  // namespace arena60
@@ -11,20 +11,26 @@ namespace arena60 {
 namespace http = boost::beast::http;
 using tcp = boost::asio::ip::tcp;
 
+// Serves HTTP/1.1 persistent connections. Requests are handled strictly in order, so pipelined
+// requests already sitting in buffer_ are parsed and answered one after another; buffer_ and
+// response_ are reused for the lifetime of the connection.
 class MetricsHttpServer::Session : public std::enable_shared_from_this<MetricsHttpServer::Session> {
    public:
     Session(std::shared_ptr<MetricsHttpServer> server, tcp::socket socket)
-        : server_(std::move(server)), socket_(std::move(socket)) {}
+        : server_(std::move(server)), stream_(std::move(socket)) {}
 
     void Start() { ReadRequest(); }
 
    private:
     void ReadRequest() {
+        request_ = {};
+        stream_.expires_after(server_->limits_.idle_timeout);
         auto self = shared_from_this();
-        http::async_read(socket_, buffer_, request_,
+        http::async_read(stream_, buffer_, request_,
                          [self](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
                              if (ec) {
-                                 if (ec != http::error::end_of_stream) {
+                                 if (ec != http::error::end_of_stream &&
+                                     ec != boost::beast::error::timeout) {
                                      std::cerr << "metrics read error: " << ec.message()
                                                << std::endl;
                                  }
@@ -36,45 +42,62 @@ class MetricsHttpServer::Session : public std::enable_shared_from_this<MetricsHt
     }
 
     void HandleRequest() {
+        ++requests_served_;
+        server_->requests_served_.fetch_add(1, std::memory_order_relaxed);
         if (server_->handler_) {
             response_ = server_->handler_(request_);
         } else {
-            response_ = {};
-            response_.version(request_.version());
-            response_.keep_alive(false);
             response_.result(http::status::not_found);
             response_.set(http::field::content_type, "text/plain");
             response_.body() = "Not Found";
-            response_.prepare_payload();
         }
-
+        response_.version(request_.version());
+        const bool keep_alive = response_.keep_alive() && request_.keep_alive() &&
+                                requests_served_ < server_->limits_.max_requests_per_connection &&
+                                server_->running_;
+        response_.keep_alive(keep_alive);
+        response_.prepare_payload();
+
+        stream_.expires_never();
         auto self = shared_from_this();
-        http::async_write(socket_, response_,
-                          [self](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
+        http::async_write(stream_, response_,
+                          [self, keep_alive](boost::system::error_code ec,
+                                             std::size_t /*bytes_transferred*/) {
                               if (ec) {
                                   std::cerr << "metrics write error: " << ec.message() << std::endl;
+                                  self->Close();
+                                  return;
+                              }
+                              self->response_.body().clear();
+                              self->response_.clear();
+                              if (!keep_alive) {
+                                  self->Close();
+                                  return;
                               }
-                              self->response_ = {};
-                              self->Close();
+                              self->ReadRequest();
                           });
     }
 
     void Close() {
         boost::system::error_code ec;
-        socket_.shutdown(tcp::socket::shutdown_send, ec);
-        socket_.close(ec);
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+        stream_.socket().close(ec);
     }
 
     std::shared_ptr<MetricsHttpServer> server_;
-    tcp::socket socket_;
+    boost::beast::tcp_stream stream_;
     boost::beast::flat_buffer buffer_;
     http::request<http::string_body> request_;
     http::response<http::string_body> response_;
+    std::size_t requests_served_{0};
 };
 
 MetricsHttpServer::MetricsHttpServer(boost::asio::io_context& io_context, std::uint16_t port,
-                                     RequestHandler handler)
-    : io_context_(io_context), acceptor_(io_context), handler_(std::move(handler)) {
+                                     RequestHandler handler, HttpConnectionLimits limits)
+    : io_context_(io_context),
+      acceptor_(io_context),
+      handler_(std::move(handler)),
+      limits_(limits) {
     boost::system::error_code ec;
     tcp::endpoint endpoint(tcp::v4(), port);
     acceptor_.open(endpoint.protocol(), ec);
@@ -119,6 +142,14 @@ std::uint16_t MetricsHttpServer::Port() const {
     return endpoint.port();
 }
 
+std::uint64_t MetricsHttpServer::ConnectionsAccepted() const noexcept {
+    return connections_accepted_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MetricsHttpServer::RequestsServed() const noexcept {
+    return requests_served_.load(std::memory_order_relaxed);
+}
+
 void MetricsHttpServer::DoAccept() {
     acceptor_.async_accept(
         [self = shared_from_this()](boost::system::error_code ec, tcp::socket socket) {
@@ -128,6 +159,7 @@ void MetricsHttpServer::DoAccept() {
                 }
                 return;
             }
+            self->connections_accepted_.fetch_add(1, std::memory_order_relaxed);
             std::make_shared<Session>(self, std::move(socket))->Start();
             if (self->running_) {
                 self->DoAccept();
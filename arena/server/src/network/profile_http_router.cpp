@@ -8,16 +8,29 @@ namespace arena60 {
 
 namespace http = boost::beast::http;
 
+namespace {
+bool EtagMatches(boost::beast::string_view if_none_match, const std::string& etag) {
+    if (if_none_match.empty()) {
+        return false;
+    }
+    return if_none_match == "*" || if_none_match.find(etag) != boost::beast::string_view::npos;
+}
+}  // namespace
+
 ProfileHttpRouter::ProfileHttpRouter(MetricsProvider metrics_provider,
                                      std::shared_ptr<PlayerProfileService> profile_service)
     : metrics_provider_(std::move(metrics_provider)),
-      profile_service_(std::move(profile_service)) {}
+      profile_service_(std::move(profile_service)) {
+    if (profile_service_) {
+        response_cache_ = std::make_unique<ProfileResponseCache>(profile_service_);
+    }
+}
 
 http::response<http::string_body> ProfileHttpRouter::Handle(
     const http::request<http::string_body>& request) const {
     http::response<http::string_body> response;
     response.version(request.version());
-    response.keep_alive(false);
+    response.keep_alive(request.keep_alive());
 
     if (request.method() != http::verb::get) {
         response.result(http::status::method_not_allowed);
@@ -69,12 +82,18 @@ http::response<http::string_body> ProfileHttpRouter::HandleMetrics(
     const http::request<http::string_body>& request) const {
     http::response<http::string_body> response;
     response.version(request.version());
-    response.keep_alive(false);
+    response.keep_alive(request.keep_alive());
     response.result(http::status::ok);
     response.set(http::field::content_type, "text/plain; version=0.0.4");
+    auto& body = response.body();
+    body.reserve(metrics_size_hint_.load(std::memory_order_relaxed));
     if (metrics_provider_) {
-        response.body() = metrics_provider_();
+        metrics_provider_(body);
     }
+    if (response_cache_) {
+        body += response_cache_->MetricsSnapshot();
+    }
+    metrics_size_hint_.store(body.size(), std::memory_order_relaxed);
     response.prepare_payload();
     return response;
 }
@@ -83,7 +102,7 @@ http::response<http::string_body> ProfileHttpRouter::HandleProfile(
     const http::request<http::string_body>& request, const std::string& player_id) const {
     http::response<http::string_body> response;
     response.version(request.version());
-    response.keep_alive(false);
+    response.keep_alive(request.keep_alive());
 
     if (!profile_service_) {
         response.result(http::status::service_unavailable);
@@ -93,27 +112,22 @@ http::response<http::string_body> ProfileHttpRouter::HandleProfile(
         return response;
     }
 
-    auto profile = profile_service_->GetProfile(player_id);
-    if (!profile) {
+    auto cached = response_cache_->Profile(player_id);
+    if (!cached) {
         response.result(http::status::not_found);
         response.set(http::field::content_type, "application/json");
         response.body() = "{\"error\":\"not found\"}";
         response.prepare_payload();
         return response;
     }
-
-    response.result(http::status::ok);
-    response.set(http::field::content_type, "application/json");
-    response.body() = profile_service_->SerializeProfile(*profile);
-    response.prepare_payload();
-    return response;
+    return RespondCached(request, *cached);
 }
 
 http::response<http::string_body> ProfileHttpRouter::HandleLeaderboard(
     const http::request<http::string_body>& request, std::size_t limit) const {
     http::response<http::string_body> response;
     response.version(request.version());
-    response.keep_alive(false);
+    response.keep_alive(request.keep_alive());
 
     if (!profile_service_) {
         response.result(http::status::service_unavailable);
@@ -123,10 +137,25 @@ http::response<http::string_body> ProfileHttpRouter::HandleLeaderboard(
         return response;
     }
 
-    auto profiles = profile_service_->TopProfiles(limit);
+    return RespondCached(request, *response_cache_->Leaderboard(limit));
+}
+
+http::response<http::string_body> ProfileHttpRouter::RespondCached(
+    const http::request<http::string_body>& request, const CachedResponse& cached) const {
+    http::response<http::string_body> response;
+    response.version(request.version());
+    response.keep_alive(request.keep_alive());
+    response.set(http::field::etag, cached.etag);
+
+    if (EtagMatches(request[http::field::if_none_match], cached.etag)) {
+        response.result(http::status::not_modified);
+        response.prepare_payload();
+        return response;
+    }
+
     response.result(http::status::ok);
     response.set(http::field::content_type, "application/json");
-    response.body() = profile_service_->SerializeLeaderboard(profiles);
+    response.body() = cached.body;
     response.prepare_payload();
     return response;
 }
@@ -0,0 +1,84 @@
+#include "arena60/network/profile_response_cache.h"
+
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <sstream>
+
+namespace arena60 {
+
+ProfileResponseCache::ProfileResponseCache(std::shared_ptr<PlayerProfileService> profile_service)
+    : profile_service_(std::move(profile_service)) {}
+
+std::shared_ptr<const CachedResponse> ProfileResponseCache::Leaderboard(std::size_t limit) {
+    const auto generation = profile_service_->Generation();
+    {
+        std::shared_lock<std::shared_mutex> lk(mutex_);
+        const auto it = leaderboards_.find(limit);
+        if (it != leaderboards_.end() && it->second->generation == generation) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto rendered = Render(generation, profile_service_->SerializeLeaderboard(
+                                           profile_service_->TopProfiles(limit)));
+    std::unique_lock<std::shared_mutex> lk(mutex_);
+    auto& slot = leaderboards_[limit];
+    if (!slot || slot->generation < generation) {
+        slot = rendered;
+    }
+    return rendered;
+}
+
+std::shared_ptr<const CachedResponse> ProfileResponseCache::Profile(const std::string& player_id) {
+    const auto generation = profile_service_->Generation();
+    {
+        std::shared_lock<std::shared_mutex> lk(mutex_);
+        const auto it = profiles_.find(player_id);
+        if (it != profiles_.end() && it->second->generation == generation) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto profile = profile_service_->GetProfile(player_id);
+    if (!profile) {
+        return nullptr;
+    }
+    auto rendered = Render(generation, profile_service_->SerializeProfile(*profile));
+    std::unique_lock<std::shared_mutex> lk(mutex_);
+    if (profiles_.size() >= kMaxProfileEntries && profiles_.find(player_id) == profiles_.end()) {
+        profiles_.clear();
+    }
+    auto& slot = profiles_[player_id];
+    if (!slot || slot->generation < generation) {
+        slot = rendered;
+    }
+    return rendered;
+}
+
+std::string ProfileResponseCache::MetricsSnapshot() const {
+    std::ostringstream oss;
+    oss << "# TYPE profile_response_cache_hits_total counter\n";
+    oss << "profile_response_cache_hits_total " << hits() << "\n";
+    oss << "# TYPE profile_response_cache_misses_total counter\n";
+    oss << "profile_response_cache_misses_total " << misses() << "\n";
+    return oss.str();
+}
+
+std::shared_ptr<const CachedResponse> ProfileResponseCache::Render(std::uint64_t generation,
+                                                                   std::string body) {
+    auto response = std::make_shared<CachedResponse>();
+    response->generation = generation;
+    char etag[24];
+    const int written = std::snprintf(etag, sizeof(etag), "\"%016zx\"",
+                                      std::hash<std::string>{}(body));
+    response->etag.assign(etag, static_cast<std::size_t>(written > 0 ? written : 0));
+    response->body = std::move(body);
+    return response;
+}
+
+}  // namespace arena60
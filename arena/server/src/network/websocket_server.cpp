@@ -1,36 +1,152 @@
 #include "arena60/network/websocket_server.h"
 
+#include <algorithm>
 #include <atomic>
+#include <boost/asio/coroutine.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/beast/core/basic_stream.hpp>
+#include <boost/beast/core/rate_policy.hpp>
+#include <charconv>
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <limits>
-#include <queue>
-#include <sstream>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
+#include "arena60/network/handler_memory.h"
+
 namespace arena60 {
 
 namespace websocket = boost::beast::websocket;
 using tcp = boost::asio::ip::tcp;
 
+namespace {
+
+// Sockets bound to the io_context's own executor rather than the type-erased default, so
+// completions run inline and posts honour the handler's allocator instead of allocating a
+// type-erased function object per operation.
+using Socket = tcp::socket::rebind_executor<boost::asio::io_context::executor_type>::other;
+
+// Unlimited rate policy that counts the bytes actually written to the socket, which after
+// permessage-deflate and framing is what the compression ratio is measured against.
+class WireByteCounter {
+   public:
+    explicit WireByteCounter(Counter& written) noexcept : written_(&written) {}
+
+   private:
+    friend class boost::beast::rate_policy_access;
+
+    std::size_t available_read_bytes() const noexcept {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    std::size_t available_write_bytes() const noexcept {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    void transfer_read_bytes(std::size_t) const noexcept {}
+    void transfer_write_bytes(std::size_t bytes) const noexcept { written_->Increment(bytes); }
+    void on_timer() const noexcept {}
+
+    Counter* written_;
+};
+
+using Stream =
+    boost::beast::basic_stream<tcp, boost::asio::io_context::executor_type, WireByteCounter>;
+
+std::uint64_t NanosecondsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - start)
+                                          .count());
+}
+
+constexpr std::chrono::milliseconds kMinAcceptBackoff{10};
+constexpr std::chrono::milliseconds kMaxAcceptBackoff{1000};
+
+// Most players WebSocketCompression::ForPlayers compresses for. At 5-10 us per state line, 256
+// players take 1.3-2.6 ms of each 16.7 ms tick.
+constexpr std::size_t kMaxDeflatePlayers = 256;
+
+// Room for a state frame with a typical player id; longer frames are formatted on the heap.
+constexpr std::size_t kFrameBufferSize = 256;
+
+// Splits off the next whitespace-separated token, leaving the rest in text.
+std::string_view NextToken(std::string_view& text) {
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) {
+        text = {};
+        return {};
+    }
+    const auto end = text.find_first_of(" \t\r\n", begin);
+    const auto token = text.substr(begin, end == std::string_view::npos ? end : end - begin);
+    text = end == std::string_view::npos ? std::string_view{} : text.substr(end);
+    return token;
+}
+
+template <typename T>
+bool ParseToken(std::string_view& text, T& value) {
+    const auto token = NextToken(text);
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return !token.empty() && result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+// "input <player_id> <sequence> <up> <down> <left> <right> <mouse_x> <mouse_y> [fire]", parsed
+// in place so reading a frame does not allocate. player_id views into data.
+bool ParseInputFrame(std::string_view data, std::string_view& player_id, MovementInput& input) {
+    // Clients that send C string literals include the terminator; the frame ends there.
+    data = data.substr(0, data.find('\0'));
+    if (NextToken(data) != "input") {
+        return false;
+    }
+    player_id = NextToken(data);
+    int up = 0, down = 0, left = 0, right = 0, fire = 0;
+    if (player_id.empty() || !ParseToken(data, input.sequence) || !ParseToken(data, up) ||
+        !ParseToken(data, down) || !ParseToken(data, left) || !ParseToken(data, right) ||
+        !ParseToken(data, input.mouse_x) || !ParseToken(data, input.mouse_y)) {
+        return false;
+    }
+    if (!ParseToken(data, fire)) {
+        fire = 0;
+    }
+    input.up = up != 0;
+    input.down = down != 0;
+    input.left = left != 0;
+    input.right = right != 0;
+    input.fire = fire != 0;
+    return true;
+}
+
+}  // namespace
+
+#include <boost/asio/yield.hpp>
+
+// Reading and writing are two stackless coroutines. Each one's handler owns the only reference
+// it needs to the session, moved from one operation to the next, and places the operation
+// state in the session's HandlerMemory, so steady-state traffic neither allocates nor touches
+// the reference count. Outgoing messages are formatted into strings the session keeps between
+// ticks; the writer drains them in batches and parks when there is nothing left.
 class WebSocketServer::ClientSession
     : public std::enable_shared_from_this<WebSocketServer::ClientSession> {
    public:
-    ClientSession(WebSocketServer& server, tcp::socket socket)
-        : server_(server), ws_(std::move(socket)) {}
+    ClientSession(WebSocketServer& server, Socket socket)
+        : server_(server), ws_(WireByteCounter(server.wire_bytes_), std::move(socket)) {}
+
+    ~ClientSession() { server_.admission_.Release(); }
 
     void Start() {
-        auto self = shared_from_this();
         ws_.set_option(websocket::stream_base::timeout::suggested(boost::beast::role_type::server));
-        ws_.async_accept([self](boost::system::error_code ec) {
-            if (ec) {
-                std::cerr << "websocket accept error: " << ec.message() << std::endl;
-                self->Stop();
-                return;
-            }
-            self->ReadLoop();
-        });
+        const WebSocketCompression& compression = server_.compression_;
+        if (compression.enabled) {
+            websocket::permessage_deflate deflate;
+            deflate.server_enable = true;
+            deflate.server_max_window_bits = compression.window_bits;
+            deflate.client_max_window_bits = compression.window_bits;
+            deflate.server_no_context_takeover = !compression.context_takeover;
+            deflate.compLevel = compression.level;
+            deflate.memLevel = compression.mem_level;
+            ws_.set_option(deflate);
+        }
+        ReadLoop{shared_from_this()}();
     }
 
     void Stop() {
@@ -44,7 +160,13 @@ class WebSocketServer::ClientSession
         }
     }
 
+    // Broadcasts run on the io_context, so these normally queue in place; calls from any other
+    // thread are posted over.
     void EnqueueState(const PlayerState& state, std::uint64_t tick, double delta) {
+        if (server_.io_context_.get_executor().running_in_this_thread()) {
+            DoEnqueueState(state, tick, delta);
+            return;
+        }
         auto self = shared_from_this();
         boost::asio::post(ws_.get_executor(), [self, state, tick, delta]() {
             self->DoEnqueueState(state, tick, delta);
@@ -52,6 +174,10 @@ class WebSocketServer::ClientSession
     }
 
     void EnqueueDeath(const std::string& player_id, std::uint64_t tick) {
+        if (server_.io_context_.get_executor().running_in_this_thread()) {
+            DoEnqueueDeath(player_id, tick);
+            return;
+        }
         auto self = shared_from_this();
         boost::asio::post(ws_.get_executor(),
                           [self, player_id, tick]() { self->DoEnqueueDeath(player_id, tick); });
@@ -60,158 +186,207 @@ class WebSocketServer::ClientSession
     const std::string& player_id() const { return player_id_; }
 
    private:
-    void DoEnqueueState(const PlayerState& state, std::uint64_t tick, double delta) {
-        std::ostringstream oss;
-        oss << "state " << state.player_id << ' ' << state.x << ' ' << state.y << ' '
-            << state.facing_radians << ' ' << tick << ' ' << delta << ' ' << state.health << ' '
-            << (state.is_alive ? 1 : 0) << ' ' << state.shots_fired << ' ' << state.hits_landed
-            << ' ' << state.deaths;
-        QueueMessage(oss.str());
-    }
+    // Accepts the handshake, then reads and applies frames until the connection fails.
+    class ReadLoop : public boost::asio::coroutine {
+       public:
+        using allocator_type = HandlerAllocator<char>;
 
-    void DoEnqueueDeath(const std::string& player_id, std::uint64_t tick) {
-        std::ostringstream oss;
-        oss << "death " << player_id << ' ' << tick;
-        QueueMessage(oss.str());
-    }
+        explicit ReadLoop(std::shared_ptr<ClientSession> self) : self_(std::move(self)) {}
 
-    void QueueMessage(std::string message) {
-        bool should_write = false;
-        {
-            std::lock_guard<std::mutex> lk(write_mutex_);
-            write_queue_.push(std::move(message));
-            if (!writing_) {
-                writing_ = true;
-                should_write = true;
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(self_->read_memory_);
+        }
+
+        void operator()(boost::system::error_code ec = {}, std::size_t /*bytes_read*/ = 0) {
+            ClientSession& session = *self_;
+            reenter(this) {
+                yield session.ws_.async_accept(std::move(*this));
+                if (ec) {
+                    std::cerr << "websocket accept error: " << ec.message() << std::endl;
+                    session.Stop();
+                    return;
+                }
+                for (;;) {
+                    yield session.ws_.async_read(session.buffer_, std::move(*this));
+                    if (ec) {
+                        if (ec != websocket::error::closed) {
+                            std::cerr << "websocket read error: " << ec.message() << std::endl;
+                        }
+                        session.Stop();
+                        return;
+                    }
+                    session.OnRead();
+                }
             }
         }
-        if (should_write) {
-            DoWrite();
+
+       private:
+        std::shared_ptr<ClientSession> self_;
+    };
+
+    // Sends queued messages batch by batch; started by QueueMessage when it finds it parked.
+    class WriteLoop : public boost::asio::coroutine {
+       public:
+        using allocator_type = HandlerAllocator<char>;
+
+        explicit WriteLoop(std::shared_ptr<ClientSession> self) : self_(std::move(self)) {}
+
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(self_->write_memory_);
         }
-    }
 
-    void DoWrite() {
-        std::string next;
-        {
-            std::lock_guard<std::mutex> lk(write_mutex_);
-            if (write_queue_.empty()) {
-                writing_ = false;
-                return;
+        void operator()(boost::system::error_code ec = {}, std::size_t /*bytes_written*/ = 0) {
+            ClientSession& session = *self_;
+            // Starting a write compresses and frames the message before the socket write is
+            // issued, so the time up to the yield is the per-message send cost.
+            const auto start = std::chrono::steady_clock::now();
+            reenter(this) {
+                while (session.TakePendingMessages()) {
+                    for (next_ = 0; next_ < session.writing_count_; ++next_) {
+                        yield {
+                            session.ws_.async_write(boost::asio::buffer(session.writing_[next_]),
+                                                    std::move(*this));
+                            session.server_.send_nanoseconds_.fetch_add(
+                                NanosecondsSince(start), std::memory_order_relaxed);
+                        }
+                        if (ec) {
+                            std::cerr << "websocket write error: " << ec.message() << std::endl;
+                            session.Stop();
+                            return;
+                        }
+                    }
+                }
             }
-            next = write_queue_.front();
         }
 
-        auto self = shared_from_this();
-        ws_.async_write(boost::asio::buffer(next),
-                        [self](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
-                            self->OnWrite(ec);
-                        });
+       private:
+        std::shared_ptr<ClientSession> self_;
+        std::size_t next_{0};
+    };
+
+    void DoEnqueueState(const PlayerState& state, std::uint64_t tick, double delta) {
+        QueueFormatted("state %s %g %g %g %llu %g %d %d %d %d %d", state.player_id.c_str(),
+                       state.x, state.y, state.facing_radians,
+                       static_cast<unsigned long long>(tick), delta, state.health,
+                       state.is_alive ? 1 : 0, state.shots_fired, state.hits_landed,
+                       state.deaths);
     }
 
-    void OnWrite(boost::system::error_code ec) {
-        if (ec) {
-            std::cerr << "websocket write error: " << ec.message() << std::endl;
-            Stop();
+    void DoEnqueueDeath(const std::string& player_id, std::uint64_t tick) {
+        QueueFormatted("death %s %llu", player_id.c_str(), static_cast<unsigned long long>(tick));
+    }
+
+    // printf formatting matches the stream output the protocol was defined with (%g is the
+    // default precision-6 double format).
+    template <typename... Args>
+    void QueueFormatted(const char* format, Args... args) {
+        char buffer[kFrameBufferSize];
+        const int length = std::snprintf(buffer, sizeof(buffer), format, args...);
+        if (length < 0) {
             return;
         }
+        if (static_cast<std::size_t>(length) < sizeof(buffer)) {
+            QueueMessage(buffer, static_cast<std::size_t>(length));
+            return;
+        }
+        std::string long_frame(static_cast<std::size_t>(length), '\0');
+        std::snprintf(&long_frame[0], long_frame.size() + 1, format, args...);
+        QueueMessage(long_frame.data(), long_frame.size());
+    }
+
+    void QueueMessage(const char* data, std::size_t size) {
+        server_.payload_bytes_.Increment(size);
+        bool start_writer = false;
         {
             std::lock_guard<std::mutex> lk(write_mutex_);
-            if (!write_queue_.empty()) {
-                write_queue_.pop();
+            if (pending_count_ == pending_.size()) {
+                pending_.emplace_back();
             }
-            if (write_queue_.empty()) {
-                writing_ = false;
-                return;
+            pending_[pending_count_++].assign(data, size);
+            if (!writer_active_) {
+                writer_active_ = true;
+                start_writer = true;
             }
         }
-        DoWrite();
+        if (start_writer) {
+            WriteLoop{shared_from_this()}();
+        }
     }
 
-    void ReadLoop() {
-        auto self = shared_from_this();
-        ws_.async_read(buffer_, [self](boost::system::error_code ec, std::size_t bytes_read) {
-            if (ec) {
-                if (ec != websocket::error::closed) {
-                    std::cerr << "websocket read error: " << ec.message() << std::endl;
-                }
-                self->Stop();
-                return;
-            }
-            self->OnRead(bytes_read);
-        });
+    // Hands the pending messages to the writer, or parks it when there are none.
+    bool TakePendingMessages() {
+        std::lock_guard<std::mutex> lk(write_mutex_);
+        if (pending_count_ == 0) {
+            writer_active_ = false;
+            return false;
+        }
+        std::swap(pending_, writing_);
+        writing_count_ = pending_count_;
+        pending_count_ = 0;
+        return true;
     }
 
-    void OnRead(std::size_t /*bytes_read*/) {
-        std::string data = boost::beast::buffers_to_string(buffer_.data());
-        buffer_.consume(buffer_.size());
+    void OnRead() {
+        const auto data = buffer_.data();
+        const std::string_view frame(static_cast<const char*>(data.data()), data.size());
 
         MovementInput input;
-        std::string player_id;
-        if (!ParseInputFrame(data, player_id, input)) {
-            std::cerr << "invalid input frame: " << data << std::endl;
-            ReadLoop();
+        std::string_view player_id;
+        if (!ParseInputFrame(frame, player_id, input)) {
+            std::cerr << "invalid input frame: " << frame << std::endl;
+            buffer_.consume(buffer_.size());
             return;
         }
 
         if (player_id_.empty()) {
-            player_id_ = player_id;
+            player_id_.assign(player_id.data(), player_id.size());
             server_.RegisterClient(player_id_, shared_from_this());
         }
+        buffer_.consume(buffer_.size());
 
         session_.ApplyInput(player_id_, input, loop_.TargetDelta());
-
-        ReadLoop();
-    }
-
-    bool ParseInputFrame(const std::string& data, std::string& player_id, MovementInput& input) {
-        std::istringstream iss(data);
-        std::string type;
-        iss >> type;
-        if (type != "input") {
-            return false;
-        }
-        int up = 0, down = 0, left = 0, right = 0, fire = 0;
-        iss >> player_id >> input.sequence >> up >> down >> left >> right >> input.mouse_x >>
-            input.mouse_y;
-        if (!iss) {
-            return false;
-        }
-        if (!(iss >> fire)) {
-            fire = 0;
-            if (!iss.eof()) {
-                iss.clear();
-                iss.ignore(std::numeric_limits<std::streamsize>::max());
-            } else {
-                iss.clear();
-            }
-        }
-        input.up = up != 0;
-        input.down = down != 0;
-        input.left = left != 0;
-        input.right = right != 0;
-        input.fire = fire != 0;
-        return true;
     }
 
     WebSocketServer& server_;
     GameSession& session_{server_.session_};
     GameLoop& loop_{server_.loop_};
-    websocket::stream<tcp::socket> ws_;
+    websocket::stream<Stream> ws_;
     boost::beast::flat_buffer buffer_;
     std::string player_id_;
 
+    HandlerMemory read_memory_;
+    HandlerMemory write_memory_;
+
+    // pending_ collects messages for the writer, which swaps it with writing_ to send a batch.
+    // Both keep their strings, so messages reuse capacity from earlier ticks.
     std::mutex write_mutex_;
-    std::queue<std::string> write_queue_;
-    bool writing_{false};
+    std::vector<std::string> pending_;
+    std::size_t pending_count_{0};
+    std::vector<std::string> writing_;
+    std::size_t writing_count_{0};
+    bool writer_active_{false};
     std::atomic<bool> closed_{false};
 };
 
+#include <boost/asio/unyield.hpp>
+
+WebSocketCompression WebSocketCompression::ForPlayers(std::size_t players) {
+    WebSocketCompression compression;
+    compression.enabled = players > 0 && players <= kMaxDeflatePlayers;
+    return compression;
+}
+
 WebSocketServer::WebSocketServer(boost::asio::io_context& io_context, std::uint16_t port,
-                                 GameSession& session, GameLoop& loop)
+                                 GameSession& session, GameLoop& loop,
+                                 WebSocketCompression compression, AdmissionOptions admission)
     : io_context_(io_context),
       acceptor_(io_context, tcp::endpoint(tcp::v4(), port)),
+      accept_timer_(io_context),
       session_(session),
-      loop_(loop) {}
+      loop_(loop),
+      admission_(admission),
+      compression_(compression),
+      send_seconds_per_tick_({0.0005, 0.001, 0.002, 0.004, 0.008, 0.016}) {}
 
 WebSocketServer::~WebSocketServer() { Stop(); }
 
@@ -222,7 +397,7 @@ void WebSocketServer::Start() {
     auto self = shared_from_this();
     loop_.SetUpdateCallback([self](const TickInfo& tick) {
         boost::asio::post(self->io_context_,
-                          [self, tick]() { self->BroadcastState(tick.tick, tick.delta_seconds); });
+                          [self, tick]() { self->BroadcastState(tick); });
     });
     DoAccept();
 }
@@ -234,6 +409,7 @@ void WebSocketServer::Stop() {
     running_ = false;
     boost::system::error_code ec;
     acceptor_.close(ec);
+    accept_timer_.cancel();
     std::vector<std::shared_ptr<ClientSession>> alive;
     {
         std::lock_guard<std::mutex> lk(clients_mutex_);
@@ -243,18 +419,27 @@ void WebSocketServer::Stop() {
             }
         }
         clients_.clear();
+        connections_.Set(0.0);
     }
     for (auto& client : alive) {
         client->Stop();
     }
 }
 
+void WebSocketServer::RegisterMetrics(MetricsRegistry& registry) const {
+    registry.Register("websocket_connections_total", connections_);
+    admission_.RegisterMetrics(registry);
+    registry.Register("websocket_payload_bytes_total", payload_bytes_);
+    registry.Register("websocket_wire_bytes_total", wire_bytes_);
+    registry.Register("websocket_compression_ratio", compression_ratio_);
+    registry.Register("websocket_send_seconds_per_tick", send_seconds_per_tick_);
+    session_.RegisterMetrics(registry);
+}
+
 std::string WebSocketServer::MetricsSnapshot() const {
-    std::ostringstream oss;
-    oss << "# TYPE websocket_connections_total gauge\n";
-    oss << "websocket_connections_total " << connection_count_.load() << "\n";
-    oss << session_.MetricsSnapshot();
-    return oss.str();
+    MetricsRegistry registry;
+    RegisterMetrics(registry);
+    return registry.Serialize();
 }
 
 std::uint16_t WebSocketServer::Port() const {
@@ -268,18 +453,47 @@ std::uint16_t WebSocketServer::Port() const {
 
 void WebSocketServer::DoAccept() {
     acceptor_.async_accept(
-        [self = shared_from_this()](boost::system::error_code ec, tcp::socket socket) {
+        io_context_, [self = shared_from_this()](boost::system::error_code ec, Socket socket) {
+            if (!self->running_ || ec == boost::asio::error::operation_aborted) {
+                return;
+            }
             if (ec) {
+                // EMFILE and friends clear up as connections close; the pending connection
+                // stays in the listen backlog until the retry.
                 std::cerr << "accept error: " << ec.message() << std::endl;
+                self->RetryAcceptAfterBackoff();
                 return;
             }
-            auto client = std::make_shared<ClientSession>(*self, std::move(socket));
-            client->Start();
+            self->accept_backoff_ = std::chrono::milliseconds(0);
+            const AdmissionDecision decision =
+                self->admission_.Admit(std::chrono::steady_clock::now());
+            if (decision == AdmissionDecision::kAdmit) {
+                std::make_shared<ClientSession>(*self, std::move(socket))->Start();
+            } else {
+                // Shed before the handshake: closing costs far less than upgrading and the
+                // client sees the refusal straight away.
+                boost::system::error_code ignored;
+                socket.close(ignored);
+            }
             self->DoAccept();
         });
 }
 
-void WebSocketServer::BroadcastState(std::uint64_t tick, double delta_seconds) {
+void WebSocketServer::RetryAcceptAfterBackoff() {
+    accept_backoff_ = std::min(std::max(accept_backoff_ * 2, kMinAcceptBackoff), kMaxAcceptBackoff);
+    accept_timer_.expires_after(accept_backoff_);
+    accept_timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+        if (!ec && self->running_) {
+            self->DoAccept();
+        }
+    });
+}
+
+void WebSocketServer::BroadcastState(const TickInfo& info) {
+    admission_.ObserveTickLateness(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - info.frame_start).count());
+    const std::uint64_t tick = info.tick;
+    const double delta_seconds = info.delta_seconds;
     session_.Tick(tick, delta_seconds);
     auto death_events = session_.ConsumeDeathEvents();
     std::vector<MatchResult> completed_matches;
@@ -323,6 +537,14 @@ void WebSocketServer::BroadcastState(std::uint64_t tick, double delta_seconds) {
     }
     last_broadcast_tick_ = tick;
 
+    send_seconds_per_tick_.Observe(
+        static_cast<double>(send_nanoseconds_.exchange(0, std::memory_order_relaxed)) * 1e-9);
+    const std::uint64_t payload_bytes = payload_bytes_.Value();
+    if (payload_bytes > 0) {
+        compression_ratio_.Set(static_cast<double>(wire_bytes_.Value()) /
+                               static_cast<double>(payload_bytes));
+    }
+
     if (has_callback) {
         for (const auto& match : completed_matches) {
             match_completed_callback_(match);
@@ -346,7 +568,7 @@ void WebSocketServer::RegisterClient(const std::string& player_id,
     {
         std::lock_guard<std::mutex> lk(clients_mutex_);
         clients_[player_id] = client;
-        connection_count_.fetch_add(1, std::memory_order_relaxed);
+        connections_.Set(static_cast<double>(clients_.size()));
     }
     session_.UpsertPlayer(player_id);
     if (on_join_) {
@@ -360,10 +582,7 @@ void WebSocketServer::UnregisterClient(const std::string& player_id) {
         auto it = clients_.find(player_id);
         if (it != clients_.end()) {
             clients_.erase(it);
-            auto current = connection_count_.load(std::memory_order_relaxed);
-            while (current != 0 && !connection_count_.compare_exchange_weak(
-                                       current, current - 1, std::memory_order_relaxed)) {
-            }
+            connections_.Set(static_cast<double>(clients_.size()));
         }
     }
     session_.RemovePlayer(player_id);
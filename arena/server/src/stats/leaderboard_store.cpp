@@ -3,8 +3,22 @@
 #include <algorithm>
 #include <iostream>
 
+#include "arena60/storage/redis_client.h"
+
 namespace arena60 {
 
+void LeaderboardStore::UpsertMany(const std::vector<std::pair<std::string, int>>& entries) {
+    for (const auto& [player_id, score] : entries) {
+        Upsert(player_id, score);
+    }
+}
+
+void LeaderboardStore::EraseMany(const std::vector<std::string>& player_ids) {
+    for (const auto& player_id : player_ids) {
+        Erase(player_id);
+    }
+}
+
 void InMemoryLeaderboardStore::RemoveFromOrdered(const std::string& player_id, int score) {
     auto ordered_it = ordered_.find(score);
     if (ordered_it == ordered_.end()) {
@@ -66,25 +80,163 @@ std::optional<int> InMemoryLeaderboardStore::Get(const std::string& player_id) c
 
 std::size_t InMemoryLeaderboardStore::Size() const { return scores_.size(); }
 
+namespace {
+// /leaderboard serves at most 50 entries; larger limits are fetched on demand up to the cap.
+constexpr std::size_t kDefaultCachedEntries = 50;
+constexpr std::size_t kMaxCachedEntries = 1000;
+}  // namespace
+
+RedisLeaderboardStore::RedisLeaderboardStore(std::shared_ptr<RedisClient> client, std::string key,
+                                             std::chrono::milliseconds refresh_interval)
+    : client_(std::move(client)),
+      key_(std::move(key)),
+      refresh_interval_(refresh_interval),
+      snapshot_(std::make_shared<Snapshot>()) {
+    snapshot_->wanted = kDefaultCachedEntries;
+    MaybeRefresh(kDefaultCachedEntries);
+}
+
 void RedisLeaderboardStore::Upsert(const std::string& player_id, int score) {
-    std::cout << "redis zadd leaderboard " << score << ' ' << player_id << std::endl;
+    UpsertMany({{player_id, score}});
 }
 
-void RedisLeaderboardStore::Erase(const std::string& player_id) {
-    std::cout << "redis zrem leaderboard " << player_id << std::endl;
+void RedisLeaderboardStore::Erase(const std::string& player_id) { EraseMany({player_id}); }
+
+void RedisLeaderboardStore::UpsertMany(const std::vector<std::pair<std::string, int>>& entries) {
+    if (entries.empty()) {
+        return;
+    }
+    RedisCommand zadd;
+    zadd.reserve(2 + entries.size() * 2);
+    zadd.emplace_back("ZADD");
+    zadd.push_back(key_);
+    for (const auto& [player_id, score] : entries) {
+        zadd.push_back(std::to_string(score));
+        zadd.push_back(player_id);
+    }
+    client_->AsyncExecute({std::move(zadd)}, nullptr);
+    NoteWrite();
+}
+
+void RedisLeaderboardStore::EraseMany(const std::vector<std::string>& player_ids) {
+    if (player_ids.empty()) {
+        return;
+    }
+    RedisCommand zrem;
+    zrem.reserve(2 + player_ids.size());
+    zrem.emplace_back("ZREM");
+    zrem.push_back(key_);
+    zrem.insert(zrem.end(), player_ids.begin(), player_ids.end());
+    client_->AsyncExecute({std::move(zrem)}, nullptr);
+    NoteWrite();
 }
 
 std::vector<std::pair<std::string, int>> RedisLeaderboardStore::TopN(std::size_t limit) const {
-    std::cout << "redis zrevrange leaderboard 0 " << (limit ? limit - 1 : 0) << " withscores"
-              << std::endl;
-    return {};
+    if (limit == 0) {
+        return {};
+    }
+    MaybeRefresh(limit);
+    std::lock_guard<std::mutex> lk(snapshot_->mutex);
+    const auto& top = snapshot_->top;
+    return {top.begin(), top.begin() + static_cast<std::ptrdiff_t>(std::min(limit, top.size()))};
 }
 
 std::optional<int> RedisLeaderboardStore::Get(const std::string& player_id) const {
-    std::cout << "redis zscore leaderboard " << player_id << std::endl;
-    return std::nullopt;
+    {
+        std::lock_guard<std::mutex> lk(snapshot_->mutex);
+        for (const auto& [id, score] : snapshot_->top) {
+            if (id == player_id) {
+                return score;
+            }
+        }
+    }
+    // Players outside the cached top cost a round trip; nothing on the network thread asks.
+    const auto reply = client_->ExecuteOne({"ZSCORE", key_, player_id});
+    if (!reply || reply->type != RedisReply::Type::kBulkString) {
+        return std::nullopt;
+    }
+    try {
+        return static_cast<int>(std::stod(reply->str));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::size_t RedisLeaderboardStore::Size() const {
+    MaybeRefresh(0);
+    std::lock_guard<std::mutex> lk(snapshot_->mutex);
+    return snapshot_->size;
+}
+
+std::uint64_t RedisLeaderboardStore::Version() const noexcept {
+    return snapshot_->version.load(std::memory_order_acquire);
+}
+
+void RedisLeaderboardStore::NoteWrite() {
+    // Counted after the write is queued, so a refresh that saw the old count may already include
+    // it (a harmless extra refresh) but one that saw the new count always does.
+    std::lock_guard<std::mutex> lk(snapshot_->mutex);
+    ++snapshot_->writes;
 }
 
-std::size_t RedisLeaderboardStore::Size() const { return 0; }
+void RedisLeaderboardStore::MaybeRefresh(std::size_t limit) const {
+    std::size_t fetch = 0;
+    std::uint64_t writes = 0;
+    {
+        std::lock_guard<std::mutex> lk(snapshot_->mutex);
+        auto& snapshot = *snapshot_;
+        snapshot.wanted = std::max(snapshot.wanted, std::min(limit, kMaxCachedEntries));
+        if (snapshot.refreshing) {
+            return;
+        }
+        const bool stale =
+            !snapshot.refreshed || snapshot.writes != snapshot.writes_seen ||
+            snapshot.wanted > snapshot.fetched ||
+            std::chrono::steady_clock::now() - snapshot.refreshed_at >= refresh_interval_;
+        if (!stale) {
+            return;
+        }
+        snapshot.refreshing = true;
+        fetch = snapshot.wanted;
+        writes = snapshot.writes;
+    }
+
+    std::vector<RedisCommand> commands;
+    commands.push_back({"ZREVRANGE", key_, "0", std::to_string(fetch - 1), "WITHSCORES"});
+    commands.push_back({"ZCARD", key_});
+    client_->AsyncExecute(
+        std::move(commands),
+        [snapshot = snapshot_, fetch, writes](bool ok, std::vector<RedisReply> replies) {
+            std::vector<std::pair<std::string, int>> top;
+            ok = ok && replies.size() == 2 && replies[0].type == RedisReply::Type::kArray &&
+                 replies[1].type == RedisReply::Type::kInteger;
+            if (ok) {
+                const auto& elements = replies[0].elements;
+                top.reserve(elements.size() / 2);
+                for (std::size_t i = 0; i + 1 < elements.size(); i += 2) {
+                    try {
+                        top.emplace_back(elements[i].str,
+                                         static_cast<int>(std::stod(elements[i + 1].str)));
+                    } catch (const std::exception&) {
+                        std::cerr << "redis leaderboard returned a non-numeric score" << std::endl;
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lk(snapshot->mutex);
+            snapshot->refreshing = false;
+            // On failure the old snapshot keeps serving; the next read retries, paced by the
+            // client's reconnect backoff.
+            if (!ok) {
+                return;
+            }
+            snapshot->top = std::move(top);
+            snapshot->size = static_cast<std::size_t>(replies[1].integer);
+            snapshot->fetched = fetch;
+            snapshot->writes_seen = writes;
+            snapshot->refreshed_at = std::chrono::steady_clock::now();
+            snapshot->refreshed = true;
+            snapshot->version.fetch_add(1, std::memory_order_release);
+        });
+}
 
 }  // namespace arena60
@@ -4,22 +4,9 @@
 #include <chrono>
 #include <iostream>
 #include <sstream>
-#include <unordered_map>
 
 namespace arena60 {
 
-namespace {
-struct RunningTotals {
-    std::string player_id;
-    std::uint32_t shots_fired{0};
-    std::uint32_t hits_landed{0};
-    std::uint32_t kills{0};
-    std::uint32_t deaths{0};
-    std::uint64_t damage_dealt{0};
-    std::uint64_t damage_taken{0};
-};
-}  // namespace
-
 PlayerMatchStats::PlayerMatchStats(std::string match_id, std::string player_id,
                                    std::uint32_t shots_fired, std::uint32_t hits_landed,
                                    std::uint32_t kills, std::uint32_t deaths,
@@ -51,54 +38,28 @@ MatchResult::MatchResult(std::string match_id, std::string winner_id, std::strin
 
 MatchResult MatchStatsCollector::Collect(const CombatEvent& death_event, const GameSession& session,
                                          std::chrono::system_clock::time_point completed_at) const {
-    auto states = session.Snapshot();
-    auto log = session.CombatLogSnapshot();
-
-    std::unordered_map<std::string, RunningTotals> totals;
-    totals.reserve(states.size());
-    for (const auto& state : states) {
-        RunningTotals entry;
-        entry.player_id = state.player_id;
-        entry.shots_fired = static_cast<std::uint32_t>(state.shots_fired);
-        entry.hits_landed = static_cast<std::uint32_t>(state.hits_landed);
-        entry.deaths = static_cast<std::uint32_t>(state.deaths);
-        totals.emplace(entry.player_id, entry);
-    }
+    auto totals = session.CombatTotalsSnapshot();
 
-    const auto ensure_entry = [&totals](const std::string& player_id) -> RunningTotals& {
-        auto it = totals.find(player_id);
+    const auto ensure_entry = [&totals](const std::string& player_id) -> PlayerCombatTotals& {
+        auto it = std::find_if(
+            totals.begin(), totals.end(),
+            [&player_id](const PlayerCombatTotals& entry) { return entry.player_id == player_id; });
         if (it == totals.end()) {
-            RunningTotals entry;
+            PlayerCombatTotals entry;
             entry.player_id = player_id;
-            it = totals.emplace(player_id, entry).first;
+            totals.push_back(std::move(entry));
+            return totals.back();
         }
-        return it->second;
+        return *it;
     };
 
-    for (const auto& event : log) {
-        if (event.tick > death_event.tick) {
-            continue;
-        }
-        if (event.type == CombatEventType::Hit) {
-            auto& shooter = ensure_entry(event.shooter_id);
-            shooter.damage_dealt += static_cast<std::uint64_t>(event.damage);
-            auto& target = ensure_entry(event.target_id);
-            target.damage_taken += static_cast<std::uint64_t>(event.damage);
-        } else if (event.type == CombatEventType::Death) {
-            auto& shooter = ensure_entry(event.shooter_id);
-            ++shooter.kills;
-            auto& target = ensure_entry(event.target_id);
-            if (target.deaths == 0) {
-                target.deaths = 1;
-            }
-        }
-    }
-
+    // Either side may have disconnected between the death and collection; the result still
+    // needs to credit the kill and the death.
     auto& winner_totals = ensure_entry(death_event.shooter_id);
-    auto& loser_totals = ensure_entry(death_event.target_id);
     if (winner_totals.kills == 0) {
         winner_totals.kills = 1;
     }
+    auto& loser_totals = ensure_entry(death_event.target_id);
     if (loser_totals.deaths == 0) {
         loser_totals.deaths = 1;
     }
@@ -110,8 +71,7 @@ MatchResult MatchStatsCollector::Collect(const CombatEvent& death_event, const G
 
     std::vector<PlayerMatchStats> stats;
     stats.reserve(totals.size());
-    for (auto& kv : totals) {
-        auto& entry = kv.second;
+    for (const auto& entry : totals) {
         stats.emplace_back(match_id, entry.player_id, entry.shots_fired, entry.hits_landed,
                            entry.kills, entry.deaths, entry.damage_dealt, entry.damage_taken);
     }
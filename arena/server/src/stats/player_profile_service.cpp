@@ -1,22 +1,78 @@
 #include "arena60/stats/player_profile_service.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <iomanip>
+#include <cstdio>
+#include <functional>
+#include <mutex>
 #include <sstream>
 
 namespace arena60 {
 
+namespace {
+void AppendField(std::string& out, const char* key, std::uint64_t value) {
+    out.append(key);
+    out.append(std::to_string(value));
+    out.push_back(',');
+}
+
+void AppendProfileJson(std::string& out, const PlayerProfile& profile) {
+    out.append("{\"player_id\":\"");
+    out.append(profile.player_id);
+    out.append("\",\"rating\":");
+    out.append(std::to_string(profile.rating));
+    out.push_back(',');
+    AppendField(out, "\"matches\":", profile.matches);
+    AppendField(out, "\"wins\":", profile.wins);
+    AppendField(out, "\"losses\":", profile.losses);
+    AppendField(out, "\"kills\":", profile.kills);
+    AppendField(out, "\"deaths\":", profile.deaths);
+    AppendField(out, "\"shots_fired\":", profile.shots_fired);
+    AppendField(out, "\"hits_landed\":", profile.hits_landed);
+    AppendField(out, "\"damage_dealt\":", profile.damage_dealt);
+    AppendField(out, "\"damage_taken\":", profile.damage_taken);
+    char accuracy[32];
+    const int written = std::snprintf(accuracy, sizeof(accuracy), "%.4f", profile.Accuracy());
+    out.append("\"accuracy\":");
+    out.append(accuracy, static_cast<std::size_t>(std::max(written, 0)));
+    out.push_back('}');
+}
+}  // namespace
+
+namespace {
+constexpr double kEloFactor = 25.0;
+// Beyond this rating gap K * (1 - expected) rounds to zero, so clamping the table lookup yields
+// exactly the same integer ratings as evaluating the logistic curve directly.
+constexpr int kMaxRatingDifference = 1000;
+
+// expected[d + kMaxRatingDifference] = 1 / (1 + 10^(d / 400)) for d = opponent - self.
+const std::array<double, 2 * kMaxRatingDifference + 1>& ExpectedScoreTable() {
+    static const auto table = []() {
+        std::array<double, 2 * kMaxRatingDifference + 1> values{};
+        for (int d = -kMaxRatingDifference; d <= kMaxRatingDifference; ++d) {
+            values[static_cast<std::size_t>(d + kMaxRatingDifference)] =
+                1.0 / (1.0 + std::pow(10.0, d / 400.0));
+        }
+        return values;
+    }();
+    return table;
+}
+
+double ExpectedScore(int opponent_minus_self) {
+    const int clamped =
+        std::clamp(opponent_minus_self, -kMaxRatingDifference, kMaxRatingDifference);
+    return ExpectedScoreTable()[static_cast<std::size_t>(clamped + kMaxRatingDifference)];
+}
+}  // namespace
+
 EloRatingUpdate EloRatingCalculator::Update(int winner_rating, int loser_rating) const {
-    const double expected_winner =
-        1.0 / (1.0 + std::pow(10.0, (loser_rating - winner_rating) / 400.0));
-    const double expected_loser =
-        1.0 / (1.0 + std::pow(10.0, (winner_rating - loser_rating) / 400.0));
-    constexpr double kFactor = 25.0;
+    const double expected_winner = ExpectedScore(loser_rating - winner_rating);
+    const double expected_loser = ExpectedScore(winner_rating - loser_rating);
     const int winner_new =
-        static_cast<int>(std::lround(winner_rating + kFactor * (1.0 - expected_winner)));
+        static_cast<int>(std::lround(winner_rating + kEloFactor * (1.0 - expected_winner)));
     const int loser_new =
-        static_cast<int>(std::lround(loser_rating + kFactor * (0.0 - expected_loser)));
+        static_cast<int>(std::lround(loser_rating + kEloFactor * (0.0 - expected_loser)));
     return {winner_new, loser_new};
 }
 
@@ -30,54 +86,164 @@ double PlayerProfile::Accuracy() const noexcept {
 PlayerProfileService::PlayerProfileService(std::shared_ptr<LeaderboardStore> leaderboard_store)
     : leaderboard_(std::move(leaderboard_store)) {}
 
-void PlayerProfileService::RecordMatch(const MatchResult& result) {
-    std::lock_guard<std::mutex> lk(mutex_);
+void PlayerProfileService::SetChangeSink(std::shared_ptr<ProfileChangeSink> sink) {
+    change_sink_ = std::move(sink);
+}
+
+void PlayerProfileService::RecordMatch(const MatchResult& result) { RecordBatch(&result, 1); }
 
-    for (const auto& stats : result.player_stats()) {
-        auto& aggregate = aggregates_[stats.player_id()];
-        aggregate.matches += 1;
-        aggregate.shots_fired += stats.shots_fired();
-        aggregate.hits_landed += stats.hits_landed();
-        aggregate.damage_dealt += stats.damage_dealt();
-        aggregate.damage_taken += stats.damage_taken();
-        aggregate.kills += stats.kills();
-        aggregate.deaths += stats.deaths();
+void PlayerProfileService::RecordMatches(const std::vector<MatchResult>& results) {
+    if (!results.empty()) {
+        RecordBatch(results.data(), results.size());
     }
+}
 
-    auto& winner = aggregates_[result.winner_id()];
-    auto& loser = aggregates_[result.loser_id()];
-    winner.wins += 1;
-    loser.losses += 1;
+void PlayerProfileService::RecordBatch(const MatchResult* results, std::size_t count) {
+    // Lock every shard touched by the batch exactly once, in ascending index order, so two
+    // concurrent batches sharing players can never deadlock.
+    std::array<bool, kShardCount> needed{};
+    for (std::size_t m = 0; m < count; ++m) {
+        needed[ShardIndex(results[m].winner_id())] = true;
+        needed[ShardIndex(results[m].loser_id())] = true;
+        for (const auto& stats : results[m].player_stats()) {
+            needed[ShardIndex(stats.player_id())] = true;
+        }
+    }
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(kShardCount);
+    for (std::size_t index = 0; index < kShardCount; ++index) {
+        if (needed[index]) {
+            locks.emplace_back(shards_[index].mutex);
+        }
+    }
+
+    // Matches are applied in order (a player's rating feeds their next match); the leaderboard
+    // and the change sink only see each player's final state for the batch.
+    std::vector<TouchedProfile> touched;
+    std::vector<TouchedProfile> rated;
+    touched.reserve(count * 2);
+    rated.reserve(count * 2);
+    const auto touch = [&](const std::string& player_id) -> AggregateStats& {
+        auto& shard = shards_[ShardIndex(player_id)];
+        auto it = shard.aggregates.try_emplace(player_id).first;
+        touched.push_back({&it->first, &it->second});
+        return it->second;
+    };
+    for (std::size_t m = 0; m < count; ++m) {
+        const MatchResult& result = results[m];
+        for (const auto& stats : result.player_stats()) {
+            auto& aggregate = touch(stats.player_id());
+            aggregate.matches += 1;
+            aggregate.shots_fired += stats.shots_fired();
+            aggregate.hits_landed += stats.hits_landed();
+            aggregate.damage_dealt += stats.damage_dealt();
+            aggregate.damage_taken += stats.damage_taken();
+            aggregate.kills += stats.kills();
+            aggregate.deaths += stats.deaths();
+        }
 
-    const auto update = calculator_.Update(winner.rating, loser.rating);
-    winner.rating = update.winner_new;
-    loser.rating = update.loser_new;
-    rating_updates_total_ += 2;
+        auto& winner = touch(result.winner_id());
+        rated.push_back(touched.back());
+        auto& loser = touch(result.loser_id());
+        rated.push_back(touched.back());
+        winner.wins += 1;
+        loser.losses += 1;
+
+        const auto update = calculator_.Update(winner.rating, loser.rating);
+        winner.rating = update.winner_new;
+        loser.rating = update.loser_new;
+    }
+    rating_updates_total_.fetch_add(2 * count, std::memory_order_relaxed);
+
+    const auto dedupe = [](std::vector<TouchedProfile>& profiles) {
+        std::sort(profiles.begin(), profiles.end(),
+                  [](const TouchedProfile& lhs, const TouchedProfile& rhs) {
+                      return lhs.aggregate < rhs.aggregate;
+                  });
+        profiles.erase(std::unique(profiles.begin(), profiles.end(),
+                                   [](const TouchedProfile& lhs, const TouchedProfile& rhs) {
+                                       return lhs.aggregate == rhs.aggregate;
+                                   }),
+                       profiles.end());
+    };
 
     if (leaderboard_) {
-        leaderboard_->Upsert(result.winner_id(), winner.rating);
-        leaderboard_->Upsert(result.loser_id(), loser.rating);
+        dedupe(rated);
+        std::vector<std::pair<std::string, int>> entries;
+        entries.reserve(rated.size());
+        for (const auto& profile : rated) {
+            entries.emplace_back(*profile.player_id, profile.aggregate->rating);
+        }
+        std::unique_lock<std::shared_mutex> leaderboard_lock(leaderboard_mutex_);
+        leaderboard_->UpsertMany(entries);
+        leaderboard_upserts_total_.fetch_add(entries.size(), std::memory_order_relaxed);
     }
 
-    ++matches_recorded_total_;
+    if (change_sink_) {
+        dedupe(touched);
+        std::vector<PlayerProfile> changed;
+        changed.reserve(touched.size());
+        for (const auto& profile : touched) {
+            changed.push_back(BuildProfileUnsafe(*profile.player_id, *profile.aggregate));
+        }
+        change_sink_->OnProfilesChanged(changed);
+    }
+
+    matches_recorded_total_.fetch_add(count, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void PlayerProfileService::RestoreProfile(const PlayerProfile& profile) {
+    auto& shard = shards_[ShardIndex(profile.player_id)];
+    {
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
+        auto& aggregate = shard.aggregates[profile.player_id];
+        aggregate.matches = profile.matches;
+        aggregate.wins = profile.wins;
+        aggregate.losses = profile.losses;
+        aggregate.kills = profile.kills;
+        aggregate.deaths = profile.deaths;
+        aggregate.shots_fired = profile.shots_fired;
+        aggregate.hits_landed = profile.hits_landed;
+        aggregate.damage_dealt = profile.damage_dealt;
+        aggregate.damage_taken = profile.damage_taken;
+        aggregate.rating = profile.rating;
+        if (leaderboard_) {
+            std::unique_lock<std::shared_mutex> leaderboard_lock(leaderboard_mutex_);
+            leaderboard_->Upsert(profile.player_id, profile.rating);
+        }
+    }
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void PlayerProfileService::ForEachProfile(
+    const std::function<void(const PlayerProfile&)>& visitor) const {
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+        for (const auto& kv : shard.aggregates) {
+            visitor(BuildProfileUnsafe(kv.first, kv.second));
+        }
+    }
 }
 
 std::optional<PlayerProfile> PlayerProfileService::GetProfile(const std::string& player_id) const {
-    std::lock_guard<std::mutex> lk(mutex_);
-    const auto it = aggregates_.find(player_id);
-    if (it == aggregates_.end()) {
+    const auto& shard = shards_[ShardIndex(player_id)];
+    std::shared_lock<std::shared_mutex> lk(shard.mutex);
+    const auto it = shard.aggregates.find(player_id);
+    if (it == shard.aggregates.end()) {
         return std::nullopt;
     }
     return BuildProfileUnsafe(player_id, it->second);
 }
 
 std::vector<PlayerProfile> PlayerProfileService::TopProfiles(std::size_t limit) const {
-    std::lock_guard<std::mutex> lk(mutex_);
     std::vector<PlayerProfile> profiles;
     if (!leaderboard_) {
-        profiles.reserve(std::min(limit, aggregates_.size()));
-        for (const auto& kv : aggregates_) {
-            profiles.push_back(BuildProfileUnsafe(kv.first, kv.second));
+        for (const auto& shard : shards_) {
+            std::shared_lock<std::shared_mutex> lk(shard.mutex);
+            for (const auto& kv : shard.aggregates) {
+                profiles.push_back(BuildProfileUnsafe(kv.first, kv.second));
+            }
         }
         std::sort(profiles.begin(), profiles.end(),
                   [](const PlayerProfile& lhs, const PlayerProfile& rhs) {
@@ -92,11 +258,17 @@ std::vector<PlayerProfile> PlayerProfileService::TopProfiles(std::size_t limit)
         return profiles;
     }
 
-    const auto ordered = leaderboard_->TopN(limit);
+    std::vector<std::pair<std::string, int>> ordered;
+    {
+        std::shared_lock<std::shared_mutex> leaderboard_lock(leaderboard_mutex_);
+        ordered = leaderboard_->TopN(limit);
+    }
     profiles.reserve(ordered.size());
     for (const auto& entry : ordered) {
-        const auto it = aggregates_.find(entry.first);
-        if (it != aggregates_.end()) {
+        const auto& shard = shards_[ShardIndex(entry.first)];
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+        const auto it = shard.aggregates.find(entry.first);
+        if (it != shard.aggregates.end()) {
             profiles.push_back(BuildProfileUnsafe(entry.first, it->second));
         }
     }
@@ -104,53 +276,64 @@ std::vector<PlayerProfile> PlayerProfileService::TopProfiles(std::size_t limit)
 }
 
 std::string PlayerProfileService::SerializeProfile(const PlayerProfile& profile) const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"player_id\":\"" << profile.player_id << "\",";
-    oss << "\"rating\":" << profile.rating << ",";
-    oss << "\"matches\":" << profile.matches << ",";
-    oss << "\"wins\":" << profile.wins << ",";
-    oss << "\"losses\":" << profile.losses << ",";
-    oss << "\"kills\":" << profile.kills << ",";
-    oss << "\"deaths\":" << profile.deaths << ",";
-    oss << "\"shots_fired\":" << profile.shots_fired << ",";
-    oss << "\"hits_landed\":" << profile.hits_landed << ",";
-    oss << "\"damage_dealt\":" << profile.damage_dealt << ",";
-    oss << "\"damage_taken\":" << profile.damage_taken << ",";
-    oss << "\"accuracy\":" << std::fixed << std::setprecision(4) << profile.Accuracy();
-    oss << "}";
-    return oss.str();
+    std::string out;
+    out.reserve(256 + profile.player_id.size());
+    AppendProfileJson(out, profile);
+    return out;
 }
 
 std::string PlayerProfileService::SerializeLeaderboard(
     const std::vector<PlayerProfile>& profiles) const {
-    std::ostringstream oss;
-    oss << "[";
+    std::string out;
+    out.reserve(2 + profiles.size() * 256);
+    out.push_back('[');
     for (std::size_t i = 0; i < profiles.size(); ++i) {
         if (i > 0) {
-            oss << ",";
+            out.push_back(',');
         }
-        oss << SerializeProfile(profiles[i]);
+        AppendProfileJson(out, profiles[i]);
     }
-    oss << "]";
-    return oss.str();
+    out.push_back(']');
+    return out;
 }
 
 std::string PlayerProfileService::MetricsSnapshot() const {
-    std::lock_guard<std::mutex> lk(mutex_);
+    std::size_t profiles_total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+        profiles_total += shard.aggregates.size();
+    }
+    std::size_t leaderboard_size = profiles_total;
+    if (leaderboard_) {
+        std::shared_lock<std::shared_mutex> leaderboard_lock(leaderboard_mutex_);
+        leaderboard_size = leaderboard_->Size();
+    }
+
     std::ostringstream oss;
     oss << "# TYPE player_profiles_total gauge\n";
-    oss << "player_profiles_total " << aggregates_.size() << "\n";
-    const std::size_t leaderboard_size = leaderboard_ ? leaderboard_->Size() : aggregates_.size();
+    oss << "player_profiles_total " << profiles_total << "\n";
     oss << "# TYPE leaderboard_entries_total gauge\n";
     oss << "leaderboard_entries_total " << leaderboard_size << "\n";
     oss << "# TYPE matches_recorded_total counter\n";
-    oss << "matches_recorded_total " << matches_recorded_total_ << "\n";
+    oss << "matches_recorded_total " << matches_recorded_total_.load(std::memory_order_relaxed)
+        << "\n";
     oss << "# TYPE rating_updates_total counter\n";
-    oss << "rating_updates_total " << rating_updates_total_ << "\n";
+    oss << "rating_updates_total " << rating_updates_total_.load(std::memory_order_relaxed)
+        << "\n";
+    oss << "# TYPE leaderboard_upserts_total counter\n";
+    oss << "leaderboard_upserts_total "
+        << leaderboard_upserts_total_.load(std::memory_order_relaxed) << "\n";
     return oss.str();
 }
 
+std::uint64_t PlayerProfileService::Generation() const noexcept {
+    return generation_.load(std::memory_order_acquire) + leaderboard_->Version();
+}
+
+std::size_t PlayerProfileService::ShardIndex(const std::string& player_id) noexcept {
+    return std::hash<std::string>{}(player_id) % kShardCount;
+}
+
 PlayerProfile PlayerProfileService::BuildProfileUnsafe(const std::string& player_id,
                                                        const AggregateStats& stats) const {
     PlayerProfile profile;
@@ -0,0 +1,599 @@
+#include "arena60/stats/profile_journal.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/crc.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'A', '6', '0', 'P', 'S', 'N', 'P', '1'};
+constexpr std::size_t kSnapshotHeaderSize = sizeof(kSnapshotMagic) + sizeof(std::uint64_t);
+constexpr std::size_t kFrameHeaderSize = 2 * sizeof(std::uint32_t);
+constexpr std::uint32_t kMaxFramePayload = 1u << 20;
+
+std::uint32_t Crc32(const char* data, std::size_t size) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+void PutFixed32(std::string& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void PutFixed64(std::string& out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+std::uint64_t GetFixed(const char* data, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+void PutVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool GetVarint(const char*& cursor, const char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        const auto byte = static_cast<unsigned char>(*cursor++);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rows are varint-packed: id length, id bytes, zigzag rating, then the nine counters in
+// declaration order. Typical rows are 20-30 bytes.
+void EncodeProfile(std::string& out, const arena60::PlayerProfile& profile) {
+    PutVarint(out, profile.player_id.size());
+    out.append(profile.player_id);
+    const auto rating = static_cast<std::int64_t>(profile.rating);
+    PutVarint(out, (static_cast<std::uint64_t>(rating) << 1) ^
+                       static_cast<std::uint64_t>(rating >> 63));
+    for (const auto counter :
+         {profile.matches, profile.wins, profile.losses, profile.kills, profile.deaths,
+          profile.shots_fired, profile.hits_landed, profile.damage_dealt, profile.damage_taken}) {
+        PutVarint(out, counter);
+    }
+}
+
+bool DecodeProfile(const char*& cursor, const char* end, arena60::PlayerProfile& profile) {
+    std::uint64_t id_size = 0;
+    if (!GetVarint(cursor, end, id_size) || id_size > static_cast<std::uint64_t>(end - cursor)) {
+        return false;
+    }
+    profile.player_id.assign(cursor, id_size);
+    cursor += id_size;
+    std::uint64_t zigzag = 0;
+    if (!GetVarint(cursor, end, zigzag)) {
+        return false;
+    }
+    profile.rating = static_cast<int>(static_cast<std::int64_t>(zigzag >> 1) ^
+                                      -static_cast<std::int64_t>(zigzag & 1));
+    for (auto* counter :
+         {&profile.matches, &profile.wins, &profile.losses, &profile.kills, &profile.deaths,
+          &profile.shots_fired, &profile.hits_landed, &profile.damage_dealt,
+          &profile.damage_taken}) {
+        if (!GetVarint(cursor, end, *counter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool SyncDirectory(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool FileExists(const std::string& path) {
+    struct stat st {};
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+// Read-only private mapping of a whole file; empty() when the file is missing or zero-length.
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error_ = errno != ENOENT;
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            error_ = true;
+        } else if (st.st_size > 0) {
+            const auto size = static_cast<std::size_t>(st.st_size);
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                error_ = true;
+            } else {
+                data_ = static_cast<const char*>(mapped);
+                size_ = size;
+                ::madvise(mapped, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    bool error() const noexcept { return error_; }
+
+   private:
+    const char* data_{nullptr};
+    std::size_t size_{0};
+    bool error_{false};
+};
+
+// Applies every complete, checksummed frame and returns the offset just past the last one.
+// Anything after that offset is a torn write from a crash and is ignored.
+std::uint64_t ReplayWal(const std::string& path, arena60::PlayerProfileService& service,
+                        std::uint64_t& rows_applied) {
+    MappedFile file(path);
+    if (file.error()) {
+        std::cerr << "profile journal failed to map " << path << ": " << std::strerror(errno)
+                  << std::endl;
+    }
+    const char* base = file.data();
+    std::size_t offset = 0;
+    std::vector<arena60::PlayerProfile> rows;
+    while (file.size() - offset >= kFrameHeaderSize) {
+        const auto length = static_cast<std::uint32_t>(GetFixed(base + offset, 4));
+        const auto crc = static_cast<std::uint32_t>(GetFixed(base + offset + 4, 4));
+        if (length > kMaxFramePayload || length > file.size() - offset - kFrameHeaderSize) {
+            break;
+        }
+        const char* payload = base + offset + kFrameHeaderSize;
+        if (Crc32(payload, length) != crc) {
+            break;
+        }
+        const char* cursor = payload;
+        const char* end = payload + length;
+        std::uint64_t count = 0;
+        bool ok = GetVarint(cursor, end, count);
+        rows.clear();
+        for (std::uint64_t i = 0; ok && i < count; ++i) {
+            arena60::PlayerProfile profile;
+            ok = DecodeProfile(cursor, end, profile);
+            rows.push_back(std::move(profile));
+        }
+        if (!ok || cursor != end) {
+            break;
+        }
+        for (const auto& profile : rows) {
+            service.RestoreProfile(profile);
+        }
+        rows_applied += rows.size();
+        offset += kFrameHeaderSize + length;
+    }
+    if (offset != file.size()) {
+        std::cerr << "profile journal ignoring " << (file.size() - offset)
+                  << " torn bytes at the end of " << path << std::endl;
+    }
+    return offset;
+}
+
+}  // namespace
+
+namespace arena60 {
+
+ProfileJournal::ProfileJournal(std::string directory, ProfileJournalOptions options)
+    : directory_(std::move(directory)), options_(options) {}
+
+ProfileJournal::~ProfileJournal() { Stop(); }
+
+bool ProfileJournal::Recover(PlayerProfileService& service) {
+    const auto start = std::chrono::steady_clock::now();
+    if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "profile journal cannot create " << directory_ << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink((directory_ + "/profiles.snapshot.tmp").c_str());
+
+    std::uint64_t records = 0;
+    {
+        const std::string path = directory_ + "/profiles.snapshot";
+        MappedFile snapshot(path);
+        if (snapshot.error()) {
+            std::cerr << "profile journal failed to map " << path << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        if (snapshot.size() > 0) {
+            const char* base = snapshot.data();
+            if (snapshot.size() < kSnapshotHeaderSize + sizeof(std::uint32_t) ||
+                std::memcmp(base, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+                std::cerr << "profile journal snapshot " << path << " has a bad header"
+                          << std::endl;
+                return false;
+            }
+            const std::size_t body_end = snapshot.size() - sizeof(std::uint32_t);
+            const auto expected_crc = static_cast<std::uint32_t>(GetFixed(base + body_end, 4));
+            if (Crc32(base + sizeof(kSnapshotMagic), body_end - sizeof(kSnapshotMagic)) !=
+                expected_crc) {
+                std::cerr << "profile journal snapshot " << path << " failed its checksum"
+                          << std::endl;
+                return false;
+            }
+            const std::uint64_t count = GetFixed(base + sizeof(kSnapshotMagic), 8);
+            const char* cursor = base + kSnapshotHeaderSize;
+            const char* end = base + body_end;
+            PlayerProfile profile;
+            for (std::uint64_t i = 0; i < count; ++i) {
+                if (!DecodeProfile(cursor, end, profile)) {
+                    std::cerr << "profile journal snapshot " << path << " is truncated"
+                              << std::endl;
+                    return false;
+                }
+                service.RestoreProfile(profile);
+            }
+            records += count;
+        }
+    }
+
+    // A leftover rotated WAL means the process died mid-checkpoint. Its rows predate the live
+    // WAL, so it is replayed first; Start then folds it into a new snapshot.
+    const std::string rotated = directory_ + "/profiles.wal.old";
+    if (FileExists(rotated)) {
+        ReplayWal(rotated, service, records);
+        checkpoint_on_start_ = true;
+    }
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+        wal_valid_bytes_ = ReplayWal(directory_ + "/profiles.wal", service, records);
+        recovered_ = true;
+    }
+
+    records_recovered_.store(records, std::memory_order_relaxed);
+    recovery_seconds_.store(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+        std::memory_order_relaxed);
+    return true;
+}
+
+bool ProfileJournal::Start(std::shared_ptr<PlayerProfileService> service) {
+    if (!service) {
+        return false;
+    }
+    service_ = service;
+    {
+        std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+        std::lock_guard<std::mutex> io(io_mutex_);
+        if (!recovered_) {
+            std::cerr << "profile journal started without Recover" << std::endl;
+            return false;
+        }
+        if (wal_fd_ >= 0) {
+            return true;
+        }
+        if (checkpoint_on_start_) {
+            if (!WriteSnapshot(*service)) {
+                return false;
+            }
+            ::unlink((directory_ + "/profiles.wal.old").c_str());
+            SyncDirectory(directory_);
+            checkpoint_on_start_ = false;
+        }
+        if (!OpenWalLocked()) {
+            return false;
+        }
+        wal_bytes_since_checkpoint_ = wal_valid_bytes_;
+    }
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!thread_.joinable()) {
+        stop_requested_ = false;
+        thread_ = std::thread([this]() { Run(); });
+    }
+    return true;
+}
+
+void ProfileJournal::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stop_requested_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::lock_guard<std::mutex> io(io_mutex_);
+    if (wal_fd_ >= 0) {
+        FlushPendingLocked();
+        ::close(wal_fd_);
+        wal_fd_ = -1;
+    }
+}
+
+void ProfileJournal::OnProfilesChanged(const std::vector<PlayerProfile>& profiles) {
+    if (profiles.empty()) {
+        return;
+    }
+    std::string payload;
+    payload.reserve(8 + profiles.size() * 32);
+    PutVarint(payload, profiles.size());
+    for (const auto& profile : profiles) {
+        EncodeProfile(payload, profile);
+    }
+    logical_bytes_.fetch_add(payload.size(), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    PutFixed32(pending_, static_cast<std::uint32_t>(payload.size()));
+    PutFixed32(pending_, Crc32(payload.data(), payload.size()));
+    pending_.append(payload);
+}
+
+bool ProfileJournal::Flush() {
+    std::lock_guard<std::mutex> io(io_mutex_);
+    return FlushPendingLocked();
+}
+
+bool ProfileJournal::FlushPendingLocked() {
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        batch.swap(pending_);
+    }
+    if (batch.empty()) {
+        return true;
+    }
+    const bool ok = wal_fd_ >= 0 && WriteAll(wal_fd_, batch.data(), batch.size()) &&
+                    ::fdatasync(wal_fd_) == 0;
+    if (!ok) {
+        // Drop any partial frame so later frames stay replayable, then requeue the batch ahead
+        // of anything recorded meanwhile.
+        std::cerr << "profile journal WAL write failed: " << std::strerror(errno) << std::endl;
+        if (wal_fd_ >= 0) {
+            if (::ftruncate(wal_fd_, static_cast<off_t>(wal_valid_bytes_)) != 0) {
+                std::cerr << "profile journal failed to truncate WAL" << std::endl;
+            }
+            ::lseek(wal_fd_, 0, SEEK_END);
+        }
+        std::lock_guard<std::mutex> lk(mutex_);
+        batch.append(pending_);
+        pending_.swap(batch);
+        return false;
+    }
+    fsyncs_total_.fetch_add(1, std::memory_order_relaxed);
+    wal_bytes_.fetch_add(batch.size(), std::memory_order_relaxed);
+    wal_valid_bytes_ += batch.size();
+    wal_bytes_since_checkpoint_ += batch.size();
+    return true;
+}
+
+bool ProfileJournal::OpenWalLocked() {
+    const std::string path = directory_ + "/profiles.wal";
+    wal_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (wal_fd_ < 0) {
+        std::cerr << "profile journal cannot open " << path << ": " << std::strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    if (::ftruncate(wal_fd_, static_cast<off_t>(wal_valid_bytes_)) != 0 ||
+        ::lseek(wal_fd_, 0, SEEK_END) < 0) {
+        std::cerr << "profile journal cannot position " << path << ": " << std::strerror(errno)
+                  << std::endl;
+        ::close(wal_fd_);
+        wal_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ProfileJournal::Checkpoint() {
+    auto service = service_.lock();
+    if (!service) {
+        return false;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+
+    // Rotate: everything recorded so far lands in profiles.wal.old, everything after in a fresh
+    // WAL. The snapshot taken below is at least as new as the rotated WAL.
+    {
+        std::lock_guard<std::mutex> io(io_mutex_);
+        if (wal_fd_ < 0 || !FlushPendingLocked()) {
+            checkpoint_failures_total_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const std::string wal = directory_ + "/profiles.wal";
+        ::close(wal_fd_);
+        wal_fd_ = -1;
+        if (::rename(wal.c_str(), (wal + ".old").c_str()) != 0) {
+            std::cerr << "profile journal cannot rotate WAL: " << std::strerror(errno)
+                      << std::endl;
+        } else {
+            wal_valid_bytes_ = 0;
+        }
+        if (!OpenWalLocked()) {
+            checkpoint_failures_total_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        SyncDirectory(directory_);
+        wal_bytes_since_checkpoint_ = wal_valid_bytes_;
+    }
+
+    if (!WriteSnapshot(*service)) {
+        checkpoint_failures_total_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ::unlink((directory_ + "/profiles.wal.old").c_str());
+    SyncDirectory(directory_);
+
+    checkpoints_total_.fetch_add(1, std::memory_order_relaxed);
+    last_checkpoint_seconds_.store(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+        std::memory_order_relaxed);
+    return true;
+}
+
+bool ProfileJournal::WriteSnapshot(const PlayerProfileService& service) {
+    // Encode into memory first so shard read locks are never held across disk I/O.
+    std::string buffer(kSnapshotHeaderSize, '\0');
+    std::memcpy(&buffer[0], kSnapshotMagic, sizeof(kSnapshotMagic));
+    std::uint64_t count = 0;
+    service.ForEachProfile([&](const PlayerProfile& profile) {
+        EncodeProfile(buffer, profile);
+        ++count;
+    });
+    std::string count_bytes;
+    PutFixed64(count_bytes, count);
+    std::memcpy(&buffer[sizeof(kSnapshotMagic)], count_bytes.data(), count_bytes.size());
+    PutFixed32(buffer, Crc32(buffer.data() + sizeof(kSnapshotMagic),
+                             buffer.size() - sizeof(kSnapshotMagic)));
+
+    const std::string path = directory_ + "/profiles.snapshot";
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "profile journal cannot open " << tmp << ": " << std::strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    const bool written = WriteAll(fd, buffer.data(), buffer.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!written || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "profile journal failed to write snapshot: " << std::strerror(errno)
+                  << std::endl;
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    SyncDirectory(directory_);
+    fsyncs_total_.fetch_add(1, std::memory_order_relaxed);
+    snapshot_bytes_.fetch_add(buffer.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void ProfileJournal::Run() {
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (!stop_requested_) {
+        cv_.wait_for(lk, options_.fsync_interval, [this]() { return stop_requested_; });
+        if (stop_requested_) {
+            break;
+        }
+        lk.unlock();
+        bool checkpoint_due = false;
+        {
+            std::lock_guard<std::mutex> io(io_mutex_);
+            FlushPendingLocked();
+            checkpoint_due = wal_bytes_since_checkpoint_ >= options_.checkpoint_wal_bytes;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (checkpoint_due || now - last_checkpoint >= options_.checkpoint_interval) {
+            Checkpoint();
+            last_checkpoint = now;
+        }
+        lk.lock();
+    }
+}
+
+std::uint64_t ProfileJournal::LogicalBytes() const noexcept {
+    return logical_bytes_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ProfileJournal::WalBytesWritten() const noexcept {
+    return wal_bytes_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ProfileJournal::SnapshotBytesWritten() const noexcept {
+    return snapshot_bytes_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ProfileJournal::FsyncsTotal() const noexcept {
+    return fsyncs_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ProfileJournal::CheckpointsTotal() const noexcept {
+    return checkpoints_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ProfileJournal::RecordsRecovered() const noexcept {
+    return records_recovered_.load(std::memory_order_relaxed);
+}
+
+std::string ProfileJournal::MetricsSnapshot() const {
+    std::size_t pending_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        pending_bytes = pending_.size();
+    }
+    std::ostringstream oss;
+    oss << "# TYPE profile_journal_pending_bytes gauge\n";
+    oss << "profile_journal_pending_bytes " << pending_bytes << "\n";
+    oss << "# TYPE profile_journal_logical_bytes_total counter\n";
+    oss << "profile_journal_logical_bytes_total " << LogicalBytes() << "\n";
+    oss << "# TYPE profile_journal_wal_bytes_total counter\n";
+    oss << "profile_journal_wal_bytes_total " << WalBytesWritten() << "\n";
+    oss << "# TYPE profile_journal_snapshot_bytes_total counter\n";
+    oss << "profile_journal_snapshot_bytes_total " << SnapshotBytesWritten() << "\n";
+    oss << "# TYPE profile_journal_fsyncs_total counter\n";
+    oss << "profile_journal_fsyncs_total " << FsyncsTotal() << "\n";
+    oss << "# TYPE profile_journal_checkpoints_total counter\n";
+    oss << "profile_journal_checkpoints_total " << CheckpointsTotal() << "\n";
+    oss << "# TYPE profile_journal_checkpoint_failures_total counter\n";
+    oss << "profile_journal_checkpoint_failures_total "
+        << checkpoint_failures_total_.load(std::memory_order_relaxed) << "\n";
+    oss << "# TYPE profile_journal_last_checkpoint_seconds gauge\n";
+    oss << "profile_journal_last_checkpoint_seconds "
+        << last_checkpoint_seconds_.load(std::memory_order_relaxed) << "\n";
+    oss << "# TYPE profile_journal_recovery_seconds gauge\n";
+    oss << "profile_journal_recovery_seconds "
+        << recovery_seconds_.load(std::memory_order_relaxed) << "\n";
+    return oss.str();
+}
+
+}  // namespace arena60
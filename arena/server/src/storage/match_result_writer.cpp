@@ -0,0 +1,127 @@
+#include "arena60/storage/match_result_writer.h"
+
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace arena60 {
+
+MatchResultWriter::MatchResultWriter(boost::asio::any_io_executor executor,
+                                     std::shared_ptr<MatchResultSink> sink,
+                                     MatchResultWriterOptions options)
+    : executor_(executor),
+      sink_(std::move(sink)),
+      options_(options),
+      retry_timer_(std::move(executor)) {}
+
+bool MatchResultWriter::Enqueue(MatchResult result) {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (queue_.size() >= options_.queue_capacity) {
+            dropped_queue_full_total_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(result));
+        // A drain already in flight or backing off picks this result up with its next batch.
+        if (draining_) {
+            return true;
+        }
+        draining_ = true;
+    }
+    boost::asio::post(executor_, [self = shared_from_this()]() { self->Drain(); });
+    return true;
+}
+
+void MatchResultWriter::Stop() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    stopping_ = true;
+    // The aborted wait still runs Drain, so the queue gets its final attempt right away.
+    retry_timer_.cancel();
+}
+
+void MatchResultWriter::Drain() {
+    std::vector<MatchResult> batch;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        const std::size_t count = std::min(queue_.size(), options_.max_batch_size);
+        batch.assign(std::make_move_iterator(queue_.begin()),
+                     std::make_move_iterator(queue_.begin() + count));
+        queue_.erase(queue_.begin(), queue_.begin() + count);
+    }
+
+    const bool ok = batch.empty() || (sink_ && sink_->RecordMatchResults(batch));
+    if (!batch.empty()) {
+        batches_total_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (ok) {
+        written_total_.fetch_add(batch.size(), std::memory_order_relaxed);
+        backoff_ = std::chrono::milliseconds{0};
+        if (queue_.empty()) {
+            draining_ = false;
+            return;
+        }
+        boost::asio::post(executor_, [self = shared_from_this()]() { self->Drain(); });
+        return;
+    }
+
+    if (stopping_) {
+        const std::size_t dropped = batch.size() + queue_.size();
+        dropped_write_failed_total_.fetch_add(dropped, std::memory_order_relaxed);
+        std::cerr << "match results dropped at shutdown: " << dropped << std::endl;
+        queue_.clear();
+        draining_ = false;
+        return;
+    }
+    // Back to the front in their original order; the sink makes replaying a batch harmless.
+    queue_.insert(queue_.begin(), std::make_move_iterator(batch.begin()),
+                  std::make_move_iterator(batch.end()));
+    retries_total_.fetch_add(1, std::memory_order_relaxed);
+    backoff_ = backoff_.count() == 0 ? options_.initial_backoff
+                                     : std::min(backoff_ * 2, options_.max_backoff);
+    retry_timer_.expires_after(backoff_);
+    retry_timer_.async_wait(
+        [self = shared_from_this()](const boost::system::error_code&) { self->Drain(); });
+}
+
+std::size_t MatchResultWriter::QueueDepth() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return queue_.size();
+}
+
+std::uint64_t MatchResultWriter::ResultsWritten() const noexcept {
+    return written_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MatchResultWriter::ResultsDropped() const noexcept {
+    return dropped_queue_full_total_.load(std::memory_order_relaxed) +
+           dropped_write_failed_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t MatchResultWriter::RetriesTotal() const noexcept {
+    return retries_total_.load(std::memory_order_relaxed);
+}
+
+std::string MatchResultWriter::MetricsSnapshot() const {
+    std::ostringstream oss;
+    oss << "# TYPE match_results_queue_depth gauge\n";
+    oss << "match_results_queue_depth " << QueueDepth() << "\n";
+    oss << "# TYPE match_results_written_total counter\n";
+    oss << "match_results_written_total " << ResultsWritten() << "\n";
+    oss << "# TYPE match_results_dropped_total counter\n";
+    oss << "match_results_dropped_total{reason=\"queue_full\"} "
+        << dropped_queue_full_total_.load(std::memory_order_relaxed) << "\n";
+    oss << "match_results_dropped_total{reason=\"write_failed\"} "
+        << dropped_write_failed_total_.load(std::memory_order_relaxed) << "\n";
+    oss << "# TYPE match_results_retries_total counter\n";
+    oss << "match_results_retries_total " << RetriesTotal() << "\n";
+    oss << "# TYPE match_results_batches_total counter\n";
+    oss << "match_results_batches_total " << batches_total_.load(std::memory_order_relaxed)
+        << "\n";
+    return oss.str();
+}
+
+}  // namespace arena60
@@ -0,0 +1,218 @@
+#include "arena60/storage/postgres_connection_pool.h"
+
+#include <iostream>
+#include <utility>
+
+namespace arena60 {
+
+void PostgresConnectionPool::ConnDeleter::operator()(PGconn* conn) const noexcept {
+    if (conn) {
+        PQfinish(conn);
+    }
+}
+
+PostgresConnectionPool::Lease::Lease(PostgresConnectionPool* pool, std::size_t index,
+                                     PGconn* conn)
+    : pool_(pool), index_(index), conn_(conn) {}
+
+PostgresConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)),
+      index_(other.index_),
+      conn_(std::exchange(other.conn_, nullptr)),
+      broken_(other.broken_) {}
+
+PostgresConnectionPool::Lease& PostgresConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        index_ = other.index_;
+        conn_ = std::exchange(other.conn_, nullptr);
+        broken_ = other.broken_;
+    }
+    return *this;
+}
+
+PostgresConnectionPool::Lease::~Lease() { Release(); }
+
+bool PostgresConnectionPool::Lease::EnsurePrepared(const char* name, const char* sql,
+                                                   int param_count) {
+    if (!conn_) {
+        return false;
+    }
+    // The slot is exclusively ours while leased, so its prepared set needs no locking.
+    auto& prepared = pool_->slots_[index_].prepared;
+    if (prepared.count(name) != 0) {
+        return true;
+    }
+    PGresult* result = PQprepare(conn_, name, sql, param_count, nullptr);
+    const bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+        std::cerr << "postgres prepare " << name << " failed: " << PQerrorMessage(conn_);
+        if (PQstatus(conn_) != CONNECTION_OK) {
+            broken_ = true;
+        }
+    } else {
+        prepared.insert(name);
+    }
+    PQclear(result);
+    return ok;
+}
+
+void PostgresConnectionPool::Lease::Release() noexcept {
+    if (pool_) {
+        const bool broken = broken_ || (conn_ && PQstatus(conn_) != CONNECTION_OK);
+        pool_->ReturnSlot(index_, broken);
+        pool_ = nullptr;
+        conn_ = nullptr;
+    }
+}
+
+PostgresConnectionPool::PostgresConnectionPool(std::string dsn, PostgresPoolOptions options)
+    : dsn_(std::move(dsn)), options_(options), slots_(options.size == 0 ? 1 : options.size) {}
+
+PostgresConnectionPool::~PostgresConnectionPool() { Close(); }
+
+std::size_t PostgresConnectionPool::Connect() {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (slots_[i].in_use || slots_[i].healthy) {
+                continue;
+            }
+            slots_[i].in_use = true;
+        }
+        // healthy is only set by ReturnSlot, so the reconnect result decides it.
+        ReturnSlot(i, !ReconnectSlot(slots_[i]));
+    }
+    return HealthyCount();
+}
+
+void PostgresConnectionPool::Close() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    for (auto& slot : slots_) {
+        if (slot.in_use) {
+            continue;
+        }
+        slot.conn.reset();
+        slot.healthy = false;
+        slot.prepared.clear();
+        slot.next_reconnect = {};
+    }
+}
+
+PostgresConnectionPool::Lease PostgresConnectionPool::Acquire() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    const auto deadline = std::chrono::steady_clock::now() + options_.acquire_timeout;
+    while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        std::size_t reconnect_candidate = slots_.size();
+        bool any_free = false;
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            auto& slot = slots_[i];
+            if (slot.in_use) {
+                continue;
+            }
+            any_free = true;
+            if (slot.healthy) {
+                slot.in_use = true;
+                return Lease(this, i, slot.conn.get());
+            }
+            if (reconnect_candidate == slots_.size() && now >= slot.next_reconnect) {
+                reconnect_candidate = i;
+            }
+        }
+
+        if (reconnect_candidate < slots_.size()) {
+            auto& slot = slots_[reconnect_candidate];
+            slot.in_use = true;
+            lk.unlock();
+            if (ReconnectSlot(slot)) {
+                return Lease(this, reconnect_candidate, slot.conn.get());
+            }
+            ReturnSlot(reconnect_candidate, true);
+            return Lease();
+        }
+        // Every free slot is broken and backing off: fail fast rather than wait.
+        if (any_free) {
+            return Lease();
+        }
+        if (available_cv_.wait_until(lk, deadline) == std::cv_status::timeout) {
+            return Lease();
+        }
+    }
+}
+
+std::size_t PostgresConnectionPool::HealthCheck() {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        bool healthy = false;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            auto& slot = slots_[i];
+            if (slot.in_use) {
+                continue;
+            }
+            if (!slot.healthy && std::chrono::steady_clock::now() < slot.next_reconnect) {
+                continue;
+            }
+            slot.in_use = true;
+            healthy = slot.healthy;
+        }
+        auto& slot = slots_[i];
+        bool ok = false;
+        if (healthy) {
+            PGresult* result = PQexec(slot.conn.get(), "SELECT 1");
+            ok = PQresultStatus(result) == PGRES_TUPLES_OK;
+            PQclear(result);
+        }
+        if (!ok) {
+            ok = ReconnectSlot(slot);
+        }
+        ReturnSlot(i, !ok);
+    }
+    return HealthyCount();
+}
+
+std::size_t PostgresConnectionPool::HealthyCount() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    std::size_t healthy = 0;
+    for (const auto& slot : slots_) {
+        if (slot.healthy) {
+            ++healthy;
+        }
+    }
+    return healthy;
+}
+
+std::uint64_t PostgresConnectionPool::ReconnectsTotal() const noexcept {
+    return reconnects_total_.load(std::memory_order_relaxed);
+}
+
+bool PostgresConnectionPool::ReconnectSlot(Slot& slot) {
+    const bool had_connection = slot.conn != nullptr;
+    slot.conn.reset(PQconnectdb(dsn_.c_str()));
+    slot.prepared.clear();
+    if (had_connection) {
+        reconnects_total_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (PQstatus(slot.conn.get()) != CONNECTION_OK) {
+        std::cerr << "postgres connection failed: " << PQerrorMessage(slot.conn.get());
+        slot.conn.reset();
+        return false;
+    }
+    return true;
+}
+
+void PostgresConnectionPool::ReturnSlot(std::size_t index, bool broken) noexcept {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto& slot = slots_[index];
+        slot.in_use = false;
+        slot.healthy = !broken && slot.conn != nullptr;
+        if (!slot.healthy) {
+            slot.next_reconnect = std::chrono::steady_clock::now() + options_.reconnect_backoff;
+        }
+    }
+    available_cv_.notify_one();
+}
+
+}  // namespace arena60
@@ -1,71 +1,285 @@
 #include "arena60/storage/postgres_storage.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <sstream>
 
 namespace arena60 {
 
-void PostgresStorage::ConnDeleter::operator()(PGconn* conn) const noexcept {
-    if (conn) {
-        PQfinish(conn);
+namespace {
+constexpr const char* kSessionEventStatement = "arena60_session_event";
+constexpr const char* kSessionEventSql =
+    "INSERT INTO session_events(player_id, event_type, created_at) VALUES($1, $2, NOW())";
+
+constexpr const char* kSessionBatchStatement = "arena60_session_events_batch";
+constexpr const char* kSessionBatchSql =
+    "INSERT INTO session_events(player_id, event_type, created_at)"
+    " SELECT p, e, to_timestamp(t) FROM unnest($1::text[], $2::text[], $3::float8[])"
+    " AS u(p, e, t)";
+
+// One statement per match: the stats rows are inserted only when the match row is new, so
+// replaying a match that already committed writes nothing and retries are safe.
+constexpr const char* kMatchRecordStatement = "arena60_match_record";
+constexpr const char* kMatchRecordSql =
+    "WITH inserted AS ("
+    " INSERT INTO match_results(match_id, winner_id, loser_id, completed_at)"
+    " VALUES($1, $2, $3, to_timestamp($4::float8)) ON CONFLICT (match_id) DO NOTHING"
+    " RETURNING match_id)"
+    " INSERT INTO player_match_stats(match_id, player_id, shots_fired, hits_landed, kills,"
+    " deaths, damage_dealt, damage_taken)"
+    " SELECT inserted.match_id, s.p, s.sf, s.hl, s.k, s.d, s.dd, s.dt FROM inserted,"
+    " unnest($5::text[], $6::int8[], $7::int8[], $8::int8[], $9::int8[], $10::int8[],"
+    " $11::int8[]) AS s(p, sf, hl, k, d, dd, dt)";
+
+// Bounds how many matches are queued before their results are read back; libpq pipelines in
+// blocking mode can deadlock if the server's output buffer fills while we are still sending.
+constexpr std::size_t kMaxPipelineMatches = 256;
+
+void AppendArrayElement(std::string& out, const std::string& value) {
+    out.push_back('"');
+    for (const char c : value) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
     }
+    out.push_back('"');
 }
 
-PostgresStorage::PostgresStorage(std::string dsn) : dsn_(std::move(dsn)) {}
-
-PostgresStorage::~PostgresStorage() { Disconnect(); }
+std::string EpochSeconds(std::chrono::system_clock::time_point time) {
+    const auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    std::string out = std::to_string(micros / 1000000);
+    out.push_back('.');
+    const auto fraction = std::to_string(1000000 + micros % 1000000);
+    out.append(fraction, 1, std::string::npos);
+    return out;
+}
 
-bool PostgresStorage::Connect() {
-    if (connection_) {
-        return true;
+// Sends each match followed by its own sync point, so every match is a separate implicit
+// transaction and one failing match does not roll back the others, then reads back every result
+// up to the last sync. Clears drained when results may be left unread on the connection.
+bool RunPipelineSegment(PGconn* conn, const MatchResult* matches, std::size_t count,
+                        bool& drained) {
+    bool ok = true;
+    std::size_t synced = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& match = matches[i];
+        const auto completed = EpochSeconds(match.completed_at());
+        std::string columns[7];
+        for (auto& column : columns) {
+            column.push_back('{');
+        }
+        bool first = true;
+        for (const auto& stats : match.player_stats()) {
+            if (!first) {
+                for (auto& column : columns) {
+                    column.push_back(',');
+                }
+            }
+            first = false;
+            AppendArrayElement(columns[0], stats.player_id());
+            columns[1].append(std::to_string(stats.shots_fired()));
+            columns[2].append(std::to_string(stats.hits_landed()));
+            columns[3].append(std::to_string(stats.kills()));
+            columns[4].append(std::to_string(stats.deaths()));
+            columns[5].append(std::to_string(stats.damage_dealt()));
+            columns[6].append(std::to_string(stats.damage_taken()));
+        }
+        for (auto& column : columns) {
+            column.push_back('}');
+        }
+        const char* params[11] = {match.match_id().c_str(), match.winner_id().c_str(),
+                                  match.loser_id().c_str(), completed.c_str(),
+                                  columns[0].c_str(),       columns[1].c_str(),
+                                  columns[2].c_str(),       columns[3].c_str(),
+                                  columns[4].c_str(),       columns[5].c_str(),
+                                  columns[6].c_str()};
+        if (!PQsendQueryPrepared(conn, kMatchRecordStatement, 11, params, nullptr, nullptr, 0)) {
+            std::cerr << "postgres pipeline send failed: " << PQerrorMessage(conn);
+            ok = false;
+            break;
+        }
+        if (!PQpipelineSync(conn)) {
+            // The statement is queued without a sync point; nothing after it can be read back.
+            std::cerr << "postgres pipeline sync failed: " << PQerrorMessage(conn);
+            drained = false;
+            ok = false;
+            break;
+        }
+        ++synced;
     }
-    PGconn* raw = PQconnectdb(dsn_.c_str());
-    if (PQstatus(raw) != CONNECTION_OK) {
-        std::cerr << "postgres connection failed: " << PQerrorMessage(raw);
-        PQfinish(raw);
-        return false;
+
+    // Consume what was sent even after a send failure so the connection can leave pipeline mode.
+    for (std::size_t i = 0; i < synced; ++i) {
+        PGresult* result = PQgetResult(conn);
+        if (!result) {
+            drained = false;
+            return false;
+        }
+        const auto status = PQresultStatus(result);
+        if (status != PGRES_COMMAND_OK) {
+            std::cerr << "postgres match insert failed: " << PQerrorMessage(conn);
+            ok = false;
+        }
+        PQclear(result);
+        // Each statement's results are terminated by a null result.
+        PQclear(PQgetResult(conn));
+        PGresult* sync = PQgetResult(conn);
+        if (!sync || PQresultStatus(sync) != PGRES_PIPELINE_SYNC) {
+            PQclear(sync);
+            drained = false;
+            return false;
+        }
+        PQclear(sync);
     }
-    connection_.reset(raw);
-    return true;
+    return ok;
 }
+}  // namespace
+
+PostgresStorage::PostgresStorage(std::string dsn, PostgresPoolOptions pool_options)
+    : dsn_(std::move(dsn)), pool_(dsn_, pool_options) {}
 
-void PostgresStorage::Disconnect() { connection_.reset(); }
+PostgresStorage::~PostgresStorage() { Disconnect(); }
 
-bool PostgresStorage::IsConnected() const noexcept { return connection_ != nullptr; }
+bool PostgresStorage::Connect() { return pool_.Connect() > 0; }
+
+void PostgresStorage::Disconnect() { pool_.Close(); }
+
+bool PostgresStorage::IsConnected() const { return pool_.HealthyCount() > 0; }
 
 bool PostgresStorage::RecordSessionEvent(const std::string& player_id, const std::string& event) {
-    if (!connection_) {
+    auto lease = pool_.Acquire();
+    if (!lease || !lease.EnsurePrepared(kSessionEventStatement, kSessionEventSql, 2)) {
         std::cerr << "postgres write skipped: no connection" << std::endl;
         return false;
     }
     const auto start = std::chrono::steady_clock::now();
     const char* param_values[2] = {player_id.c_str(), event.c_str()};
-    const int param_lengths[2] = {static_cast<int>(player_id.size()),
-                                  static_cast<int>(event.size())};
-    const int param_formats[2] = {0, 0};
-
-    PGresult* result = PQexecParams(connection_.get(),
-                                    "INSERT INTO session_events(player_id, event_type, created_at)"
-                                    " VALUES($1, $2, NOW())",
-                                    2, nullptr, param_values, param_lengths, param_formats, 0);
+    PGresult* result = PQexecPrepared(lease.get(), kSessionEventStatement, 2, param_values,
+                                      nullptr, nullptr, 0);
     const auto finish = std::chrono::steady_clock::now();
-    const double duration = std::chrono::duration<double>(finish - start).count();
-    last_query_seconds_.store(duration, std::memory_order_relaxed);
-    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-        std::cerr << "postgres insert failed: " << PQerrorMessage(connection_.get());
-        PQclear(result);
+    ObserveQuery(kSessionEventStatement, std::chrono::duration<double>(finish - start).count());
+    const bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+        std::cerr << "postgres insert failed: " << PQerrorMessage(lease.get());
+    }
+    PQclear(result);
+    return ok;
+}
+
+bool PostgresStorage::WriteSessionEvents(const std::vector<SessionEvent>& events) {
+    if (events.empty()) {
+        return true;
+    }
+    auto lease = pool_.Acquire();
+    if (!lease || !lease.EnsurePrepared(kSessionBatchStatement, kSessionBatchSql, 3)) {
         return false;
     }
+
+    std::string player_ids{"{"};
+    std::string event_types{"{"};
+    std::string timestamps{"{"};
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        if (i > 0) {
+            player_ids.push_back(',');
+            event_types.push_back(',');
+            timestamps.push_back(',');
+        }
+        AppendArrayElement(player_ids, events[i].player_id);
+        AppendArrayElement(event_types, events[i].event_type);
+        timestamps.append(EpochSeconds(events[i].created_at));
+    }
+    player_ids.push_back('}');
+    event_types.push_back('}');
+    timestamps.push_back('}');
+
+    const auto start = std::chrono::steady_clock::now();
+    const char* param_values[3] = {player_ids.c_str(), event_types.c_str(), timestamps.c_str()};
+    PGresult* result = PQexecPrepared(lease.get(), kSessionBatchStatement, 3, param_values,
+                                      nullptr, nullptr, 0);
+    const auto finish = std::chrono::steady_clock::now();
+    ObserveQuery(kSessionBatchStatement, std::chrono::duration<double>(finish - start).count());
+    const bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+        std::cerr << "postgres batch insert failed: " << PQerrorMessage(lease.get());
+    }
     PQclear(result);
-    return true;
+    return ok;
 }
 
+bool PostgresStorage::RecordMatchResults(const std::vector<MatchResult>& results) {
+    if (results.empty()) {
+        return true;
+    }
+    auto lease = pool_.Acquire();
+    if (!lease || !lease.EnsurePrepared(kMatchRecordStatement, kMatchRecordSql, 11)) {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (!PQenterPipelineMode(lease.get())) {
+        std::cerr << "postgres pipeline mode unavailable: " << PQerrorMessage(lease.get());
+        return false;
+    }
+
+    bool ok = true;
+    bool drained = true;
+    for (std::size_t offset = 0; offset < results.size() && drained;
+         offset += kMaxPipelineMatches) {
+        const std::size_t count = std::min(kMaxPipelineMatches, results.size() - offset);
+        ok = RunPipelineSegment(lease.get(), results.data() + offset, count, drained) && ok;
+    }
+
+    if (!drained) {
+        lease.MarkBroken();
+        ok = false;
+    } else if (!PQexitPipelineMode(lease.get())) {
+        std::cerr << "postgres pipeline exit failed: " << PQerrorMessage(lease.get());
+        lease.MarkBroken();
+        ok = false;
+    }
+    const auto finish = std::chrono::steady_clock::now();
+    ObserveQuery("arena60_match_results_pipeline",
+                 std::chrono::duration<double>(finish - start).count());
+    if (!ok) {
+        std::lock_guard<std::mutex> lk(metrics_mutex_);
+        ++pipeline_failures_total_;
+    }
+    return ok;
+}
+
+std::size_t PostgresStorage::HealthCheck() { return pool_.HealthCheck(); }
+
 std::string PostgresStorage::MetricsSnapshot() const {
     std::ostringstream oss;
-    oss << "# TYPE database_query_duration_seconds gauge\n";
-    oss << "database_query_duration_seconds " << last_query_seconds_.load(std::memory_order_relaxed)
-        << "\n";
+    oss << "# TYPE database_pool_connections_healthy gauge\n";
+    oss << "database_pool_connections_healthy " << pool_.HealthyCount() << "\n";
+    oss << "# TYPE database_pool_connections gauge\n";
+    oss << "database_pool_connections " << pool_.Size() << "\n";
+    oss << "# TYPE database_reconnects_total counter\n";
+    oss << "database_reconnects_total " << pool_.ReconnectsTotal() << "\n";
+
+    std::lock_guard<std::mutex> lk(metrics_mutex_);
+    oss << "# TYPE database_pipeline_failures_total counter\n";
+    oss << "database_pipeline_failures_total " << pipeline_failures_total_ << "\n";
+    oss << "# TYPE database_query_duration_seconds histogram\n";
+    for (const auto& [statement, histogram] : query_durations_) {
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < kDurationBuckets.size(); ++i) {
+            cumulative += histogram.bucket_counts[i];
+            oss << "database_query_duration_seconds_bucket{statement=\"" << statement
+                << "\",le=\"" << kDurationBuckets[i] << "\"} " << cumulative << "\n";
+        }
+        cumulative += histogram.overflow_count;
+        oss << "database_query_duration_seconds_bucket{statement=\"" << statement
+            << "\",le=\"+Inf\"} " << cumulative << "\n";
+        oss << "database_query_duration_seconds_sum{statement=\"" << statement << "\"} "
+            << histogram.sum << "\n";
+        oss << "database_query_duration_seconds_count{statement=\"" << statement << "\"} "
+            << histogram.count << "\n";
+    }
     return oss.str();
 }
 
@@ -73,4 +287,19 @@ double PostgresStorage::LastQueryDurationSeconds() const noexcept {
     return last_query_seconds_.load(std::memory_order_relaxed);
 }
 
+void PostgresStorage::ObserveQuery(const char* statement, double seconds) {
+    last_query_seconds_.store(seconds, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(metrics_mutex_);
+    auto& histogram = query_durations_[statement];
+    histogram.sum += seconds;
+    ++histogram.count;
+    for (std::size_t i = 0; i < kDurationBuckets.size(); ++i) {
+        if (seconds <= kDurationBuckets[i]) {
+            ++histogram.bucket_counts[i];
+            return;
+        }
+    }
+    ++histogram.overflow_count;
+}
+
 }  // namespace arena60
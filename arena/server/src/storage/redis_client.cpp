@@ -0,0 +1,464 @@
+#include "arena60/storage/redis_client.h"
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <charconv>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string_view>
+
+namespace arena60 {
+
+namespace {
+constexpr int kMaxReplyDepth = 8;
+constexpr std::size_t kCompactThreshold = 64 * 1024;
+// Redis's own proto-max-bulk-len default; anything larger is a corrupt or hostile length.
+constexpr std::int64_t kMaxBulkLength = 512 * 1024 * 1024;
+constexpr std::int64_t kMaxArrayElements = 1 << 24;
+// The shortest element, an empty simple string, is "+\r\n".
+constexpr std::size_t kMinElementBytes = 3;
+
+bool ParseInteger(std::string_view text, std::int64_t& value) {
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+}  // namespace
+
+void AppendRespCommand(std::string& out, const RedisCommand& command) {
+    out.push_back('*');
+    out.append(std::to_string(command.size()));
+    out.append("\r\n");
+    for (const auto& argument : command) {
+        out.push_back('$');
+        out.append(std::to_string(argument.size()));
+        out.append("\r\n");
+        out.append(argument);
+        out.append("\r\n");
+    }
+}
+
+void RespParser::Feed(const char* data, std::size_t size) {
+    if (consumed_ == buffer_.size()) {
+        buffer_.clear();
+        consumed_ = 0;
+    } else if (consumed_ >= kCompactThreshold) {
+        buffer_.erase(0, consumed_);
+        consumed_ = 0;
+    }
+    buffer_.append(data, size);
+}
+
+RespParser::Result RespParser::Next(RedisReply& reply) {
+    std::size_t pos = consumed_;
+    const auto result = Parse(pos, reply, 0);
+    if (result == Result::kReply) {
+        consumed_ = pos;
+    }
+    return result;
+}
+
+void RespParser::Reset() {
+    buffer_.clear();
+    consumed_ = 0;
+}
+
+RespParser::Result RespParser::Parse(std::size_t& pos, RedisReply& reply, int depth) const {
+    if (depth > kMaxReplyDepth) {
+        return Result::kError;
+    }
+    if (pos >= buffer_.size()) {
+        return Result::kIncomplete;
+    }
+    const auto eol = buffer_.find("\r\n", pos + 1);
+    if (eol == std::string::npos) {
+        return Result::kIncomplete;
+    }
+    const char type = buffer_[pos];
+    const std::string_view line(buffer_.data() + pos + 1, eol - pos - 1);
+    const std::size_t next = eol + 2;
+    std::int64_t number = 0;
+    switch (type) {
+        case '+':
+        case '-':
+            reply.type = type == '+' ? RedisReply::Type::kSimpleString : RedisReply::Type::kError;
+            reply.str.assign(line.data(), line.size());
+            pos = next;
+            return Result::kReply;
+        case ':':
+            if (!ParseInteger(line, number)) {
+                return Result::kError;
+            }
+            reply.type = RedisReply::Type::kInteger;
+            reply.integer = number;
+            pos = next;
+            return Result::kReply;
+        case '$': {
+            if (!ParseInteger(line, number) || number < -1 || number > kMaxBulkLength) {
+                return Result::kError;
+            }
+            if (number == -1) {
+                reply.type = RedisReply::Type::kNil;
+                pos = next;
+                return Result::kReply;
+            }
+            const auto length = static_cast<std::size_t>(number);
+            if (buffer_.size() < next + length + 2) {
+                return Result::kIncomplete;
+            }
+            if (buffer_[next + length] != '\r' || buffer_[next + length + 1] != '\n') {
+                return Result::kError;
+            }
+            reply.type = RedisReply::Type::kBulkString;
+            reply.str.assign(buffer_, next, length);
+            pos = next + length + 2;
+            return Result::kReply;
+        }
+        case '*': {
+            if (!ParseInteger(line, number) || number < -1 || number > kMaxArrayElements) {
+                return Result::kError;
+            }
+            if (number == -1) {
+                reply.type = RedisReply::Type::kNil;
+                pos = next;
+                return Result::kReply;
+            }
+            const auto count = static_cast<std::size_t>(number);
+            // Only size the array once enough bytes have arrived to hold every element, so the
+            // count alone never drives the allocation.
+            if ((buffer_.size() - next) / kMinElementBytes < count) {
+                return Result::kIncomplete;
+            }
+            reply.type = RedisReply::Type::kArray;
+            reply.elements.clear();
+            reply.elements.resize(count);
+            std::size_t cursor = next;
+            for (auto& element : reply.elements) {
+                const auto result = Parse(cursor, element, depth + 1);
+                if (result != Result::kReply) {
+                    return result;
+                }
+            }
+            pos = cursor;
+            return Result::kReply;
+        }
+        default:
+            return Result::kError;
+    }
+}
+
+RedisClient::RedisClient(RedisClientOptions options)
+    : options_(std::move(options)),
+      work_guard_(boost::asio::make_work_guard(io_context_)),
+      socket_(io_context_),
+      resolver_(io_context_),
+      connect_timer_(io_context_) {
+    thread_ = std::thread([this]() { io_context_.run(); });
+}
+
+RedisClient::~RedisClient() {
+    Close();
+    work_guard_.reset();
+    io_context_.stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool RedisClient::Connect() {
+    if (connected_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    auto done = std::make_shared<std::promise<bool>>();
+    auto result = done->get_future();
+    boost::asio::post(io_context_, [this, done]() {
+        if (state_ == State::kConnected) {
+            done->set_value(true);
+            return;
+        }
+        connect_waiters_.push_back([done](bool ok) { done->set_value(ok); });
+        StartConnect();
+    });
+    // connect_timer_ bounds the attempt, so the waiter always fires.
+    return result.get();
+}
+
+void RedisClient::Close() {
+    boost::asio::post(io_context_, [this]() { FailAll(); });
+}
+
+bool RedisClient::IsConnected() const noexcept {
+    return connected_.load(std::memory_order_acquire);
+}
+
+void RedisClient::AsyncExecute(std::vector<RedisCommand> commands, Callback callback) {
+    pipelines_total_.fetch_add(1, std::memory_order_relaxed);
+    commands_total_.fetch_add(commands.size(), std::memory_order_relaxed);
+    std::string encoded;
+    for (const auto& command : commands) {
+        AppendRespCommand(encoded, command);
+    }
+    const std::size_t count = commands.size();
+    boost::asio::post(io_context_, [this, encoded = std::move(encoded), count,
+                                    callback = std::move(callback)]() mutable {
+        if (count == 0) {
+            if (callback) {
+                callback(true, {});
+            }
+            return;
+        }
+        if (state_ == State::kDisconnected) {
+            StartConnect();
+        }
+        if (state_ == State::kDisconnected) {
+            // Still inside the reconnect backoff.
+            errors_total_.fetch_add(1, std::memory_order_relaxed);
+            if (callback) {
+                callback(false, {});
+            }
+            return;
+        }
+        // While connecting the pipeline waits in outgoing_; FinishConnect writes or fails it.
+        outgoing_.append(encoded);
+        pending_.push_back(PendingPipeline{count, {}, std::move(callback)});
+        pending_.back().replies.reserve(count);
+        DoWrite();
+    });
+}
+
+std::optional<std::vector<RedisReply>> RedisClient::Execute(std::vector<RedisCommand> commands) {
+    auto timeout = options_.command_timeout;
+    if (!IsConnected()) {
+        timeout += options_.connect_timeout;
+    }
+    auto done = std::make_shared<std::promise<std::optional<std::vector<RedisReply>>>>();
+    auto result = done->get_future();
+    AsyncExecute(std::move(commands), [done](bool ok, std::vector<RedisReply> replies) {
+        if (ok) {
+            done->set_value(std::move(replies));
+        } else {
+            done->set_value(std::nullopt);
+        }
+    });
+    if (result.wait_for(timeout) != std::future_status::ready) {
+        errors_total_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    return result.get();
+}
+
+std::optional<RedisReply> RedisClient::ExecuteOne(RedisCommand command) {
+    std::vector<RedisCommand> commands;
+    commands.push_back(std::move(command));
+    auto replies = Execute(std::move(commands));
+    if (!replies || replies->empty()) {
+        return std::nullopt;
+    }
+    return std::move(replies->front());
+}
+
+void RedisClient::StartConnect() {
+    if (state_ != State::kDisconnected) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() < retry_at_) {
+        auto waiters = std::move(connect_waiters_);
+        connect_waiters_.clear();
+        for (auto& waiter : waiters) {
+            waiter(false);
+        }
+        return;
+    }
+    state_ = State::kConnecting;
+    const std::uint64_t attempt = ++connect_attempt_;
+    boost::system::error_code ec;
+    socket_.close(ec);
+    connect_timer_.expires_after(options_.connect_timeout);
+    connect_timer_.async_wait([this, attempt](const boost::system::error_code& timer_ec) {
+        if (!timer_ec) {
+            FinishConnect(attempt, boost::asio::error::timed_out);
+        }
+    });
+    resolver_.async_resolve(
+        options_.host, std::to_string(options_.port),
+        [this, attempt](const boost::system::error_code& resolve_ec,
+                        const boost::asio::ip::tcp::resolver::results_type& endpoints) {
+            if (attempt != connect_attempt_ || state_ != State::kConnecting) {
+                return;
+            }
+            if (resolve_ec) {
+                FinishConnect(attempt, resolve_ec);
+                return;
+            }
+            boost::asio::async_connect(
+                socket_, endpoints,
+                [this, attempt](const boost::system::error_code& connect_ec,
+                                const boost::asio::ip::tcp::endpoint&) {
+                    FinishConnect(attempt, connect_ec);
+                });
+        });
+}
+
+void RedisClient::FinishConnect(std::uint64_t attempt, const boost::system::error_code& ec) {
+    // The timer and the connect race; whichever lands second belongs to a finished attempt.
+    if (attempt != connect_attempt_ || state_ != State::kConnecting) {
+        return;
+    }
+    connect_timer_.cancel();
+    auto waiters = std::move(connect_waiters_);
+    connect_waiters_.clear();
+    const bool ok = !ec;
+    if (ok) {
+        boost::system::error_code option_ec;
+        socket_.set_option(boost::asio::ip::tcp::no_delay(true), option_ec);
+        state_ = State::kConnected;
+        backoff_ = std::chrono::milliseconds{0};
+        parser_.Reset();
+        connected_.store(true, std::memory_order_release);
+        DoRead();
+        DoWrite();
+    } else {
+        std::cerr << "redis connect to " << options_.host << ':' << options_.port
+                  << " failed: " << ec.message() << std::endl;
+        state_ = State::kDisconnected;
+        resolver_.cancel();
+        backoff_ = backoff_.count() == 0
+                       ? options_.reconnect_backoff_min
+                       : std::min(backoff_ * 2, options_.reconnect_backoff_max);
+        retry_at_ = std::chrono::steady_clock::now() + backoff_;
+        // FailAll counts the error itself when pipelines were waiting on this connect.
+        if (pending_.empty()) {
+            errors_total_.fetch_add(1, std::memory_order_relaxed);
+        }
+        FailAll();
+    }
+    for (auto& waiter : waiters) {
+        waiter(ok);
+    }
+}
+
+void RedisClient::DoWrite() {
+    if (state_ != State::kConnected || writing_ || outgoing_.empty()) {
+        return;
+    }
+    writing_ = true;
+    in_flight_.clear();
+    in_flight_.swap(outgoing_);
+    writes_total_.fetch_add(1, std::memory_order_relaxed);
+    const std::uint64_t attempt = connect_attempt_;
+    boost::asio::async_write(
+        socket_, boost::asio::buffer(in_flight_),
+        [this, attempt](const boost::system::error_code& ec, std::size_t) {
+            if (attempt != connect_attempt_ || state_ != State::kConnected) {
+                return;  // FailAll already tore this connection down
+            }
+            writing_ = false;
+            if (ec) {
+                std::cerr << "redis write error: " << ec.message() << std::endl;
+                FailAll();
+                return;
+            }
+            DoWrite();
+        });
+}
+
+void RedisClient::DoRead() {
+    const std::uint64_t attempt = connect_attempt_;
+    socket_.async_read_some(
+        boost::asio::buffer(read_buffer_),
+        [this, attempt](const boost::system::error_code& ec, std::size_t bytes) {
+            if (attempt != connect_attempt_ || state_ != State::kConnected) {
+                return;  // FailAll already tore this connection down
+            }
+            if (ec) {
+                std::cerr << "redis read error: " << ec.message() << std::endl;
+                FailAll();
+                return;
+            }
+            parser_.Feed(read_buffer_.data(), bytes);
+            RedisReply reply;
+            while (true) {
+                const auto result = parser_.Next(reply);
+                if (result == RespParser::Result::kIncomplete) {
+                    break;
+                }
+                if (result == RespParser::Result::kError || pending_.empty()) {
+                    std::cerr << "redis protocol error" << std::endl;
+                    FailAll();
+                    return;
+                }
+                auto& front = pending_.front();
+                front.replies.push_back(std::move(reply));
+                reply = RedisReply{};
+                if (front.replies.size() == front.expected) {
+                    PendingPipeline completed = std::move(front);
+                    pending_.pop_front();
+                    if (completed.callback) {
+                        completed.callback(true, std::move(completed.replies));
+                    }
+                }
+            }
+            DoRead();
+        });
+}
+
+void RedisClient::FailAll() {
+    // Handlers of the torn-down socket may still be queued; they carry an older attempt or see
+    // state_ != kConnected and return without touching the next connection. Closing the socket
+    // while connecting aborts the attempt, and FinishConnect reports the failure to waiters.
+    if (state_ == State::kConnected) {
+        state_ = State::kDisconnected;
+    }
+    const bool was_connected = connected_.exchange(false, std::memory_order_acq_rel);
+    boost::system::error_code ec;
+    socket_.close(ec);
+    parser_.Reset();
+    outgoing_.clear();
+    writing_ = false;
+    auto failed = std::move(pending_);
+    pending_.clear();
+    if (was_connected || !failed.empty()) {
+        errors_total_.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (auto& pipeline : failed) {
+        if (pipeline.callback) {
+            pipeline.callback(false, {});
+        }
+    }
+}
+
+std::uint64_t RedisClient::PipelinesTotal() const noexcept {
+    return pipelines_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RedisClient::CommandsTotal() const noexcept {
+    return commands_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RedisClient::WritesTotal() const noexcept {
+    return writes_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RedisClient::ErrorsTotal() const noexcept {
+    return errors_total_.load(std::memory_order_relaxed);
+}
+
+std::string RedisClient::MetricsSnapshot() const {
+    std::ostringstream oss;
+    oss << "# TYPE redis_connected gauge\n";
+    oss << "redis_connected " << (IsConnected() ? 1 : 0) << "\n";
+    oss << "# TYPE redis_pipelines_total counter\n";
+    oss << "redis_pipelines_total " << PipelinesTotal() << "\n";
+    oss << "# TYPE redis_commands_total counter\n";
+    oss << "redis_commands_total " << CommandsTotal() << "\n";
+    oss << "# TYPE redis_writes_total counter\n";
+    oss << "redis_writes_total " << WritesTotal() << "\n";
+    oss << "# TYPE redis_errors_total counter\n";
+    oss << "redis_errors_total " << ErrorsTotal() << "\n";
+    return oss.str();
+}
+
+}  // namespace arena60
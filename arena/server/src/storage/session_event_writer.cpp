@@ -0,0 +1,154 @@
+#include "arena60/storage/session_event_writer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace arena60 {
+
+SessionEventWriter::SessionEventWriter(std::shared_ptr<SessionEventSink> sink,
+                                       SessionEventWriterOptions options)
+    : sink_(std::move(sink)), options_(options) {}
+
+SessionEventWriter::~SessionEventWriter() { Stop(); }
+
+void SessionEventWriter::Start() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (thread_.joinable()) {
+        return;
+    }
+    stop_requested_ = false;
+    thread_ = std::thread([this]() { Run(); });
+}
+
+void SessionEventWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stop_requested_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool SessionEventWriter::Enqueue(const std::string& player_id, const std::string& event_type) {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (queue_.size() >= options_.queue_capacity) {
+            dropped_queue_full_total_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(SessionEvent{player_id, event_type, std::chrono::system_clock::now()});
+        enqueued_total_.fetch_add(1, std::memory_order_relaxed);
+        if (queue_.size() < options_.max_batch_size) {
+            return true;
+        }
+    }
+    cv_.notify_one();
+    return true;
+}
+
+std::size_t SessionEventWriter::QueueDepth() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return queue_.size();
+}
+
+std::uint64_t SessionEventWriter::EventsWritten() const noexcept {
+    return written_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SessionEventWriter::EventsDropped() const noexcept {
+    return dropped_queue_full_total_.load(std::memory_order_relaxed) +
+           dropped_write_failed_total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SessionEventWriter::RetriesTotal() const noexcept {
+    return retries_total_.load(std::memory_order_relaxed);
+}
+
+std::string SessionEventWriter::MetricsSnapshot() const {
+    std::ostringstream oss;
+    oss << "# TYPE session_events_queue_depth gauge\n";
+    oss << "session_events_queue_depth " << QueueDepth() << "\n";
+    oss << "# TYPE session_events_enqueued_total counter\n";
+    oss << "session_events_enqueued_total " << enqueued_total_.load(std::memory_order_relaxed)
+        << "\n";
+    oss << "# TYPE session_events_written_total counter\n";
+    oss << "session_events_written_total " << EventsWritten() << "\n";
+    oss << "# TYPE session_events_dropped_total counter\n";
+    oss << "session_events_dropped_total{reason=\"queue_full\"} "
+        << dropped_queue_full_total_.load(std::memory_order_relaxed) << "\n";
+    oss << "session_events_dropped_total{reason=\"write_failed\"} "
+        << dropped_write_failed_total_.load(std::memory_order_relaxed) << "\n";
+    oss << "# TYPE session_events_retries_total counter\n";
+    oss << "session_events_retries_total " << RetriesTotal() << "\n";
+    oss << "# TYPE session_events_batches_total counter\n";
+    oss << "session_events_batches_total " << batches_total_.load(std::memory_order_relaxed)
+        << "\n";
+    oss << "# TYPE session_events_batch_duration_seconds gauge\n";
+    oss << "session_events_batch_duration_seconds "
+        << last_batch_seconds_.load(std::memory_order_relaxed) << "\n";
+    return oss.str();
+}
+
+void SessionEventWriter::Run() {
+    std::vector<SessionEvent> batch;
+    batch.reserve(options_.max_batch_size);
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            cv_.wait_for(lk, options_.flush_interval, [this]() {
+                return stop_requested_ || queue_.size() >= options_.max_batch_size;
+            });
+            stopping = stop_requested_;
+            if (queue_.empty()) {
+                if (stopping) {
+                    return;
+                }
+                continue;
+            }
+            const std::size_t count = std::min(queue_.size(), options_.max_batch_size);
+            for (std::size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        if (WriteWithRetry(batch)) {
+            written_total_.fetch_add(batch.size(), std::memory_order_relaxed);
+        } else {
+            dropped_write_failed_total_.fetch_add(batch.size(), std::memory_order_relaxed);
+            std::cerr << "session event batch dropped after retries: " << batch.size()
+                      << " events" << std::endl;
+        }
+        batch.clear();
+    }
+}
+
+bool SessionEventWriter::WriteWithRetry(const std::vector<SessionEvent>& batch) {
+    auto backoff = options_.initial_backoff;
+    for (std::uint32_t attempt = 0;; ++attempt) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = sink_ && sink_->WriteSessionEvents(batch);
+        const auto finish = std::chrono::steady_clock::now();
+        last_batch_seconds_.store(std::chrono::duration<double>(finish - start).count(),
+                                  std::memory_order_relaxed);
+        batches_total_.fetch_add(1, std::memory_order_relaxed);
+        if (ok) {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lk(mutex_);
+        // Once shutdown has begun the remaining queue is drained with a single attempt each.
+        if (attempt >= options_.max_retries || stop_requested_) {
+            return false;
+        }
+        retries_total_.fetch_add(1, std::memory_order_relaxed);
+        cv_.wait_for(lk, backoff, [this]() { return stop_requested_; });
+        backoff = std::min(backoff * 2, options_.max_backoff);
+    }
+}
+
+}  // namespace arena60
@@ -22,7 +22,8 @@ using arena60::MatchResult;
 using arena60::PlayerMatchStats;
 }  // namespace
 
-http::response<http::string_body> PerformRequest(std::uint16_t port, const std::string& target) {
+http::response<http::string_body> PerformRequest(std::uint16_t port, const std::string& target,
+                                                 const std::string& if_none_match = {}) {
     boost::asio::io_context io_context;
     boost::asio::ip::tcp::resolver resolver(io_context);
     auto endpoints = resolver.resolve("127.0.0.1", std::to_string(port));
@@ -32,6 +33,9 @@ http::response<http::string_body> PerformRequest(std::uint16_t port, const std::
     http::request<http::string_body> request{http::verb::get, target, 11};
     request.set(http::field::host, "127.0.0.1");
     request.set(http::field::user_agent, "arena60-tests");
+    if (!if_none_match.empty()) {
+        request.set(http::field::if_none_match, if_none_match);
+    }
     http::write(stream, request);
 
     boost::beast::flat_buffer buffer;
@@ -55,7 +59,9 @@ TEST(ProfileHttpRouterIntegrationTest, ServesMetricsProfilesAndLeaderboard) {
     MatchResult result{"match-1", "winner", "loser", std::chrono::system_clock::now(), stats};
     profile_service->RecordMatch(result);
 
-    auto metrics_provider = [profile_service]() { return profile_service->MetricsSnapshot(); };
+    auto metrics_provider = [profile_service](std::string& out) {
+        out.append(profile_service->MetricsSnapshot());
+    };
     auto router = std::make_shared<arena60::ProfileHttpRouter>(metrics_provider, profile_service);
     arena60::MetricsHttpServer::RequestHandler handler =
         [router](const http::request<http::string_body>& request) {
@@ -86,6 +92,22 @@ TEST(ProfileHttpRouterIntegrationTest, ServesMetricsProfilesAndLeaderboard) {
     auto leaderboard_response = PerformRequest(port, "/leaderboard?limit=1");
     EXPECT_EQ(http::status::ok, leaderboard_response.result());
     EXPECT_NE(leaderboard_response.body().find("winner"), std::string::npos);
+    const std::string etag{leaderboard_response[http::field::etag]};
+    ASSERT_FALSE(etag.empty());
+
+    auto not_modified = PerformRequest(port, "/leaderboard?limit=1", etag);
+    EXPECT_EQ(http::status::not_modified, not_modified.result());
+    EXPECT_TRUE(not_modified.body().empty());
+
+    std::vector<PlayerMatchStats> rematch_stats{
+        PlayerMatchStats{"match-2", "loser", 5, 5, 1, 0, 100, 10},
+        PlayerMatchStats{"match-2", "winner", 4, 2, 0, 1, 40, 100},
+    };
+    profile_service->RecordMatch(
+        MatchResult{"match-2", "loser", "winner", std::chrono::system_clock::now(), rematch_stats});
+    auto refreshed = PerformRequest(port, "/leaderboard?limit=1", etag);
+    EXPECT_EQ(http::status::ok, refreshed.result());
+    EXPECT_NE(etag, std::string{refreshed[http::field::etag]});
 
     server->Stop();
     io_context.stop();
@@ -11,6 +11,8 @@
 #include <cmath>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <sys/resource.h>
 #include <thread>
 #include <vector>
 
@@ -110,3 +112,90 @@ TEST(WebSocketServerIntegrationTest, ProcessesInputAndReturnsState) {
     EXPECT_GE(start_events.load(), 1);
     EXPECT_GE(end_events.load(), 1);
 }
+
+TEST(WebSocketServerIntegrationTest, NegotiatesPermessageDeflateForTextClients) {
+    arena60::GameSession session(60.0);
+    arena60::GameLoop loop(60.0);
+    boost::asio::io_context io_context;
+
+    auto server = std::make_shared<arena60::WebSocketServer>(
+        io_context, 0, session, loop, arena60::WebSocketCompression::ForPlayers(16));
+    server->Start();
+    loop.Start();
+    std::thread server_thread([&]() { io_context.run(); });
+
+    boost::asio::io_context client_io;
+    websocket::stream<tcp::socket> ws(client_io);
+    ws.next_layer().connect(
+        tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), server->Port()));
+    websocket::permessage_deflate deflate;
+    deflate.client_enable = true;
+    ws.set_option(deflate);
+    websocket::response_type response;
+    ws.handshake(response, "127.0.0.1", "/");
+    EXPECT_NE(std::string::npos,
+              std::string(response[boost::beast::http::field::sec_websocket_extensions])
+                  .find("permessage-deflate"));
+    ws.write(boost::asio::buffer(std::string("input deflate 1 0 0 0 1 1.0 0.0 0")));
+
+    std::string last;
+    for (int i = 0; i < 90; ++i) {
+        boost::beast::flat_buffer buffer;
+        ws.read(buffer);
+        last = boost::beast::buffers_to_string(buffer.data());
+    }
+    EXPECT_EQ(0u, last.rfind("state deflate ", 0)) << last;
+
+    boost::system::error_code close_error;
+    ws.next_layer().shutdown(tcp::socket::shutdown_both, close_error);
+    ws.next_layer().close(close_error);
+    const std::string metrics = server->MetricsSnapshot();
+    server->Stop();
+    loop.Stop();
+    io_context.stop();
+    loop.Join();
+    server_thread.join();
+
+    const std::string sample = "\nwebsocket_compression_ratio ";
+    const auto ratio_at = metrics.find(sample);
+    ASSERT_NE(std::string::npos, ratio_at);
+    const double ratio = std::stod(metrics.substr(ratio_at + sample.size()));
+    EXPECT_GT(ratio, 0.5);
+    EXPECT_LT(ratio, 1.1);
+    EXPECT_NE(std::string::npos, metrics.find("websocket_send_seconds_per_tick_count"));
+}
+
+TEST(WebSocketServerIntegrationTest, KeepsAcceptingAfterRunningOutOfDescriptors) {
+    arena60::GameSession session(60.0);
+    arena60::GameLoop loop(60.0);
+    boost::asio::io_context io_context;
+
+    auto server = std::make_shared<arena60::WebSocketServer>(io_context, 0, session, loop);
+    server->Start();
+    std::thread server_thread([&]() { io_context.run(); });
+
+    boost::asio::io_context client_io;
+    websocket::stream<tcp::socket> ws(client_io);
+    ws.next_layer().open(tcp::v4());
+    // Cap descriptors just above the client socket so the server's accept fails with EMFILE.
+    rlimit original{};
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &original));
+    rlimit capped = original;
+    capped.rlim_cur = static_cast<rlim_t>(ws.next_layer().native_handle()) + 1;
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &capped));
+    ws.next_layer().connect(
+        tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), server->Port()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &original));
+
+    boost::system::error_code handshake_error = boost::asio::error::timed_out;
+    ws.async_handshake("127.0.0.1", "/",
+                       [&](boost::system::error_code ec) { handshake_error = ec; });
+    client_io.run_for(std::chrono::seconds(3));
+
+    server->Stop();
+    io_context.stop();
+    server_thread.join();
+
+    EXPECT_FALSE(handshake_error) << handshake_error.message();
+}
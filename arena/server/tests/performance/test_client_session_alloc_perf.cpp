@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/core/game_loop.h"
+#include "arena60/game/game_session.h"
+#include "arena60/network/websocket_server.h"
+
+// Heap allocations made on the server's io_context thread. The replacement operator new below
+// applies to the whole performance test binary but only counts on a thread that opted in.
+namespace {
+std::atomic<std::uint64_t> g_server_allocations{0};
+thread_local bool t_count_allocations = false;
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (t_count_allocations) {
+        g_server_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Out of line so the compiler does not pair the inlined free() with a new-expression.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+using tcp = boost::asio::ip::tcp;
+namespace websocket = boost::beast::websocket;
+
+constexpr int kSessions = 1000;
+
+// Reads every state frame and answers each one with an input, so the server both reads and
+// writes one message per session per tick.
+struct EchoClient : std::enable_shared_from_this<EchoClient> {
+    EchoClient(boost::asio::io_context& io, int index)
+        : ws(io), player_id("bench-" + std::to_string(index)) {}
+
+    void Run(std::atomic<std::uint64_t>& received, std::atomic<std::uint64_t>& sent) {
+        ws.async_read(buffer, [self = shared_from_this(), &received, &sent](
+                                  boost::system::error_code ec, std::size_t) {
+            if (ec) {
+                return;
+            }
+            received.fetch_add(1, std::memory_order_relaxed);
+            self->buffer.consume(self->buffer.size());
+            self->frame = "input " + self->player_id + " " + std::to_string(++self->sequence) +
+                          " 0 1 0 0 0.0 1.0 0";
+            self->ws.async_write(boost::asio::buffer(self->frame),
+                                 [self, &received, &sent](boost::system::error_code ec,
+                                                          std::size_t) {
+                                     if (ec) {
+                                         return;
+                                     }
+                                     sent.fetch_add(1, std::memory_order_relaxed);
+                                     self->Run(received, sent);
+                                 });
+        });
+    }
+
+    websocket::stream<tcp::socket> ws;
+    boost::beast::flat_buffer buffer;
+    std::string player_id;
+    std::string frame;
+    std::uint64_t sequence{1};
+};
+
+}  // namespace
+
+TEST(ClientSessionAllocationTest, ThousandSessionsStayUnderOneAllocationPerMessage) {
+    std::ostringstream sink;
+    auto* const original_out = std::cout.rdbuf(sink.rdbuf());
+    auto* const original_err = std::cerr.rdbuf(sink.rdbuf());
+
+    // 20 Hz leaves a single core enough headroom for 1000 clients in the same process; at 60 Hz
+    // the write queues back up and the count measures queue growth rather than steady state.
+    arena60::GameSession session(20.0);
+    arena60::GameLoop loop(20.0);
+    boost::asio::io_context server_io;
+    auto server = std::make_shared<arena60::WebSocketServer>(server_io, 0, session, loop);
+    server->Start();
+    std::thread server_thread([&]() {
+        t_count_allocations = true;
+        server_io.run();
+    });
+
+    boost::asio::io_context client_io;
+    const tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), server->Port());
+    std::vector<std::shared_ptr<EchoClient>> clients;
+    clients.reserve(kSessions);
+    for (int i = 0; i < kSessions; ++i) {
+        auto client = std::make_shared<EchoClient>(client_io, i);
+        client->ws.next_layer().connect(endpoint);
+        client->ws.handshake("127.0.0.1", "/");
+        client->ws.write(
+            boost::asio::buffer("input " + client->player_id + " 1 0 0 0 0 1.0 0.0 0"));
+        clients.push_back(std::move(client));
+    }
+
+    std::atomic<std::uint64_t> received{0};
+    std::atomic<std::uint64_t> sent{0};
+    for (auto& client : clients) {
+        client->Run(received, sent);
+    }
+    std::thread client_thread([&]() { client_io.run(); });
+    loop.Start();
+
+    auto wait_for = [&](std::uint64_t target) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (received.load() < target && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    };
+    // Warm up until every session has a steady read/write cycle going.
+    wait_for(10u * kSessions);
+    const std::uint64_t received_before = received.load();
+    const std::uint64_t sent_before = sent.load();
+    const std::uint64_t allocations_before = g_server_allocations.load();
+    wait_for(received_before + 60u * kSessions);
+    const std::uint64_t allocations = g_server_allocations.load() - allocations_before;
+    const std::uint64_t messages =
+        (received.load() - received_before) + (sent.load() - sent_before);
+
+    loop.Stop();
+    loop.Join();
+    server->Stop();
+    server_io.stop();
+    client_io.stop();
+    server_thread.join();
+    client_thread.join();
+    std::cout.rdbuf(original_out);
+    std::cerr.rdbuf(original_err);
+
+    ASSERT_GT(messages, 0u);
+    const double per_message = static_cast<double>(allocations) / static_cast<double>(messages);
+    std::cout << kSessions << " sessions: " << messages << " messages, " << allocations
+              << " server allocations (" << per_message << " per message)" << std::endl;
+    EXPECT_LT(per_message, 1.0);
+}
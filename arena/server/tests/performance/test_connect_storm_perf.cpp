@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/core/game_loop.h"
+#include "arena60/game/game_session.h"
+#include "arena60/network/websocket_server.h"
+
+namespace {
+using tcp = boost::asio::ip::tcp;
+namespace websocket = boost::beast::websocket;
+
+constexpr int kPlayers = 50;
+constexpr int kStormConnections = 3000;
+constexpr double kTickBudgetSeconds = 1.0 / 60.0;
+
+// Cumulative bucket counts of websocket_tick_lateness_seconds, +Inf last.
+std::vector<std::uint64_t> LatenessBuckets(const std::string& metrics) {
+    std::vector<std::uint64_t> buckets;
+    std::istringstream lines(metrics);
+    std::string line;
+    const std::string prefix = "websocket_tick_lateness_seconds_bucket{";
+    while (std::getline(lines, line)) {
+        if (line.rfind(prefix, 0) == 0) {
+            buckets.push_back(std::stoull(line.substr(line.rfind(' ') + 1)));
+        }
+    }
+    return buckets;
+}
+
+// Upper bound of the bucket holding the 99th percentile of the ticks between two snapshots.
+double LatenessP99(const std::vector<std::uint64_t>& before,
+                   const std::vector<std::uint64_t>& after) {
+    const std::vector<double> bounds{0.001, 0.002, 0.004, 0.008, 0.016, 0.032, 0.064};
+    const std::uint64_t total = after.back() - before.back();
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        if (static_cast<double>(after[i] - before[i]) >= 0.99 * static_cast<double>(total)) {
+            return bounds[i];
+        }
+    }
+    return 1.0;
+}
+
+struct StormClient : std::enable_shared_from_this<StormClient> {
+    explicit StormClient(boost::asio::io_context& io) : ws(io) {}
+
+    void Run(const tcp::endpoint& endpoint, std::atomic<int>& admitted,
+             std::atomic<int>& refused) {
+        auto self = shared_from_this();
+        ws.next_layer().async_connect(endpoint, [self, &admitted,
+                                                 &refused](boost::system::error_code ec) {
+            if (ec) {
+                refused.fetch_add(1);
+                return;
+            }
+            self->ws.async_handshake("127.0.0.1", "/",
+                                     [self, &admitted, &refused](boost::system::error_code ec) {
+                                         (ec ? refused : admitted).fetch_add(1);
+                                     });
+        });
+    }
+
+    websocket::stream<tcp::socket> ws;
+};
+
+struct StormResult {
+    double p99_lateness;
+    int admitted;
+    int refused;
+};
+
+// Runs kPlayers players, then opens kStormConnections connections at once and reports tick
+// lateness on the server's io_context while the storm is handled.
+StormResult RunStorm(const arena60::AdmissionOptions& admission) {
+    arena60::GameSession session(60.0);
+    arena60::GameLoop loop(60.0);
+    boost::asio::io_context server_io;
+    auto server = std::make_shared<arena60::WebSocketServer>(
+        server_io, 0, session, loop, arena60::WebSocketCompression{}, admission);
+    server->Start();
+    std::thread server_thread([&]() { server_io.run(); });
+    const tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), server->Port());
+
+    boost::asio::io_context client_io;
+    std::vector<std::unique_ptr<websocket::stream<tcp::socket>>> players;
+    std::vector<boost::beast::flat_buffer> buffers(kPlayers);
+    std::function<void(int)> drain = [&](int i) {
+        players[i]->async_read(buffers[i], [&, i](boost::system::error_code ec, std::size_t) {
+            if (!ec) {
+                buffers[i].consume(buffers[i].size());
+                drain(i);
+            }
+        });
+    };
+    for (int i = 0; i < kPlayers; ++i) {
+        players.push_back(std::make_unique<websocket::stream<tcp::socket>>(client_io));
+        players[i]->next_layer().connect(endpoint);
+        players[i]->handshake("127.0.0.1", "/");
+        players[i]->write(
+            boost::asio::buffer("input storm-" + std::to_string(i) + " 1 0 1 0 0 1.0 0.0 0"));
+        drain(i);
+    }
+    std::thread client_thread([&]() { client_io.run(); });
+    loop.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    const auto before = LatenessBuckets(server->MetricsSnapshot());
+    std::atomic<int> admitted{0};
+    std::atomic<int> refused{0};
+    std::vector<std::shared_ptr<StormClient>> storm;
+    storm.reserve(kStormConnections);
+    for (int i = 0; i < kStormConnections; ++i) {
+        storm.push_back(std::make_shared<StormClient>(client_io));
+    }
+    boost::asio::post(client_io, [&]() {
+        for (auto& client : storm) {
+            client->Run(endpoint, admitted, refused);
+        }
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (admitted.load() + refused.load() < kStormConnections &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // Keep the admitted connections open for a few more ticks.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const auto after = LatenessBuckets(server->MetricsSnapshot());
+
+    loop.Stop();
+    loop.Join();
+    server->Stop();
+    server_io.stop();
+    client_io.stop();
+    server_thread.join();
+    client_thread.join();
+
+    return StormResult{LatenessP99(before, after), admitted.load(), refused.load()};
+}
+
+}  // namespace
+
+TEST(ConnectStormPerformanceTest, AdmissionControlKeepsTickLatenessWithinBudget) {
+    std::ostringstream sink;
+    auto* const original_err = std::cerr.rdbuf(sink.rdbuf());
+    arena60::AdmissionOptions admission;
+    admission.max_connections = 1000;
+    admission.handshakes_per_second = 500.0;
+    admission.handshake_burst = 50.0;
+    admission.max_tick_lateness_seconds = kTickBudgetSeconds / 2.0;
+    const StormResult limited = RunStorm(admission);
+    const StormResult unlimited = RunStorm(arena60::AdmissionOptions{});
+    std::cerr.rdbuf(original_err);
+
+    std::cout << kStormConnections << " connects with admission control: p99 tick lateness <= "
+              << limited.p99_lateness * 1000.0 << " ms, " << limited.admitted << " admitted, "
+              << limited.refused << " refused; without: p99 <= "
+              << unlimited.p99_lateness * 1000.0 << " ms, " << unlimited.admitted
+              << " admitted" << std::endl;
+    EXPECT_EQ(kStormConnections, limited.admitted + limited.refused);
+    EXPECT_GT(limited.admitted, 0);
+    EXPECT_GT(limited.refused, 0);
+    EXPECT_LE(limited.p99_lateness, kTickBudgetSeconds);
+}
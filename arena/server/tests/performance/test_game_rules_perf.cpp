@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arena60/game/game_rules.h"
+#include "arena60/game/game_session.h"
+
+namespace {
+
+constexpr int kPlayers = 500;
+constexpr int kTicks = 240;
+constexpr int kFireStride = 60;
+constexpr double kDelta = 1.0 / 60.0;
+
+// Same layout as the metrics scrape benchmark: players 2 m apart along x, all firing +y, so the
+// tick is dominated by the projectile x player collision loop.
+template <typename Session>
+double MedianTickMicros(Session& session) {
+    for (int i = 0; i < kPlayers; ++i) {
+        const std::string id = "player-" + std::to_string(i);
+        session.UpsertPlayer(id);
+        arena60::MovementInput move{};
+        move.sequence = 1;
+        move.right = true;
+        move.mouse_y = 1.0;
+        session.ApplyInput(id, move, (2.0 * i) / session.rules().PlayerSpeed());
+    }
+    std::vector<double> durations;
+    durations.reserve(kTicks);
+    std::uint64_t sequence = 1;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        ++sequence;
+        for (int i = tick % kFireStride; i < kPlayers; i += kFireStride) {
+            arena60::MovementInput fire{};
+            fire.sequence = sequence;
+            fire.fire = true;
+            fire.mouse_y = 1.0;
+            session.ApplyInput("player-" + std::to_string(i), fire, kDelta);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        session.Tick(static_cast<std::uint64_t>(tick), kDelta);
+        durations.push_back(std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations[durations.size() / 2];
+}
+
+}  // namespace
+
+TEST(GameRulesPerformanceTest, CompileTimeRulesTickNoSlowerThanRuntimeRules) {
+    std::ostringstream sink;
+    auto* const original = std::cout.rdbuf(sink.rdbuf());
+
+    arena60::GameSession compiled(60.0);
+    arena60::TunableGameSession tunable(60.0);
+    // Alternate runs so neither variant always gets the warmer cache.
+    const double compiled_first = MedianTickMicros(compiled);
+    const double tunable_first = MedianTickMicros(tunable);
+    arena60::GameSession compiled_again(60.0);
+    arena60::TunableGameSession tunable_again(60.0);
+    const double tunable_second = MedianTickMicros(tunable_again);
+    const double compiled_second = MedianTickMicros(compiled_again);
+    std::cout.rdbuf(original);
+
+    const double compiled_us = std::min(compiled_first, compiled_second);
+    const double tunable_us = std::min(tunable_first, tunable_second);
+    std::cout << "500-player tick p50: " << compiled_us << " us with StandardRules vs "
+              << tunable_us << " us with RuntimeRules" << std::endl;
+
+    EXPECT_EQ(compiled.MetricsSnapshot(), tunable.MetricsSnapshot());
+    EXPECT_LT(compiled_us, tunable_us * 1.2 + 20.0);
+}
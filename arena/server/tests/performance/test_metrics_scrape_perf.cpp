@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/core/metrics_registry.h"
+#include "arena60/game/game_session.h"
+#include "arena60/matchmaking/match_queue.h"
+#include "arena60/matchmaking/matchmaker.h"
+
+namespace {
+
+constexpr int kPlayers = 1000;
+constexpr int kTicks = 180;
+constexpr int kFireStride = 120;
+constexpr double kDelta = 1.0 / 60.0;
+
+// Lines players up 2 m apart along x, all aiming +y, so projectiles stay in flight for their
+// full lifetime and every tick does players x projectiles collision checks without deaths.
+void SeedPlayers(arena60::GameSession& session) {
+    for (int i = 0; i < kPlayers; ++i) {
+        const std::string id = "player-" + std::to_string(i);
+        session.UpsertPlayer(id);
+        arena60::MovementInput move{};
+        move.sequence = 1;
+        move.right = true;
+        move.mouse_y = 1.0;
+        session.ApplyInput(id, move, (2.0 * i) / 5.0);
+    }
+}
+
+// Runs kTicks ticks with a rotating subset of players firing and returns the sorted durations of
+// the input + tick phase in microseconds.
+std::vector<double> RunTicks(arena60::GameSession& session, std::uint64_t& sequence) {
+    std::vector<double> durations;
+    durations.reserve(kTicks);
+    for (int tick = 0; tick < kTicks; ++tick) {
+        const auto start = std::chrono::steady_clock::now();
+        ++sequence;
+        for (int i = tick % kFireStride; i < kPlayers; i += kFireStride) {
+            arena60::MovementInput fire{};
+            fire.sequence = sequence;
+            fire.fire = true;
+            fire.mouse_y = 1.0;
+            session.ApplyInput("player-" + std::to_string(i), fire, kDelta);
+        }
+        session.Tick(static_cast<std::uint64_t>(tick), kDelta);
+        durations.push_back(std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+    }
+    std::sort(durations.begin(), durations.end());
+    return durations;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+    return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))];
+}
+
+}  // namespace
+
+TEST(MetricsScrapePerformanceTest, ScrapingDuringThousandPlayerTickDoesNotSlowTheTick) {
+    // The session logs every spawn; keep that I/O out of the measurement.
+    std::ostringstream sink;
+    auto* const original = std::cout.rdbuf(sink.rdbuf());
+
+    arena60::GameSession session(60.0);
+    arena60::Matchmaker matchmaker(std::make_shared<arena60::InMemoryMatchQueue>());
+    arena60::MetricsRegistry registry;
+    session.RegisterMetrics(registry);
+    matchmaker.RegisterMetrics(registry);
+    SeedPlayers(session);
+
+    std::uint64_t sequence = 1;
+    RunTicks(session, sequence);  // warm up to a steady projectile population
+    const auto baseline = RunTicks(session, sequence);
+
+    std::atomic<bool> scraping{true};
+    std::atomic<std::uint64_t> scrapes{0};
+    // One scrape per millisecond, thousands of times Prometheus' usual rate.
+    std::thread scraper([&]() {
+        std::string buffer;
+        while (scraping.load(std::memory_order_relaxed)) {
+            buffer.clear();
+            registry.AppendTo(buffer);
+            scrapes.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    const auto with_scrapes = RunTicks(session, sequence);
+    scraping = false;
+    scraper.join();
+    sink.str({});
+    std::cout.rdbuf(original);
+
+    const double baseline_p50 = Percentile(baseline, 0.5);
+    const double scraped_p50 = Percentile(with_scrapes, 0.5);
+    std::cout << "1000-player tick: p50 " << baseline_p50 << " us idle vs " << scraped_p50
+              << " us during " << scrapes.load() << " scrapes (p99 " << Percentile(baseline, 0.99)
+              << " vs " << Percentile(with_scrapes, 0.99) << " us)" << std::endl;
+
+    EXPECT_GT(scrapes.load(), static_cast<std::uint64_t>(kTicks));
+    EXPECT_GT(session.ActiveProjectileCount(), 0u);
+    // Scrapes never take the session mutex, so a tick is never parked behind one.
+    EXPECT_LT(scraped_p50, baseline_p50 * 1.25 + 50.0);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/network/metrics_http_server.h"
+#include "arena60/network/profile_http_router.h"
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/stats/player_profile_service.h"
+
+namespace http = boost::beast::http;
+
+namespace {
+using arena60::MatchResult;
+using arena60::PlayerMatchStats;
+
+std::shared_ptr<arena60::PlayerProfileService> MakePopulatedService(int players) {
+    auto leaderboard = std::make_shared<arena60::InMemoryLeaderboardStore>();
+    auto service = std::make_shared<arena60::PlayerProfileService>(leaderboard);
+    const auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < players; ++i) {
+        const std::string winner = "player-" + std::to_string(i);
+        const std::string loser = "player-" + std::to_string((i + 1) % players);
+        const std::string match_id = "match-" + std::to_string(i);
+        std::vector<PlayerMatchStats> stats{
+            PlayerMatchStats{match_id, winner, 5, 4, 1, 0, 80, 20},
+            PlayerMatchStats{match_id, loser, 5, 1, 0, 1, 20, 80},
+        };
+        service->RecordMatch(MatchResult{match_id, winner, loser, now, stats});
+    }
+    return service;
+}
+
+http::request<http::string_body> MakeRequest(const std::string& target) {
+    http::request<http::string_body> request{http::verb::get, target, 11};
+    request.set(http::field::host, "127.0.0.1");
+    return request;
+}
+
+struct LoadResult {
+    double requests_per_second{0.0};
+    double p99_ms{0.0};
+};
+
+// Drives /profiles/{id} from several client threads, either reusing one keep-alive connection
+// per thread or opening a fresh connection for every request.
+LoadResult RunProfileLoad(std::uint16_t port, int threads, int requests_per_thread,
+                          bool keep_alive) {
+    std::vector<std::vector<double>> latencies(static_cast<std::size_t>(threads));
+    std::vector<std::thread> clients;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        clients.emplace_back([&, t]() {
+            auto& samples = latencies[static_cast<std::size_t>(t)];
+            samples.reserve(static_cast<std::size_t>(requests_per_thread));
+            boost::asio::io_context client_io;
+            boost::asio::ip::tcp::resolver resolver(client_io);
+            const auto endpoints = resolver.resolve("127.0.0.1", std::to_string(port));
+            boost::beast::flat_buffer buffer;
+            std::unique_ptr<boost::beast::tcp_stream> stream;
+            for (int i = 0; i < requests_per_thread; ++i) {
+                const auto request_start = std::chrono::steady_clock::now();
+                if (!stream) {
+                    stream = std::make_unique<boost::beast::tcp_stream>(client_io);
+                    stream->connect(endpoints);
+                    buffer.clear();
+                }
+                const int player = (t * 97 + i) % 1000;
+                auto request = MakeRequest("/profiles/player-" + std::to_string(player));
+                request.keep_alive(keep_alive);
+                http::write(*stream, request);
+                http::response<http::string_body> response;
+                http::read(*stream, buffer, response);
+                if (response.result() != http::status::ok) {
+                    ADD_FAILURE() << "unexpected status " << response.result_int();
+                    return;
+                }
+                if (!response.keep_alive()) {
+                    boost::system::error_code ec;
+                    stream->socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+                    stream.reset();
+                }
+                samples.push_back(std::chrono::duration<double, std::milli>(
+                                      std::chrono::steady_clock::now() - request_start)
+                                      .count());
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    LoadResult result;
+    if (all.empty()) {
+        return result;
+    }
+    std::sort(all.begin(), all.end());
+    result.requests_per_second = static_cast<double>(all.size()) / seconds;
+    result.p99_ms = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    return result;
+}
+}  // namespace
+
+TEST(ProfileHttpPerformanceTest, CachedLeaderboardRouteThroughput) {
+    auto service = MakePopulatedService(1000);
+    arena60::ProfileHttpRouter router(nullptr, service);
+    const auto request = MakeRequest("/leaderboard?limit=50");
+
+    constexpr int kIterations = 2000;
+    const auto uncached_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        auto body = service->SerializeLeaderboard(service->TopProfiles(50));
+        ASSERT_FALSE(body.empty());
+    }
+    const double uncached_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - uncached_start).count();
+
+    const auto cached_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        auto response = router.Handle(request);
+        ASSERT_EQ(http::status::ok, response.result());
+    }
+    const double cached_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - cached_start).count();
+
+    std::cout << "leaderboard limit=50: render " << kIterations / uncached_seconds
+              << " req/s, cached route " << kIterations / cached_seconds << " req/s" << std::endl;
+    EXPECT_LT(cached_seconds, uncached_seconds);
+}
+
+TEST(ProfileHttpPerformanceTest, ServesProfileRoutesOverLoopback) {
+    auto service = MakePopulatedService(1000);
+    auto router = std::make_shared<arena60::ProfileHttpRouter>(nullptr, service);
+    boost::asio::io_context io_context;
+    arena60::MetricsHttpServer::RequestHandler handler =
+        [router](const http::request<http::string_body>& request) {
+            return router->Handle(request);
+        };
+    auto server = std::make_shared<arena60::MetricsHttpServer>(io_context, 0, handler);
+    server->Start();
+    std::thread server_thread([&]() { io_context.run(); });
+    const auto port = server->Port();
+    ASSERT_NE(port, 0);
+
+    constexpr int kRequests = 500;
+    boost::asio::io_context client_io;
+    boost::asio::ip::tcp::resolver resolver(client_io);
+    const auto endpoints = resolver.resolve("127.0.0.1", std::to_string(port));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRequests; ++i) {
+        const std::string target = (i % 2 == 0)
+                                       ? "/leaderboard?limit=50"
+                                       : "/profiles/player-" + std::to_string(i % 1000);
+        boost::beast::tcp_stream stream(client_io);
+        stream.connect(endpoints);
+        http::write(stream, MakeRequest(target));
+        boost::beast::flat_buffer buffer;
+        http::response<http::string_body> response;
+        http::read(stream, buffer, response);
+        ASSERT_EQ(http::status::ok, response.result());
+        boost::system::error_code ec;
+        stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "profile routes over loopback: " << kRequests / seconds << " req/s" << std::endl;
+
+    server->Stop();
+    io_context.stop();
+    server_thread.join();
+    EXPECT_GT(kRequests / seconds, 200.0);
+}
+
+TEST(ProfileHttpPerformanceTest, KeepAliveLowersProfileLookupTailLatency) {
+    auto service = MakePopulatedService(1000);
+    auto router = std::make_shared<arena60::ProfileHttpRouter>(nullptr, service);
+    boost::asio::io_context io_context;
+    arena60::MetricsHttpServer::RequestHandler handler =
+        [router](const http::request<http::string_body>& request) {
+            return router->Handle(request);
+        };
+    arena60::HttpConnectionLimits limits;
+    limits.max_requests_per_connection = 10000;
+    auto server = std::make_shared<arena60::MetricsHttpServer>(io_context, 0, handler, limits);
+    server->Start();
+    std::thread server_thread([&]() { io_context.run(); });
+    const auto port = server->Port();
+    ASSERT_NE(port, 0);
+
+    constexpr int kThreads = 4;
+    constexpr int kRequestsPerThread = 2500;
+    const auto per_request = RunProfileLoad(port, kThreads, kRequestsPerThread, false);
+    const auto accepted_before = server->ConnectionsAccepted();
+    const auto keep_alive = RunProfileLoad(port, kThreads, kRequestsPerThread, true);
+    const auto keep_alive_connections = server->ConnectionsAccepted() - accepted_before;
+
+    std::cout << "/profiles/{id} connection-per-request: " << per_request.requests_per_second
+              << " req/s p99=" << per_request.p99_ms << " ms" << std::endl;
+    std::cout << "/profiles/{id} keep-alive: " << keep_alive.requests_per_second
+              << " req/s p99=" << keep_alive.p99_ms << " ms" << std::endl;
+
+    server->Stop();
+    io_context.stop();
+    server_thread.join();
+
+    EXPECT_EQ(static_cast<std::uint64_t>(kThreads), keep_alive_connections);
+    EXPECT_GT(keep_alive.requests_per_second, per_request.requests_per_second);
+    EXPECT_LT(keep_alive.p99_ms, 10.0);
+}
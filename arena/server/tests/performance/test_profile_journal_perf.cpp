@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/stats/player_profile_service.h"
+#include "arena60/stats/profile_journal.h"
+
+namespace {
+using namespace std::chrono_literals;
+
+class TempDirectory {
+   public:
+    TempDirectory() {
+        std::string pattern =
+            (std::filesystem::temp_directory_path() / "arena60-journal-perf-XXXXXX").string();
+        path_ = ::mkdtemp(pattern.data());
+    }
+    ~TempDirectory() { std::filesystem::remove_all(path_); }
+
+    const std::string& path() const { return path_; }
+
+   private:
+    std::string path_;
+};
+
+arena60::MatchResult MakeMatch(int index, int players) {
+    const std::string id = "match-" + std::to_string(index);
+    const std::string winner = "player-" + std::to_string(index % players);
+    const std::string loser = "player-" + std::to_string((index * 7 + 1) % players);
+    std::vector<arena60::PlayerMatchStats> stats{
+        arena60::PlayerMatchStats{id, winner, 12, 7, 1, 0, 140, 40},
+        arena60::PlayerMatchStats{id, loser, 10, 3, 0, 1, 40, 140},
+    };
+    return arena60::MatchResult{id, winner, loser, std::chrono::system_clock::now(), stats};
+}
+}  // namespace
+
+TEST(ProfileJournalPerformanceTest, RecoversOneMillionProfilesQuickly) {
+    constexpr int kProfiles = 1'000'000;
+    constexpr int kWalMatches = 20'000;
+    TempDirectory dir;
+    {
+        auto service = std::make_shared<arena60::PlayerProfileService>(
+            std::make_shared<arena60::InMemoryLeaderboardStore>());
+        auto journal = std::make_shared<arena60::ProfileJournal>(dir.path());
+        ASSERT_TRUE(journal->Recover(*service));
+        arena60::PlayerProfile profile;
+        for (int i = 0; i < kProfiles; ++i) {
+            profile.player_id = "player-" + std::to_string(i);
+            profile.rating = 1000 + i % 800;
+            profile.matches = 40 + i % 100;
+            profile.wins = profile.matches / 2;
+            profile.losses = profile.matches - profile.wins;
+            profile.kills = profile.wins * 3;
+            profile.deaths = profile.losses * 2;
+            profile.shots_fired = profile.matches * 25;
+            profile.hits_landed = profile.matches * 11;
+            profile.damage_dealt = profile.hits_landed * 20;
+            profile.damage_taken = profile.deaths * 100;
+            service->RestoreProfile(profile);
+        }
+        ASSERT_TRUE(journal->Start(service));
+        service->SetChangeSink(journal);
+        ASSERT_TRUE(journal->Checkpoint());
+        for (int i = 0; i < kWalMatches; ++i) {
+            service->RecordMatch(MakeMatch(i, kProfiles));
+        }
+        journal->Stop();
+    }
+    const auto snapshot_bytes = std::filesystem::file_size(dir.path() + "/profiles.snapshot");
+    const auto wal_bytes = std::filesystem::file_size(dir.path() + "/profiles.wal");
+
+    auto service = std::make_shared<arena60::PlayerProfileService>(
+        std::make_shared<arena60::InMemoryLeaderboardStore>());
+    arena60::ProfileJournal journal(dir.path());
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(journal.Recover(*service));
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "profile journal: recovered " << kProfiles << " profiles (" << snapshot_bytes
+              << " B snapshot) + " << kWalMatches << " WAL matches (" << wal_bytes << " B) in "
+              << seconds << " s" << std::endl;
+
+    EXPECT_EQ(static_cast<std::uint64_t>(kProfiles + 2 * kWalMatches), journal.RecordsRecovered());
+    EXPECT_LT(snapshot_bytes / kProfiles, 40u);
+    ASSERT_TRUE(service->GetProfile("player-999999").has_value());
+    EXPECT_LT(seconds, 10.0);
+}
+
+TEST(ProfileJournalPerformanceTest, GroupCommitKeepsWriteAmplificationLow) {
+    constexpr int kThreads = 4;
+    constexpr int kMatchesPerThread = 25'000;
+    constexpr int kPlayers = 20'000;
+    TempDirectory dir;
+    auto service = std::make_shared<arena60::PlayerProfileService>(
+        std::make_shared<arena60::InMemoryLeaderboardStore>());
+    arena60::ProfileJournalOptions options;
+    options.fsync_interval = 20ms;
+    options.checkpoint_wal_bytes = 2 * 1024 * 1024;
+    auto journal = std::make_shared<arena60::ProfileJournal>(dir.path(), options);
+    ASSERT_TRUE(journal->Recover(*service));
+    ASSERT_TRUE(journal->Start(service));
+    service->SetChangeSink(journal);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kMatchesPerThread; ++i) {
+                service->RecordMatch(MakeMatch(t * kMatchesPerThread + i, kPlayers));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    journal->Stop();
+
+    constexpr int kMatches = kThreads * kMatchesPerThread;
+    const double physical =
+        static_cast<double>(journal->WalBytesWritten() + journal->SnapshotBytesWritten());
+    const double amplification = physical / static_cast<double>(journal->LogicalBytes());
+    const double fsyncs_per_match =
+        static_cast<double>(journal->FsyncsTotal()) / static_cast<double>(kMatches);
+    std::cout << "profile journal: " << kMatches / seconds << " matches/s, write amplification "
+              << amplification << " (" << journal->CheckpointsTotal() << " checkpoints), "
+              << fsyncs_per_match << " fsyncs/match" << std::endl;
+
+    EXPECT_GT(journal->CheckpointsTotal(), 0u);
+    // Frame headers plus periodic snapshots of the working set; a per-match rewrite of the full
+    // profile table would be orders of magnitude higher.
+    EXPECT_LT(amplification, 3.0);
+    EXPECT_LT(fsyncs_per_match, 0.05);
+}
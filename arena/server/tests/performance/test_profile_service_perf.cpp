@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
+#include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "arena60/stats/leaderboard_store.h"
@@ -29,3 +32,139 @@ TEST(PlayerProfileServicePerformanceTest, RecordsHundredMatchesUnderBudget) {
         std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count();
     EXPECT_LE(elapsed_ms, 5);
 }
+
+TEST(PlayerProfileServicePerformanceTest, MixedReadWriteWithSixteenThreads) {
+    auto leaderboard = std::make_shared<arena60::InMemoryLeaderboardStore>();
+    arena60::PlayerProfileService service(leaderboard);
+
+    constexpr int kWriterThreads = 12;
+    constexpr int kReaderThreads = 4;
+    constexpr int kMatchesPerWriter = 2000;
+    constexpr int kPlayers = 512;
+
+    const auto now = std::chrono::system_clock::now();
+    std::atomic<bool> writers_done{false};
+    std::atomic<std::uint64_t> reads{0};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(kWriterThreads + kReaderThreads);
+    for (int w = 0; w < kWriterThreads; ++w) {
+        threads.emplace_back([&, w]() {
+            for (int i = 0; i < kMatchesPerWriter; ++i) {
+                const int a = (w * 31 + i * 7) % kPlayers;
+                const int b = (a + 1 + (i % (kPlayers - 1))) % kPlayers;
+                const std::string winner = "player-" + std::to_string(a);
+                const std::string loser = "player-" + std::to_string(b);
+                const std::string match_id =
+                    "match-" + std::to_string(w) + "-" + std::to_string(i);
+                std::vector<arena60::PlayerMatchStats> stats{
+                    arena60::PlayerMatchStats{match_id, winner, 5, 4, 1, 0, 80, 20},
+                    arena60::PlayerMatchStats{match_id, loser, 5, 1, 0, 1, 20, 80},
+                };
+                service.RecordMatch(arena60::MatchResult{match_id, winner, loser, now, stats});
+            }
+        });
+    }
+    for (int r = 0; r < kReaderThreads; ++r) {
+        threads.emplace_back([&, r]() {
+            std::uint64_t local = 0;
+            while (!writers_done.load(std::memory_order_acquire)) {
+                if (r % 2 == 0) {
+                    auto top = service.TopProfiles(100);
+                    EXPECT_LE(top.size(), 100u);
+                } else {
+                    service.GetProfile("player-" + std::to_string(local % kPlayers));
+                }
+                ++local;
+            }
+            reads.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+    for (int w = 0; w < kWriterThreads; ++w) {
+        threads[static_cast<std::size_t>(w)].join();
+    }
+    const auto writes_finish = std::chrono::steady_clock::now();
+    writers_done.store(true, std::memory_order_release);
+    for (std::size_t t = kWriterThreads; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    const double write_seconds = std::chrono::duration<double>(writes_finish - start).count();
+    const std::uint64_t total_matches =
+        static_cast<std::uint64_t>(kWriterThreads) * kMatchesPerWriter;
+    std::cout << "profile service mixed load: " << total_matches / write_seconds
+              << " matches/s, " << reads.load() << " reads during " << write_seconds << " s"
+              << std::endl;
+
+    std::uint64_t wins = 0;
+    std::uint64_t losses = 0;
+    for (int p = 0; p < kPlayers; ++p) {
+        auto profile = service.GetProfile("player-" + std::to_string(p));
+        if (profile) {
+            wins += profile->wins;
+            losses += profile->losses;
+        }
+    }
+    EXPECT_EQ(total_matches, wins);
+    EXPECT_EQ(total_matches, losses);
+    EXPECT_NE(service.MetricsSnapshot().find("matches_recorded_total " +
+                                             std::to_string(total_matches)),
+              std::string::npos);
+    EXPECT_LE(write_seconds, 2.0);
+}
+
+TEST(PlayerProfileServicePerformanceTest, BatchedRecordingSustainsHundredThousandMatchesPerSecond) {
+    constexpr int kMatches = 200'000;
+    constexpr int kPlayers = 10'000;
+    constexpr std::size_t kBatchSize = 256;
+
+    const auto now = std::chrono::system_clock::now();
+    std::vector<arena60::MatchResult> matches;
+    matches.reserve(kMatches);
+    for (int i = 0; i < kMatches; ++i) {
+        const std::string match_id = "match-" + std::to_string(i);
+        const std::string winner = "player-" + std::to_string((i * 13) % kPlayers);
+        const std::string loser = "player-" + std::to_string((i * 13 + 1 + i % 97) % kPlayers);
+        std::vector<arena60::PlayerMatchStats> stats{
+            arena60::PlayerMatchStats{match_id, winner, 8, 5, 1, 0, 100, 20},
+            arena60::PlayerMatchStats{match_id, loser, 7, 1, 0, 1, 20, 100},
+        };
+        matches.emplace_back(match_id, winner, loser, now, std::move(stats));
+    }
+    std::vector<std::vector<arena60::MatchResult>> batches;
+    for (std::size_t offset = 0; offset < matches.size(); offset += kBatchSize) {
+        const auto end = std::min(matches.size(), offset + kBatchSize);
+        batches.emplace_back(matches.begin() + static_cast<std::ptrdiff_t>(offset),
+                             matches.begin() + static_cast<std::ptrdiff_t>(end));
+    }
+
+    arena60::PlayerProfileService sequential(
+        std::make_shared<arena60::InMemoryLeaderboardStore>());
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& match : matches) {
+        sequential.RecordMatch(match);
+    }
+    const double sequential_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    arena60::PlayerProfileService batched(std::make_shared<arena60::InMemoryLeaderboardStore>());
+    start = std::chrono::steady_clock::now();
+    for (const auto& batch : batches) {
+        batched.RecordMatches(batch);
+    }
+    const double batched_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double sequential_rate = kMatches / sequential_seconds;
+    const double batched_rate = kMatches / batched_seconds;
+    std::cout << "profile service: RecordMatch " << sequential_rate << " matches/s, RecordMatches("
+              << kBatchSize << ") " << batched_rate << " matches/s" << std::endl;
+
+    const auto expected = sequential.GetProfile("player-42");
+    const auto actual = batched.GetProfile("player-42");
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(expected->rating, actual->rating);
+    EXPECT_GT(batched_rate, 100000.0);
+}
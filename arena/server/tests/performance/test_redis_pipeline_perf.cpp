@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "../support/resp_stub_server.h"
+#include "arena60/matchmaking/match_queue.h"
+#include "arena60/matchmaking/matchmaker.h"
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/storage/redis_client.h"
+
+namespace {
+using namespace std::chrono;
+using arena60::test_support::RespStubServer;
+
+constexpr int kOperations = 5000;
+}  // namespace
+
+TEST(RedisPipelinePerformanceTest, PipelinedLeaderboardWritesOutrunRoundTrips) {
+    RespStubServer server;
+    arena60::RedisClientOptions options;
+    options.port = server.port();
+    auto client = std::make_shared<arena60::RedisClient>(options);
+    ASSERT_TRUE(client->Connect());
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < kOperations; ++i) {
+        client->ExecuteOne({"ZADD", "sync", std::to_string(i), "p" + std::to_string(i)});
+    }
+    const double sync_seconds = duration<double>(steady_clock::now() - start).count();
+
+    arena60::RedisLeaderboardStore store(client, "pipelined");
+    start = steady_clock::now();
+    for (int i = 0; i < kOperations; ++i) {
+        store.Upsert("p" + std::to_string(i), i);
+    }
+    // The read queues behind every write on the same connection, so it returns once all landed.
+    const auto size = client->ExecuteOne({"ZCARD", "pipelined"});
+    ASSERT_TRUE(size.has_value());
+    EXPECT_EQ(kOperations, size->integer);
+    const double pipelined_seconds = duration<double>(steady_clock::now() - start).count();
+
+    const double sync_rate = kOperations / sync_seconds;
+    const double pipelined_rate = kOperations / pipelined_seconds;
+    std::cout << "redis ZADD: " << sync_rate << " ops/s with a round trip each vs "
+              << pipelined_rate << " ops/s pipelined (" << client->WritesTotal()
+              << " socket writes for " << client->PipelinesTotal() << " pipelines)" << std::endl;
+    EXPECT_GT(pipelined_rate, sync_rate * 1.5);
+}
+
+TEST(RedisPipelinePerformanceTest, ThousandPlayerMatchingPassIsTwoRoundTrips) {
+    RespStubServer server;
+    arena60::RedisClientOptions options;
+    options.port = server.port();
+    auto client = std::make_shared<arena60::RedisClient>(options);
+    ASSERT_TRUE(client->Connect());
+
+    std::ostringstream sink;
+    auto* const original = std::cout.rdbuf(sink.rdbuf());
+    auto queue = std::make_shared<arena60::RedisMatchQueue>(client);
+    arena60::Matchmaker matchmaker(queue);
+    const auto base = steady_clock::now() - seconds(30);
+    for (int i = 0; i < 1000; ++i) {
+        const int elo = 1000 + (i % 200) * 5;
+        matchmaker.Enqueue(
+            arena60::MatchRequest{"perf" + std::to_string(i), elo, base + milliseconds(i)});
+    }
+
+    const auto pipelines_before = client->PipelinesTotal();
+    const auto start = steady_clock::now();
+    const auto matches = matchmaker.RunMatching(base + seconds(40));
+    const auto elapsed_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+    std::cout.rdbuf(original);
+
+    const auto round_trips = client->PipelinesTotal() - pipelines_before;
+    std::cout << "redis matching pass: " << matches.size() << " matches from 1000 players in "
+              << elapsed_us << " us over " << round_trips << " round trips" << std::endl;
+    EXPECT_EQ(500u, matches.size());
+    EXPECT_EQ(2u, round_trips);
+    EXPECT_EQ(0u, queue->Size());
+}
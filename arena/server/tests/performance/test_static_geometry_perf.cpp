@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arena60/game/game_session.h"
+#include "arena60/game/static_geometry.h"
+
+namespace {
+using namespace std::chrono;
+
+constexpr int kShapes = 10000;
+constexpr int kProjectiles = 2000;
+constexpr double kMapHalfExtent = 500.0;
+constexpr double kDelta = 1.0 / 60.0;
+
+// Crates of 0.5-4 m scattered over a 1 km square, keeping the shooters' lane at x = 0 clear.
+std::vector<arena60::Aabb> ScatterShapes(std::mt19937& rng) {
+    std::uniform_real_distribution<double> position(-kMapHalfExtent, kMapHalfExtent);
+    std::uniform_real_distribution<double> extent(0.5, 4.0);
+    std::vector<arena60::Aabb> boxes;
+    boxes.reserve(kShapes);
+    while (boxes.size() < static_cast<std::size_t>(kShapes)) {
+        const double x = position(rng);
+        const double y = position(rng);
+        if (std::abs(x) < 5.0 && std::abs(y) < 110.0) {
+            continue;
+        }
+        boxes.push_back({x, y, x + extent(rng), y + extent(rng)});
+    }
+    return boxes;
+}
+
+bool BruteForceHit(const std::vector<arena60::Aabb>& boxes, double x, double y, double dx,
+                   double dy, double radius) {
+    for (const auto& box : boxes) {
+        double enter = 0.0;
+        double exit = 1.0;
+        const double origin[2] = {x, y};
+        const double delta[2] = {dx, dy};
+        const double lo[2] = {box.min_x - radius, box.min_y - radius};
+        const double hi[2] = {box.max_x + radius, box.max_y + radius};
+        if (x > lo[0] && x < hi[0] && y > lo[1] && y < hi[1]) {
+            continue;  // SweepCircle ignores boxes it starts inside
+        }
+        for (int axis = 0; axis < 2 && enter <= exit; ++axis) {
+            if (delta[axis] == 0.0) {
+                if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) {
+                    exit = -1.0;
+                }
+                continue;
+            }
+            double t0 = (lo[axis] - origin[axis]) / delta[axis];
+            double t1 = (hi[axis] - origin[axis]) / delta[axis];
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            enter = std::max(enter, t0);
+            exit = std::min(exit, t1);
+        }
+        if (enter <= exit) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+TEST(StaticGeometryPerformanceTest, TwoThousandProjectileSweepsAgainstTenThousandShapes) {
+    std::mt19937 rng(2000);
+    const auto boxes = ScatterShapes(rng);
+    const auto build_start = steady_clock::now();
+    const arena60::StaticGeometry geometry(boxes);
+    const auto build_us = duration_cast<microseconds>(steady_clock::now() - build_start).count();
+
+    // One tick of projectile motion: 0.5 m steps at 30 m/s and 60 Hz.
+    std::uniform_real_distribution<double> position(-kMapHalfExtent, kMapHalfExtent);
+    std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+    struct Sweep {
+        double x, y, dx, dy;
+    };
+    std::vector<Sweep> sweeps;
+    for (int i = 0; i < kProjectiles; ++i) {
+        const double a = angle(rng);
+        sweeps.push_back({position(rng), position(rng), 0.5 * std::cos(a), 0.5 * std::sin(a)});
+    }
+
+    constexpr int kTicks = 200;
+    std::vector<double> tick_us;
+    std::size_t hits = 0;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        const auto start = steady_clock::now();
+        for (const auto& sweep : sweeps) {
+            hits += geometry.SweepCircle(sweep.x, sweep.y, sweep.dx, sweep.dy, 0.2).hit ? 1 : 0;
+        }
+        tick_us.push_back(duration<double, std::micro>(steady_clock::now() - start).count());
+    }
+    std::sort(tick_us.begin(), tick_us.end());
+
+    constexpr int kBruteTicks = 3;
+    std::size_t brute_hits = 0;
+    const auto brute_start = steady_clock::now();
+    for (int tick = 0; tick < kBruteTicks; ++tick) {
+        for (const auto& sweep : sweeps) {
+            brute_hits += BruteForceHit(boxes, sweep.x, sweep.y, sweep.dx, sweep.dy, 0.2) ? 1 : 0;
+        }
+    }
+    const double brute_us =
+        duration<double, std::micro>(steady_clock::now() - brute_start).count() / kBruteTicks;
+
+    const double p50 = tick_us[tick_us.size() / 2];
+    const double p99 = tick_us[tick_us.size() * 99 / 100];
+    std::cout << "static geometry: " << kShapes << " shapes, " << geometry.node_count()
+              << " BVH nodes built in " << build_us << " us; " << kProjectiles
+              << " sweeps/tick p50 " << p50 << " us p99 " << p99 << " us vs brute force "
+              << brute_us << " us" << std::endl;
+
+    EXPECT_EQ(hits / kTicks, brute_hits / kBruteTicks);
+    EXPECT_LT(p50, 2000.0);  // an eighth of a 60 Hz tick
+    EXPECT_LT(p50 * 10.0, brute_us);
+}
+
+TEST(StaticGeometryPerformanceTest, SessionTickWithTwoThousandProjectilesAmongTenThousandShapes) {
+    std::ostringstream sink;
+    auto* const original = std::cout.rdbuf(sink.rdbuf());
+
+    std::mt19937 rng(2000);
+    auto geometry = std::make_shared<arena60::StaticGeometry>(ScatterShapes(rng));
+    arena60::GameSession open_plane(60.0);
+    arena60::GameSession walled(60.0);
+    walled.SetStaticGeometry(geometry);
+
+    // 200 shooters 1 m apart along y, far enough that shots miss their neighbours, try to fire
+    // every tick; the cooldown lets each through every sixth, which keeps ~2000 projectiles in
+    // flight toward +x and -x on the open plane.
+    constexpr int kShooters = 200;
+    auto run = [](arena60::GameSession& session) {
+        for (int i = 0; i < kShooters; ++i) {
+            const std::string id = "shooter-" + std::to_string(i);
+            session.UpsertPlayer(id);
+            arena60::MovementInput move{};
+            move.sequence = 1;
+            move.down = true;
+            move.mouse_x = 1.0;
+            session.ApplyInput(id, move, (1.0 * (i - kShooters / 2)) / 5.0);
+        }
+        std::vector<double> durations;
+        std::uint64_t sequence = 1;
+        for (int tick = 0; tick < 240; ++tick) {
+            ++sequence;
+            for (int i = 0; i < kShooters; ++i) {
+                arena60::MovementInput fire{};
+                fire.sequence = sequence;
+                fire.fire = true;
+                fire.mouse_x = i % 2 == 0 ? 1.0 : -1.0;
+                session.ApplyInput("shooter-" + std::to_string(i), fire, kDelta);
+            }
+            const auto start = steady_clock::now();
+            session.Tick(static_cast<std::uint64_t>(tick), kDelta);
+            if (tick >= 120) {
+                durations.push_back(
+                    duration<double, std::micro>(steady_clock::now() - start).count());
+            }
+        }
+        std::sort(durations.begin(), durations.end());
+        return durations[durations.size() / 2];
+    };
+    const double open_us = run(open_plane);
+    const std::size_t open_projectiles = open_plane.ActiveProjectileCount();
+    const double walled_us = run(walled);
+    const std::size_t walled_projectiles = walled.ActiveProjectileCount();
+    sink.str({});
+    std::cout.rdbuf(original);
+
+    std::cout << "session tick p50: " << open_us << " us on an open plane (" << open_projectiles
+              << " projectiles in flight) vs " << walled_us << " us with " << kShapes
+              << " shapes (" << walled_projectiles << " in flight)" << std::endl;
+    EXPECT_GE(open_projectiles, static_cast<std::size_t>(kProjectiles));
+    EXPECT_LT(walled_us, open_us + 2000.0);
+}
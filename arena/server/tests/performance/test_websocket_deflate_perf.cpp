@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arena60/network/websocket_server.h"
+
+namespace {
+using namespace std::chrono;
+namespace zlib = boost::beast::zlib;
+
+constexpr int kTicks = 30;
+
+// One connection's compressor, driven the way Beast's permessage-deflate drives it: the message
+// is deflated, then a block flush and a full flush end it, and without context takeover the
+// stream is reset afterwards. The full flush clears the match hash, so even with context
+// takeover a message only finds matches within itself.
+class Connection {
+   public:
+    explicit Connection(const arena60::WebSocketCompression& settings) : settings_(settings) {
+        stream_.reset(settings.level, settings.window_bits, settings.mem_level,
+                      zlib::Strategy::normal);
+    }
+
+    std::size_t Compress(const std::string& message) {
+        zlib::z_params params;
+        params.next_in = message.data();
+        params.avail_in = message.size();
+        params.next_out = out_;
+        params.avail_out = sizeof(out_);
+        boost::system::error_code ec;
+        stream_.write(params, zlib::Flush::none, ec);
+        stream_.write(params, zlib::Flush::block, ec);
+        stream_.write(params, zlib::Flush::full, ec);
+        if (!settings_.context_takeover) {
+            stream_.reset();
+        }
+        // The trailing 00 00 ff ff of the flush is not sent.
+        return sizeof(out_) - params.avail_out - 4;
+    }
+
+   private:
+    arena60::WebSocketCompression settings_;
+    zlib::deflate_stream stream_;
+    char out_[512];
+};
+
+// State lines as WebSocketServer formats them, for a player wandering and firing.
+std::string StateLine(int player, int tick) {
+    const double t = tick / 60.0;
+    char line[160];
+    std::snprintf(line, sizeof(line), "state player-%d %g %g %g %d %g %d %d %d %d %d", player,
+                  10.0 * std::sin(0.3 * t + player), 8.0 * std::cos(0.2 * t + player),
+                  std::fmod(0.5 * t + player, 6.283185307179586), 1000 + tick, 1.0 / 60.0,
+                  100 - (tick / 30 + player) % 5 * 20, 1, tick / 6, tick / 40, player % 3);
+    return line;
+}
+
+struct Result {
+    double ratio;
+    double tick_us;
+};
+
+Result Measure(const arena60::WebSocketCompression& settings, int players) {
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (int i = 0; i < players; ++i) {
+        connections.push_back(std::make_unique<Connection>(settings));
+    }
+    std::size_t raw = 0;
+    std::size_t compressed = 0;
+    std::vector<double> tick_us;
+    for (int tick = 0; tick < kTicks; ++tick) {
+        std::vector<std::string> lines;
+        lines.reserve(players);
+        for (int i = 0; i < players; ++i) {
+            lines.push_back(StateLine(i, tick));
+        }
+        const auto start = steady_clock::now();
+        for (int i = 0; i < players; ++i) {
+            compressed += connections[i]->Compress(lines[i]);
+            raw += lines[i].size();
+        }
+        tick_us.push_back(duration<double, std::micro>(steady_clock::now() - start).count());
+    }
+    std::sort(tick_us.begin(), tick_us.end());
+    return Result{static_cast<double>(compressed) / static_cast<double>(raw),
+                  tick_us[tick_us.size() / 2]};
+}
+
+}  // namespace
+
+// Sweeps window and hash sizes at several player counts, printing ratio and compression time per
+// tick, and checks the settings ForPlayers picks against the widest ones.
+TEST(WebSocketDeflatePerformanceTest, PicksSettingsByPlayerCount) {
+    arena60::WebSocketCompression widest;
+    widest.enabled = true;
+    widest.window_bits = 15;
+    widest.mem_level = 8;
+    widest.context_takeover = true;
+    constexpr double kTickBudgetUs = 1e6 / 60.0 / 4.0;  // a quarter of a 60 Hz tick
+
+    for (int players : {16, 256, 1000}) {
+        for (int bits : {9, 15}) {
+            for (int mem : {1, 2, 8}) {
+                arena60::WebSocketCompression settings = widest;
+                settings.window_bits = bits;
+                settings.mem_level = mem;
+                const auto result = Measure(settings, players);
+                std::cout << players << " players, window " << bits << " mem " << mem
+                          << ": ratio " << result.ratio << ", " << result.tick_us
+                          << " us per tick" << std::endl;
+            }
+        }
+        const auto widest_result = Measure(widest, players);
+        const auto picked = arena60::WebSocketCompression::ForPlayers(players);
+        arena60::WebSocketCompression compact = arena60::WebSocketCompression::ForPlayers(1);
+        const auto compact_result = Measure(compact, players);
+        compact.context_takeover = true;
+        const auto takeover_result = Measure(compact, players);
+        std::cout << players << " players: compression "
+                  << (picked.enabled ? "on" : "off") << "; window " << compact.window_bits
+                  << " mem " << compact.mem_level << " ratio " << compact_result.ratio << ", "
+                  << compact_result.tick_us << " us per tick (widest " << widest_result.ratio
+                  << ", " << widest_result.tick_us << " us; with context takeover "
+                  << takeover_result.ratio << ")" << std::endl;
+
+        EXPECT_LT(compact_result.ratio, 1.0);
+        EXPECT_LT(compact_result.ratio, widest_result.ratio + 0.01);
+        // Each message ends in a full flush, so carrying the window over buys nothing.
+        EXPECT_NEAR(takeover_result.ratio, compact_result.ratio, 0.01);
+        if (picked.enabled) {
+            EXPECT_LT(compact_result.tick_us, kTickBudgetUs);
+        }
+    }
+    EXPECT_TRUE(arena60::WebSocketCompression::ForPlayers(256).enabled);
+    EXPECT_FALSE(arena60::WebSocketCompression::ForPlayers(1000).enabled);
+    EXPECT_FALSE(arena60::WebSocketCompression::ForPlayers(0).enabled);
+}
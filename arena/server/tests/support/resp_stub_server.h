@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "arena60/matchmaking/match_queue.h"
+#include "arena60/storage/redis_client.h"
+
+namespace arena60::test_support {
+
+// In-process stand-in for the handful of Redis commands the server uses, so the RESP client and
+// the Redis-backed queue and leaderboard can be tested without a redis-server binary. EVAL and
+// EVALSHA only understand RedisMatchQueue's own scripts, matched by text; SCRIPT LOAD hands out
+// made-up digests rather than SHA1s.
+class RespStubServer {
+   public:
+    RespStubServer() : acceptor_(io_context_, {boost::asio::ip::tcp::v4(), 0}) {
+        DoAccept();
+        thread_ = std::thread([this]() { io_context_.run(); });
+    }
+
+    ~RespStubServer() {
+        io_context_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    std::uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+    std::uint64_t commands() const { return commands_.load(); }
+    std::uint64_t connections() const { return connections_.load(); }
+
+    std::uint64_t evals() const { return evals_.load(); }
+
+    // Forgets loaded scripts, as SCRIPT FLUSH or a Redis restart would.
+    void FlushScripts() {
+        boost::asio::post(io_context_, [this]() { scripts_.clear(); });
+    }
+
+    // Closes every accepted connection, as a Redis restart would.
+    void DropConnections() {
+        boost::asio::post(io_context_, [this]() {
+            for (auto& weak : sessions_) {
+                if (auto session = weak.lock()) {
+                    boost::system::error_code ec;
+                    session->socket.close(ec);
+                }
+            }
+            sessions_.clear();
+        });
+    }
+
+   private:
+    struct Session {
+        explicit Session(boost::asio::io_context& io) : socket(io) {}
+        boost::asio::ip::tcp::socket socket;
+        std::array<char, 16384> buffer{};
+        RespParser parser;
+        std::string out;
+        bool writing{false};
+    };
+
+    using ZSet = std::map<std::string, double>;
+    using Hash = std::map<std::string, std::string>;
+
+    void DoAccept() {
+        auto session = std::make_shared<Session>(io_context_);
+        acceptor_.async_accept(session->socket, [this, session](boost::system::error_code ec) {
+            if (ec) {
+                return;
+            }
+            connections_.fetch_add(1);
+            sessions_.push_back(session);
+            DoRead(session);
+            DoAccept();
+        });
+    }
+
+    void DoRead(const std::shared_ptr<Session>& session) {
+        session->socket.async_read_some(
+            boost::asio::buffer(session->buffer),
+            [this, session](boost::system::error_code ec, std::size_t bytes) {
+                if (ec) {
+                    return;
+                }
+                session->parser.Feed(session->buffer.data(), bytes);
+                RedisReply request;
+                while (session->parser.Next(request) == RespParser::Result::kReply) {
+                    std::vector<std::string> args;
+                    for (const auto& element : request.elements) {
+                        args.push_back(element.str);
+                    }
+                    commands_.fetch_add(1);
+                    Handle(args, session->out);
+                    request = RedisReply{};
+                }
+                DoWrite(session);
+                DoRead(session);
+            });
+    }
+
+    void DoWrite(const std::shared_ptr<Session>& session) {
+        if (session->writing || session->out.empty()) {
+            return;
+        }
+        session->writing = true;
+        auto data = std::make_shared<std::string>(std::move(session->out));
+        session->out.clear();
+        boost::asio::async_write(session->socket, boost::asio::buffer(*data),
+                                 [this, session, data](boost::system::error_code ec, std::size_t) {
+                                     session->writing = false;
+                                     if (!ec) {
+                                         DoWrite(session);
+                                     }
+                                 });
+    }
+
+    static void Integer(std::string& out, std::int64_t value) {
+        out += ":" + std::to_string(value) + "\r\n";
+    }
+    static void Bulk(std::string& out, const std::string& value) {
+        out += "$" + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    }
+    static void Nil(std::string& out) { out += "$-1\r\n"; }
+    static void ArrayHeader(std::string& out, std::size_t size) {
+        out += "*" + std::to_string(size) + "\r\n";
+    }
+    static std::string Score(double score) {
+        std::string text = std::to_string(score);
+        text.erase(text.find_last_not_of('0') + 1);
+        if (!text.empty() && text.back() == '.') {
+            text.pop_back();
+        }
+        return text;
+    }
+
+    std::vector<std::string> Ordered(const std::string& key) const {
+        std::vector<std::pair<double, std::string>> entries;
+        const auto it = zsets_.find(key);
+        if (it != zsets_.end()) {
+            for (const auto& [member, score] : it->second) {
+                entries.emplace_back(score, member);
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        std::vector<std::string> members;
+        for (auto& entry : entries) {
+            members.push_back(std::move(entry.second));
+        }
+        return members;
+    }
+
+    void Handle(const std::vector<std::string>& args, std::string& out) {
+        if (args.empty()) {
+            out += "-ERR empty command\r\n";
+            return;
+        }
+        const auto& name = args[0];
+        if (name == "PING") {
+            out += "+PONG\r\n";
+        } else if (name == "FLUSHALL") {
+            zsets_.clear();
+            hashes_.clear();
+            out += "+OK\r\n";
+        } else if (name == "ZADD") {
+            auto& zset = zsets_[args[1]];
+            std::int64_t added = 0;
+            for (std::size_t i = 2; i + 1 < args.size(); i += 2) {
+                added += zset.count(args[i + 1]) == 0 ? 1 : 0;
+                zset[args[i + 1]] = std::stod(args[i]);
+            }
+            Integer(out, added);
+        } else if (name == "ZREM") {
+            auto& zset = zsets_[args[1]];
+            std::int64_t removed = 0;
+            for (std::size_t i = 2; i < args.size(); ++i) {
+                removed += static_cast<std::int64_t>(zset.erase(args[i]));
+            }
+            Integer(out, removed);
+        } else if (name == "ZSCORE") {
+            const auto& zset = zsets_[args[1]];
+            const auto it = zset.find(args[2]);
+            if (it == zset.end()) {
+                Nil(out);
+            } else {
+                Bulk(out, Score(it->second));
+            }
+        } else if (name == "ZCARD") {
+            Integer(out, static_cast<std::int64_t>(zsets_[args[1]].size()));
+        } else if (name == "ZRANGE" || name == "ZREVRANGE") {
+            auto members = Ordered(args[1]);
+            if (name == "ZREVRANGE") {
+                std::reverse(members.begin(), members.end());
+            }
+            const auto size = static_cast<long>(members.size());
+            long start = std::stol(args[2]);
+            long stop = std::stol(args[3]);
+            start = start < 0 ? std::max(0L, size + start) : start;
+            stop = stop < 0 ? size + stop : std::min(stop, size - 1);
+            const bool with_scores = args.size() > 4 && args[4] == "WITHSCORES";
+            if (start > stop) {
+                ArrayHeader(out, 0);
+                return;
+            }
+            const auto count = static_cast<std::size_t>(stop - start + 1);
+            ArrayHeader(out, with_scores ? count * 2 : count);
+            for (long i = start; i <= stop; ++i) {
+                const auto& member = members[static_cast<std::size_t>(i)];
+                Bulk(out, member);
+                if (with_scores) {
+                    Bulk(out, Score(zsets_[args[1]][member]));
+                }
+            }
+        } else if (name == "HSET") {
+            auto& hash = hashes_[args[1]];
+            std::int64_t added = 0;
+            for (std::size_t i = 2; i + 1 < args.size(); i += 2) {
+                added += hash.count(args[i]) == 0 ? 1 : 0;
+                hash[args[i]] = args[i + 1];
+            }
+            Integer(out, added);
+        } else if (name == "HDEL") {
+            auto& hash = hashes_[args[1]];
+            std::int64_t removed = 0;
+            for (std::size_t i = 2; i < args.size(); ++i) {
+                removed += static_cast<std::int64_t>(hash.erase(args[i]));
+            }
+            Integer(out, removed);
+        } else if (name == "SCRIPT" && args.size() == 3 && args[1] == "LOAD") {
+            const std::string digest = "stub-" + std::to_string(std::hash<std::string>{}(args[2]));
+            scripts_[digest] = args[2];
+            Bulk(out, digest);
+        } else if (name == "EVAL") {
+            evals_.fetch_add(1);
+            Eval(args[1], args, out);
+        } else if (name == "EVALSHA") {
+            const auto it = scripts_.find(args[1]);
+            if (it == scripts_.end()) {
+                out += "-NOSCRIPT No matching script. Please use EVAL.\r\n";
+            } else {
+                Eval(it->second, args, out);
+            }
+        } else {
+            out += "-ERR unknown command '" + name + "'\r\n";
+        }
+    }
+
+    void Eval(const std::string& script, const std::vector<std::string>& args, std::string& out) {
+        const auto& queue = args[3];
+        const auto& requests = args[4];
+        if (script == RedisMatchQueue::kFetchScript) {
+            const auto ids = Ordered(queue);
+            const auto& hash = hashes_[requests];
+            ArrayHeader(out, 2);
+            ArrayHeader(out, ids.size());
+            for (const auto& id : ids) {
+                Bulk(out, id);
+            }
+            ArrayHeader(out, ids.size());
+            for (const auto& id : ids) {
+                const auto it = hash.find(id);
+                if (it == hash.end()) {
+                    Nil(out);
+                } else {
+                    Bulk(out, it->second);
+                }
+            }
+        } else if (script == RedisMatchQueue::kClaimPairsScript) {
+            auto& zset = zsets_[queue];
+            auto& hash = hashes_[requests];
+            ArrayHeader(out, (args.size() - 5) / 2);
+            for (std::size_t i = 5; i + 1 < args.size(); i += 2) {
+                const bool both = zset.count(args[i]) != 0 && zset.count(args[i + 1]) != 0;
+                if (both) {
+                    zset.erase(args[i]);
+                    zset.erase(args[i + 1]);
+                    hash.erase(args[i]);
+                    hash.erase(args[i + 1]);
+                }
+                Integer(out, both ? 1 : 0);
+            }
+        } else {
+            out += "-NOSCRIPT stub only runs RedisMatchQueue scripts\r\n";
+        }
+    }
+
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread thread_;
+    std::vector<std::weak_ptr<Session>> sessions_;
+    std::map<std::string, ZSet> zsets_;
+    std::map<std::string, Hash> hashes_;
+    std::map<std::string, std::string> scripts_;
+    std::atomic<std::uint64_t> commands_{0};
+    std::atomic<std::uint64_t> connections_{0};
+    std::atomic<std::uint64_t> evals_{0};
+};
+
+}  // namespace arena60::test_support
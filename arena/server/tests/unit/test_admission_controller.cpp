@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "arena60/network/admission_controller.h"
+
+using arena60::AdmissionController;
+using arena60::AdmissionDecision;
+using arena60::AdmissionOptions;
+using namespace std::chrono_literals;
+
+TEST(AdmissionControllerTest, RateLimitsHandshakesWithATokenBucket) {
+    AdmissionOptions options;
+    options.handshakes_per_second = 10.0;
+    options.handshake_burst = 3.0;
+    AdmissionController controller(options);
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(start));
+    }
+    EXPECT_EQ(AdmissionDecision::kRateLimited, controller.Admit(start + 50ms));
+    EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(start + 110ms));
+    EXPECT_EQ(AdmissionDecision::kRateLimited, controller.Admit(start + 120ms));
+    // The bucket refills to the burst size and no further.
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(start + 10s));
+    }
+    EXPECT_EQ(AdmissionDecision::kRateLimited, controller.Admit(start + 10s));
+    EXPECT_EQ(7u, controller.open_connections());
+}
+
+TEST(AdmissionControllerTest, ShedsAtCapacityAndWhileTicksRunLate) {
+    AdmissionOptions options;
+    options.max_connections = 2;
+    options.max_tick_lateness_seconds = 0.008;
+    AdmissionController controller(options);
+    const auto now = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(now));
+    controller.ObserveTickLateness(0.020);
+    EXPECT_EQ(AdmissionDecision::kTickLate, controller.Admit(now));
+    controller.ObserveTickLateness(0.001);
+    EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(now));
+    EXPECT_EQ(AdmissionDecision::kAtCapacity, controller.Admit(now));
+    controller.Release();
+    EXPECT_EQ(AdmissionDecision::kAdmit, controller.Admit(now));
+
+    arena60::MetricsRegistry registry;
+    controller.RegisterMetrics(registry);
+    const std::string text = registry.Serialize();
+    EXPECT_NE(std::string::npos, text.find("websocket_open_connections 2"));
+    EXPECT_NE(std::string::npos, text.find("websocket_rejected_total{reason=\"capacity\"} 1"));
+    EXPECT_NE(std::string::npos, text.find("websocket_rejected_total{reason=\"tick_late\"} 1"));
+}
@@ -32,7 +32,7 @@ void AdvanceUntilNoProjectiles(arena60::GameSession& session, std::uint64_t& tic
 }  // namespace
 
 TEST(GameCombatTest, ProjectileHitReducesHealth) {
-    arena60::GameSession session(60.0);
+    arena60::GameSession session(60.0, 32);
     session.UpsertPlayer("attacker");
     session.UpsertPlayer("defender");
 
@@ -52,7 +52,7 @@ TEST(GameCombatTest, ProjectileHitReducesHealth) {
 }
 
 TEST(GameCombatTest, DeathEventQueuedOnce) {
-    arena60::GameSession session(60.0);
+    arena60::GameSession session(60.0, 32);
     session.UpsertPlayer("attacker");
     session.UpsertPlayer("defender");
 
@@ -119,3 +119,31 @@ TEST(GameCombatTest, MetricsIncludeCollisionChecks) {
     EXPECT_TRUE(found);
     EXPECT_GE(value, 1u);
 }
+
+TEST(GameCombatTest, CombatLogIsDisabledByDefault) {
+    arena60::GameSession session(60.0);
+    session.UpsertPlayer("attacker");
+    session.UpsertPlayer("defender");
+    MoveTarget(session, "defender", 0.08);
+
+    std::uint64_t tick = 0;
+    Fire(session, "attacker", 1);
+    AdvanceUntilNoProjectiles(session, tick, 1.0 / 60.0);
+
+    EXPECT_EQ(80, session.GetPlayer("defender").health);
+    EXPECT_TRUE(session.CombatLogSnapshot().empty());
+}
+
+TEST(GameCombatTest, CombatLogKeepsMostRecentEventsInOrder) {
+    arena60::CombatLog log(3);
+    for (std::uint64_t tick = 1; tick <= 5; ++tick) {
+        arena60::CombatEvent event;
+        event.tick = tick;
+        log.Add(event);
+    }
+    const auto events = log.Snapshot();
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(3u, events[0].tick);
+    EXPECT_EQ(4u, events[1].tick);
+    EXPECT_EQ(5u, events[2].tick);
+}
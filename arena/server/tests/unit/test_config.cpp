@@ -33,11 +33,25 @@ TEST(GameConfigTest, ReadsEnvironmentVariables) {
     EnvVarGuard metrics_guard("ARENA60_METRICS_PORT");
     EnvVarGuard tick_guard("ARENA60_TICK_RATE");
     EnvVarGuard dsn_guard("ARENA60_DATABASE_DSN");
+    EnvVarGuard profile_dir_guard("ARENA60_PROFILE_DATA_DIR");
+    EnvVarGuard redis_host_guard("ARENA60_REDIS_HOST");
+    EnvVarGuard redis_port_guard("ARENA60_REDIS_PORT");
+    EnvVarGuard map_file_guard("ARENA60_MAP_FILE");
+    EnvVarGuard deflate_players_guard("ARENA60_WS_DEFLATE_PLAYERS");
+    EnvVarGuard max_connections_guard("ARENA60_WS_MAX_CONNECTIONS");
+    EnvVarGuard handshake_rate_guard("ARENA60_WS_HANDSHAKES_PER_SECOND");
 
     setenv("ARENA60_PORT", "12345", 1);
     setenv("ARENA60_METRICS_PORT", "54321", 1);
     setenv("ARENA60_TICK_RATE", "75.0", 1);
     setenv("ARENA60_DATABASE_DSN", "postgresql://example.com:5432/arena", 1);
+    setenv("ARENA60_PROFILE_DATA_DIR", "/var/lib/arena60", 1);
+    setenv("ARENA60_REDIS_HOST", "redis.internal", 1);
+    setenv("ARENA60_REDIS_PORT", "6380", 1);
+    setenv("ARENA60_MAP_FILE", "/etc/arena60/maps/warehouse.map", 1);
+    setenv("ARENA60_WS_DEFLATE_PLAYERS", "500", 1);
+    setenv("ARENA60_WS_MAX_CONNECTIONS", "2000", 1);
+    setenv("ARENA60_WS_HANDSHAKES_PER_SECOND", "150", 1);
 
     const auto config = arena60::GameConfig::FromEnv();
 
@@ -45,4 +59,11 @@ TEST(GameConfigTest, ReadsEnvironmentVariables) {
     EXPECT_EQ(54321, config.metrics_port());
     EXPECT_DOUBLE_EQ(75.0, config.tick_rate());
     EXPECT_EQ("postgresql://example.com:5432/arena", config.database_dsn());
+    EXPECT_EQ("/var/lib/arena60", config.profile_data_dir());
+    EXPECT_EQ("redis.internal", config.redis_host());
+    EXPECT_EQ(6380, config.redis_port());
+    EXPECT_EQ("/etc/arena60/maps/warehouse.map", config.map_file());
+    EXPECT_EQ(500u, config.websocket_deflate_players());
+    EXPECT_EQ(2000u, config.websocket_max_connections());
+    EXPECT_EQ(150u, config.websocket_handshakes_per_second());
 }
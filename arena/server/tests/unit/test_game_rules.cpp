@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "arena60/game/game_rules.h"
+#include "arena60/game/game_session.h"
+
+namespace {
+
+template <typename Session>
+void Fire(Session& session, const std::string& player_id, std::uint64_t sequence,
+          double aim_x = 1.0) {
+    arena60::MovementInput input;
+    input.sequence = sequence;
+    input.mouse_x = aim_x;
+    input.fire = true;
+    session.ApplyInput(player_id, input, 1.0 / 60.0);
+}
+
+// Places the defender 0.4 m to the right of the attacker and lands one shot.
+template <typename Session>
+int HealthAfterOneHit(Session& session) {
+    session.UpsertPlayer("attacker");
+    session.UpsertPlayer("defender");
+    arena60::MovementInput move;
+    move.sequence = 1;
+    move.right = true;
+    move.mouse_x = 1.0;
+    session.ApplyInput("defender", move, 0.4 / session.rules().PlayerSpeed());
+
+    Fire(session, "attacker", 1);
+    std::uint64_t tick = 0;
+    for (int i = 0; i < 120 && session.ActiveProjectileCount() > 0; ++i) {
+        session.Tick(++tick, 1.0 / 60.0);
+    }
+    return session.GetPlayer("defender").health;
+}
+
+}  // namespace
+
+TEST(GameRulesTest, RuntimeRulesDefaultToStandardRules) {
+    const arena60::RuntimeRules runtime;
+    EXPECT_EQ(arena60::StandardRules::PlayerSpeed(), runtime.PlayerSpeed());
+    EXPECT_EQ(arena60::StandardRules::DamagePerHit(), runtime.DamagePerHit());
+    EXPECT_EQ(arena60::StandardRules::ProjectileLifetime(), runtime.ProjectileLifetime());
+
+    arena60::GameSession standard(60.0);
+    arena60::TunableGameSession tunable(60.0);
+    EXPECT_EQ(HealthAfterOneHit(standard), HealthAfterOneHit(tunable));
+}
+
+TEST(GameRulesTest, RapidFireRulesHalveCooldownAndDamage) {
+    arena60::RapidFireGameSession session(60.0);
+    EXPECT_EQ(90, HealthAfterOneHit(session));
+
+    // 0.06 s is past the 0.05 s rapid-fire cooldown but short of the standard 0.1 s. Shots aim
+    // away from the defender so both stay in flight.
+    session.Tick(1000, 0.06);
+    Fire(session, "attacker", 2, -1.0);
+    session.Tick(1001, 0.06);
+    Fire(session, "attacker", 3, -1.0);
+    EXPECT_EQ(2u, session.ActiveProjectileCount());
+}
+
+TEST(GameRulesTest, TunableSessionAppliesConfiguredValues) {
+    arena60::RuntimeRules rules;
+    rules.max_health = 50;
+    rules.damage_per_hit = 35;
+    arena60::TunableGameSession session(60.0, 0, rules);
+    EXPECT_EQ(15, HealthAfterOneHit(session));
+    EXPECT_EQ(50, session.GetPlayer("attacker").health);
+}
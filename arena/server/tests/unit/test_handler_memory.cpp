@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "arena60/network/handler_memory.h"
+
+TEST(HandlerMemoryTest, ReusesSlotsAndFallsBackToTheHeap) {
+    arena60::HandlerMemory memory;
+    void* first = memory.Allocate(200);
+    memory.Deallocate(first);
+    EXPECT_EQ(first, memory.Allocate(300));  // a chain of single operations cycles one slot
+    EXPECT_EQ(1u, memory.slots_in_use());
+
+    std::vector<void*> held;
+    for (std::size_t i = 1; i < arena60::HandlerMemory::kSlots; ++i) {
+        held.push_back(memory.Allocate(64));
+    }
+    EXPECT_EQ(arena60::HandlerMemory::kSlots, memory.slots_in_use());
+    void* overflow = memory.Allocate(64);
+    void* oversized = memory.Allocate(arena60::HandlerMemory::kSlotSize + 1);
+    EXPECT_EQ(arena60::HandlerMemory::kSlots, memory.slots_in_use());
+    memory.Deallocate(overflow);
+    memory.Deallocate(oversized);
+
+    memory.Deallocate(first);
+    for (void* pointer : held) {
+        memory.Deallocate(pointer);
+    }
+    EXPECT_EQ(0u, memory.slots_in_use());
+}
+
+TEST(HandlerMemoryTest, AllocatorsCompareByMemory) {
+    arena60::HandlerMemory a;
+    arena60::HandlerMemory b;
+    arena60::HandlerAllocator<char> from_a(a);
+    arena60::HandlerAllocator<int> rebound(from_a);
+    EXPECT_TRUE(from_a == rebound);
+    EXPECT_TRUE(from_a != arena60::HandlerAllocator<char>(b));
+
+    int* values = rebound.allocate(4);
+    EXPECT_EQ(1u, a.slots_in_use());
+    rebound.deallocate(values, 4);
+    EXPECT_EQ(0u, a.slots_in_use());
+}
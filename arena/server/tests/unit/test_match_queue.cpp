@@ -50,3 +50,22 @@ TEST(MatchQueueTest, RemoveDeletesPlayer) {
     ASSERT_EQ(1u, ordered.size());
     EXPECT_EQ("bob", ordered.front().request.player_id());
 }
+
+TEST(MatchQueueTest, ClaimPairsKeepsPlayerWhosePartnerLeft) {
+    InMemoryMatchQueue queue;
+    const auto now = steady_clock::now();
+    queue.Upsert(MatchRequest{"alice", 1200, now}, 1);
+    queue.Upsert(MatchRequest{"bob", 1210, now}, 2);
+    queue.Upsert(MatchRequest{"carol", 1220, now}, 3);
+    queue.Upsert(MatchRequest{"dave", 1230, now}, 4);
+    ASSERT_TRUE(queue.Remove("bob"));
+
+    const auto claimed = queue.ClaimPairs({{"alice", "bob"}, {"carol", "dave"}});
+    ASSERT_EQ(2u, claimed.size());
+    EXPECT_FALSE(claimed[0]);
+    EXPECT_TRUE(claimed[1]);
+
+    const auto ordered = queue.FetchOrdered();
+    ASSERT_EQ(1u, ordered.size());
+    EXPECT_EQ("alice", ordered.front().request.player_id());
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/storage/match_result_writer.h"
+
+namespace {
+using namespace std::chrono_literals;
+
+arena60::MatchResult MakeResult(int index) {
+    const std::string id = "match-" + std::to_string(index);
+    return arena60::MatchResult(id, "winner", "loser", std::chrono::system_clock::now(), {});
+}
+
+class RecordingSink : public arena60::MatchResultSink {
+   public:
+    explicit RecordingSink(int failures_before_success = 0)
+        : failures_remaining_(failures_before_success) {}
+
+    bool RecordMatchResults(const std::vector<arena60::MatchResult>& results) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        ++attempts_;
+        if (failures_remaining_ != 0) {
+            if (failures_remaining_ > 0) {
+                --failures_remaining_;
+            }
+            return false;
+        }
+        batch_sizes_.push_back(results.size());
+        for (const auto& result : results) {
+            match_ids_.push_back(result.match_id());
+        }
+        return true;
+    }
+
+    std::vector<std::string> match_ids() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return match_ids_;
+    }
+    std::vector<std::size_t> batch_sizes() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return batch_sizes_;
+    }
+    int attempts() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return attempts_;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    int failures_remaining_;
+    int attempts_{0};
+    std::vector<std::size_t> batch_sizes_;
+    std::vector<std::string> match_ids_;
+};
+
+void WaitForWritten(const arena60::MatchResultWriter& writer, std::uint64_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (writer.ResultsWritten() < count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+}
+}  // namespace
+
+TEST(MatchResultWriterTest, BatchesQueuedResultsInOrder) {
+    boost::asio::thread_pool pool(1);
+    auto sink = std::make_shared<RecordingSink>();
+    arena60::MatchResultWriterOptions options;
+    options.max_batch_size = 4;
+    auto writer = std::make_shared<arena60::MatchResultWriter>(pool.get_executor(), sink, options);
+
+    // Hold the pool so every result is queued before the first drain runs.
+    std::promise<void> release;
+    boost::asio::post(pool, [future = release.get_future().share()]() { future.wait(); });
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(writer->Enqueue(MakeResult(i)));
+    }
+    release.set_value();
+    WaitForWritten(*writer, 10);
+    writer->Stop();
+    pool.join();
+
+    const auto ids = sink->match_ids();
+    ASSERT_EQ(10u, ids.size());
+    EXPECT_EQ("match-0", ids.front());
+    EXPECT_EQ("match-9", ids.back());
+    EXPECT_EQ((std::vector<std::size_t>{4, 4, 2}), sink->batch_sizes());
+    EXPECT_EQ(0u, writer->QueueDepth());
+}
+
+TEST(MatchResultWriterTest, RequeuesFailedBatchesUntilTheSinkRecovers) {
+    boost::asio::thread_pool pool(1);
+    auto sink = std::make_shared<RecordingSink>(2);
+    arena60::MatchResultWriterOptions options;
+    options.initial_backoff = 5ms;
+    auto writer = std::make_shared<arena60::MatchResultWriter>(pool.get_executor(), sink, options);
+
+    EXPECT_TRUE(writer->Enqueue(MakeResult(0)));
+    EXPECT_TRUE(writer->Enqueue(MakeResult(1)));
+    WaitForWritten(*writer, 2);
+    writer->Stop();
+    pool.join();
+
+    EXPECT_EQ((std::vector<std::string>{"match-0", "match-1"}), sink->match_ids());
+    EXPECT_GE(writer->RetriesTotal(), 2u);
+    EXPECT_EQ(0u, writer->ResultsDropped());
+}
+
+TEST(MatchResultWriterTest, StopGivesOneLastAttemptThenDrops) {
+    boost::asio::thread_pool pool(1);
+    auto sink = std::make_shared<RecordingSink>(-1);
+    arena60::MatchResultWriterOptions options;
+    options.queue_capacity = 2;
+    options.initial_backoff = 10s;
+    auto writer = std::make_shared<arena60::MatchResultWriter>(pool.get_executor(), sink, options);
+
+    std::promise<void> release;
+    boost::asio::post(pool, [future = release.get_future().share()]() { future.wait(); });
+    EXPECT_TRUE(writer->Enqueue(MakeResult(0)));
+    EXPECT_TRUE(writer->Enqueue(MakeResult(1)));
+    EXPECT_FALSE(writer->Enqueue(MakeResult(2)));
+    release.set_value();
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (writer->RetriesTotal() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+
+    // Stop cuts the 10 s backoff short, so join returns promptly.
+    const auto start = std::chrono::steady_clock::now();
+    writer->Stop();
+    pool.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    EXPECT_EQ(2, sink->attempts());
+    EXPECT_EQ(3u, writer->ResultsDropped());
+    EXPECT_EQ(0u, writer->QueueDepth());
+}
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <chrono>
 #include <stdexcept>
+#include <vector>
 
 #include "arena60/game/game_session.h"
 #include "arena60/stats/match_stats.h"
@@ -13,7 +14,7 @@ using arena60::MatchStatsCollector;
 using arena60::PlayerMatchStats;
 }  // namespace
 
-TEST(MatchStatsCollectorTest, ProducesAccurateStatsFromCombatLog) {
+TEST(MatchStatsCollectorTest, ProducesAccurateStatsFromCombatTotals) {
     arena60::GameSession session(60.0);
     session.UpsertPlayer("attacker");
     session.UpsertPlayer("defender");
@@ -80,3 +81,49 @@ TEST(MatchStatsCollectorTest, ProducesAccurateStatsFromCombatLog) {
     EXPECT_EQ(defender_stats.shots_fired(), 0u);
     EXPECT_DOUBLE_EQ(0.0, defender_stats.Accuracy());
 }
+
+TEST(MatchStatsCollectorTest, CountsEveryHitInLongMatches) {
+    arena60::GameSession session(60.0);
+    session.UpsertPlayer("attacker");
+    session.UpsertPlayer("defender");
+
+    arena60::MovementInput position;
+    position.sequence = 1;
+    position.right = true;
+    position.mouse_x = 1.0;
+    session.ApplyInput("defender", position, 0.08);
+
+    // Ten kills of five hits each is 60 combat events, well past the old 32-entry log.
+    std::uint64_t tick = 0;
+    std::uint64_t sequence = 1;
+    std::vector<arena60::CombatEvent> deaths;
+    for (int round = 0; round < 10; ++round) {
+        session.UpsertPlayer("defender");
+        for (int shot = 0; shot < 5; ++shot) {
+            arena60::MovementInput input;
+            input.sequence = ++sequence;
+            input.mouse_x = 1.0;
+            input.fire = true;
+            session.ApplyInput("attacker", input, 1.0 / 60.0);
+            for (int i = 0; i < 10; ++i) {
+                session.Tick(++tick, 1.0 / 60.0);
+            }
+        }
+        auto round_deaths = session.ConsumeDeathEvents();
+        ASSERT_EQ(1u, round_deaths.size());
+        deaths.push_back(round_deaths.front());
+    }
+
+    MatchStatsCollector collector;
+    const auto result =
+        collector.Collect(deaths.back(), session, std::chrono::system_clock::now());
+    ASSERT_EQ(2u, result.player_stats().size());
+    const auto& attacker = result.player_stats()[0];
+    const auto& defender = result.player_stats()[1];
+    ASSERT_EQ("attacker", attacker.player_id());
+    EXPECT_EQ(50u, attacker.hits_landed());
+    EXPECT_EQ(1000u, attacker.damage_dealt());
+    EXPECT_EQ(10u, attacker.kills());
+    EXPECT_EQ(1000u, defender.damage_taken());
+    EXPECT_EQ(10u, defender.deaths());
+}
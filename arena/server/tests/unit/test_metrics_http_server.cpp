@@ -2,9 +2,11 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/system/error_code.hpp>
+#include <chrono>
 #include <future>
 #include <string>
 #include <thread>
@@ -82,3 +84,83 @@ TEST(MetricsHttpServerTest, ServesMetricsPayload) {
     io_context.stop();
     server_thread.join();
 }
+
+TEST(MetricsHttpServerTest, KeepsAliveServesPipelinedRequestsAndEnforcesCap) {
+    namespace http = boost::beast::http;
+    boost::asio::io_context io_context;
+    arena60::MetricsHttpServer::RequestHandler handler =
+        [](const http::request<http::string_body>& req) {
+            http::response<http::string_body> res;
+            res.version(req.version());
+            res.keep_alive(req.keep_alive());
+            res.result(http::status::ok);
+            res.body() = std::string(req.target());
+            res.prepare_payload();
+            return res;
+        };
+    arena60::HttpConnectionLimits limits;
+    limits.max_requests_per_connection = 3;
+    auto server =
+        std::make_shared<arena60::MetricsHttpServer>(io_context, 0, std::move(handler), limits);
+    server->Start();
+    std::thread server_thread([&]() { io_context.run(); });
+
+    boost::asio::io_context client_io;
+    boost::beast::tcp_stream stream(client_io);
+    boost::asio::ip::tcp::resolver resolver(client_io);
+    stream.connect(resolver.resolve("127.0.0.1", std::to_string(server->Port())));
+
+    // All three requests go out in a single write before any response is read.
+    std::string pipelined;
+    for (const char* target : {"/a", "/b", "/c"}) {
+        pipelined += std::string("GET ") + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    }
+    boost::asio::write(stream, boost::asio::buffer(pipelined));
+
+    boost::beast::flat_buffer buffer;
+    for (const char* target : {"/a", "/b", "/c"}) {
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        EXPECT_EQ(http::status::ok, res.result());
+        EXPECT_EQ(target, res.body());
+        EXPECT_EQ(std::string(target) != "/c", res.keep_alive());
+    }
+
+    http::response<http::string_body> extra;
+    boost::system::error_code ec;
+    http::read(stream, buffer, extra, ec);
+    EXPECT_EQ(http::error::end_of_stream, ec);
+    EXPECT_EQ(1u, server->ConnectionsAccepted());
+    EXPECT_EQ(3u, server->RequestsServed());
+
+    server->Stop();
+    io_context.stop();
+    server_thread.join();
+}
+
+TEST(MetricsHttpServerTest, ClosesIdleConnections) {
+    namespace http = boost::beast::http;
+    boost::asio::io_context io_context;
+    arena60::HttpConnectionLimits limits;
+    limits.idle_timeout = std::chrono::milliseconds(100);
+    auto server = std::make_shared<arena60::MetricsHttpServer>(io_context, 0, nullptr, limits);
+    server->Start();
+    std::thread server_thread([&]() { io_context.run(); });
+
+    boost::asio::io_context client_io;
+    boost::beast::tcp_stream stream(client_io);
+    boost::asio::ip::tcp::resolver resolver(client_io);
+    stream.connect(resolver.resolve("127.0.0.1", std::to_string(server->Port())));
+
+    const auto start = std::chrono::steady_clock::now();
+    char byte = 0;
+    boost::system::error_code ec;
+    stream.socket().read_some(boost::asio::buffer(&byte, 1), ec);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(boost::asio::error::eof, ec);
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+
+    server->Stop();
+    io_context.stop();
+    server_thread.join();
+}
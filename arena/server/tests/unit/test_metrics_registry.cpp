@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "arena60/core/metrics_registry.h"
+
+TEST(MetricsRegistryTest, RendersCountersAndGaugesWithOneTypeLinePerFamily) {
+    arena60::Counter queue_full;
+    arena60::Counter write_failed;
+    arena60::Gauge depth;
+    queue_full.Increment(3);
+    write_failed.Increment();
+    depth.Set(12.5);
+    depth.Add(-2.0);
+
+    arena60::MetricsRegistry registry;
+    registry.Register("events_dropped_total{reason=\"queue_full\"}", queue_full);
+    registry.Register("events_dropped_total{reason=\"write_failed\"}", write_failed);
+    registry.Register("events_queue_depth", depth);
+
+    EXPECT_EQ(
+        "# TYPE events_dropped_total counter\n"
+        "events_dropped_total{reason=\"queue_full\"} 3\n"
+        "events_dropped_total{reason=\"write_failed\"} 1\n"
+        "# TYPE events_queue_depth gauge\n"
+        "events_queue_depth 10.5\n",
+        registry.Serialize());
+}
+
+TEST(MetricsRegistryTest, RendersCumulativeHistogramBuckets) {
+    arena60::Histogram latency({0.001, 0.01, 0.1});
+    latency.Observe(0.0005);
+    latency.Observe(0.001);
+    latency.Observe(0.05);
+    latency.Observe(2.0);
+
+    arena60::MetricsRegistry registry;
+    registry.Register("query_seconds{statement=\"insert\"}", latency);
+
+    EXPECT_EQ(
+        "# TYPE query_seconds histogram\n"
+        "query_seconds_bucket{statement=\"insert\",le=\"0.001\"} 2\n"
+        "query_seconds_bucket{statement=\"insert\",le=\"0.01\"} 2\n"
+        "query_seconds_bucket{statement=\"insert\",le=\"0.1\"} 3\n"
+        "query_seconds_bucket{statement=\"insert\",le=\"+Inf\"} 4\n"
+        "query_seconds_sum{statement=\"insert\"} 2.0515\n"
+        "query_seconds_count{statement=\"insert\"} 4\n",
+        registry.Serialize());
+}
+
+TEST(MetricsRegistryTest, ReusedBufferKeepsItsCapacity) {
+    arena60::Counter ticks;
+    arena60::MetricsRegistry registry;
+    registry.Register("ticks_total", ticks);
+
+    std::string buffer;
+    registry.AppendTo(buffer);
+    const auto capacity = buffer.capacity();
+    for (int i = 0; i < 100; ++i) {
+        ticks.Increment();
+        buffer.clear();
+        registry.AppendTo(buffer);
+    }
+    EXPECT_EQ("# TYPE ticks_total counter\nticks_total 100\n", buffer);
+    EXPECT_EQ(capacity, buffer.capacity());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
@@ -100,3 +101,65 @@ TEST(PlayerProfileServiceTest, UpdatesRatingsAggregatesStatsAndSerializes) {
     EXPECT_NE(metrics_after.find("matches_recorded_total 3"), std::string::npos);
     EXPECT_NE(metrics_after.find("rating_updates_total 6"), std::string::npos);
 }
+
+TEST(EloRatingCalculatorTest, LookupTableMatchesLogisticFormula) {
+    const arena60::EloRatingCalculator calculator;
+    for (int winner = 0; winner <= 3000; winner += 7) {
+        for (int loser = 0; loser <= 3000; loser += 11) {
+            const double expected_winner =
+                1.0 / (1.0 + std::pow(10.0, (loser - winner) / 400.0));
+            const double expected_loser =
+                1.0 / (1.0 + std::pow(10.0, (winner - loser) / 400.0));
+            const auto update = calculator.Update(winner, loser);
+            ASSERT_EQ(std::lround(winner + 25.0 * (1.0 - expected_winner)), update.winner_new)
+                << winner << " vs " << loser;
+            ASSERT_EQ(std::lround(loser - 25.0 * expected_loser), update.loser_new)
+                << winner << " vs " << loser;
+        }
+    }
+}
+
+TEST(PlayerProfileServiceTest, RecordMatchesMatchesSequentialRecording) {
+    auto sequential_leaderboard = std::make_shared<arena60::InMemoryLeaderboardStore>();
+    auto batched_leaderboard = std::make_shared<arena60::InMemoryLeaderboardStore>();
+    arena60::PlayerProfileService sequential(sequential_leaderboard);
+    arena60::PlayerProfileService batched(batched_leaderboard);
+
+    const auto now = std::chrono::system_clock::now();
+    std::vector<MatchResult> matches;
+    for (int i = 0; i < 200; ++i) {
+        const std::string id = "match-" + std::to_string(i);
+        const std::string winner = "player-" + std::to_string((i * 7) % 12);
+        const std::string loser = "player-" + std::to_string((i * 7 + 1 + i % 5) % 12);
+        std::vector<PlayerMatchStats> stats{
+            PlayerMatchStats{id, winner, 6, static_cast<std::uint32_t>(3 + i % 3), 1, 0, 60, 20},
+            PlayerMatchStats{id, loser, 5, 2, 0, 1, 40, 60},
+        };
+        matches.emplace_back(id, winner, loser, now, stats);
+    }
+    for (const auto& match : matches) {
+        sequential.RecordMatch(match);
+    }
+    batched.RecordMatches({matches.begin(), matches.begin() + 64});
+    batched.RecordMatches({matches.begin() + 64, matches.end()});
+
+    for (int p = 0; p < 12; ++p) {
+        const std::string id = "player-" + std::to_string(p);
+        const auto expected = sequential.GetProfile(id);
+        const auto actual = batched.GetProfile(id);
+        ASSERT_TRUE(expected.has_value());
+        ASSERT_TRUE(actual.has_value());
+        EXPECT_EQ(expected->rating, actual->rating) << id;
+        EXPECT_EQ(expected->matches, actual->matches) << id;
+        EXPECT_EQ(expected->wins, actual->wins) << id;
+        EXPECT_EQ(expected->hits_landed, actual->hits_landed) << id;
+        EXPECT_EQ(sequential_leaderboard->Get(id), batched_leaderboard->Get(id)) << id;
+    }
+
+    const std::string metrics = batched.MetricsSnapshot();
+    EXPECT_NE(metrics.find("matches_recorded_total 200"), std::string::npos);
+    EXPECT_NE(metrics.find("rating_updates_total 400"), std::string::npos);
+    // Two batches over twelve players: at most 24 leaderboard writes instead of 400.
+    EXPECT_NE(metrics.find("leaderboard_upserts_total 24"), std::string::npos);
+    EXPECT_EQ(2u, batched.Generation());
+}
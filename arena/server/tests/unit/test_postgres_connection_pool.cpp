@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+
+#include "arena60/storage/postgres_connection_pool.h"
+
+TEST(PostgresConnectionPoolTest, ReportsNoHealthyConnectionsWhenDatabaseIsDown) {
+    arena60::PostgresPoolOptions options;
+    options.size = 2;
+    arena60::PostgresConnectionPool pool("postgresql://localhost:1/arena60", options);
+    EXPECT_EQ(2u, pool.Size());
+    EXPECT_EQ(0u, pool.HealthyCount());
+    EXPECT_EQ(0u, pool.Connect());
+    EXPECT_EQ(0u, pool.HealthCheck());
+
+    auto lease = pool.Acquire();
+    EXPECT_FALSE(lease);
+    EXPECT_EQ(nullptr, lease.get());
+    EXPECT_FALSE(lease.EnsurePrepared("noop", "SELECT 1", 0));
+}
+
+TEST(PostgresConnectionPoolTest, BacksOffReconnectsInsteadOfBlocking) {
+    arena60::PostgresPoolOptions options;
+    options.size = 1;
+    options.acquire_timeout = std::chrono::milliseconds(500);
+    options.reconnect_backoff = std::chrono::seconds(30);
+    arena60::PostgresConnectionPool pool("postgresql://localhost:1/arena60", options);
+    EXPECT_FALSE(pool.Acquire());
+
+    // The only slot is backing off, so Acquire fails fast instead of waiting out the timeout.
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(pool.Acquire());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(0u, pool.ReconnectsTotal());
+}
+
+TEST(PostgresConnectionPoolTest, ConnectReportsEverySlotHealthyWhenDatabaseIsUp) {
+    // Needs a live server, e.g. ARENA60_TEST_DATABASE_DSN=postgresql://localhost/arena60.
+    const char* dsn = std::getenv("ARENA60_TEST_DATABASE_DSN");
+    if (dsn == nullptr || *dsn == '\0') {
+        GTEST_SKIP() << "ARENA60_TEST_DATABASE_DSN not set";
+    }
+    arena60::PostgresPoolOptions options;
+    options.size = 3;
+    arena60::PostgresConnectionPool pool(dsn, options);
+    EXPECT_EQ(3u, pool.Connect());
+    EXPECT_EQ(3u, pool.HealthyCount());
+    EXPECT_EQ(3u, pool.HealthCheck());
+
+    auto lease = pool.Acquire();
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(lease.EnsurePrepared("arena60_pool_probe", "SELECT 1", 0));
+}
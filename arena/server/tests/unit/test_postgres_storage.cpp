@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <vector>
+
 #include "arena60/storage/postgres_storage.h"
 
 TEST(PostgresStorageTest, ConnectionFailureIsHandled) {
@@ -16,3 +19,32 @@ TEST(PostgresStorageTest, RecordSessionEventFailsWithoutConnection) {
     const auto snapshot = storage.MetricsSnapshot();
     EXPECT_NE(snapshot.find("database_query_duration_seconds"), std::string::npos);
 }
+
+TEST(PostgresStorageTest, WriteSessionEventsFailsWithoutDatabase) {
+    arena60::PostgresStorage storage("postgresql://localhost:1/arena60");
+    std::vector<arena60::SessionEvent> events{
+        {"player", "start", std::chrono::system_clock::now()},
+    };
+    EXPECT_FALSE(storage.WriteSessionEvents(events));
+    EXPECT_TRUE(storage.WriteSessionEvents({}));
+    EXPECT_FALSE(storage.IsConnected());
+}
+
+TEST(PostgresStorageTest, RecordMatchResultsFailsWithoutDatabase) {
+    arena60::PostgresStorage storage("postgresql://localhost:1/arena60");
+    std::vector<arena60::PlayerMatchStats> stats{
+        arena60::PlayerMatchStats{"match-1", "winner", 5, 5, 1, 0, 100, 10},
+        arena60::PlayerMatchStats{"match-1", "loser", 4, 2, 0, 1, 40, 100},
+    };
+    std::vector<arena60::MatchResult> results{
+        arena60::MatchResult{"match-1", "winner", "loser", std::chrono::system_clock::now(),
+                             stats},
+    };
+    EXPECT_FALSE(storage.RecordMatchResults(results));
+    EXPECT_TRUE(storage.RecordMatchResults({}));
+
+    const auto snapshot = storage.MetricsSnapshot();
+    EXPECT_NE(snapshot.find("# TYPE database_query_duration_seconds histogram"),
+              std::string::npos);
+    EXPECT_NE(snapshot.find("database_pool_connections_healthy 0"), std::string::npos);
+}
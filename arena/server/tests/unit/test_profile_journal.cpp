@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/stats/player_profile_service.h"
+#include "arena60/stats/profile_journal.h"
+
+namespace {
+using arena60::MatchResult;
+using arena60::PlayerMatchStats;
+using arena60::PlayerProfileService;
+using arena60::ProfileJournal;
+
+class TempDirectory {
+   public:
+    TempDirectory() {
+        std::string pattern =
+            (std::filesystem::temp_directory_path() / "arena60-journal-XXXXXX").string();
+        path_ = ::mkdtemp(pattern.data());
+    }
+    ~TempDirectory() { std::filesystem::remove_all(path_); }
+
+    const std::string& path() const { return path_; }
+
+   private:
+    std::string path_;
+};
+
+// A service wired to a journal the way main() does it.
+struct JournaledService {
+    explicit JournaledService(const std::string& directory)
+        : leaderboard(std::make_shared<arena60::InMemoryLeaderboardStore>()),
+          service(std::make_shared<PlayerProfileService>(leaderboard)),
+          journal(std::make_shared<ProfileJournal>(directory)) {}
+
+    bool Open() {
+        if (!journal->Recover(*service) || !journal->Start(service)) {
+            return false;
+        }
+        service->SetChangeSink(journal);
+        return true;
+    }
+
+    std::shared_ptr<arena60::InMemoryLeaderboardStore> leaderboard;
+    std::shared_ptr<PlayerProfileService> service;
+    std::shared_ptr<ProfileJournal> journal;
+};
+
+MatchResult MakeMatch(const std::string& id, const std::string& winner, const std::string& loser) {
+    std::vector<PlayerMatchStats> stats{
+        PlayerMatchStats{id, winner, 5, 4, 1, 0, 80, 20},
+        PlayerMatchStats{id, loser, 6, 2, 0, 1, 20, 80},
+    };
+    return MatchResult{id, winner, loser, std::chrono::system_clock::now(), stats};
+}
+
+void ExpectSameProfiles(const PlayerProfileService& expected, const PlayerProfileService& actual) {
+    std::size_t visited = 0;
+    expected.ForEachProfile([&](const arena60::PlayerProfile& profile) {
+        ++visited;
+        const auto restored = actual.GetProfile(profile.player_id);
+        ASSERT_TRUE(restored.has_value()) << profile.player_id;
+        EXPECT_EQ(profile.rating, restored->rating);
+        EXPECT_EQ(profile.matches, restored->matches);
+        EXPECT_EQ(profile.wins, restored->wins);
+        EXPECT_EQ(profile.losses, restored->losses);
+        EXPECT_EQ(profile.kills, restored->kills);
+        EXPECT_EQ(profile.deaths, restored->deaths);
+        EXPECT_EQ(profile.shots_fired, restored->shots_fired);
+        EXPECT_EQ(profile.hits_landed, restored->hits_landed);
+        EXPECT_EQ(profile.damage_dealt, restored->damage_dealt);
+        EXPECT_EQ(profile.damage_taken, restored->damage_taken);
+    });
+    std::size_t restored_count = 0;
+    actual.ForEachProfile([&](const arena60::PlayerProfile&) { ++restored_count; });
+    EXPECT_EQ(visited, restored_count);
+}
+}  // namespace
+
+TEST(ProfileJournalTest, ReplaysWalAfterRestart) {
+    TempDirectory dir;
+    JournaledService first(dir.path());
+    ASSERT_TRUE(first.Open());
+    first.service->RecordMatch(MakeMatch("m1", "alpha", "bravo"));
+    first.service->RecordMatch(MakeMatch("m2", "bravo", "charlie"));
+    first.service->RecordMatch(MakeMatch("m3", "alpha", "charlie"));
+    first.journal->Stop();
+    EXPECT_GT(first.journal->WalBytesWritten(), 0u);
+
+    JournaledService second(dir.path());
+    ASSERT_TRUE(second.Open());
+    EXPECT_EQ(6u, second.journal->RecordsRecovered());
+    ExpectSameProfiles(*first.service, *second.service);
+    ASSERT_TRUE(second.leaderboard->Get("alpha").has_value());
+    EXPECT_EQ(first.leaderboard->Get("alpha"), second.leaderboard->Get("alpha"));
+}
+
+TEST(ProfileJournalTest, CheckpointWritesSnapshotAndStartsFreshWal) {
+    TempDirectory dir;
+    JournaledService first(dir.path());
+    ASSERT_TRUE(first.Open());
+    for (int i = 0; i < 20; ++i) {
+        first.service->RecordMatch(
+            MakeMatch("m" + std::to_string(i), "p" + std::to_string(i % 5), "p5"));
+    }
+    ASSERT_TRUE(first.journal->Checkpoint());
+    EXPECT_EQ(1u, first.journal->CheckpointsTotal());
+    EXPECT_TRUE(std::filesystem::exists(dir.path() + "/profiles.snapshot"));
+    EXPECT_FALSE(std::filesystem::exists(dir.path() + "/profiles.wal.old"));
+    EXPECT_EQ(0u, std::filesystem::file_size(dir.path() + "/profiles.wal"));
+
+    first.service->RecordMatch(MakeMatch("after", "p5", "p0"));
+    first.journal->Stop();
+
+    JournaledService second(dir.path());
+    ASSERT_TRUE(second.Open());
+    // Six profiles from the snapshot plus the two rows of the post-checkpoint match.
+    EXPECT_EQ(8u, second.journal->RecordsRecovered());
+    ExpectSameProfiles(*first.service, *second.service);
+}
+
+TEST(ProfileJournalTest, DropsTornWalTailAndKeepsAppending) {
+    TempDirectory dir;
+    JournaledService first(dir.path());
+    ASSERT_TRUE(first.Open());
+    first.service->RecordMatch(MakeMatch("m1", "alpha", "bravo"));
+    first.journal->Stop();
+    {
+        // Simulate a crash halfway through the next frame.
+        std::ofstream wal(dir.path() + "/profiles.wal", std::ios::binary | std::ios::app);
+        wal.write("\x40\x00\x00\x00\x12\x34", 6);
+    }
+
+    JournaledService second(dir.path());
+    ASSERT_TRUE(second.Open());
+    EXPECT_EQ(2u, second.journal->RecordsRecovered());
+    second.service->RecordMatch(MakeMatch("m2", "bravo", "alpha"));
+    second.journal->Stop();
+
+    JournaledService third(dir.path());
+    ASSERT_TRUE(third.Open());
+    EXPECT_EQ(4u, third.journal->RecordsRecovered());
+    ExpectSameProfiles(*second.service, *third.service);
+}
+
+TEST(ProfileJournalTest, FoldsRotatedWalLeftByInterruptedCheckpoint) {
+    TempDirectory dir;
+    JournaledService first(dir.path());
+    ASSERT_TRUE(first.Open());
+    first.service->RecordMatch(MakeMatch("m1", "alpha", "bravo"));
+    first.journal->Stop();
+    std::filesystem::rename(dir.path() + "/profiles.wal", dir.path() + "/profiles.wal.old");
+
+    JournaledService second(dir.path());
+    ASSERT_TRUE(second.Open());
+    EXPECT_FALSE(std::filesystem::exists(dir.path() + "/profiles.wal.old"));
+    EXPECT_TRUE(std::filesystem::exists(dir.path() + "/profiles.snapshot"));
+    ExpectSameProfiles(*first.service, *second.service);
+}
+
+TEST(ProfileJournalTest, RejectsCorruptSnapshot) {
+    TempDirectory dir;
+    JournaledService first(dir.path());
+    ASSERT_TRUE(first.Open());
+    first.service->RecordMatch(MakeMatch("m1", "alpha", "bravo"));
+    ASSERT_TRUE(first.journal->Checkpoint());
+    first.journal->Stop();
+    {
+        std::fstream snapshot(dir.path() + "/profiles.snapshot",
+                              std::ios::binary | std::ios::in | std::ios::out);
+        snapshot.seekp(20);
+        snapshot.put('\x7f');
+    }
+
+    JournaledService second(dir.path());
+    EXPECT_FALSE(second.journal->Recover(*second.service));
+    const std::string metrics = first.journal->MetricsSnapshot();
+    EXPECT_NE(metrics.find("profile_journal_checkpoints_total 1"), std::string::npos);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arena60/network/profile_response_cache.h"
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/stats/player_profile_service.h"
+
+namespace {
+using arena60::MatchResult;
+using arena60::PlayerMatchStats;
+
+MatchResult MakeMatch(const std::string& match_id, const std::string& winner,
+                      const std::string& loser) {
+    std::vector<PlayerMatchStats> stats{
+        PlayerMatchStats{match_id, winner, 5, 5, 1, 0, 100, 10},
+        PlayerMatchStats{match_id, loser, 4, 2, 0, 1, 40, 100},
+    };
+    return MatchResult{match_id, winner, loser, std::chrono::system_clock::now(), stats};
+}
+}  // namespace
+
+TEST(ProfileResponseCacheTest, ServesCachedBodiesUntilGenerationChanges) {
+    auto leaderboard = std::make_shared<arena60::InMemoryLeaderboardStore>();
+    auto service = std::make_shared<arena60::PlayerProfileService>(leaderboard);
+    arena60::ProfileResponseCache cache(service);
+
+    service->RecordMatch(MakeMatch("match-1", "alice", "bob"));
+    EXPECT_EQ(1u, service->Generation());
+
+    auto first = cache.Leaderboard(10);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(service->SerializeLeaderboard(service->TopProfiles(10)), first->body);
+    EXPECT_FALSE(first->etag.empty());
+    EXPECT_EQ(0u, cache.hits());
+    EXPECT_EQ(1u, cache.misses());
+
+    auto second = cache.Leaderboard(10);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(1u, cache.hits());
+
+    auto profile = cache.Profile("alice");
+    ASSERT_TRUE(profile);
+    EXPECT_EQ(service->SerializeProfile(*service->GetProfile("alice")), profile->body);
+    EXPECT_EQ(nullptr, cache.Profile("missing"));
+
+    service->RecordMatch(MakeMatch("match-2", "bob", "alice"));
+    auto refreshed = cache.Leaderboard(10);
+    EXPECT_NE(first.get(), refreshed.get());
+    EXPECT_EQ(2u, refreshed->generation);
+    EXPECT_NE(first->etag, refreshed->etag);
+    EXPECT_EQ(service->SerializeLeaderboard(service->TopProfiles(10)), refreshed->body);
+
+    const auto metrics = cache.MetricsSnapshot();
+    EXPECT_NE(metrics.find("profile_response_cache_hits_total 1"), std::string::npos);
+}
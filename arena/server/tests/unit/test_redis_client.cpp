@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../support/resp_stub_server.h"
+#include "arena60/matchmaking/match_queue.h"
+#include "arena60/matchmaking/matchmaker.h"
+#include "arena60/stats/leaderboard_store.h"
+#include "arena60/storage/redis_client.h"
+
+namespace {
+
+using arena60::test_support::RespStubServer;
+
+std::shared_ptr<arena60::RedisClient> ConnectTo(const RespStubServer& server) {
+    arena60::RedisClientOptions options;
+    options.port = server.port();
+    auto client = std::make_shared<arena60::RedisClient>(options);
+    EXPECT_TRUE(client->Connect());
+    return client;
+}
+
+}  // namespace
+
+TEST(RespParserTest, DecodesNestedRepliesSplitAcrossReads) {
+    const std::string wire = "*3\r\n:42\r\n$5\r\nhello\r\n*2\r\n$-1\r\n-ERR nope\r\n+OK\r\n";
+    arena60::RespParser parser;
+    arena60::RedisReply reply;
+    // Everything but the last byte of the array and the trailing +OK arrives one byte at a time.
+    for (std::size_t i = 0; i + 6 < wire.size(); ++i) {
+        parser.Feed(&wire[i], 1);
+        EXPECT_EQ(arena60::RespParser::Result::kIncomplete, parser.Next(reply));
+    }
+    parser.Feed(wire.data() + wire.size() - 6, 6);
+
+    ASSERT_EQ(arena60::RespParser::Result::kReply, parser.Next(reply));
+    ASSERT_EQ(arena60::RedisReply::Type::kArray, reply.type);
+    ASSERT_EQ(3u, reply.elements.size());
+    EXPECT_EQ(42, reply.elements[0].integer);
+    EXPECT_EQ("hello", reply.elements[1].str);
+    ASSERT_EQ(2u, reply.elements[2].elements.size());
+    EXPECT_EQ(arena60::RedisReply::Type::kNil, reply.elements[2].elements[0].type);
+    EXPECT_TRUE(reply.elements[2].elements[1].IsError());
+    EXPECT_EQ("ERR nope", reply.elements[2].elements[1].str);
+
+    ASSERT_EQ(arena60::RespParser::Result::kReply, parser.Next(reply));
+    EXPECT_EQ(arena60::RedisReply::Type::kSimpleString, reply.type);
+    EXPECT_EQ("OK", reply.str);
+    EXPECT_EQ(arena60::RespParser::Result::kIncomplete, parser.Next(reply));
+}
+
+TEST(RespParserTest, RejectsMalformedInput) {
+    arena60::RespParser parser;
+    const std::string wire = ":12x\r\n";
+    parser.Feed(wire.data(), wire.size());
+    arena60::RedisReply reply;
+    EXPECT_EQ(arena60::RespParser::Result::kError, parser.Next(reply));
+}
+
+TEST(RespParserTest, RejectsOutOfRangeLengthsAndCounts) {
+    for (const std::string wire :
+         {"$9223372036854775807\r\n", "$-5\r\n", "*-2\r\n", "*1000000000\r\n"}) {
+        arena60::RespParser parser;
+        parser.Feed(wire.data(), wire.size());
+        arena60::RedisReply reply;
+        EXPECT_EQ(arena60::RespParser::Result::kError, parser.Next(reply)) << wire;
+    }
+
+    // A plausible count waits for its bytes instead of allocating every element up front.
+    arena60::RespParser parser;
+    const std::string head = "*1000\r\n:1\r\n";
+    parser.Feed(head.data(), head.size());
+    arena60::RedisReply reply;
+    EXPECT_EQ(arena60::RespParser::Result::kIncomplete, parser.Next(reply));
+    EXPECT_TRUE(reply.elements.empty());
+}
+
+TEST(RedisClientTest, PipelinesRepliesInOrderAndCoalescesWrites) {
+    RespStubServer server;
+    auto client = ConnectTo(server);
+
+    std::vector<std::future<std::int64_t>> results;
+    for (int i = 0; i < 50; ++i) {
+        auto done = std::make_shared<std::promise<std::int64_t>>();
+        results.push_back(done->get_future());
+        client->AsyncExecute({{"ZADD", "scores", std::to_string(i), "p" + std::to_string(i)},
+                              {"ZCARD", "scores"}},
+                             [done](bool ok, std::vector<arena60::RedisReply> replies) {
+                                 done->set_value(ok && replies.size() == 2 ? replies[1].integer
+                                                                           : -1);
+                             });
+    }
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(i + 1, results[static_cast<std::size_t>(i)].get());
+    }
+    EXPECT_EQ(50u, client->PipelinesTotal());
+    EXPECT_EQ(100u, client->CommandsTotal());
+    EXPECT_LE(client->WritesTotal(), client->PipelinesTotal());
+    EXPECT_NE(std::string::npos, client->MetricsSnapshot().find("redis_pipelines_total 50"));
+}
+
+TEST(RedisClientTest, ReconnectsAfterServerDropsConnection) {
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    ASSERT_TRUE(client->ExecuteOne({"PING"}).has_value());
+
+    server.DropConnections();
+    for (int i = 0; i < 100 && client->IsConnected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(client->IsConnected());
+
+    const auto reply = client->ExecuteOne({"PING"});
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ("PONG", reply->str);
+    EXPECT_GE(client->ErrorsTotal(), 1u);
+}
+
+TEST(RedisClientTest, ConcurrentConnectsShareOneAttempt) {
+    RespStubServer server;
+    arena60::RedisClientOptions options;
+    options.port = server.port();
+    arena60::RedisClient client(options);
+
+    std::vector<std::future<bool>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.push_back(std::async(std::launch::async, [&client]() { return client.Connect(); }));
+    }
+    for (auto& result : results) {
+        EXPECT_TRUE(result.get());
+    }
+    ASSERT_TRUE(client.ExecuteOne({"PING"}).has_value());
+    EXPECT_EQ(1u, server.connections());
+}
+
+TEST(RedisClientTest, AsyncExecuteReconnectsAfterServerDropsConnection) {
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    ASSERT_TRUE(client->ExecuteOne({"PING"}).has_value());
+    server.DropConnections();
+    for (int i = 0; i < 100 && client->IsConnected(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_FALSE(client->IsConnected());
+
+    // Fire-and-forget writes issued while disconnected wait for the reconnect, not the floor.
+    client->AsyncExecute({{"ZADD", "board", "10", "alice"}}, nullptr);
+    std::promise<bool> done;
+    client->AsyncExecute({{"PING"}, {"PING"}},
+                         [&done](bool ok, std::vector<arena60::RedisReply> replies) {
+                             done.set_value(ok && replies.size() == 2);
+                         });
+    auto result = done.get_future();
+    ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(2)));
+    EXPECT_TRUE(result.get());
+    EXPECT_TRUE(client->IsConnected());
+    EXPECT_EQ(2u, server.connections());
+    const auto score = client->ExecuteOne({"ZSCORE", "board", "alice"});
+    ASSERT_TRUE(score.has_value());
+    EXPECT_EQ("10", score->str);
+}
+
+TEST(RedisClientTest, FailsFastDuringReconnectBackoff) {
+    std::uint16_t port = 0;
+    {
+        // Grab a free port and release it so nothing is listening there.
+        RespStubServer server;
+        port = server.port();
+    }
+    arena60::RedisClientOptions options;
+    options.port = port;
+    options.reconnect_backoff_min = std::chrono::seconds(30);
+    arena60::RedisClient client(options);
+    EXPECT_FALSE(client.Connect());
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(client.Connect());
+    EXPECT_FALSE(client.ExecuteOne({"PING"}).has_value());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_GE(client.ErrorsTotal(), 2u);
+}
+
+TEST(RedisLeaderboardStoreTest, BatchesUpsertsIntoOneCommand) {
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    arena60::RedisLeaderboardStore store(client);
+    const auto initial_version = store.Version();
+
+    const auto commands_before = client->CommandsTotal();
+    store.UpsertMany({{"alice", 1200}, {"bob", 1350}, {"carol", 1100}});
+    store.Upsert("alice", 1400);
+    store.EraseMany({"carol"});
+    // Three writes, one command each; reads below only queue refreshes behind them.
+    EXPECT_EQ(commands_before + 3, client->CommandsTotal());
+
+    std::vector<std::pair<std::string, int>> top;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while ((top = store.TopN(5)).size() != 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(2u, top.size());
+    EXPECT_EQ("alice", top[0].first);
+    EXPECT_EQ(1400, top[0].second);
+    EXPECT_EQ("bob", top[1].first);
+    EXPECT_EQ(1350, *store.Get("bob"));
+    EXPECT_FALSE(store.Get("carol").has_value());
+    EXPECT_EQ(2u, store.Size());
+    EXPECT_GT(store.Version(), initial_version);
+}
+
+TEST(RedisLeaderboardStoreTest, ReadsNeverWaitOnAnUnreachableServer) {
+    std::uint16_t port = 0;
+    {
+        RespStubServer server;
+        port = server.port();
+    }
+    arena60::RedisClientOptions options;
+    options.port = port;
+    auto client = std::make_shared<arena60::RedisClient>(options);
+    arena60::RedisLeaderboardStore store(client);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(store.TopN(10).empty());
+        EXPECT_EQ(0u, store.Size());
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(0u, store.Version());
+}
+
+TEST(RedisMatchQueueTest, OrdersByEloAndInsertionAndClaimsPairsAtomically) {
+    using std::chrono::steady_clock;
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    arena60::RedisMatchQueue queue(client);
+    const auto now = steady_clock::now();
+    queue.Upsert(arena60::MatchRequest{"alice", 1200, now, "eu"}, 1);
+    queue.Upsert(arena60::MatchRequest{"bob", 1100, now}, 2);
+    queue.Upsert(arena60::MatchRequest{"carol", 1200, now}, 3);
+    queue.Upsert(arena60::MatchRequest{"dave", 1300, now}, 4);
+
+    const auto ordered = queue.FetchOrdered();
+    ASSERT_EQ(4u, ordered.size());
+    EXPECT_EQ("bob", ordered[0].request.player_id());
+    EXPECT_EQ("alice", ordered[1].request.player_id());
+    EXPECT_EQ("eu", ordered[1].request.preferred_region());
+    EXPECT_NEAR(0.0, ordered[1].request.WaitSeconds(now), 1e-6);
+    EXPECT_EQ("carol", ordered[2].request.player_id());
+    EXPECT_EQ("bob:1100,alice:1200,carol:1200,dave:1300", queue.Snapshot());
+
+    EXPECT_TRUE(queue.Remove("dave"));
+    EXPECT_FALSE(queue.Remove("dave"));
+    const auto claimed = queue.ClaimPairs({{"alice", "carol"}, {"bob", "dave"}});
+    ASSERT_EQ(2u, claimed.size());
+    EXPECT_TRUE(claimed[0]);
+    EXPECT_FALSE(claimed[1]);
+    EXPECT_EQ(1u, queue.Size());
+    EXPECT_EQ("bob", queue.FetchOrdered().front().request.player_id());
+}
+
+TEST(RedisMatchQueueTest, MatchingPassCostsTwoRoundTrips) {
+    using std::chrono::steady_clock;
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    auto queue = std::make_shared<arena60::RedisMatchQueue>(client);
+    arena60::Matchmaker matchmaker(queue);
+    const auto now = steady_clock::now();
+    for (int i = 0; i < 40; ++i) {
+        matchmaker.Enqueue(arena60::MatchRequest{"p" + std::to_string(i), 1000 + i, now});
+    }
+
+    const auto before = client->PipelinesTotal();
+    const auto matches = matchmaker.RunMatching(now);
+    EXPECT_EQ(20u, matches.size());
+    EXPECT_EQ(2u, client->PipelinesTotal() - before);
+    EXPECT_EQ(0u, queue->Size());
+}
+
+TEST(RedisMatchQueueTest, RunsScriptsByDigestAndReloadsAfterFlush) {
+    using std::chrono::steady_clock;
+    RespStubServer server;
+    auto client = ConnectTo(server);
+    arena60::RedisMatchQueue queue(client);
+    const auto now = steady_clock::now();
+    queue.Upsert(arena60::MatchRequest{"alice", 1200, now}, 1);
+    queue.Upsert(arena60::MatchRequest{"bob", 1210, now}, 2);
+    ASSERT_EQ(2u, queue.FetchOrdered().size());
+
+    server.FlushScripts();
+    const auto claimed = queue.ClaimPairs({{"alice", "bob"}});
+    ASSERT_EQ(1u, claimed.size());
+    EXPECT_TRUE(claimed[0]);
+    EXPECT_TRUE(queue.FetchOrdered().empty());
+    // Script bodies went over the wire only in SCRIPT LOAD, never in EVAL.
+    EXPECT_EQ(0u, server.evals());
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena60/storage/session_event_writer.h"
+
+namespace {
+using namespace std::chrono_literals;
+
+class RecordingSink : public arena60::SessionEventSink {
+   public:
+    explicit RecordingSink(int failures_before_success = 0)
+        : failures_remaining_(failures_before_success) {}
+
+    bool WriteSessionEvents(const std::vector<arena60::SessionEvent>& events) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        ++attempts_;
+        if (failures_remaining_ != 0) {
+            if (failures_remaining_ > 0) {
+                --failures_remaining_;
+            }
+            return false;
+        }
+        batch_sizes_.push_back(events.size());
+        events_.insert(events_.end(), events.begin(), events.end());
+        return true;
+    }
+
+    std::vector<arena60::SessionEvent> events() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return events_;
+    }
+    std::vector<std::size_t> batch_sizes() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return batch_sizes_;
+    }
+    int attempts() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return attempts_;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    int failures_remaining_;
+    int attempts_{0};
+    std::vector<std::size_t> batch_sizes_;
+    std::vector<arena60::SessionEvent> events_;
+};
+}  // namespace
+
+TEST(SessionEventWriterTest, FlushesOnBatchSizeAndInterval) {
+    auto sink = std::make_shared<RecordingSink>();
+    arena60::SessionEventWriterOptions options;
+    options.max_batch_size = 4;
+    options.flush_interval = 20ms;
+    arena60::SessionEventWriter writer(sink, options);
+    writer.Start();
+
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_TRUE(writer.Enqueue("player-" + std::to_string(i), i % 2 == 0 ? "start" : "end"));
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (writer.EventsWritten() < 9 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+    writer.Stop();
+
+    const auto events = sink->events();
+    ASSERT_EQ(9u, events.size());
+    EXPECT_EQ("player-0", events.front().player_id);
+    EXPECT_EQ("start", events.front().event_type);
+    EXPECT_EQ("player-8", events.back().player_id);
+    for (const auto size : sink->batch_sizes()) {
+        EXPECT_LE(size, 4u);
+    }
+    EXPECT_EQ(0u, writer.EventsDropped());
+}
+
+TEST(SessionEventWriterTest, RetriesWithBackoffThenSucceeds) {
+    auto sink = std::make_shared<RecordingSink>(2);
+    arena60::SessionEventWriterOptions options;
+    options.flush_interval = 5ms;
+    options.initial_backoff = 5ms;
+    arena60::SessionEventWriter writer(sink, options);
+    writer.Start();
+    writer.Enqueue("player", "start");
+
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (writer.EventsWritten() < 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+    writer.Stop();
+
+    EXPECT_EQ(1u, writer.EventsWritten());
+    EXPECT_EQ(2u, writer.RetriesTotal());
+    EXPECT_EQ(3, sink->attempts());
+}
+
+TEST(SessionEventWriterTest, AccountsForDroppedEvents) {
+    auto sink = std::make_shared<RecordingSink>(-1);
+    arena60::SessionEventWriterOptions options;
+    options.queue_capacity = 2;
+    options.max_retries = 1;
+    options.flush_interval = 5ms;
+    options.initial_backoff = 1ms;
+    arena60::SessionEventWriter writer(sink, options);
+
+    // Not started yet, so the third event overflows the queue.
+    EXPECT_TRUE(writer.Enqueue("a", "start"));
+    EXPECT_TRUE(writer.Enqueue("b", "start"));
+    EXPECT_FALSE(writer.Enqueue("c", "start"));
+
+    writer.Start();
+    writer.Stop();
+
+    EXPECT_EQ(0u, writer.EventsWritten());
+    EXPECT_EQ(3u, writer.EventsDropped());
+    const auto metrics = writer.MetricsSnapshot();
+    EXPECT_NE(metrics.find("session_events_dropped_total{reason=\"queue_full\"} 1"),
+              std::string::npos);
+    EXPECT_NE(metrics.find("session_events_dropped_total{reason=\"write_failed\"} 2"),
+              std::string::npos);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arena60/game/game_session.h"
+#include "arena60/game/static_geometry.h"
+
+namespace {
+
+// Reference answer: slab test against every grown box, skipping boxes the start point is in.
+double BruteForceFraction(const std::vector<arena60::Aabb>& boxes, double x, double y, double dx,
+                          double dy, double radius) {
+    double best = 1.0;
+    for (const auto& box : boxes) {
+        const double min_x = box.min_x - radius;
+        const double max_x = box.max_x + radius;
+        const double min_y = box.min_y - radius;
+        const double max_y = box.max_y + radius;
+        if (x > min_x && x < max_x && y > min_y && y < max_y) {
+            continue;
+        }
+        double enter = -std::numeric_limits<double>::infinity();
+        double exit = std::numeric_limits<double>::infinity();
+        const double origin[2] = {x, y};
+        const double delta[2] = {dx, dy};
+        const double lo[2] = {min_x, min_y};
+        const double hi[2] = {max_x, max_y};
+        bool miss = false;
+        for (int axis = 0; axis < 2 && !miss; ++axis) {
+            if (delta[axis] == 0.0) {
+                miss = origin[axis] < lo[axis] || origin[axis] > hi[axis];
+                continue;
+            }
+            double t0 = (lo[axis] - origin[axis]) / delta[axis];
+            double t1 = (hi[axis] - origin[axis]) / delta[axis];
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            enter = std::max(enter, t0);
+            exit = std::min(exit, t1);
+        }
+        if (!miss && enter <= exit && enter >= 0.0 && enter < best && exit > 0.0) {
+            best = enter;
+        }
+    }
+    return best;
+}
+
+void Move(arena60::GameSession& session, const std::string& player_id, std::uint64_t sequence,
+          bool right, bool down, double seconds) {
+    arena60::MovementInput input;
+    input.sequence = sequence;
+    input.right = right;
+    input.down = down;
+    input.mouse_x = 1.0;
+    session.ApplyInput(player_id, input, seconds);
+}
+
+}  // namespace
+
+TEST(StaticGeometryTest, LoadsBoxesAndBoundsAndRejectsMalformedLines) {
+    std::istringstream map(
+        "# warehouse\n"
+        "bounds -50 -50 50 50\n"
+        "\n"
+        "box 2 -1 3 1   # crate\n");
+    arena60::StaticGeometry geometry;
+    ASSERT_TRUE(geometry.Load(map));
+    EXPECT_EQ(5u, geometry.size());
+    EXPECT_TRUE(geometry.OverlapsCircle(2.5, 0.0, 0.1));
+    EXPECT_TRUE(geometry.OverlapsCircle(50.5, 0.0, 0.1));
+    EXPECT_FALSE(geometry.OverlapsCircle(0.0, 0.0, 0.5));
+
+    std::istringstream reversed("box 3 0 2 1\n");
+    EXPECT_FALSE(geometry.Load(reversed));
+    std::istringstream unknown("circle 0 0 1\n");
+    EXPECT_FALSE(geometry.Load(unknown));
+    EXPECT_EQ(5u, geometry.size());  // failed loads keep the previous map
+}
+
+TEST(StaticGeometryTest, SweepReportsFirstContactAndFaceNormal) {
+    arena60::StaticGeometry geometry({{2.0, -1.0, 3.0, 1.0}, {5.0, -1.0, 6.0, 1.0}});
+    const auto hit = geometry.SweepCircle(0.0, 0.0, 10.0, 0.0, 0.5);
+    ASSERT_TRUE(hit.hit);
+    EXPECT_NEAR(0.15, hit.fraction, 1e-12);  // 1.5 m of the 10 m move
+    EXPECT_EQ(-1.0, hit.normal_x);
+    EXPECT_EQ(0.0, hit.normal_y);
+
+    EXPECT_FALSE(geometry.SweepCircle(0.0, 2.0, 10.0, 0.0, 0.5).hit);
+    // Starting inside a box ignores it so the mover can get out.
+    EXPECT_FALSE(geometry.SweepCircle(2.5, 0.0, -2.0, 0.0, 0.1).hit);
+}
+
+TEST(StaticGeometryTest, BvhMatchesBruteForceOnRandomSweeps) {
+    std::mt19937 rng(37);
+    std::uniform_real_distribution<double> position(-200.0, 200.0);
+    std::uniform_real_distribution<double> extent(0.2, 6.0);
+    std::vector<arena60::Aabb> boxes;
+    for (int i = 0; i < 2000; ++i) {
+        const double x = position(rng);
+        const double y = position(rng);
+        boxes.push_back({x, y, x + extent(rng), y + extent(rng)});
+    }
+    const arena60::StaticGeometry geometry(boxes);
+    EXPECT_GT(geometry.node_count(), boxes.size() / 4);
+
+    std::uniform_real_distribution<double> move(-40.0, 40.0);
+    for (int i = 0; i < 2000; ++i) {
+        const double x = position(rng);
+        const double y = position(rng);
+        const double dx = i % 7 == 0 ? 0.0 : move(rng);
+        const double dy = move(rng);
+        const double radius = (i % 3) * 0.25;
+        const auto hit = geometry.SweepCircle(x, y, dx, dy, radius);
+        const double expected = BruteForceFraction(boxes, x, y, dx, dy, radius);
+        ASSERT_EQ(expected < 1.0, hit.hit) << "sweep " << i;
+        EXPECT_DOUBLE_EQ(expected, hit.fraction) << "sweep " << i;
+    }
+}
+
+TEST(StaticGeometryTest, WallsStopAndSlidePlayers) {
+    arena60::GameSession session(60.0);
+    session.SetStaticGeometry(std::make_shared<arena60::StaticGeometry>(
+        std::vector<arena60::Aabb>{{1.0, -5.0, 2.0, 5.0}}));
+    session.UpsertPlayer("runner");
+
+    Move(session, "runner", 1, true, false, 1.0);  // 5 m east into a wall 1 m away
+    auto runner = session.GetPlayer("runner");
+    EXPECT_NEAR(0.5, runner.x, 1e-3);  // radius 0.5 short of the face
+    EXPECT_LT(runner.x, 0.5);
+    EXPECT_EQ(0.0, runner.y);
+
+    Move(session, "runner", 2, true, true, 1.0);  // diagonal: slides south along the wall
+    runner = session.GetPlayer("runner");
+    EXPECT_LT(runner.x, 0.5);
+    EXPECT_NEAR(5.0 / std::sqrt(2.0), runner.y, 1e-3);
+}
+
+TEST(StaticGeometryTest, WallsAbsorbProjectiles) {
+    arena60::GameSession session(60.0);
+    session.SetStaticGeometry(std::make_shared<arena60::StaticGeometry>(
+        std::vector<arena60::Aabb>{{3.0, -2.0, 3.2, 2.0}}));
+    session.UpsertPlayer("attacker");
+    session.UpsertPlayer("defender");
+    // Walk the defender around the wall's south end to (6, 0), directly behind it.
+    Move(session, "defender", 1, false, true, 0.6);
+    Move(session, "defender", 2, true, false, 1.2);
+    arena60::MovementInput north;
+    north.sequence = 3;
+    north.up = true;
+    north.mouse_x = 1.0;
+    session.ApplyInput("defender", north, 0.6);
+    ASSERT_NEAR(6.0, session.GetPlayer("defender").x, 1e-9);
+    ASSERT_NEAR(0.0, session.GetPlayer("defender").y, 1e-9);
+
+    arena60::MovementInput fire;
+    fire.sequence = 1;
+    fire.mouse_x = 1.0;
+    fire.fire = true;
+    session.ApplyInput("attacker", fire, 1.0 / 60.0);
+    for (std::uint64_t tick = 1; tick < 120 && session.ActiveProjectileCount() > 0; ++tick) {
+        session.Tick(tick, 1.0 / 60.0);
+    }
+    EXPECT_EQ(100, session.GetPlayer("defender").health);
+    EXPECT_NE(std::string::npos, session.MetricsSnapshot().find("projectiles_blocked_total 1"));
+}
+
+TEST(StaticGeometryTest, ProjectilesInterceptEachOtherWhenRulesAllow) {
+    arena60::RuntimeRules rules;
+    rules.projectiles_collide = true;
+    arena60::TunableGameSession session(60.0, 0, rules);
+    session.UpsertPlayer("west");
+    session.UpsertPlayer("east");
+    arena60::MovementInput move;
+    move.sequence = 1;
+    move.right = true;
+    move.mouse_x = 1.0;
+    session.ApplyInput("east", move, 2.0);  // 10 m apart
+
+    arena60::MovementInput fire;
+    fire.sequence = 2;
+    fire.fire = true;
+    fire.mouse_x = 1.0;
+    session.ApplyInput("west", fire, 1.0 / 60.0);
+    fire.mouse_x = -1.0;
+    session.ApplyInput("east", fire, 1.0 / 60.0);
+
+    for (std::uint64_t tick = 1; tick < 60 && session.ActiveProjectileCount() > 0; ++tick) {
+        session.Tick(tick, 1.0 / 60.0);
+    }
+    EXPECT_EQ(100, session.GetPlayer("west").health);
+    EXPECT_EQ(100, session.GetPlayer("east").health);
+    EXPECT_NE(std::string::npos,
+              session.MetricsSnapshot().find("projectiles_intercepted_total 2"));
+}
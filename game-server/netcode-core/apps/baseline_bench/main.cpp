@@ -0,0 +1,357 @@
+// Snapshot bandwidth with and without acked baselines: a server UdpTransport
+// steps a core::World at the tick rate, with two scripted players, and sends
+// each tick's snapshot to --clients clients, each behind its own local UDP
+// proxy that delays datagrams by half the round trip and drops a share of
+// them. Clients decode every snapshot with a SnapshotDecoder and send
+// unreliable inputs at the tick rate, which carry their acks.
+//
+// "keyframe" mode is the fixed scheme: SnapshotGenerator::encode() sends a
+// keyframe every 20 ticks and deltas against it, so a lost keyframe leaves
+// the deltas after it undecodable. "acked" mode sends each client a delta
+// against the newest snapshot its transport acked (send_acked() and the
+// delivery handler), and a keyframe only when there is none. The bench
+// reports server bytes per client, snapshot sizes, the keyframe share,
+// snapshots that failed to decode and encodings made per tick.
+
+#include "core/world.h"
+#include "link_options.h"
+#include "lossy_proxy.h"
+#include "net/udp/udp_transport.h"
+#include "sync/snapshot.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Snapshot frame: tick, base tick, keyframe flag, then the codec payload.
+constexpr std::size_t kFrameHeaderSize = 2 * sizeof(std::uint64_t) + 1;
+
+struct BenchConfig {
+  bench::LinkOptions link{{0.01, 0.05, 0.10}, {40.0}};
+  std::size_t clients{4};
+  double seconds{10.0};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  bench::print_link_usage(BenchConfig{}.link);
+  std::cout << "  --clients N         Clients (default: 4)\n";
+  std::cout << "  --seconds S         Length of each run (default: 10)\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--clients" && i + 1 < argc) {
+      config.clients = std::stoul(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (!bench::parse_link_option(argc, argv, i, config.link)) {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  config.clients = std::max<std::size_t>(config.clients, 1);
+  return config;
+}
+
+// A player who moves toward where the ball is, with a per-rally aiming error
+// that is sometimes large enough to miss, and who idles between rallies.
+class ScriptedPlayer {
+public:
+  ScriptedPlayer(core::PlayerSide side, std::uint32_t seed)
+      : side_(side), rng_(seed) {}
+
+  int direction(const core::WorldState &state) {
+    const bool approaching = side_ == core::PlayerSide::Left
+                                 ? state.ball_vx < 0.0
+                                 : state.ball_vx > 0.0;
+    if (approaching != was_approaching_) {
+      was_approaching_ = approaching;
+      aim_error_ = aim_(rng_);
+      idle_ = !approaching && idle_chance_(rng_) < 0.5;
+    }
+    if (idle_) {
+      return 0;
+    }
+    const double paddle_y = side_ == core::PlayerSide::Left
+                                ? state.left_paddle_y
+                                : state.right_paddle_y;
+    const double target = state.ball_y + aim_error_;
+    if (target > paddle_y + 6.0) {
+      return 1;
+    }
+    if (target < paddle_y - 6.0) {
+      return -1;
+    }
+    return 0;
+  }
+
+private:
+  core::PlayerSide side_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> aim_{0.0, 40.0};
+  std::uniform_real_distribution<double> idle_chance_{0.0, 1.0};
+  double aim_error_{0.0};
+  bool was_approaching_{false};
+  bool idle_{false};
+};
+
+enum class Mode { Keyframe, Acked };
+
+const char *mode_name(Mode mode) {
+  return mode == Mode::Keyframe ? "keyframe" : "acked";
+}
+
+net::PacketBuffer make_frame(net::udp::UdpTransport &transport,
+                             const mini::sync::EncodedSnapshot &encoded) {
+  net::PacketBuffer frame = transport.allocate_send_buffer();
+  frame.resize(kFrameHeaderSize + encoded.payload.size());
+  std::uint8_t *out = frame.data();
+  std::memcpy(out, &encoded.tick, sizeof(encoded.tick));
+  std::memcpy(out + sizeof(encoded.tick), &encoded.base_tick,
+              sizeof(encoded.base_tick));
+  out[2 * sizeof(std::uint64_t)] = encoded.is_keyframe ? 1 : 0;
+  std::copy(encoded.payload.begin(), encoded.payload.end(),
+            out + kFrameHeaderSize);
+  return frame;
+}
+
+// One client: its proxy and transport, its decoder, and the baseline the
+// server keeps for it. Receive and delivery handlers run on the io thread.
+struct Client {
+  std::unique_ptr<bench::LossyProxy> proxy;
+  std::unique_ptr<net::udp::UdpTransport> transport;
+  mini::sync::SnapshotDecoder decoder;
+  std::uint64_t decoded{0};
+  std::uint64_t decode_failures{0};
+
+  std::mutex baseline_mutex;
+  std::optional<std::uint64_t> acked_tick;
+
+  void receive(net::PacketBuffer &&payload) {
+    if (payload.size() < kFrameHeaderSize) {
+      ++decode_failures;
+      return;
+    }
+    mini::sync::EncodedSnapshot snapshot;
+    std::memcpy(&snapshot.tick, payload.data(), sizeof(snapshot.tick));
+    std::memcpy(&snapshot.base_tick, payload.data() + sizeof(snapshot.tick),
+                sizeof(snapshot.base_tick));
+    snapshot.is_keyframe = payload.data()[2 * sizeof(std::uint64_t)] != 0;
+    snapshot.payload.assign(payload.data() + kFrameHeaderSize,
+                            payload.data() + payload.size());
+    try {
+      decoder.apply(snapshot);
+      ++decoded;
+    } catch (const std::exception &) {
+      ++decode_failures;
+    }
+  }
+};
+
+struct RunResult {
+  std::uint64_t ticks{0};
+  std::uint64_t snapshots{0};
+  std::uint64_t keyframes{0};
+  std::uint64_t payload_bytes{0};
+  std::uint64_t encodings{0};
+  std::uint64_t bytes_sent{0};
+  std::uint64_t decoded{0};
+  std::uint64_t decode_failures{0};
+  double seconds{0.0};
+};
+
+RunResult run(const BenchConfig &config, Mode mode, double loss,
+              double rtt_ms) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  const boost::asio::ip::udp::endpoint loopback(
+      boost::asio::ip::make_address("127.0.0.1"), 0);
+
+  net::udp::UdpTransport server(io, loopback);
+  std::vector<std::unique_ptr<Client>> clients;
+  for (std::size_t i = 0; i < config.clients; ++i) {
+    auto client = std::make_unique<Client>();
+    client->proxy = std::make_unique<bench::LossyProxy>(
+        server.local_endpoint(), rtt_ms / 2.0, config.link.jitter_ms, loss,
+        static_cast<std::uint32_t>(12345 + i));
+    client->transport =
+        std::make_unique<net::udp::UdpTransport>(io, loopback);
+    Client *raw = client.get();
+    client->transport->start(
+        [raw](const net::ITransport::Endpoint &, net::PacketBuffer &&payload) {
+          raw->receive(std::move(payload));
+        });
+    clients.push_back(std::move(client));
+  }
+
+  server.set_delivery_handler(
+      [&clients](const net::ITransport::Endpoint &endpoint,
+                 std::uint64_t tick) {
+        for (const auto &client : clients) {
+          if (client->proxy->back_endpoint() != endpoint) {
+            continue;
+          }
+          std::lock_guard<std::mutex> lock(client->baseline_mutex);
+          if (!client->acked_tick || tick > *client->acked_tick) {
+            client->acked_tick = tick;
+          }
+          return;
+        }
+      });
+  server.start([](const net::ITransport::Endpoint &, net::PacketBuffer &&) {});
+  std::thread io_thread([&io]() { io.run(); });
+
+  core::World world;
+  ScriptedPlayer left(core::PlayerSide::Left, 1);
+  ScriptedPlayer right(core::PlayerSide::Right, 2);
+  mini::sync::SnapshotGenerator generator(20, 120);
+  const double dt = 1.0 / config.link.tick_hz;
+  const auto tick = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(dt));
+  const std::vector<std::uint8_t> input(16, 0x11);
+
+  RunResult result;
+  const auto started = Clock::now();
+  const auto deadline =
+      started + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(config.seconds));
+  auto next_tick = started;
+  while (Clock::now() < deadline) {
+    const auto now = Clock::now();
+    if (now >= next_tick) {
+      const core::WorldState current = world.snapshot();
+      world.set_player_input(core::PlayerSide::Left, left.direction(current));
+      world.set_player_input(core::PlayerSide::Right,
+                             right.direction(current));
+      const core::WorldState state = world.step(dt);
+      ++result.ticks;
+
+      if (mode == Mode::Keyframe) {
+        const auto encoded = generator.encode(state);
+        for (const auto &client : clients) {
+          server.send(client->proxy->back_endpoint(),
+                      make_frame(server, encoded), false);
+          ++result.snapshots;
+          result.keyframes += encoded.is_keyframe ? 1 : 0;
+          result.payload_bytes += encoded.payload.size();
+        }
+        ++result.encodings;
+      } else {
+        generator.begin_tick(state);
+        for (const auto &client : clients) {
+          std::optional<std::uint64_t> baseline;
+          {
+            std::lock_guard<std::mutex> lock(client->baseline_mutex);
+            baseline = client->acked_tick;
+          }
+          const auto &encoded = generator.encode_for(baseline);
+          server.send_acked(client->proxy->back_endpoint(),
+                            make_frame(server, encoded), encoded.tick);
+          ++result.snapshots;
+          result.keyframes += encoded.is_keyframe ? 1 : 0;
+          result.payload_bytes += encoded.payload.size();
+        }
+        result.encodings += generator.tick_encodings();
+      }
+
+      for (const auto &client : clients) {
+        client->transport->send(client->proxy->front_endpoint(), input,
+                                false);
+      }
+      next_tick = std::max(next_tick + tick, now);
+    }
+    server.update();
+    for (const auto &client : clients) {
+      client->transport->update();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  result.seconds =
+      std::chrono::duration<double>(Clock::now() - started).count();
+
+  // Let the last snapshots land before counting what was decoded.
+  std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(
+      rtt_ms + config.link.jitter_ms));
+  result.bytes_sent = server.sample_counters().bytes_sent_total;
+  server.stop();
+  for (const auto &client : clients) {
+    client->transport->stop();
+  }
+  work.reset();
+  io.stop();
+  io_thread.join();
+
+  for (const auto &client : clients) {
+    result.decoded += client->decoded;
+    result.decode_failures += client->decode_failures;
+  }
+  return result;
+}
+
+double ratio(std::uint64_t value, std::uint64_t total) {
+  return total > 0 ? static_cast<double>(value) / static_cast<double>(total)
+                   : 0.0;
+}
+
+void report(const BenchConfig &config, Mode mode, const RunResult &result) {
+  const double per_client_bps =
+      static_cast<double>(result.bytes_sent) /
+      std::max(result.seconds, 1e-9) / static_cast<double>(config.clients);
+  std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(8)
+            << mode_name(mode) << ": " << per_client_bps
+            << " B/s per client, snapshot payload "
+            << ratio(result.payload_bytes, result.snapshots) << " B, "
+            << ratio(result.keyframes, result.snapshots) * 100.0
+            << "% keyframes; decoded " << result.decoded << ", "
+            << result.decode_failures << " failed; "
+            << std::setprecision(2) << ratio(result.encodings, result.ticks)
+            << " encodings per tick for " << config.clients << " clients\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  std::cout << config.clients << " clients, " << config.seconds
+            << " s per run at " << config.link.tick_hz
+            << " Hz, jitter up to " << config.link.jitter_ms << " ms\n";
+  for (const double rtt_ms : config.link.rtts_ms) {
+    for (const double loss : config.link.losses) {
+      std::cout << std::fixed << std::setprecision(1) << "rtt " << rtt_ms
+                << " ms, loss " << loss * 100.0 << "%:\n";
+      for (const Mode mode : {Mode::Keyframe, Mode::Acked}) {
+        report(config, mode, run(config, mode, loss, rtt_ms));
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include "link_options.h"
+
+#include <iostream>
+#include <sstream>
+
+namespace bench {
+
+namespace {
+std::string format_list(const std::vector<double> &values) {
+  std::ostringstream out;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    out << (i > 0 ? "," : "") << values[i];
+  }
+  return out.str();
+}
+} // namespace
+
+std::vector<double> parse_list(const std::string &text) {
+  std::vector<double> values;
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    values.push_back(std::stod(item));
+  }
+  return values;
+}
+
+bool parse_link_option(int argc, char **argv, int &i, LinkOptions &options) {
+  const std::string arg = argv[i];
+  if (i + 1 >= argc) {
+    return false;
+  }
+  if (arg == "--loss") {
+    options.losses = parse_list(argv[++i]);
+  } else if (arg == "--rtt") {
+    options.rtts_ms = parse_list(argv[++i]);
+  } else if (arg == "--jitter") {
+    options.jitter_ms = std::stod(argv[++i]);
+  } else if (arg == "--tick") {
+    options.tick_hz = std::stod(argv[++i]);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void print_link_usage(const LinkOptions &defaults) {
+  std::cout << "  --loss RATE[,RATE]  Drop rates each way (default: "
+            << format_list(defaults.losses) << ")\n";
+  std::cout << "  --rtt MS[,MS]       Round trips (default: "
+            << format_list(defaults.rtts_ms) << ")\n";
+  std::cout << "  --jitter MS         Extra one-way delay, up to (default: "
+            << defaults.jitter_ms << ")\n";
+  std::cout << "  --tick HZ           Send rate (default: " << defaults.tick_hz
+            << ")\n";
+}
+
+} // namespace bench
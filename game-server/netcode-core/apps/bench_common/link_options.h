@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// The emulated link of the benches that run through a LossyProxy. Each bench
+// runs every loss rate against every round trip.
+struct LinkOptions {
+  std::vector<double> losses{0.05};
+  std::vector<double> rtts_ms{20.0};
+  double jitter_ms{2.0};
+  double tick_hz{60.0};
+};
+
+// Comma-separated numbers, as in "0,0.05".
+std::vector<double> parse_list(const std::string &text);
+
+// Consumes argv[i] and its value when it is one of the link options, leaving
+// i on the value; returns false for anything else.
+bool parse_link_option(int argc, char **argv, int &i, LinkOptions &options);
+
+// Help lines for the link options, with the calling bench's defaults.
+void print_link_usage(const LinkOptions &defaults);
+
+} // namespace bench
@@ -0,0 +1,79 @@
+#include "lossy_proxy.h"
+
+#include <algorithm>
+#include <array>
+
+namespace bench {
+
+namespace {
+boost::asio::ip::udp::endpoint loopback() {
+  return {boost::asio::ip::make_address("127.0.0.1"), 0};
+}
+} // namespace
+
+LossyProxy::LossyProxy(const boost::asio::ip::udp::endpoint &server,
+                       double one_way_ms, double jitter_ms, double loss,
+                       std::uint32_t seed)
+    : front_(io_, loopback()), back_(io_, loopback()), server_(server),
+      one_way_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double, std::milli>(one_way_ms))),
+      jitter_ms_(jitter_ms), loss_(loss), rng_(seed) {
+  front_.non_blocking(true);
+  back_.non_blocking(true);
+  thread_ = std::thread([this]() { run(); });
+}
+
+LossyProxy::~LossyProxy() {
+  stop_.store(true);
+  thread_.join();
+}
+
+void LossyProxy::receive_from(boost::asio::ip::udp::socket &socket,
+                              bool to_server) {
+  std::array<std::uint8_t, 2048> buffer{};
+  while (true) {
+    boost::asio::ip::udp::endpoint sender;
+    boost::system::error_code ec;
+    const std::size_t size =
+        socket.receive_from(boost::asio::buffer(buffer), sender, 0, ec);
+    if (ec) {
+      return;
+    }
+    if (to_server) {
+      client_ = sender;
+    }
+    if (chance_(rng_) < loss_) {
+      continue;
+    }
+    const auto jitter = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(chance_(rng_) * jitter_ms_));
+    queue_.push_back(Delayed{Clock::now() + one_way_ + jitter, to_server,
+                             {buffer.begin(), buffer.begin() + size}});
+  }
+}
+
+void LossyProxy::run() {
+  while (!stop_.load()) {
+    receive_from(front_, true);
+    receive_from(back_, false);
+    // Jitter may reorder packets, as it would on a real path.
+    std::stable_sort(queue_.begin(), queue_.end(),
+                     [](const Delayed &lhs, const Delayed &rhs) {
+                       return lhs.deliver_at < rhs.deliver_at;
+                     });
+    const auto now = Clock::now();
+    while (!queue_.empty() && queue_.front().deliver_at <= now) {
+      const Delayed &packet = queue_.front();
+      boost::system::error_code ec;
+      if (packet.to_server) {
+        back_.send_to(boost::asio::buffer(packet.data), server_, 0, ec);
+      } else {
+        front_.send_to(boost::asio::buffer(packet.data), client_, 0, ec);
+      }
+      queue_.pop_front();
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+}
+
+} // namespace bench
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Forwards between one client and the server: the client talks to the front
+// socket, the server sees the back socket. Datagrams wait in a queue until
+// their delivery time, unless they were dropped on the way in. Runs on its
+// own thread from construction to destruction.
+class LossyProxy {
+public:
+  LossyProxy(const boost::asio::ip::udp::endpoint &server, double one_way_ms,
+             double jitter_ms, double loss, std::uint32_t seed = 12345);
+  ~LossyProxy();
+
+  LossyProxy(const LossyProxy &) = delete;
+  LossyProxy &operator=(const LossyProxy &) = delete;
+
+  boost::asio::ip::udp::endpoint front_endpoint() const {
+    return front_.local_endpoint();
+  }
+  boost::asio::ip::udp::endpoint back_endpoint() const {
+    return back_.local_endpoint();
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Delayed {
+    Clock::time_point deliver_at;
+    bool to_server{false};
+    std::vector<std::uint8_t> data;
+  };
+
+  void receive_from(boost::asio::ip::udp::socket &socket, bool to_server);
+  void run();
+
+  boost::asio::io_context io_;
+  boost::asio::ip::udp::socket front_;
+  boost::asio::ip::udp::socket back_;
+  boost::asio::ip::udp::endpoint server_;
+  boost::asio::ip::udp::endpoint client_;
+  const Clock::duration one_way_;
+  const double jitter_ms_;
+  const double loss_;
+  std::mt19937 rng_;
+  std::uniform_real_distribution<double> chance_{0.0, 1.0};
+  std::deque<Delayed> queue_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+} // namespace bench
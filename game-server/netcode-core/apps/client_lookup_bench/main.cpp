@@ -0,0 +1,140 @@
+// Per-packet client lookup cost with many clients: the endpoint string keyed
+// unordered_map UdpTransport used to build on every packet against the packed
+// EndpointKey in a FlatMap.
+
+#include "net/endpoint_key.h"
+#include "net/flat_map.h"
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using ClientState = net::udp::UdpTransport::ClientState;
+using Endpoint = boost::asio::ip::udp::endpoint;
+
+struct BenchConfig {
+  std::size_t clients{10000};
+  std::size_t lookups{10000000};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  std::cout << "  --clients N     Clients in the table (default: 10000)\n";
+  std::cout << "  --lookups N     Lookups per variant (default: 10000000)\n";
+  std::cout << "  --help          Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--clients" && i + 1 < argc) {
+      config.clients = std::stoul(argv[++i]);
+    } else if (arg == "--lookups" && i + 1 < argc) {
+      config.lookups = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  return config;
+}
+
+// The key UdpTransport built per packet before it switched to EndpointKey.
+std::string endpoint_string(const Endpoint &endpoint) {
+  boost::system::error_code ec;
+  const std::string address = endpoint.address().to_string(ec);
+  if (ec) {
+    return std::string{"invalid:"} + std::to_string(endpoint.port());
+  }
+  return address + ':' + std::to_string(endpoint.port());
+}
+
+// Clients behind a few NATs: addresses from a /16 with ephemeral ports.
+std::vector<Endpoint> make_endpoints(std::size_t count, std::mt19937 &rng) {
+  std::uniform_int_distribution<std::uint32_t> host(0, 0xffff);
+  std::uniform_int_distribution<std::uint32_t> port(32768, 60999);
+  std::unordered_map<std::string, bool> seen;
+  std::vector<Endpoint> endpoints;
+  while (endpoints.size() < count) {
+    const Endpoint endpoint(boost::asio::ip::address_v4(0x0a000000u | host(rng)),
+                            static_cast<std::uint16_t>(port(rng)));
+    if (seen.emplace(endpoint_string(endpoint), true).second) {
+      endpoints.push_back(endpoint);
+    }
+  }
+  return endpoints;
+}
+
+template <typename Lookup>
+double nanoseconds_per_lookup(const std::vector<Endpoint> &endpoints,
+                              const std::vector<std::uint32_t> &order,
+                              std::size_t lookups, Lookup &&lookup) {
+  std::uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < lookups; ++i) {
+    checksum += lookup(endpoints[order[i % order.size()]]);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  if (checksum != lookups) {
+    std::cerr << "lookup missed: " << checksum << " of " << lookups << "\n";
+    std::exit(1);
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         static_cast<double>(lookups);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  std::mt19937 rng(42);
+  const std::vector<Endpoint> endpoints = make_endpoints(config.clients, rng);
+
+  // Packets arrive from clients in no particular order.
+  std::vector<std::uint32_t> order(1 << 20);
+  std::uniform_int_distribution<std::uint32_t> pick(
+      0, static_cast<std::uint32_t>(endpoints.size() - 1));
+  for (auto &index : order) {
+    index = pick(rng);
+  }
+
+  std::unordered_map<std::string, ClientState> by_string;
+  net::FlatMap<net::EndpointKey, ClientState, net::EndpointKeyHash> by_key;
+  for (const auto &endpoint : endpoints) {
+    by_string[endpoint_string(endpoint)].endpoint = endpoint;
+    by_key.try_emplace(net::EndpointKey::from(endpoint)).first->endpoint =
+        endpoint;
+  }
+
+  const double string_ns = nanoseconds_per_lookup(
+      endpoints, order, config.lookups, [&](const Endpoint &endpoint) {
+        return by_string.count(endpoint_string(endpoint));
+      });
+  const double key_ns = nanoseconds_per_lookup(
+      endpoints, order, config.lookups, [&](const Endpoint &endpoint) {
+        return by_key.find(net::EndpointKey::from(endpoint)) ? 1u : 0u;
+      });
+
+  std::cout << std::fixed << std::setprecision(1) << config.clients
+            << " clients: endpoint string + unordered_map " << string_ns
+            << " ns/lookup, EndpointKey + FlatMap " << key_ns
+            << " ns/lookup (" << string_ns / key_ns << "x)\n";
+  return 0;
+}
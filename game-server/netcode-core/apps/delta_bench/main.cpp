@@ -0,0 +1,260 @@
+// Snapshot encoding over recorded pong sessions: each session is a core::World
+// stepped at the tick rate with two scripted players that chase the ball, hold
+// still now and then and sometimes misjudge it, so the recording has idle
+// paddles, bounces and goals. The states are then encoded the way
+// SnapshotGenerator sends them (a keyframe every --keyframe-interval ticks,
+// deltas against it in between) and decoded again. The bench reports bytes
+// per snapshot against the previous full-precision format (34-byte keyframes,
+// 28-byte deltas), encode and decode time, and the largest quantization error.
+
+#include "core/world.h"
+#include "sync/delta.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Sizes of the previous encoding: six floats, two u32 scores and two i8
+// directions for a keyframe; six float deltas, two i16 score deltas and the
+// directions for a delta.
+constexpr double kLegacyKeyframeBytes = 34.0;
+constexpr double kLegacyDeltaBytes = 28.0;
+
+struct BenchConfig {
+  std::size_t sessions{20};
+  std::size_t ticks{3600};
+  double tick_hz{60.0};
+  std::uint32_t keyframe_interval{20};
+  mini::sync::Quantization quantization{};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  std::cout << "  --sessions N          Recorded sessions (default: 20)\n";
+  std::cout << "  --ticks N             Ticks per session (default: 3600)\n";
+  std::cout << "  --tick HZ             Tick rate (default: 60)\n";
+  std::cout << "  --keyframe-interval N Keyframe spacing (default: 20)\n";
+  std::cout << "  --position-step STEP  Position quantum (default: 0.015625)\n";
+  std::cout << "  --velocity-step STEP  Velocity quantum (default: 0.0625)\n";
+  std::cout << "  --help                Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--sessions" && i + 1 < argc) {
+      config.sessions = std::stoul(argv[++i]);
+    } else if (arg == "--ticks" && i + 1 < argc) {
+      config.ticks = std::stoul(argv[++i]);
+    } else if (arg == "--tick" && i + 1 < argc) {
+      config.tick_hz = std::stod(argv[++i]);
+    } else if (arg == "--keyframe-interval" && i + 1 < argc) {
+      config.keyframe_interval =
+          static_cast<std::uint32_t>(std::stoul(argv[++i]));
+    } else if (arg == "--position-step" && i + 1 < argc) {
+      config.quantization.position_step = std::stod(argv[++i]);
+    } else if (arg == "--velocity-step" && i + 1 < argc) {
+      config.quantization.velocity_step = std::stod(argv[++i]);
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  config.keyframe_interval =
+      std::max<std::uint32_t>(config.keyframe_interval, 1);
+  return config;
+}
+
+// A player who moves toward where the ball is, with a per-rally aiming error
+// that is sometimes large enough to miss, and who idles between rallies.
+class ScriptedPlayer {
+public:
+  ScriptedPlayer(core::PlayerSide side, std::uint32_t seed)
+      : side_(side), rng_(seed) {}
+
+  int direction(const core::WorldState &state) {
+    const bool approaching = side_ == core::PlayerSide::Left
+                                 ? state.ball_vx < 0.0
+                                 : state.ball_vx > 0.0;
+    if (approaching != was_approaching_) {
+      was_approaching_ = approaching;
+      aim_error_ = aim_(rng_);
+      idle_ = !approaching && idle_chance_(rng_) < 0.5;
+    }
+    if (idle_) {
+      return 0;
+    }
+    const double paddle_y = side_ == core::PlayerSide::Left
+                                ? state.left_paddle_y
+                                : state.right_paddle_y;
+    const double target = state.ball_y + aim_error_;
+    if (target > paddle_y + 6.0) {
+      return 1;
+    }
+    if (target < paddle_y - 6.0) {
+      return -1;
+    }
+    return 0;
+  }
+
+private:
+  core::PlayerSide side_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> aim_{0.0, 40.0};
+  std::uniform_real_distribution<double> idle_chance_{0.0, 1.0};
+  double aim_error_{0.0};
+  bool was_approaching_{false};
+  bool idle_{false};
+};
+
+std::vector<core::WorldState> record_session(const BenchConfig &config,
+                                             std::uint32_t seed) {
+  core::World world;
+  ScriptedPlayer left(core::PlayerSide::Left, seed * 2 + 1);
+  ScriptedPlayer right(core::PlayerSide::Right, seed * 2 + 2);
+  std::vector<core::WorldState> states;
+  states.reserve(config.ticks);
+  const double dt = 1.0 / config.tick_hz;
+  for (std::size_t i = 0; i < config.ticks; ++i) {
+    const core::WorldState current = world.snapshot();
+    world.set_player_input(core::PlayerSide::Left, left.direction(current));
+    world.set_player_input(core::PlayerSide::Right, right.direction(current));
+    states.push_back(world.step(dt));
+  }
+  return states;
+}
+
+struct Totals {
+  std::size_t keyframes{0};
+  std::size_t deltas{0};
+  std::size_t keyframe_bytes{0};
+  std::size_t delta_bytes{0};
+  double keyframe_encode_ns{0.0};
+  double delta_encode_ns{0.0};
+  double decode_ns{0.0};
+  double max_position_error{0.0};
+  double max_velocity_error{0.0};
+  std::size_t state_mismatches{0};
+};
+
+double elapsed_ns(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+void encode_session(const BenchConfig &config,
+                    const std::vector<core::WorldState> &states,
+                    Totals &totals) {
+  const mini::sync::DeltaCodec codec(config.quantization);
+  core::WorldState base{};
+  core::WorldState decoded_base{};
+  for (std::size_t i = 0; i < states.size(); ++i) {
+    const core::WorldState &state = states[i];
+    const bool keyframe = i % config.keyframe_interval == 0;
+    auto start = Clock::now();
+    const std::vector<std::uint8_t> payload =
+        keyframe ? codec.encode_keyframe(state)
+                 : codec.encode_delta(base, state);
+    const double encode_ns = elapsed_ns(start);
+
+    start = Clock::now();
+    const core::WorldState decoded =
+        keyframe ? codec.decode_keyframe(payload, state.tick)
+                 : codec.apply_delta(decoded_base, payload, state.tick);
+    totals.decode_ns += elapsed_ns(start);
+
+    if (keyframe) {
+      ++totals.keyframes;
+      totals.keyframe_bytes += payload.size();
+      totals.keyframe_encode_ns += encode_ns;
+      base = state;
+      decoded_base = decoded;
+    } else {
+      ++totals.deltas;
+      totals.delta_bytes += payload.size();
+      totals.delta_encode_ns += encode_ns;
+    }
+
+    totals.max_position_error = std::max(
+        {totals.max_position_error, std::abs(decoded.ball_x - state.ball_x),
+         std::abs(decoded.ball_y - state.ball_y),
+         std::abs(decoded.left_paddle_y - state.left_paddle_y),
+         std::abs(decoded.right_paddle_y - state.right_paddle_y)});
+    totals.max_velocity_error = std::max(
+        {totals.max_velocity_error, std::abs(decoded.ball_vx - state.ball_vx),
+         std::abs(decoded.ball_vy - state.ball_vy)});
+    if (decoded.left_score != state.left_score ||
+        decoded.right_score != state.right_score ||
+        decoded.left_direction != state.left_direction ||
+        decoded.right_direction != state.right_direction) {
+      ++totals.state_mismatches;
+    }
+  }
+}
+
+double mean(double total, std::size_t count) {
+  return count > 0 ? total / static_cast<double>(count) : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+
+  std::vector<std::vector<core::WorldState>> sessions;
+  std::uint32_t goals = 0;
+  for (std::size_t i = 0; i < config.sessions; ++i) {
+    sessions.push_back(record_session(config, static_cast<std::uint32_t>(i)));
+    goals += sessions.back().back().left_score +
+             sessions.back().back().right_score;
+  }
+
+  Totals totals;
+  for (const auto &session : sessions) {
+    encode_session(config, session, totals);
+  }
+
+  const std::size_t snapshots = totals.keyframes + totals.deltas;
+  const double bytes =
+      static_cast<double>(totals.keyframe_bytes + totals.delta_bytes);
+  const double legacy_bytes =
+      kLegacyKeyframeBytes * static_cast<double>(totals.keyframes) +
+      kLegacyDeltaBytes * static_cast<double>(totals.deltas);
+  std::cout << config.sessions << " sessions x " << config.ticks << " ticks ("
+            << goals << " goals), keyframe every " << config.keyframe_interval
+            << " ticks, position step " << config.quantization.position_step
+            << ", velocity step " << config.quantization.velocity_step << "\n";
+  std::cout << std::fixed << std::setprecision(2) << "keyframe "
+            << mean(totals.keyframe_bytes, totals.keyframes) << " B (was "
+            << kLegacyKeyframeBytes << "), delta "
+            << mean(totals.delta_bytes, totals.deltas) << " B (was "
+            << kLegacyDeltaBytes << "); " << mean(bytes, snapshots)
+            << " B per snapshot, " << legacy_bytes / std::max(bytes, 1.0)
+            << "x smaller\n";
+  std::cout << std::setprecision(1) << "encode keyframe "
+            << mean(totals.keyframe_encode_ns, totals.keyframes)
+            << " ns, delta " << mean(totals.delta_encode_ns, totals.deltas)
+            << " ns; decode " << mean(totals.decode_ns, snapshots) << " ns\n";
+  std::cout << std::setprecision(4) << "max error: position "
+            << totals.max_position_error << ", velocity "
+            << totals.max_velocity_error << "; " << totals.state_mismatches
+            << " snapshots with wrong scores or directions\n";
+  return totals.state_mismatches == 0 ? 0 : 1;
+}
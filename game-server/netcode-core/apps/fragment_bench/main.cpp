@@ -0,0 +1,220 @@
+// Large reliable messages through a lossy link: a server UdpTransport with
+// fragmentation on sends messages of --size bytes to a client, one after
+// another, through a local UDP proxy that delays each datagram by half the
+// round trip and drops a share of them. The client sends unreliable inputs at
+// the tick rate, which carry its acks, and checks every message it gets. The
+// bench reports how long each message took from send to delivery and what it
+// cost in retransmits, reassembly drops and timeouts.
+
+#include "link_options.h"
+#include "lossy_proxy.h"
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+  bench::LinkOptions link{{0.0, 0.05}, {20.0}};
+  std::size_t message_bytes{64 * 1024};
+  std::size_t messages{100};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  bench::print_link_usage(BenchConfig{}.link);
+  std::cout << "  --size BYTES        Message size (default: 65536)\n";
+  std::cout << "  --messages N        Messages per run (default: 100)\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--size" && i + 1 < argc) {
+      config.message_bytes = std::stoul(argv[++i]);
+    } else if (arg == "--messages" && i + 1 < argc) {
+      config.messages = std::stoul(argv[++i]);
+    } else if (!bench::parse_link_option(argc, argv, i, config.link)) {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  config.message_bytes = std::max<std::size_t>(config.message_bytes, 8);
+  return config;
+}
+
+struct RunResult {
+  std::uint64_t delivered{0};
+  std::uint64_t corrupt{0};
+  std::uint64_t datagrams{0};
+  std::uint64_t retransmits{0};
+  std::uint64_t timeouts{0};
+  std::uint64_t reassembly_timeouts{0};
+  std::uint64_t reassembly_drops{0};
+  double transfer_p50_ms{0.0};
+  double transfer_p99_ms{0.0};
+};
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[std::min(values.size() - 1,
+                         static_cast<std::size_t>(
+                             p * static_cast<double>(values.size())))];
+}
+
+// Message i is its index followed by bytes derived from it, so the client can
+// check it arrived whole.
+std::vector<std::uint8_t> make_message(std::uint32_t index, std::size_t size) {
+  std::vector<std::uint8_t> message(size);
+  std::memcpy(message.data(), &index, sizeof(index));
+  for (std::size_t i = sizeof(index); i < size; ++i) {
+    message[i] = static_cast<std::uint8_t>(index * 31 + i);
+  }
+  return message;
+}
+
+RunResult run(const BenchConfig &config, double loss, double rtt_ms) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  const boost::asio::ip::udp::endpoint loopback(
+      boost::asio::ip::make_address("127.0.0.1"), 0);
+
+  net::udp::UdpTransportOptions options;
+  options.fragmentation = true;
+  options.max_message_size = std::max(options.max_message_size,
+                                      config.message_bytes);
+  net::udp::UdpTransport server(io, loopback, options);
+  net::udp::UdpTransport client(io, loopback, options);
+  bench::LossyProxy proxy(server.local_endpoint(), rtt_ms / 2.0,
+                          config.link.jitter_ms, loss);
+
+  std::atomic<std::uint32_t> received{0};
+  std::atomic<std::uint64_t> corrupt{0};
+  server.start([](const net::ITransport::Endpoint &, net::PacketBuffer &&) {});
+  client.start([&](const net::ITransport::Endpoint &,
+                   net::PacketBuffer &&payload) {
+    std::uint32_t index = 0;
+    if (payload.size() < sizeof(index)) {
+      return;
+    }
+    std::memcpy(&index, payload.data(), sizeof(index));
+    const std::vector<std::uint8_t> expected =
+        make_message(index, config.message_bytes);
+    if (payload.size() != expected.size() ||
+        std::memcmp(payload.data(), expected.data(), expected.size()) != 0) {
+      corrupt.fetch_add(1);
+    }
+    received.store(index + 1);
+  });
+  std::thread io_thread([&io]() { io.run(); });
+
+  // A message that never completes is given up on after the reassembly
+  // timeout plus a round trip, and the next one goes out.
+  const auto give_up_after =
+      options.reassembly_timeout +
+      std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double, std::milli>(rtt_ms));
+  const auto tick = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / config.link.tick_hz));
+  const std::vector<std::uint8_t> input(16, 0x11);
+  std::vector<double> transfers_ms;
+  RunResult result;
+  auto next_tick = Clock::now();
+  for (std::uint32_t index = 0; index < config.messages; ++index) {
+    const auto sent_at = Clock::now();
+    server.send(proxy.back_endpoint(),
+                make_message(index, config.message_bytes), true);
+    while (received.load() <= index && Clock::now() - sent_at < give_up_after) {
+      const auto now = Clock::now();
+      if (now >= next_tick) {
+        client.send(proxy.front_endpoint(), input, false);
+        next_tick = std::max(next_tick + tick, now);
+      }
+      server.update();
+      client.update();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (received.load() > index) {
+      transfers_ms.push_back(
+          std::chrono::duration<double, std::milli>(Clock::now() - sent_at)
+              .count());
+    }
+  }
+
+  const auto server_counters = server.sample_counters();
+  const auto client_counters = client.sample_counters();
+  server.stop();
+  client.stop();
+  work.reset();
+  io.stop();
+  io_thread.join();
+
+  result.delivered = transfers_ms.size();
+  result.corrupt = corrupt.load();
+  result.datagrams = server_counters.datagrams_sent_total;
+  result.retransmits = server_counters.reliable_retries_total;
+  result.timeouts = server_counters.reliable_timeouts_total;
+  result.reassembly_timeouts = client_counters.reassembly_timeouts_total;
+  result.reassembly_drops = client_counters.dropped_reassembly_total;
+  result.transfer_p50_ms = percentile(transfers_ms, 0.5);
+  result.transfer_p99_ms = percentile(transfers_ms, 0.99);
+  return result;
+}
+
+void report(const BenchConfig &config, double loss, double rtt_ms,
+            const RunResult &result) {
+  const double messages =
+      static_cast<double>(std::max<std::size_t>(config.messages, 1));
+  std::cout << std::fixed << std::setprecision(1) << "rtt " << rtt_ms
+            << " ms, loss " << loss * 100.0 << "%: delivered "
+            << result.delivered << "/" << config.messages
+            << " (" << result.corrupt << " corrupt), transfer p50 "
+            << result.transfer_p50_ms << " p99 " << result.transfer_p99_ms
+            << " ms; per message " << static_cast<double>(result.datagrams) /
+                                          messages
+            << " datagrams, " << static_cast<double>(result.retransmits) /
+                                     messages
+            << " retransmits; " << result.timeouts << " reliable timeouts, "
+            << result.reassembly_timeouts << " reassembly timeouts, "
+            << result.reassembly_drops << " reassembly drops\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  std::cout << config.messages << " messages of " << config.message_bytes
+            << " bytes, jitter up to " << config.link.jitter_ms << " ms\n";
+  for (const double rtt_ms : config.link.rtts_ms) {
+    for (const double loss : config.link.losses) {
+      report(config, loss, rtt_ms, run(config, loss, rtt_ms));
+    }
+  }
+  return 0;
+}
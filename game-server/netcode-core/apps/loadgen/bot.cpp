@@ -14,8 +14,11 @@ namespace apps::loadgen {
 Bot::Bot(boost::asio::io_context &io_context, Config config)
     : io_context_(io_context), config_(std::move(config)) {
 
-  socket_ = std::make_unique<boost::asio::ip::udp::socket>(
-      io_context_, boost::asio::ip::udp::v4());
+  net::udp::UdpTransportOptions options;
+  options.aggregate_messages = config_.aggregate_messages;
+  transport_ = std::make_unique<net::udp::UdpTransport>(
+      io_context_,
+      boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0), options);
 
   // Resolve server endpoint
   boost::asio::ip::udp::resolver resolver(io_context_);
@@ -36,6 +39,10 @@ void Bot::start() {
   stats_.start_time = std::chrono::steady_clock::now();
   stats_.last_input_time = stats_.start_time;
 
+  transport_->start([this](const net::ITransport::Endpoint &,
+                           net::PacketBuffer &&payload) {
+    handle_message(std::move(payload));
+  });
   schedule_next_input();
 }
 
@@ -43,6 +50,7 @@ void Bot::stop() {
   if (!running_.exchange(false)) {
     return; // Not running
   }
+  transport_->stop();
 }
 
 void Bot::send_input() {
@@ -66,13 +74,15 @@ void Bot::send_input() {
   input.set_fire(fire_dist(gen) == 1);
 
   // Serialize
-  std::vector<std::uint8_t> payload(1 + input.ByteSizeLong());
-  payload[0] = 1; // MessageType::Input
+  net::PacketBuffer payload = transport_->allocate_send_buffer();
+  payload.resize(1 + input.ByteSizeLong());
+  payload.data()[0] = 1; // MessageType::Input
   input.SerializeToArray(payload.data() + 1, static_cast<int>(payload.size() - 1));
 
-  // Send
+  // Send; the flush is this bot's end of tick
   try {
-    socket_->send_to(boost::asio::buffer(payload), *server_endpoint_);
+    transport_->send(*server_endpoint_, std::move(payload), false);
+    transport_->flush();
 
     std::lock_guard<std::mutex> lock(stats_mutex_);
     stats_.packets_sent++;
@@ -88,9 +98,33 @@ void Bot::send_input() {
   schedule_next_input();
 }
 
-void Bot::receive_loop() {
-  // Simplified - in a real implementation, this would run in a separate thread
-  // or use async_receive_from
+void Bot::handle_message(net::PacketBuffer &&payload) {
+  if (payload.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.packets_received++;
+
+  // MessageType::ServerAck: RTT from when the acked input was sent
+  if (payload.data()[0] != 3 || !config_.measure_rtt) {
+    return;
+  }
+  mini::ServerAck ack;
+  if (!ack.ParseFromArray(payload.data() + 1,
+                          static_cast<int>(payload.size() - 1))) {
+    return;
+  }
+  const auto it = pending_acks_.find(ack.last_client_seq());
+  if (it != pending_acks_.end()) {
+    stats_.rtt_samples_ms.push_back(
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - it->second)
+            .count());
+  }
+  // Older inputs will not be acked on their own any more.
+  pending_acks_.erase(pending_acks_.begin(),
+                      pending_acks_.upper_bound(ack.last_client_seq()));
 }
 
 void Bot::schedule_next_input() {
@@ -110,8 +144,14 @@ void Bot::schedule_next_input() {
 }
 
 Bot::Stats Bot::get_stats() const {
+  const auto counters = transport_->sample_counters();
   std::lock_guard<std::mutex> lock(stats_mutex_);
-  return stats_;
+  Stats stats = stats_;
+  stats.datagrams_sent = counters.datagrams_sent_total;
+  stats.datagrams_received = counters.datagrams_received_total;
+  stats.bytes_sent = counters.bytes_sent_total;
+  stats.bytes_received = counters.bytes_received_total;
+  return stats;
 }
 
 } // namespace apps::loadgen
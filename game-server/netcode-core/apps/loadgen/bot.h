@@ -13,6 +13,8 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/udp.hpp>
 
+#include "net/udp/udp_transport.h"
+
 namespace apps::loadgen {
 
 class Bot {
@@ -22,11 +24,19 @@ public:
     std::uint16_t server_port{40000};
     double input_rate{60.0}; // inputs per second
     bool measure_rtt{true};
+    // Must match the server's --aggregate.
+    bool aggregate_messages{false};
   };
 
   struct Stats {
     std::uint64_t packets_sent{0};
     std::uint64_t packets_received{0};
+    // What the transport put on and took off the wire, against the messages
+    // counted above.
+    std::uint64_t datagrams_sent{0};
+    std::uint64_t datagrams_received{0};
+    std::uint64_t bytes_sent{0};
+    std::uint64_t bytes_received{0};
     std::vector<double> rtt_samples_ms;
     std::chrono::steady_clock::time_point start_time;
     std::chrono::steady_clock::time_point last_input_time;
@@ -42,12 +52,12 @@ public:
 
 private:
   void send_input();
-  void receive_loop();
+  void handle_message(net::PacketBuffer &&payload);
   void schedule_next_input();
 
   boost::asio::io_context &io_context_;
   Config config_;
-  std::unique_ptr<boost::asio::ip::udp::socket> socket_;
+  std::unique_ptr<net::udp::UdpTransport> transport_;
   std::unique_ptr<boost::asio::ip::udp::endpoint> server_endpoint_;
 
   std::atomic<bool> running_{false};
@@ -3,7 +3,9 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
 
+#include <algorithm>
 #include <csignal>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -20,8 +22,12 @@ struct LoadgenConfig {
   std::uint32_t duration_seconds{60};
   std::string csv_output;
   double input_rate{60.0};
+  bool aggregate_messages{false};
 };
 
+// IPv4 and UDP headers, for what each datagram costs on the wire.
+constexpr std::uint64_t kDatagramOverheadBytes = 28;
+
 void print_usage(const char *program_name) {
   std::cout << "Usage: " << program_name << " [options]\n";
   std::cout << "Options:\n";
@@ -31,6 +37,7 @@ void print_usage(const char *program_name) {
   std::cout << "  --duration SECS     Test duration in seconds (default: 60)\n";
   std::cout << "  --csv FILE          Output CSV file path\n";
   std::cout << "  --rate RATE         Input rate per client (default: 60)\n";
+  std::cout << "  --aggregate         Server runs with --aggregate\n";
   std::cout << "  --help              Show this help\n";
 }
 
@@ -55,6 +62,8 @@ LoadgenConfig parse_args(int argc, char **argv) {
       config.csv_output = argv[++i];
     } else if (arg == "--rate" && i + 1 < argc) {
       config.input_rate = std::stod(argv[++i]);
+    } else if (arg == "--aggregate") {
+      config.aggregate_messages = true;
     } else {
       std::cerr << "Unknown argument: " << arg << "\n";
       print_usage(argv[0]);
@@ -74,7 +83,8 @@ void write_csv(const std::string &filepath,
   }
 
   // Header
-  file << "bot_id,packets_sent,packets_received,avg_rtt_ms,p50_rtt_ms,p99_rtt_"
+  file << "bot_id,packets_sent,packets_received,datagrams_sent,datagrams_"
+          "received,bytes_sent,bytes_received,avg_rtt_ms,p50_rtt_ms,p99_rtt_"
           "ms\n";
 
   // Data
@@ -99,7 +109,9 @@ void write_csv(const std::string &filepath,
     }
 
     file << i << "," << stats.packets_sent << "," << stats.packets_received
-         << "," << avg_rtt << "," << p50_rtt << "," << p99_rtt << "\n";
+         << "," << stats.datagrams_sent << "," << stats.datagrams_received
+         << "," << stats.bytes_sent << "," << stats.bytes_received << ","
+         << avg_rtt << "," << p50_rtt << "," << p99_rtt << "\n";
   }
 
   file.close();
@@ -117,6 +129,8 @@ int main(int argc, char **argv) {
             << "\n";
   std::cout << "  Duration: " << config.duration_seconds << " seconds\n";
   std::cout << "  Input rate: " << config.input_rate << " Hz\n";
+  std::cout << "  Message aggregation: "
+            << (config.aggregate_messages ? "on" : "off") << "\n";
   if (!config.csv_output.empty()) {
     std::cout << "  CSV output: " << config.csv_output << "\n";
   }
@@ -131,6 +145,7 @@ int main(int argc, char **argv) {
     bot_config.server_host = config.server_host;
     bot_config.server_port = config.server_port;
     bot_config.input_rate = config.input_rate;
+    bot_config.aggregate_messages = config.aggregate_messages;
 
     for (std::uint32_t i = 0; i < config.num_clients; ++i) {
       bots.push_back(
@@ -179,20 +194,47 @@ int main(int argc, char **argv) {
     std::vector<apps::loadgen::Bot::Stats> all_stats;
     std::uint64_t total_sent = 0;
     std::uint64_t total_received = 0;
+    apps::loadgen::Bot::Stats wire;
 
     for (auto &bot : bots) {
       auto stats = bot->get_stats();
       total_sent += stats.packets_sent;
       total_received += stats.packets_received;
+      wire.datagrams_sent += stats.datagrams_sent;
+      wire.datagrams_received += stats.datagrams_received;
+      wire.bytes_sent += stats.bytes_sent;
+      wire.bytes_received += stats.bytes_received;
       all_stats.push_back(std::move(stats));
     }
 
+    const double seconds = static_cast<double>(config.duration_seconds);
+    const double clients =
+        static_cast<double>(std::max<std::uint32_t>(config.num_clients, 1));
+    const auto per_client_second = [&](std::uint64_t value) {
+      return static_cast<double>(value) / seconds / clients;
+    };
     std::cout << "\nResults:\n";
     std::cout << "  Total packets sent: " << total_sent << "\n";
     std::cout << "  Total packets received: " << total_received << "\n";
     std::cout << "  Packet rate: "
               << (total_sent / static_cast<double>(config.duration_seconds))
               << " pkt/s\n";
+    // Messages against datagrams and wire bytes (with IP/UDP headers), per
+    // client: what aggregation saves shows up in the datagram and byte rates.
+    std::cout << "  Per client, up: " << per_client_second(total_sent)
+              << " msg/s in " << per_client_second(wire.datagrams_sent)
+              << " pkt/s, "
+              << per_client_second(wire.bytes_sent +
+                                   wire.datagrams_sent *
+                                       kDatagramOverheadBytes)
+              << " B/s\n";
+    std::cout << "  Per client, down: " << per_client_second(total_received)
+              << " msg/s in " << per_client_second(wire.datagrams_received)
+              << " pkt/s, "
+              << per_client_second(wire.bytes_received +
+                                   wire.datagrams_received *
+                                       kDatagramOverheadBytes)
+              << " B/s\n";
 
     // Write CSV if requested
     if (!config.csv_output.empty()) {
@@ -20,11 +20,18 @@ int main(int argc, char **argv) {
   std::string redis_host = "127.0.0.1";
   int redis_port = 6379;
   std::string room_id = "default_room";
+  net::udp::UdpTransportOptions transport_options;
 
   for (int i = 1; i < argc; ++i) {
     const std::string arg = argv[i];
     if (arg == "--metrics") {
       metrics_enabled = true;
+    } else if (arg == "--batched-io") {
+      transport_options.batched_io = true;
+    } else if (arg == "--connection-ids") {
+      transport_options.connection_ids = true;
+    } else if (arg == "--aggregate") {
+      transport_options.aggregate_messages = true;
     } else if (arg == "--redis-host" && i + 1 < argc) {
       redis_host = argv[++i];
     } else if (arg == "--redis-port" && i + 1 < argc) {
@@ -38,6 +45,9 @@ int main(int argc, char **argv) {
                 << "Options:\n"
                 << "  --port <port>         UDP port (default: 40000)\n"
                 << "  --metrics             Enable Prometheus metrics\n"
+                << "  --batched-io          recvmmsg/sendmmsg socket I/O (Linux)\n"
+                << "  --connection-ids      Keep clients across NAT rebinding\n"
+                << "  --aggregate           One datagram per client per tick\n"
                 << "  --redis-host <host>   Redis host (default: 127.0.0.1)\n"
                 << "  --redis-port <port>   Redis port (default: 6379)\n"
                 << "  --room-id <id>        Room identifier (default: default_room)\n"
@@ -59,7 +69,8 @@ int main(int argc, char **argv) {
     auto endpoint =
         boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), port);
     auto transport =
-        std::make_unique<net::udp::UdpTransport>(io_context, endpoint);
+        std::make_unique<net::udp::UdpTransport>(io_context, endpoint,
+                                                 transport_options);
     apps::pong_udp::PongUdpServer server(io_context, std::move(transport),
                                          metrics_enabled, redis_host, redis_port, room_id);
     server.start();
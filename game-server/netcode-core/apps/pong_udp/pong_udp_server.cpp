@@ -32,7 +32,9 @@ PongUdpServer::PongUdpServer(boost::asio::io_context &io_context,
                              int redis_port,
                              const std::string& room_id)
     : io_context_(io_context), transport_(std::move(transport)), loop_(60.0),
-      snapshot_generator_(20, 256), metrics_enabled_(metrics_enabled),
+      // Baselines are kept as long as SnapshotDecoder keeps states by
+      // default, so a client still has any baseline the server picks.
+      snapshot_generator_(20, 120), metrics_enabled_(metrics_enabled),
       room_id_(room_id) {
   if (!transport_) {
     throw std::invalid_argument("transport must not be null");
@@ -61,8 +63,16 @@ void PongUdpServer::start() {
     log_start();
   }
   transport_->set_metrics_enabled(metrics_enabled_);
+  transport_->set_rebind_handler([this](const net::ITransport::Endpoint &from,
+                                        const net::ITransport::Endpoint &to) {
+    rebind_client(from, to);
+  });
+  transport_->set_delivery_handler(
+      [this](const net::ITransport::Endpoint &endpoint, std::uint64_t tick) {
+        handle_snapshot_delivered(endpoint, tick);
+      });
   transport_->start([this](const net::ITransport::Endpoint &endpoint,
-                           std::vector<std::uint8_t> &&payload) {
+                           net::PacketBuffer &&payload) {
     handle_datagram(endpoint, std::move(payload));
   });
 
@@ -79,14 +89,14 @@ void PongUdpServer::start() {
     server_tick_.store(static_cast<std::uint32_t>(state.tick),
                        std::memory_order_relaxed);
     broadcast_snapshot(state);
+    // With message aggregation, the tick's snapshot and the acks for inputs
+    // received since the last tick leave together.
+    transport_->flush();
 
     // M1.8: Store checkpoint periodically for reconnection
     if (room_manager_ && tick_counter_ % CHECKPOINT_INTERVAL_TICKS == 0) {
-      auto encoded = snapshot_generator_.encode(state);
-      if (!encoded.is_keyframe) {
-        // For checkpoints, always use keyframe (full state)
-        encoded = snapshot_generator_.encode_keyframe(state);
-      }
+      // For checkpoints, always use keyframe (full state)
+      const auto encoded = snapshot_generator_.encode_keyframe(state);
       room_manager_->store_checkpoint(room_id_, encoded.payload, 30);
     }
 
@@ -123,12 +133,12 @@ std::vector<double> PongUdpServer::encode_durations_ms() const {
 std::uint64_t PongUdpServer::total_ticks() const { return tick_counter_; }
 
 void PongUdpServer::handle_datagram(const net::ITransport::Endpoint &endpoint,
-                                    std::vector<std::uint8_t> &&payload) {
+                                    net::PacketBuffer &&payload) {
   if (payload.empty()) {
     return;
   }
 
-  const MessageType type = static_cast<MessageType>(payload.front());
+  const MessageType type = static_cast<MessageType>(payload.data()[0]);
   if (payload.size() == 1) {
     return;
   }
@@ -164,10 +174,11 @@ void PongUdpServer::handle_input(const net::ITransport::Endpoint &endpoint,
 }
 
 void PongUdpServer::broadcast_snapshot(const core::WorldState &state) {
-  const auto encoded = snapshot_generator_.encode(state);
+  snapshot_generator_.begin_tick(state);
   const auto clients = snapshot_clients();
   for (const auto &client : clients) {
     const auto encode_start = std::chrono::steady_clock::now();
+    const auto &encoded = snapshot_generator_.encode_for(client.acked_tick);
     mini::Snapshot snapshot_msg;
     snapshot_msg.set_tick(static_cast<std::uint32_t>(encoded.tick));
     snapshot_msg.set_is_keyframe(encoded.is_keyframe);
@@ -185,13 +196,19 @@ void PongUdpServer::broadcast_snapshot(const core::WorldState &state) {
             .count();
     record_encode_metrics(encode_ms);
 
-    const std::string serialized = snapshot_msg.SerializeAsString();
-    record_snapshot_size(encoded.is_keyframe, serialized.size());
-    std::vector<std::uint8_t> buffer;
-    buffer.reserve(serialized.size() + 1);
-    buffer.push_back(static_cast<std::uint8_t>(MessageType::Snapshot));
-    buffer.insert(buffer.end(), serialized.begin(), serialized.end());
-    transport_->send(client.endpoint, std::move(buffer), false);
+    const std::size_t size =
+        send_message(client.endpoint, MessageType::Snapshot, snapshot_msg,
+                     false, encoded.tick);
+    record_snapshot_size(encoded.is_keyframe, size);
+  }
+}
+
+void PongUdpServer::handle_snapshot_delivered(
+    const net::ITransport::Endpoint &endpoint, std::uint64_t tick) {
+  std::lock_guard<std::mutex> lock(clients_mutex_);
+  ClientInfo *client = clients_.find(net::EndpointKey::from(endpoint));
+  if (client && (!client->acked_tick || tick > *client->acked_tick)) {
+    client->acked_tick = tick;
   }
 }
 
@@ -201,54 +218,77 @@ void PongUdpServer::send_ack(const ClientInfo &client,
   ack.set_last_client_seq(client_seq);
   ack.set_server_tick(server_tick_.load(std::memory_order_relaxed));
 
-  const std::string serialized = ack.SerializeAsString();
-  std::vector<std::uint8_t> buffer;
-  buffer.reserve(serialized.size() + 1);
-  buffer.push_back(static_cast<std::uint8_t>(MessageType::ServerAck));
-  buffer.insert(buffer.end(), serialized.begin(), serialized.end());
-  transport_->send(client.endpoint, std::move(buffer), true);
+  send_message(client.endpoint, MessageType::ServerAck, ack, true);
 }
 
-std::string
-PongUdpServer::endpoint_key(const net::ITransport::Endpoint &endpoint) {
-  boost::system::error_code ec;
-  const std::string address = endpoint.address().to_string(ec);
-  if (ec) {
-    return std::string{"invalid:"} + std::to_string(endpoint.port());
+std::size_t
+PongUdpServer::send_message(const net::ITransport::Endpoint &endpoint,
+                            MessageType type,
+                            const google::protobuf::MessageLite &message,
+                            bool reliable,
+                            std::optional<std::uint64_t> delivery_token) {
+  const std::size_t size = message.ByteSizeLong();
+  net::PacketBuffer buffer = transport_->allocate_send_buffer();
+  if (size + 1 <= buffer.tailroom()) {
+    // Serialize straight into the transport's buffer so the header can be
+    // written in front of it without another copy.
+    buffer.resize(size + 1);
+    buffer.data()[0] = static_cast<std::uint8_t>(type);
+    message.SerializeWithCachedSizesToArray(buffer.data() + 1);
+    if (delivery_token) {
+      transport_->send_acked(endpoint, std::move(buffer), *delivery_token);
+    } else {
+      transport_->send(endpoint, std::move(buffer), reliable);
+    }
+    return size;
   }
-  return address + ':' + std::to_string(endpoint.port());
+
+  std::vector<std::uint8_t> oversized(size + 1);
+  oversized[0] = static_cast<std::uint8_t>(type);
+  message.SerializeWithCachedSizesToArray(oversized.data() + 1);
+  transport_->send(endpoint, std::move(oversized), reliable);
+  return size;
 }
 
 PongUdpServer::ClientInfo &
 PongUdpServer::ensure_client_locked(const net::ITransport::Endpoint &endpoint) {
-  const std::string key = endpoint_key(endpoint);
-  auto it = clients_.find(key);
-  if (it == clients_.end()) {
-    ClientInfo info;
-    info.endpoint = endpoint;
-    if (left_client_key_.empty()) {
-      info.side = core::PlayerSide::Left;
-      left_client_key_ = key;
-    } else if (right_client_key_.empty()) {
-      info.side = core::PlayerSide::Right;
-      right_client_key_ = key;
+  auto [client, inserted] =
+      clients_.try_emplace(net::EndpointKey::from(endpoint));
+  if (inserted) {
+    client->endpoint = endpoint;
+    if (!left_taken_) {
+      client->side = core::PlayerSide::Left;
+      left_taken_ = true;
+    } else if (!right_taken_) {
+      client->side = core::PlayerSide::Right;
+      right_taken_ = true;
     } else {
-      info.side = core::PlayerSide::Spectator;
+      client->side = core::PlayerSide::Spectator;
     }
-    auto inserted = clients_.emplace(key, info);
-    it = inserted.first;
-  } else {
-    it->second.endpoint = endpoint;
   }
-  return it->second;
+  return *client;
+}
+
+void PongUdpServer::rebind_client(const net::ITransport::Endpoint &from,
+                                  const net::ITransport::Endpoint &to) {
+  std::lock_guard<std::mutex> lock(clients_mutex_);
+  const net::EndpointKey from_key = net::EndpointKey::from(from);
+  ClientInfo *client = clients_.find(from_key);
+  if (!client) {
+    return;
+  }
+  ClientInfo moved = *client;
+  moved.endpoint = to;
+  clients_.erase(from_key);
+  *clients_.try_emplace(net::EndpointKey::from(to)).first = moved;
 }
 
 std::vector<PongUdpServer::ClientInfo> PongUdpServer::snapshot_clients() const {
   std::lock_guard<std::mutex> lock(clients_mutex_);
   std::vector<ClientInfo> result;
   result.reserve(clients_.size());
-  for (const auto &pair : clients_) {
-    result.push_back(pair.second);
+  for (const auto &entry : clients_) {
+    result.push_back(entry.value);
   }
   return result;
 }
@@ -333,18 +373,33 @@ void PongUdpServer::update_prometheus_metrics() {
   {
     std::lock_guard<std::mutex> lock(clients_mutex_);
     std::uint32_t active_players = 0;
-    if (!left_client_key_.empty())
+    if (left_taken_)
       active_players++;
-    if (!right_client_key_.empty())
+    if (right_taken_)
       active_players++;
     prometheus_exporter_->set_players_active(active_players);
     prometheus_exporter_->set_rooms_active(active_players > 0 ? 1 : 0);
   }
 
-  // Note: RTT and resimulation metrics would be collected from clients
-  // For now, we set placeholder values
-  prometheus_exporter_->set_rtt_p50(0.0);
-  prometheus_exporter_->set_rtt_p99(0.0);
+  // RTT across clients: the median client's typical round trip and the
+  // 99th percentile of the clients' slow tails.
+  const auto rtts = transport_->sample_rtt();
+  if (!rtts.empty()) {
+    std::vector<double> p50s;
+    std::vector<double> p99s;
+    for (const auto &peer : rtts) {
+      p50s.push_back(peer.p50_ms);
+      p99s.push_back(peer.p99_ms);
+    }
+    std::sort(p50s.begin(), p50s.end());
+    std::sort(p99s.begin(), p99s.end());
+    const auto rank = [](std::size_t size, double p) {
+      return std::min(size - 1,
+                      static_cast<std::size_t>(p * static_cast<double>(size)));
+    };
+    prometheus_exporter_->set_rtt_p50(p50s[rank(p50s.size(), 0.5)]);
+    prometheus_exporter_->set_rtt_p99(p99s[rank(p99s.size(), 0.99)]);
+  }
 }
 
 void PongUdpServer::log_start() const {
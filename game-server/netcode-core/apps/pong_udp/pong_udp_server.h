@@ -3,6 +3,8 @@
 #include "core/game_loop.h"
 #include "core/world.h"
 #include "metrics/prometheus.h"
+#include "net/endpoint_key.h"
+#include "net/flat_map.h"
 #include "net/transport.h"
 #include "sync/snapshot.h"
 
@@ -11,10 +13,14 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+namespace google::protobuf {
+class MessageLite;
+} // namespace google::protobuf
+
 namespace mini {
 class Input;
 class RoomManager;
@@ -59,16 +65,28 @@ private:
     net::ITransport::Endpoint endpoint;
     core::PlayerSide side{core::PlayerSide::Spectator};
     std::uint32_t last_client_seq{0};
+    // Newest snapshot tick the client's transport acked; its snapshots are
+    // deltas against it.
+    std::optional<std::uint64_t> acked_tick;
   };
 
   void handle_datagram(const net::ITransport::Endpoint &endpoint,
-                       std::vector<std::uint8_t> &&payload);
+                       net::PacketBuffer &&payload);
   void handle_input(const net::ITransport::Endpoint &endpoint,
                     const mini::Input &input);
   void broadcast_snapshot(const core::WorldState &state);
+  void handle_snapshot_delivered(const net::ITransport::Endpoint &endpoint,
+                                 std::uint64_t tick);
   void send_ack(const ClientInfo &client, std::uint32_t client_seq);
-  static std::string endpoint_key(const net::ITransport::Endpoint &endpoint);
+  // With a delivery token the message goes out through send_acked().
+  std::size_t send_message(const net::ITransport::Endpoint &endpoint,
+                           MessageType type,
+                           const google::protobuf::MessageLite &message,
+                           bool reliable,
+                           std::optional<std::uint64_t> delivery_token = {});
   ClientInfo &ensure_client_locked(const net::ITransport::Endpoint &endpoint);
+  void rebind_client(const net::ITransport::Endpoint &from,
+                     const net::ITransport::Endpoint &to);
   std::vector<ClientInfo> snapshot_clients() const;
   void record_tick_metrics(double dt_seconds);
   void record_encode_metrics(double encode_ms);
@@ -83,9 +101,9 @@ private:
   core::GameLoop loop_;
   mini::sync::SnapshotGenerator snapshot_generator_;
   mutable std::mutex clients_mutex_;
-  std::unordered_map<std::string, ClientInfo> clients_;
-  std::string left_client_key_;
-  std::string right_client_key_;
+  net::FlatMap<net::EndpointKey, ClientInfo, net::EndpointKeyHash> clients_;
+  bool left_taken_{false};
+  bool right_taken_{false};
   std::atomic<std::uint32_t> server_tick_{0};
   bool metrics_enabled_{false};
   mutable std::mutex metrics_mutex_;
@@ -0,0 +1,176 @@
+// Cost of UdpTransport::update() with many reliable packets in flight: N
+// clients that never ack get W reliable packets each, then update() runs every
+// millisecond through the first retransmit wave. Updates with nothing due show
+// what it costs to carry the in-flight packets between retransmits; the others
+// show the cost per retransmitted packet, sending included. The retransmit
+// interval is stretched so filling the windows finishes before it.
+
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct BenchConfig {
+  std::size_t clients{5000};
+  std::size_t in_flight{32};
+  std::size_t payload_bytes{64};
+  double seconds{3.0};
+  std::chrono::milliseconds retransmit_interval{1500};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  std::cout << "  --clients N         Clients (default: 5000)\n";
+  std::cout << "  --in-flight N       Reliable packets per client (default: 32)\n";
+  std::cout << "  --payload BYTES     Payload size (default: 64)\n";
+  std::cout << "  --seconds SECS      How long to keep updating (default: 3)\n";
+  std::cout << "  --interval MS       First retransmit after (default: 1500)\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--clients" && i + 1 < argc) {
+      config.clients = std::stoul(argv[++i]);
+    } else if (arg == "--in-flight" && i + 1 < argc) {
+      config.in_flight = std::stoul(argv[++i]);
+    } else if (arg == "--payload" && i + 1 < argc) {
+      config.payload_bytes = std::stoul(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (arg == "--interval" && i + 1 < argc) {
+      config.retransmit_interval = std::chrono::milliseconds(std::stol(argv[++i]));
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  return config;
+}
+
+double thread_cpu_seconds() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) +
+         static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+struct UpdateStats {
+  std::size_t count{0};
+  double cpu_seconds{0.0};
+  double max_seconds{0.0};
+
+  void add(double seconds) {
+    ++count;
+    cpu_seconds += seconds;
+    max_seconds = std::max(max_seconds, seconds);
+  }
+  double mean_microseconds() const {
+    return count > 0 ? cpu_seconds / static_cast<double>(count) * 1e6 : 0.0;
+  }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+
+  // Every client address on the loopback /8 reaches this sink, which never
+  // reads: the retransmits only have to leave the transport.
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  boost::asio::ip::udp::socket sink(
+      io, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const std::uint16_t sink_port = sink.local_endpoint().port();
+
+  net::udp::UdpTransportOptions options;
+  options.batched_io = true;
+  options.retransmit_interval = config.retransmit_interval;
+  options.reliable_ttl = config.retransmit_interval * 10;
+  net::udp::UdpTransport transport(
+      io,
+      boost::asio::ip::udp::endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                     0),
+      options);
+  transport.start([](const net::ITransport::Endpoint &, net::PacketBuffer &&) {});
+  std::thread io_thread([&io]() { io.run(); });
+
+  const std::vector<std::uint8_t> payload(config.payload_bytes, 0x5a);
+  const double fill_start = thread_cpu_seconds();
+  for (std::size_t i = 0; i < config.clients; ++i) {
+    const boost::asio::ip::address_v4 address(
+        0x7f010000u + static_cast<std::uint32_t>(i / 250) * 256u +
+        static_cast<std::uint32_t>(i % 250) + 1u);
+    const boost::asio::ip::udp::endpoint client(address, sink_port);
+    for (std::size_t j = 0; j < config.in_flight; ++j) {
+      transport.send(client, payload, true);
+    }
+  }
+  transport.update();
+  const double fill_seconds = thread_cpu_seconds() - fill_start;
+  const std::uint64_t total = config.clients * config.in_flight;
+
+  UpdateStats idle;
+  UpdateStats busy;
+  net::ITransport::Counters before = transport.sample_counters();
+  const auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(config.seconds));
+  while (std::chrono::steady_clock::now() < deadline &&
+         before.reliable_timeouts_total < total) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const double start = thread_cpu_seconds();
+    transport.update();
+    const double elapsed = thread_cpu_seconds() - start;
+    const net::ITransport::Counters after = transport.sample_counters();
+    if (after.reliable_retries_total != before.reliable_retries_total) {
+      busy.add(elapsed);
+    } else if (after.reliable_timeouts_total == before.reliable_timeouts_total) {
+      idle.add(elapsed);
+    }
+    before = after;
+  }
+
+  transport.stop();
+  work.reset();
+  io.stop();
+  io_thread.join();
+
+  std::cout << std::fixed << std::setprecision(1) << config.clients
+            << " clients x " << config.in_flight << " in flight, filled in "
+            << fill_seconds * 1e3 << " ms: " << idle.count
+            << " idle updates at " << idle.mean_microseconds() << " us mean ("
+            << idle.max_seconds * 1e6 << " us max), " << busy.count
+            << " retransmit updates at "
+            << (before.reliable_retries_total > 0
+                    ? busy.cpu_seconds * 1e9 /
+                          static_cast<double>(before.reliable_retries_total)
+                    : 0.0)
+            << " ns per retransmit; " << before.reliable_retries_total
+            << " retransmits, " << before.reliable_timeouts_total
+            << " timeouts\n";
+  return 0;
+}
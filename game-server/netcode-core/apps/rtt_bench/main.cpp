@@ -0,0 +1,208 @@
+// Reliable delivery through a lossy, latent link: a client and a server
+// UdpTransport talk through a local UDP proxy that delays each datagram by half
+// the configured round trip (plus jitter) and drops a share of them. The server
+// sends reliable snapshots and the client sends unreliable inputs that carry
+// the acks, both at the tick rate. Each round trip runs with the adaptive
+// retransmit timeout and with the fixed one, and the bench reports the
+// server's RTT estimate, how long snapshots took to arrive, and how many
+// retransmits turned out to be unnecessary (duplicates at the client).
+
+#include "link_options.h"
+#include "lossy_proxy.h"
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+  bench::LinkOptions link{{0.05}, {2.0, 60.0, 200.0}};
+  double seconds{4.0};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  bench::print_link_usage(BenchConfig{}.link);
+  std::cout << "  --seconds SECS      Duration per run (default: 4)\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (!bench::parse_link_option(argc, argv, i, config.link)) {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  return config;
+}
+
+struct RunResult {
+  std::uint64_t snapshots_sent{0};
+  std::uint64_t snapshots_received{0};
+  std::uint64_t retransmits{0};
+  std::uint64_t timeouts{0};
+  std::uint64_t duplicates{0};
+  double delivery_p50_ms{0.0};
+  double delivery_p99_ms{0.0};
+  net::ITransport::PeerRtt rtt{};
+};
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[std::min(values.size() - 1,
+                         static_cast<std::size_t>(
+                             p * static_cast<double>(values.size())))];
+}
+
+RunResult run(const BenchConfig &config, double loss, double rtt_ms,
+              bool adaptive) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  const boost::asio::ip::udp::endpoint loopback(
+      boost::asio::ip::make_address("127.0.0.1"), 0);
+
+  net::udp::UdpTransportOptions server_options;
+  server_options.adaptive_rto = adaptive;
+  net::udp::UdpTransport server(io, loopback, server_options);
+  net::udp::UdpTransport client(io, loopback);
+  bench::LossyProxy proxy(server.local_endpoint(), rtt_ms / 2.0,
+                          config.link.jitter_ms, loss);
+
+  // Snapshots carry their send time so the client can tell how late they are.
+  std::mutex delays_mutex;
+  std::vector<double> delays_ms;
+  server.start([](const net::ITransport::Endpoint &, net::PacketBuffer &&) {});
+  client.start([&](const net::ITransport::Endpoint &,
+                   net::PacketBuffer &&payload) {
+    std::int64_t sent_ns = 0;
+    if (payload.size() < sizeof(sent_ns)) {
+      return;
+    }
+    std::memcpy(&sent_ns, payload.data(), sizeof(sent_ns));
+    const double delay_ms =
+        static_cast<double>(Clock::now().time_since_epoch().count() -
+                            sent_ns) /
+        1e6;
+    std::lock_guard<std::mutex> lock(delays_mutex);
+    delays_ms.push_back(delay_ms);
+  });
+  std::thread io_thread([&io]() { io.run(); });
+
+  RunResult result;
+  const auto tick = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / config.link.tick_hz));
+  const std::vector<std::uint8_t> input(16, 0x11);
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(config.seconds));
+  auto next_tick = start;
+  while (Clock::now() < end) {
+    const auto now = Clock::now();
+    if (now >= next_tick) {
+      client.send(proxy.front_endpoint(), input, false);
+      std::vector<std::uint8_t> snapshot(64, 0x22);
+      const std::int64_t sent_ns = now.time_since_epoch().count();
+      std::memcpy(snapshot.data(), &sent_ns, sizeof(sent_ns));
+      server.send(proxy.back_endpoint(), std::move(snapshot), true);
+      ++result.snapshots_sent;
+      next_tick += tick;
+    }
+    server.update();
+    client.update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Let the last snapshots land or time out.
+  const auto drain_end =
+      Clock::now() + std::chrono::milliseconds(static_cast<int>(rtt_ms)) +
+      server_options.reliable_ttl;
+  while (Clock::now() < drain_end) {
+    client.send(proxy.front_endpoint(), input, false);
+    server.update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  const auto server_counters = server.sample_counters();
+  const auto client_counters = client.sample_counters();
+  const auto rtts = server.sample_rtt();
+  server.stop();
+  client.stop();
+  work.reset();
+  io.stop();
+  io_thread.join();
+
+  result.retransmits = server_counters.reliable_retries_total;
+  result.timeouts = server_counters.reliable_timeouts_total;
+  result.duplicates = client_counters.dropped_duplicates_total;
+  result.snapshots_received = delays_ms.size();
+  result.delivery_p50_ms = percentile(delays_ms, 0.5);
+  result.delivery_p99_ms = percentile(delays_ms, 0.99);
+  if (!rtts.empty()) {
+    result.rtt = rtts.front();
+  }
+  return result;
+}
+
+void report(double rtt_ms, bool adaptive, const RunResult &result) {
+  const double sent = static_cast<double>(std::max<std::uint64_t>(
+      result.snapshots_sent, 1));
+  std::cout << std::fixed << std::setprecision(1) << "rtt " << rtt_ms
+            << " ms, " << (adaptive ? "adaptive" : "fixed   ")
+            << ": srtt " << result.rtt.srtt_ms << " rttvar "
+            << result.rtt.rttvar_ms << " rto " << result.rtt.rto_ms
+            << " (samples p50 " << result.rtt.p50_ms << " p99 "
+            << result.rtt.p99_ms << "); delivered "
+            << static_cast<double>(result.snapshots_received) / sent * 100.0
+            << "%, p50 " << result.delivery_p50_ms << " p99 "
+            << result.delivery_p99_ms << " ms; " << std::setprecision(2)
+            << static_cast<double>(result.retransmits) / sent
+            << " retransmits and "
+            << static_cast<double>(result.duplicates) / sent
+            << " duplicates per snapshot, " << result.timeouts
+            << " timeouts\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  for (const double loss : config.link.losses) {
+    std::cout << "loss " << loss * 100.0 << "% each way, jitter up to "
+              << config.link.jitter_ms << " ms, " << config.link.tick_hz
+              << " Hz\n";
+    for (const double rtt_ms : config.link.rtts_ms) {
+      report(rtt_ms, true, run(config, loss, rtt_ms, true));
+      report(rtt_ms, false, run(config, loss, rtt_ms, false));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,240 @@
+// Receive scaling of ShardedUdpTransport: sender threads blast packets from
+// many client sockets at one port served by 1..N shards, and the bench reports
+// packets handled per second. "shared" runs the same load through a single
+// UdpTransport whose io_context is run by N threads, for comparison.
+
+#include "net/udp/sharded_udp_transport.h"
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct BenchConfig {
+  std::size_t max_shards{8};
+  std::size_t clients{256};
+  std::size_t senders{2};
+  std::size_t payload_bytes{64};
+  double seconds{2.0};
+  bool batched_io{true};
+  bool shared{true};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  std::cout << "  --max-shards N      Largest shard count (default: 8)\n";
+  std::cout << "  --clients N         Client sockets (default: 256)\n";
+  std::cout << "  --senders N         Sender threads (default: 2)\n";
+  std::cout << "  --payload BYTES     Payload size (default: 64)\n";
+  std::cout << "  --seconds SECS      Duration per run (default: 2)\n";
+  std::cout << "  --single-io         Use single-datagram socket I/O\n";
+  std::cout << "  --no-shared         Skip the single-socket comparison\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--max-shards" && i + 1 < argc) {
+      config.max_shards = std::stoul(argv[++i]);
+    } else if (arg == "--clients" && i + 1 < argc) {
+      config.clients = std::stoul(argv[++i]);
+    } else if (arg == "--senders" && i + 1 < argc) {
+      config.senders = std::stoul(argv[++i]);
+    } else if (arg == "--payload" && i + 1 < argc) {
+      config.payload_bytes = std::stoul(argv[++i]);
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (arg == "--single-io") {
+      config.batched_io = false;
+    } else if (arg == "--no-shared") {
+      config.shared = false;
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  config.clients = std::max<std::size_t>(config.clients, 1);
+  config.senders =
+      std::clamp<std::size_t>(config.senders, 1, config.clients);
+  return config;
+}
+
+// Counts on separate cache lines so shards do not share a contended line.
+struct alignas(64) ShardCounter {
+  std::atomic<std::uint64_t> packets{0};
+};
+
+// Sends raw transport datagrams (header plus payload) from its share of the
+// client sockets, round robin, until stop is set.
+void run_sender(const BenchConfig &config, std::size_t sender_index,
+                const boost::asio::ip::udp::endpoint &target,
+                const std::atomic<bool> &stop, std::atomic<std::uint64_t> &sent) {
+  boost::asio::io_context io;
+  std::vector<boost::asio::ip::udp::socket> sockets;
+  for (std::size_t i = sender_index; i < config.clients; i += config.senders) {
+    sockets.emplace_back(io, boost::asio::ip::udp::endpoint(
+                                 boost::asio::ip::make_address("127.0.0.1"), 0));
+    sockets.back().non_blocking(true);
+  }
+  std::vector<std::uint16_t> seqs(sockets.size(), 1);
+  std::vector<std::uint8_t> datagram(sizeof(net::udp::UdpHeader) +
+                                     config.payload_bytes, 0x5a);
+  std::uint64_t local_sent = 0;
+  while (!stop.load(std::memory_order_relaxed)) {
+    for (std::size_t i = 0; i < sockets.size(); ++i) {
+      const std::uint16_t seq = boost::endian::native_to_big(seqs[i]++);
+      std::memset(datagram.data(), 0, sizeof(net::udp::UdpHeader));
+      std::memcpy(datagram.data(), &seq, sizeof(seq));
+      boost::system::error_code ec;
+      sockets[i].send_to(boost::asio::buffer(datagram), target, 0, ec);
+      if (!ec) {
+        ++local_sent;
+      }
+    }
+  }
+  sent.fetch_add(local_sent);
+}
+
+struct RunResult {
+  std::uint64_t sent{0};
+  std::uint64_t received{0};
+  double seconds{0.0};
+  std::vector<std::uint64_t> per_shard;
+};
+
+RunResult drive_load(const BenchConfig &config,
+                     const boost::asio::ip::udp::endpoint &target,
+                     const std::vector<ShardCounter> &counters) {
+  std::atomic<bool> stop{false};
+  std::atomic<std::uint64_t> sent{0};
+  std::vector<std::thread> senders;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < config.senders; ++i) {
+    senders.emplace_back(
+        [&, i]() { run_sender(config, i, target, stop, sent); });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+  stop.store(true);
+  for (auto &sender : senders) {
+    sender.join();
+  }
+  RunResult result;
+  result.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  // Let the receivers drain their socket buffers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  result.sent = sent.load();
+  for (const auto &counter : counters) {
+    result.per_shard.push_back(counter.packets.load());
+    result.received += result.per_shard.back();
+  }
+  return result;
+}
+
+net::udp::UdpTransportOptions transport_options(const BenchConfig &config) {
+  net::udp::UdpTransportOptions options;
+  options.batched_io = config.batched_io;
+  return options;
+}
+
+RunResult run_sharded(const BenchConfig &config, std::size_t shards) {
+  net::udp::ShardedUdpTransport transport(
+      boost::asio::ip::udp::endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                     0),
+      shards, transport_options(config));
+  std::vector<ShardCounter> counters(shards);
+  transport.start([&counters](std::size_t shard,
+                              const net::ITransport::Endpoint &,
+                              net::PacketBuffer &&) {
+    counters[shard].packets.fetch_add(1, std::memory_order_relaxed);
+  });
+  RunResult result = drive_load(config, transport.local_endpoint(), counters);
+  transport.stop();
+  return result;
+}
+
+RunResult run_shared(const BenchConfig &config, std::size_t threads) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  net::udp::UdpTransport transport(
+      io,
+      boost::asio::ip::udp::endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                     0),
+      transport_options(config));
+  std::vector<ShardCounter> counters(1);
+  transport.start(
+      [&counters](const net::ITransport::Endpoint &, net::PacketBuffer &&) {
+        counters[0].packets.fetch_add(1, std::memory_order_relaxed);
+      });
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&io]() { io.run(); });
+  }
+  RunResult result = drive_load(config, transport.local_endpoint(), counters);
+  transport.stop();
+  work.reset();
+  io.stop();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return result;
+}
+
+void report(const char *name, std::size_t cores, const RunResult &result) {
+  const double received_rate =
+      static_cast<double>(result.received) / result.seconds;
+  const double sent_rate = static_cast<double>(result.sent) / result.seconds;
+  std::cout << std::fixed << std::setprecision(0) << name << " x" << cores
+            << ": received " << received_rate << " pkt/s of " << sent_rate
+            << " sent";
+  if (result.per_shard.size() > 1) {
+    const auto [low, high] =
+        std::minmax_element(result.per_shard.begin(), result.per_shard.end());
+    std::cout << ", busiest shard " << std::setprecision(2)
+              << static_cast<double>(*high) /
+                     static_cast<double>(std::max<std::uint64_t>(*low, 1))
+              << "x the quietest";
+  }
+  std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  std::cout << std::thread::hardware_concurrency()
+            << " hardware threads; " << config.clients << " clients, "
+            << config.senders << " sender threads\n";
+  for (std::size_t shards = 1; shards <= config.max_shards; shards *= 2) {
+    report("sharded", shards, run_sharded(config, shards));
+    if (config.shared) {
+      report("shared", shards, run_shared(config, shards));
+    }
+  }
+  return 0;
+}
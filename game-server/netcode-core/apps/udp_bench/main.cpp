@@ -0,0 +1,233 @@
+// Loopback throughput of net::udp::UdpTransport: one transport blasts
+// unreliable packets at another, and each side reports packets per second of
+// its own thread's CPU time and heap allocations per packet once warmed up.
+
+#include "net/udp/udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+struct BenchConfig {
+  std::string mode{"both"};
+  double seconds{3.0};
+  std::size_t burst{256};
+  std::size_t payload_bytes{64};
+  std::size_t batch_size{64};
+  bool gso{true};
+};
+
+struct BenchResult {
+  std::uint64_t sent{0};
+  std::uint64_t received{0};
+  double wall_seconds{0.0};
+  double sender_cpu_seconds{0.0};
+  double receiver_cpu_seconds{0.0};
+  // Counted over the last three quarters of the run, after the pools and
+  // queues have grown to their working size.
+  std::uint64_t steady_packets{0};
+  std::uint64_t steady_allocations{0};
+};
+
+void print_usage(const char *program_name) {
+  std::cout << "Usage: " << program_name << " [options]\n";
+  std::cout << "Options:\n";
+  std::cout << "  --mode MODE         single, batched or both (default: both)\n";
+  std::cout << "  --seconds SECS      Duration per mode (default: 3)\n";
+  std::cout << "  --burst N           Sends between flushes (default: 256)\n";
+  std::cout << "  --payload BYTES     Payload size (default: 64)\n";
+  std::cout << "  --batch N           recvmmsg/sendmmsg batch (default: 64)\n";
+  std::cout << "  --no-gso            Disable UDP GSO in batched mode\n";
+  std::cout << "  --help              Show this help\n";
+}
+
+BenchConfig parse_args(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      print_usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--mode" && i + 1 < argc) {
+      config.mode = argv[++i];
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      config.seconds = std::stod(argv[++i]);
+    } else if (arg == "--burst" && i + 1 < argc) {
+      config.burst = std::stoul(argv[++i]);
+    } else if (arg == "--payload" && i + 1 < argc) {
+      config.payload_bytes = std::stoul(argv[++i]);
+    } else if (arg == "--batch" && i + 1 < argc) {
+      config.batch_size = std::stoul(argv[++i]);
+    } else if (arg == "--no-gso") {
+      config.gso = false;
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      print_usage(argv[0]);
+      std::exit(1);
+    }
+  }
+  return config;
+}
+
+double thread_cpu_seconds() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) +
+         static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+BenchResult run(const BenchConfig &config, bool batched) {
+  net::udp::UdpTransportOptions options;
+  options.batched_io = batched;
+  options.batch_size = config.batch_size;
+  options.gso = config.gso;
+  const boost::asio::ip::udp::endpoint loopback(
+      boost::asio::ip::make_address("127.0.0.1"), 0);
+
+  boost::asio::io_context receiver_io;
+  net::udp::UdpTransport receiver(receiver_io, loopback, options);
+  std::atomic<std::uint64_t> received{0};
+  receiver.start([&received](const net::ITransport::Endpoint &,
+                             net::PacketBuffer &&) {
+    received.fetch_add(1, std::memory_order_relaxed);
+  });
+  const auto target = receiver.local_endpoint();
+
+  BenchResult result;
+  std::thread receiver_thread([&]() {
+    const double start = thread_cpu_seconds();
+    receiver_io.run();
+    result.receiver_cpu_seconds = thread_cpu_seconds() - start;
+  });
+
+  // The sending side runs like a server: sends come from a tick thread and the
+  // io_context runs on its own thread.
+  boost::asio::io_context sender_io;
+  auto work = boost::asio::make_work_guard(sender_io);
+  net::udp::UdpTransport sender(sender_io, loopback, options);
+  double sender_io_cpu_seconds = 0.0;
+  std::thread sender_io_thread([&]() {
+    const double start = thread_cpu_seconds();
+    sender_io.run();
+    sender_io_cpu_seconds = thread_cpu_seconds() - start;
+  });
+
+  const std::vector<std::uint8_t> payload(config.payload_bytes, 0x5a);
+  const double sender_start = thread_cpu_seconds();
+  const auto wall_start = std::chrono::steady_clock::now();
+  const auto run_length = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(config.seconds));
+  const auto deadline = wall_start + run_length;
+  const auto warmed_up = wall_start + run_length / 4;
+  bool counting = false;
+  std::uint64_t packets_at_warmup = 0;
+  std::uint64_t allocations_at_warmup = 0;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (!counting && std::chrono::steady_clock::now() >= warmed_up) {
+      counting = true;
+      packets_at_warmup = result.sent + received.load();
+      allocations_at_warmup = g_allocations.load();
+    }
+    // Closed loop: keep at most a few bursts in flight, but give up waiting
+    // after a millisecond so lost packets do not stall the sender.
+    const auto wait_until =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+    while (result.sent - received.load(std::memory_order_relaxed) >
+               4 * config.burst &&
+           std::chrono::steady_clock::now() < wait_until) {
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    for (std::size_t i = 0; i < config.burst; ++i) {
+      net::PacketBuffer buffer = sender.allocate_send_buffer();
+      buffer.assign(payload.data(), payload.size());
+      sender.send(target, std::move(buffer), false);
+    }
+    sender.update();
+    result.sent += config.burst;
+  }
+  if (counting) {
+    result.steady_packets = result.sent + received.load() - packets_at_warmup;
+    result.steady_allocations = g_allocations.load() - allocations_at_warmup;
+  }
+  result.sender_cpu_seconds = thread_cpu_seconds() - sender_start;
+  result.wall_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - wall_start)
+                            .count();
+
+  // Let both sides drain what is still queued.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  work.reset();
+  sender.stop();
+  sender_io.stop();
+  sender_io_thread.join();
+  result.sender_cpu_seconds += sender_io_cpu_seconds;
+  receiver.stop();
+  receiver_io.stop();
+  receiver_thread.join();
+  result.received = received.load();
+  return result;
+}
+
+void report(const char *name, const BenchResult &result) {
+  const auto per_second = [](std::uint64_t packets, double seconds) {
+    return seconds > 0.0 ? static_cast<double>(packets) / seconds : 0.0;
+  };
+  std::cout << std::fixed << std::setprecision(0) << name << ": sent "
+            << per_second(result.sent, result.wall_seconds) << " pkt/s ("
+            << per_second(result.sent, result.sender_cpu_seconds)
+            << " per sender core-second), received "
+            << per_second(result.received, result.wall_seconds) << " pkt/s ("
+            << per_second(result.received, result.receiver_cpu_seconds)
+            << " per receiver core-second), " << std::setprecision(3)
+            << (result.steady_packets > 0
+                    ? static_cast<double>(result.steady_allocations) /
+                          static_cast<double>(result.steady_packets)
+                    : 0.0)
+            << " allocations per packet sent or received\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const BenchConfig config = parse_args(argc, argv);
+  if (config.mode == "single" || config.mode == "both") {
+    report("single", run(config, false));
+  }
+  if (config.mode == "batched" || config.mode == "both") {
+    report(config.gso ? "batched+gso" : "batched", run(config, true));
+  }
+  return 0;
+}
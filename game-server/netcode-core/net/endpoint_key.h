@@ -0,0 +1,58 @@
+#pragma once
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+
+// A UDP endpoint packed into integers for hashing and comparison. IPv4 addresses are stored in
+// their IPv4-mapped IPv6 form so both families share one key space.
+struct EndpointKey {
+    std::uint64_t address_high{0};
+    std::uint64_t address_low{0};
+    std::uint32_t port_scope{0};
+
+    static EndpointKey from(const boost::asio::ip::udp::endpoint &endpoint) noexcept {
+        EndpointKey key;
+        const auto address = endpoint.address();
+        if (address.is_v4()) {
+            key.address_high = 0;
+            key.address_low = 0x0000ffff00000000ull | address.to_v4().to_uint();
+        } else {
+            const auto v6 = address.to_v6();
+            const auto bytes = v6.to_bytes();
+            for (std::size_t i = 0; i < 8; ++i) {
+                key.address_high = (key.address_high << 8) | bytes[i];
+                key.address_low = (key.address_low << 8) | bytes[i + 8];
+            }
+            key.port_scope = static_cast<std::uint32_t>(v6.scope_id()) << 16;
+        }
+        key.port_scope |= endpoint.port();
+        return key;
+    }
+
+    friend bool operator==(const EndpointKey &lhs, const EndpointKey &rhs) noexcept {
+        return lhs.address_low == rhs.address_low && lhs.port_scope == rhs.port_scope &&
+               lhs.address_high == rhs.address_high;
+    }
+    friend bool operator!=(const EndpointKey &lhs, const EndpointKey &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+struct EndpointKeyHash {
+    std::size_t operator()(const EndpointKey &key) const noexcept {
+        // Multiply-xorshift mixing so addresses that differ only in low bits spread over the
+        // whole table.
+        std::uint64_t h = key.address_low * 0x9e3779b97f4a7c15ull;
+        h ^= (key.address_high + key.port_scope) * 0xc2b2ae3d27d4eb4full;
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+} // namespace net
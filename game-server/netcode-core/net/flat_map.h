@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+// Open-addressing hash map with linear probing and backward-shift erase. Entries live inline in
+// one array, so a lookup touches a handful of neighbouring cache lines and no nodes. Inserting
+// may move every entry; references and iterators are only stable until the next insert.
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class FlatMap {
+public:
+    struct Entry {
+        Entry() = default;
+        explicit Entry(const Key &k) : key(k) {}
+
+        Key key{};
+        Value value{};
+    };
+
+private:
+    // An entry is constructed in place when a slot is taken and destroyed when it is freed, so
+    // free slots hold nothing and no entry is ever reset by assigning a temporary.
+    struct Slot {
+        std::optional<Entry> entry;
+    };
+
+    template <typename SlotT, typename EntryT> class Iterator {
+    public:
+        Iterator(SlotT *slot, SlotT *end) : slot_(slot), end_(end) { skip(); }
+        EntryT &operator*() const { return *slot_->entry; }
+        EntryT *operator->() const { return &*slot_->entry; }
+        Iterator &operator++() {
+            ++slot_;
+            skip();
+            return *this;
+        }
+        bool operator==(const Iterator &other) const { return slot_ == other.slot_; }
+        bool operator!=(const Iterator &other) const { return slot_ != other.slot_; }
+
+    private:
+        void skip() {
+            while (slot_ != end_ && !slot_->entry) {
+                ++slot_;
+            }
+        }
+
+        SlotT *slot_;
+        SlotT *end_;
+    };
+
+public:
+    using iterator = Iterator<Slot, Entry>;
+    using const_iterator = Iterator<const Slot, const Entry>;
+
+    FlatMap() = default;
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    // Grows the table so count entries fit without rehashing.
+    void reserve(std::size_t count) {
+        std::size_t capacity = kMinCapacity;
+        while (capacity * kMaxLoadNumerator < count * kMaxLoadDenominator) {
+            capacity *= 2;
+        }
+        if (capacity > slots_.size()) {
+            rehash(capacity);
+        }
+    }
+
+    Value *find(const Key &key) noexcept {
+        Slot *slot = find_slot(key);
+        return slot ? &slot->entry->value : nullptr;
+    }
+    const Value *find(const Key &key) const noexcept {
+        const Slot *slot = const_cast<FlatMap *>(this)->find_slot(key);
+        return slot ? &slot->entry->value : nullptr;
+    }
+
+    // Returns the value for key, default-constructing it first if absent, and whether it was
+    // inserted.
+    std::pair<Value *, bool> try_emplace(const Key &key) {
+        if ((size_ + 1) * kMaxLoadDenominator > slots_.size() * kMaxLoadNumerator) {
+            rehash(slots_.empty() ? kMinCapacity : slots_.size() * 2);
+        }
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash_(key) & mask;; i = (i + 1) & mask) {
+            Slot &slot = slots_[i];
+            if (!slot.entry) {
+                slot.entry.emplace(key);
+                ++size_;
+                return {&slot.entry->value, true};
+            }
+            if (slot.entry->key == key) {
+                return {&slot.entry->value, false};
+            }
+        }
+    }
+
+    bool erase(const Key &key) {
+        Slot *slot = find_slot(key);
+        if (!slot) {
+            return false;
+        }
+        // Shift later members of the probe run back so lookups never stop at a hole early.
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t hole = static_cast<std::size_t>(slot - slots_.data());
+        for (std::size_t i = (hole + 1) & mask; slots_[i].entry; i = (i + 1) & mask) {
+            const std::size_t home = hash_(slots_[i].entry->key) & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                slots_[hole].entry = std::move(slots_[i].entry);
+                hole = i;
+            }
+        }
+        slots_[hole].entry.reset();
+        --size_;
+        return true;
+    }
+
+    void clear() {
+        slots_.clear();
+        size_ = 0;
+    }
+
+    iterator begin() noexcept { return {slots_.data(), slots_.data() + slots_.size()}; }
+    iterator end() noexcept {
+        return {slots_.data() + slots_.size(), slots_.data() + slots_.size()};
+    }
+    const_iterator begin() const noexcept {
+        return {slots_.data(), slots_.data() + slots_.size()};
+    }
+    const_iterator end() const noexcept {
+        return {slots_.data() + slots_.size(), slots_.data() + slots_.size()};
+    }
+
+private:
+    static constexpr std::size_t kMinCapacity = 16;
+    // Keeps probe runs short: the table is at most 3/4 full.
+    static constexpr std::size_t kMaxLoadNumerator = 3;
+    static constexpr std::size_t kMaxLoadDenominator = 4;
+
+    Slot *find_slot(const Key &key) noexcept {
+        if (size_ == 0) {
+            return nullptr;
+        }
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash_(key) & mask;; i = (i + 1) & mask) {
+            Slot &slot = slots_[i];
+            if (!slot.entry) {
+                return nullptr;
+            }
+            if (slot.entry->key == key) {
+                return &slot;
+            }
+        }
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        const std::size_t mask = capacity - 1;
+        for (Slot &slot : old) {
+            if (!slot.entry) {
+                continue;
+            }
+            std::size_t i = hash_(slot.entry->key) & mask;
+            while (slots_[i].entry) {
+                i = (i + 1) & mask;
+            }
+            slots_[i].entry = std::move(slot.entry);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t size_{0};
+    Hash hash_{};
+};
+
+} // namespace net
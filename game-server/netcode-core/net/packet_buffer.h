@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace net {
+
+class PacketBufferPool;
+
+// Handle to a fixed-size buffer from a PacketBufferPool. Copies share the buffer and the last
+// handle to go returns it to the pool. A handle views a window of the buffer, so a transport can
+// strip its header on receive or write it in front of the payload on send without copying.
+class PacketBuffer {
+public:
+    // Size of a pool's buffers unless it asks for others; room for any datagram we send.
+    static constexpr std::size_t kCapacity = 2048;
+
+    PacketBuffer() = default;
+    PacketBuffer(const PacketBuffer &other) noexcept
+        : slot_(other.slot_), offset_(other.offset_), size_(other.size_) {
+        retain();
+    }
+    PacketBuffer(PacketBuffer &&other) noexcept
+        : slot_(other.slot_), offset_(other.offset_), size_(other.size_) {
+        other.slot_ = nullptr;
+        other.offset_ = 0;
+        other.size_ = 0;
+    }
+    PacketBuffer &operator=(PacketBuffer other) noexcept {
+        std::swap(slot_, other.slot_);
+        std::swap(offset_, other.offset_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+    ~PacketBuffer() { release(); }
+
+    explicit operator bool() const noexcept { return slot_ != nullptr; }
+    // Whether this is the only handle to the buffer, so writing to it races with no one.
+    bool unique() const noexcept;
+
+    std::uint8_t *data() noexcept;
+    const std::uint8_t *data() const noexcept;
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    std::size_t capacity() const noexcept;
+
+    // Free bytes before and after the window.
+    std::size_t headroom() const noexcept { return offset_; }
+    std::size_t tailroom() const noexcept { return capacity() - offset_ - size_; }
+
+    void resize(std::size_t size) noexcept {
+        assert(offset_ + size <= capacity());
+        size_ = size;
+    }
+    // Extends the window n bytes into the headroom.
+    void push_front(std::size_t n) noexcept {
+        assert(n <= offset_);
+        offset_ -= n;
+        size_ += n;
+    }
+    // Drops n bytes from the front of the window.
+    void pull_front(std::size_t n) noexcept {
+        assert(n <= size_);
+        offset_ += n;
+        size_ -= n;
+    }
+    void assign(const std::uint8_t *bytes, std::size_t size) noexcept {
+        resize(size);
+        if (size > 0) {
+            std::memcpy(data(), bytes, size);
+        }
+    }
+
+private:
+    friend class PacketBufferPool;
+    struct Slot;
+
+    PacketBuffer(Slot *slot, std::size_t offset) noexcept : slot_(slot), offset_(offset) {}
+
+    void retain() noexcept;
+    void release() noexcept;
+
+    Slot *slot_{nullptr};
+    std::size_t offset_{0};
+    std::size_t size_{0};
+};
+
+// Slabs of equal-sized buffers, PacketBuffer::kCapacity bytes unless asked otherwise. Acquiring
+// takes a buffer off a free list and only allocates when every buffer is in use, so steady
+// traffic does not touch the heap. Safe to use from any thread; handles may outlive the pool.
+class PacketBufferPool {
+public:
+    explicit PacketBufferPool(std::size_t buffers_per_slab = 256,
+                              std::size_t buffer_size = PacketBuffer::kCapacity);
+    PacketBufferPool(const PacketBufferPool &) = delete;
+    PacketBufferPool &operator=(const PacketBufferPool &) = delete;
+    ~PacketBufferPool();
+
+    // An empty window with headroom bytes kept free in front of it.
+    PacketBuffer acquire(std::size_t headroom = 0);
+
+    std::size_t buffer_size() const noexcept;
+    std::size_t capacity() const;
+    std::size_t in_use() const;
+
+private:
+    friend class PacketBuffer;
+    struct Core;
+
+    Core *core_;
+};
+
+struct PacketBuffer::Slot {
+    std::atomic<std::uint32_t> refs{0};
+    PacketBufferPool::Core *core{nullptr};
+    std::uint8_t *bytes{nullptr};
+};
+
+struct PacketBufferPool::Core {
+    void grow() {
+        // Buffers start 16-byte aligned, as operator new[] aligns the storage.
+        const std::size_t stride = (buffer_size + 15) & ~std::size_t{15};
+        slabs.emplace_back(new PacketBuffer::Slot[buffers_per_slab]);
+        storage.emplace_back(new std::uint8_t[stride * buffers_per_slab]);
+        free.reserve(slabs.size() * buffers_per_slab);
+        for (std::size_t i = 0; i < buffers_per_slab; ++i) {
+            slabs.back()[i].core = this;
+            slabs.back()[i].bytes = storage.back().get() + i * stride;
+            free.push_back(&slabs.back()[i]);
+        }
+    }
+
+    // Returns whether the core should be deleted: the pool is gone and this was the last buffer.
+    bool put(PacketBuffer::Slot *slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        free.push_back(slot);
+        --in_use;
+        return closed && in_use == 0;
+    }
+
+    mutable std::mutex mutex;
+    std::size_t buffers_per_slab{0};
+    std::size_t buffer_size{0};
+    std::vector<std::unique_ptr<PacketBuffer::Slot[]>> slabs;
+    std::vector<std::unique_ptr<std::uint8_t[]>> storage;
+    std::vector<PacketBuffer::Slot *> free;
+    std::size_t in_use{0};
+    bool closed{false};
+};
+
+inline PacketBufferPool::PacketBufferPool(std::size_t buffers_per_slab, std::size_t buffer_size)
+    : core_(new Core) {
+    core_->buffers_per_slab = buffers_per_slab == 0 ? 1 : buffers_per_slab;
+    core_->buffer_size = buffer_size;
+}
+
+inline PacketBufferPool::~PacketBufferPool() {
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        core_->closed = true;
+        last = core_->in_use == 0;
+    }
+    if (last) {
+        delete core_;
+    }
+}
+
+inline PacketBuffer PacketBufferPool::acquire(std::size_t headroom) {
+    assert(headroom <= core_->buffer_size);
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    if (core_->free.empty()) {
+        core_->grow();
+    }
+    PacketBuffer::Slot *slot = core_->free.back();
+    core_->free.pop_back();
+    ++core_->in_use;
+    slot->refs.store(1, std::memory_order_relaxed);
+    return PacketBuffer(slot, headroom);
+}
+
+inline std::size_t PacketBufferPool::buffer_size() const noexcept { return core_->buffer_size; }
+
+inline std::size_t PacketBufferPool::capacity() const {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    return core_->slabs.size() * core_->buffers_per_slab;
+}
+
+inline std::size_t PacketBufferPool::in_use() const {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    return core_->in_use;
+}
+
+inline std::uint8_t *PacketBuffer::data() noexcept { return slot_->bytes + offset_; }
+
+inline const std::uint8_t *PacketBuffer::data() const noexcept { return slot_->bytes + offset_; }
+
+inline std::size_t PacketBuffer::capacity() const noexcept {
+    return slot_ ? slot_->core->buffer_size : 0;
+}
+
+inline bool PacketBuffer::unique() const noexcept {
+    return slot_ && slot_->refs.load(std::memory_order_acquire) == 1;
+}
+
+inline void PacketBuffer::retain() noexcept {
+    if (slot_) {
+        slot_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline void PacketBuffer::release() noexcept {
+    if (!slot_) {
+        return;
+    }
+    if (slot_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        PacketBufferPool::Core *core = slot_->core;
+        if (core->put(slot_)) {
+            delete core;
+        }
+    }
+    slot_ = nullptr;
+}
+
+} // namespace net
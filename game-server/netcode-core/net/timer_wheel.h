@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+// Hierarchical timing wheel with millisecond ticks: four levels of 64 slots cover about 4.6
+// hours, and longer deadlines are clamped to that. Scheduling and cancelling are O(1) and
+// advancing costs one step per elapsed tick plus the timers that fall due, however many are
+// pending. Timers are stored in a reusable node array, so steady use does not allocate.
+template <typename T> class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Names a scheduled timer; stale ids (fired or cancelled) are ignored by cancel().
+    struct TimerId {
+        std::uint32_t index{kNil};
+        std::uint32_t generation{0};
+    };
+
+    explicit TimerWheel(Clock::time_point origin = Clock::now()) : origin_(origin) {
+        heads_.fill(kNil);
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    // A deadline at or before the wheel's current time fires on the next advance().
+    TimerId schedule(Clock::time_point deadline, T value) {
+        std::uint32_t index;
+        if (free_ != kNil) {
+            index = free_;
+            free_ = nodes_[index].next;
+        } else {
+            index = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        Node &node = nodes_[index];
+        node.value = std::move(value);
+        node.deadline = std::max(to_tick_ceil(deadline), now_tick_ + 1);
+        node.active = true;
+        link(index);
+        ++size_;
+        return {index, node.generation};
+    }
+
+    bool cancel(TimerId id) noexcept {
+        if (id.index >= nodes_.size()) {
+            return false;
+        }
+        Node &node = nodes_[id.index];
+        if (!node.active || node.generation != id.generation) {
+            return false;
+        }
+        unlink(id.index);
+        release(id.index);
+        return true;
+    }
+
+    // Fires every timer due at or before now, tick by tick, by calling on_expire(value).
+    // on_expire must not schedule or cancel on this wheel; collect and act afterwards.
+    template <typename F> void advance(Clock::time_point now, F &&on_expire) {
+        const std::uint64_t target = to_tick(now);
+        while (now_tick_ < target) {
+            ++now_tick_;
+            // Entering a new block of a level pulls that block's timers down first.
+            for (std::size_t level = kLevels - 1; level > 0; --level) {
+                if ((now_tick_ & ((std::uint64_t{1} << (kSlotBits * level)) - 1)) == 0) {
+                    cascade(level, (now_tick_ >> (kSlotBits * level)) & kSlotMask);
+                }
+            }
+            const std::size_t bucket = now_tick_ & kSlotMask;
+            while (heads_[bucket] != kNil) {
+                const std::uint32_t index = heads_[bucket];
+                unlink(index);
+                T value = std::move(nodes_[index].value);
+                release(index);
+                on_expire(value);
+            }
+            if (size_ == 0) {
+                now_tick_ = target;
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kNil = 0xffffffffu;
+    static constexpr std::size_t kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{1} << kSlotBits;
+    static constexpr std::uint64_t kSlotMask = kSlots - 1;
+    static constexpr std::size_t kLevels = 4;
+
+    struct Node {
+        T value{};
+        std::uint64_t deadline{0};
+        std::uint32_t prev{kNil};
+        std::uint32_t next{kNil};
+        std::uint32_t generation{0};
+        std::uint16_t bucket{0};
+        bool active{false};
+    };
+
+    std::uint64_t to_tick(Clock::time_point time) const noexcept {
+        if (time <= origin_) {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(time - origin_).count());
+    }
+
+    // Rounds up so a timer never fires before its deadline.
+    std::uint64_t to_tick_ceil(Clock::time_point time) const noexcept {
+        const std::uint64_t tick = to_tick(time);
+        return origin_ + std::chrono::milliseconds(tick) < time ? tick + 1 : tick;
+    }
+
+    void link(std::uint32_t index) noexcept {
+        Node &node = nodes_[index];
+        const std::uint64_t horizon = (std::uint64_t{1} << (kSlotBits * kLevels)) - 1;
+        if (node.deadline - now_tick_ > horizon) {
+            node.deadline = now_tick_ + horizon;
+        }
+        const std::uint64_t delta = node.deadline - now_tick_;
+        std::size_t level = 0;
+        while (level + 1 < kLevels && delta >= (std::uint64_t{1} << (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        const std::size_t slot = (node.deadline >> (kSlotBits * level)) & kSlotMask;
+        node.bucket = static_cast<std::uint16_t>(level * kSlots + slot);
+        node.prev = kNil;
+        node.next = heads_[node.bucket];
+        if (node.next != kNil) {
+            nodes_[node.next].prev = index;
+        }
+        heads_[node.bucket] = index;
+    }
+
+    void unlink(std::uint32_t index) noexcept {
+        Node &node = nodes_[index];
+        if (node.prev != kNil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.bucket] = node.next;
+        }
+        if (node.next != kNil) {
+            nodes_[node.next].prev = node.prev;
+        }
+    }
+
+    void release(std::uint32_t index) noexcept {
+        Node &node = nodes_[index];
+        node.active = false;
+        ++node.generation;
+        node.next = free_;
+        free_ = index;
+        --size_;
+    }
+
+    void cascade(std::size_t level, std::size_t slot) noexcept {
+        const std::size_t bucket = level * kSlots + slot;
+        std::uint32_t index = heads_[bucket];
+        heads_[bucket] = kNil;
+        while (index != kNil) {
+            const std::uint32_t next = nodes_[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    Clock::time_point origin_;
+    std::uint64_t now_tick_{0};
+    std::array<std::uint32_t, kSlots * kLevels> heads_{};
+    std::vector<Node> nodes_;
+    std::uint32_t free_{kNil};
+    std::size_t size_{0};
+};
+
+} // namespace net
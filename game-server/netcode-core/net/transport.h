@@ -1,9 +1,12 @@
 #pragma once
 
+#include "net/packet_buffer.h"
+
 #include <boost/asio/ip/udp.hpp>
 
 #include <cstdint>
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace net {
@@ -11,14 +14,34 @@ namespace net {
 class ITransport {
 public:
     using Endpoint = boost::asio::ip::udp::endpoint;
-    using ReceiveHandler = std::function<void(const Endpoint &, std::vector<std::uint8_t> &&)>;
+    // The packet's window is the payload; the handler may keep the handle.
+    using ReceiveHandler = std::function<void(const Endpoint &, PacketBuffer &&)>;
+    // A known peer started sending from a new address (NAT rebinding); runs before the handler
+    // sees the packet that moved it.
+    using RebindHandler = std::function<void(const Endpoint &from, const Endpoint &to)>;
+    // The peer acked a datagram that carried the send_acked() message with this token.
+    using DeliveryHandler = std::function<void(const Endpoint &, std::uint64_t token)>;
 
     virtual ~ITransport() = default;
 
     virtual void start(ReceiveHandler handler) = 0;
     virtual void stop() = 0;
     virtual void send(const Endpoint &endpoint, std::vector<std::uint8_t> data, bool reliable) = 0;
+    // Empty buffer with room in front for the transport's header; fill it and hand it to the
+    // PacketBuffer overload of send() to have the header written in place.
+    virtual PacketBuffer allocate_send_buffer() = 0;
+    virtual void send(const Endpoint &endpoint, PacketBuffer payload, bool reliable) = 0;
+    // Unreliable send that is reported to the delivery handler once the peer acks it; a lost one
+    // is never reported. The receiver gets it even if a newer message overtook it, so that what
+    // was reported is what it holds. Transports without acks just send it.
+    virtual void send_acked(const Endpoint &endpoint, PacketBuffer payload,
+                            std::uint64_t /*token*/) {
+        send(endpoint, std::move(payload), false);
+    }
     virtual void update() = 0;
+    // Sends what has been held back for coalescing since the last flush; call once per tick.
+    // update() flushes too.
+    virtual void flush() {}
 
     struct Counters {
         std::uint64_t reliable_retries_total{0};
@@ -26,10 +49,33 @@ public:
         std::uint64_t dropped_duplicates_total{0};
         std::uint64_t dropped_old_total{0};
         std::uint64_t dropped_window_total{0};
+        // Fragmented messages given up on: not complete in time, or over the memory caps.
+        std::uint64_t reassembly_timeouts_total{0};
+        std::uint64_t dropped_reassembly_total{0};
+        // Datagrams and their UDP payload bytes, transport header included.
+        std::uint64_t datagrams_sent_total{0};
+        std::uint64_t datagrams_received_total{0};
+        std::uint64_t bytes_sent_total{0};
+        std::uint64_t bytes_received_total{0};
+    };
+
+    // Round-trip estimate for one peer, from the acks of packets that were sent only once.
+    // Percentiles cover the peer's most recent samples.
+    struct PeerRtt {
+        Endpoint endpoint;
+        double srtt_ms{0.0};
+        double rttvar_ms{0.0};
+        double rto_ms{0.0};
+        double p50_ms{0.0};
+        double p99_ms{0.0};
     };
 
+    virtual void set_rebind_handler(RebindHandler /*handler*/) {}
+    virtual void set_delivery_handler(DeliveryHandler /*handler*/) {}
     virtual void set_metrics_enabled(bool /*enabled*/) {}
     virtual Counters sample_counters() const { return {}; }
+    // Peers with at least one RTT sample.
+    virtual std::vector<PeerRtt> sample_rtt() const { return {}; }
 };
 
 } // namespace net
@@ -0,0 +1,167 @@
+#include "sharded_udp_transport.h"
+
+#include <boost/asio/post.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+namespace net::udp {
+
+namespace {
+// Forwards to a shard's transport without owning it.
+class PinnedTransport : public ITransport {
+public:
+  explicit PinnedTransport(UdpTransport &transport) : transport_(transport) {}
+
+  void start(ReceiveHandler handler) override {
+    transport_.start(std::move(handler));
+  }
+  void stop() override { transport_.stop(); }
+  void send(const Endpoint &endpoint, std::vector<std::uint8_t> data,
+            bool reliable) override {
+    transport_.send(endpoint, std::move(data), reliable);
+  }
+  PacketBuffer allocate_send_buffer() override {
+    return transport_.allocate_send_buffer();
+  }
+  void send(const Endpoint &endpoint, PacketBuffer payload,
+            bool reliable) override {
+    transport_.send(endpoint, std::move(payload), reliable);
+  }
+  void send_acked(const Endpoint &endpoint, PacketBuffer payload,
+                  std::uint64_t token) override {
+    transport_.send_acked(endpoint, std::move(payload), token);
+  }
+  void update() override { transport_.update(); }
+  void flush() override { transport_.flush(); }
+  void set_rebind_handler(RebindHandler handler) override {
+    transport_.set_rebind_handler(std::move(handler));
+  }
+  void set_delivery_handler(DeliveryHandler handler) override {
+    transport_.set_delivery_handler(std::move(handler));
+  }
+  void set_metrics_enabled(bool enabled) override {
+    transport_.set_metrics_enabled(enabled);
+  }
+  Counters sample_counters() const override {
+    return transport_.sample_counters();
+  }
+  std::vector<PeerRtt> sample_rtt() const override {
+    return transport_.sample_rtt();
+  }
+
+private:
+  UdpTransport &transport_;
+};
+} // namespace
+
+ShardedUdpTransport::ShardedUdpTransport(
+    const boost::asio::ip::udp::endpoint &endpoint, std::size_t shard_count,
+    UdpTransportOptions options) {
+  if (shard_count == 0) {
+    throw std::invalid_argument("ShardedUdpTransport needs at least one shard");
+  }
+  options.reuse_port = true;
+  options.shard_count = static_cast<std::uint32_t>(shard_count);
+  // Sockets join the reuseport group in bind order, so shard i is the
+  // group's socket i. The first bind picks the port when endpoint asks for 0.
+  boost::asio::ip::udp::endpoint bind_endpoint = endpoint;
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    auto shard = std::make_unique<Shard>();
+    options.shard_index = static_cast<std::uint32_t>(i);
+    shard->transport = std::make_unique<UdpTransport>(shard->io_context,
+                                                      bind_endpoint, options);
+    bind_endpoint.port(shard->transport->local_endpoint().port());
+    shards_.push_back(std::move(shard));
+  }
+}
+
+ShardedUdpTransport::~ShardedUdpTransport() { stop(); }
+
+void ShardedUdpTransport::start(ShardReceiveHandler handler) {
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i]->transport->start(
+        [handler, i](const ITransport::Endpoint &endpoint,
+                     PacketBuffer &&packet) {
+          handler(i, endpoint, std::move(packet));
+        });
+  }
+  run();
+}
+
+void ShardedUdpTransport::run() {
+  for (auto &shard : shards_) {
+    if (!shard->thread.joinable()) {
+      Shard *raw = shard.get();
+      shard->thread = std::thread([raw]() { raw->io_context.run(); });
+    }
+  }
+}
+
+void ShardedUdpTransport::stop() {
+  for (auto &shard : shards_) {
+    shard->transport->stop();
+    shard->work.reset();
+    shard->io_context.stop();
+  }
+  for (auto &shard : shards_) {
+    if (shard->thread.joinable()) {
+      shard->thread.join();
+    }
+  }
+}
+
+void ShardedUdpTransport::update() {
+  for (auto &shard : shards_) {
+    UdpTransport *transport = shard->transport.get();
+    boost::asio::post(shard->io_context,
+                      [transport]() { transport->update(); });
+  }
+}
+
+UdpTransport &ShardedUdpTransport::shard(std::size_t index) {
+  return *shards_.at(index)->transport;
+}
+
+boost::asio::io_context &ShardedUdpTransport::shard_context(std::size_t index) {
+  return shards_.at(index)->io_context;
+}
+
+std::unique_ptr<ITransport> ShardedUdpTransport::pin(std::size_t index) {
+  return std::make_unique<PinnedTransport>(shard(index));
+}
+
+boost::asio::ip::udp::endpoint ShardedUdpTransport::local_endpoint() const {
+  return shards_.front()->transport->local_endpoint();
+}
+
+ITransport::Counters ShardedUdpTransport::sample_counters() const {
+  ITransport::Counters total;
+  for (const auto &shard : shards_) {
+    const ITransport::Counters counters = shard->transport->sample_counters();
+    total.reliable_retries_total += counters.reliable_retries_total;
+    total.reliable_timeouts_total += counters.reliable_timeouts_total;
+    total.dropped_duplicates_total += counters.dropped_duplicates_total;
+    total.dropped_old_total += counters.dropped_old_total;
+    total.dropped_window_total += counters.dropped_window_total;
+    total.reassembly_timeouts_total += counters.reassembly_timeouts_total;
+    total.dropped_reassembly_total += counters.dropped_reassembly_total;
+    total.datagrams_sent_total += counters.datagrams_sent_total;
+    total.datagrams_received_total += counters.datagrams_received_total;
+    total.bytes_sent_total += counters.bytes_sent_total;
+    total.bytes_received_total += counters.bytes_received_total;
+  }
+  return total;
+}
+
+std::vector<ITransport::PeerRtt> ShardedUdpTransport::sample_rtt() const {
+  std::vector<ITransport::PeerRtt> peers;
+  for (const auto &shard : shards_) {
+    std::vector<ITransport::PeerRtt> shard_peers =
+        shard->transport->sample_rtt();
+    peers.insert(peers.end(), shard_peers.begin(), shard_peers.end());
+  }
+  return peers;
+}
+
+} // namespace net::udp
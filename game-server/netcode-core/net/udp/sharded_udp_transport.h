@@ -0,0 +1,71 @@
+#pragma once
+
+#include "udp_transport.h"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace net::udp {
+
+// N UdpTransports bound to one port with SO_REUSEPORT, each with its own
+// io_context and thread. The kernel spreads clients over the sockets by flow
+// hash (or by connection id when UdpTransportOptions::connection_ids is set),
+// and each shard owns the clients it hears from, so shards share no locks.
+//
+// Work for a client belongs on its shard: either start() with one handler that
+// is told the shard, or pin() a room server to a shard and run() the threads.
+class ShardedUdpTransport {
+public:
+  using ShardReceiveHandler = std::function<void(
+      std::size_t shard, const ITransport::Endpoint &, PacketBuffer &&)>;
+
+  ShardedUdpTransport(const boost::asio::ip::udp::endpoint &endpoint,
+                      std::size_t shard_count,
+                      UdpTransportOptions options = {});
+  ~ShardedUdpTransport();
+
+  ShardedUdpTransport(const ShardedUdpTransport &) = delete;
+  ShardedUdpTransport &operator=(const ShardedUdpTransport &) = delete;
+
+  // Starts every shard's transport with handler, then run().
+  void start(ShardReceiveHandler handler);
+  // Starts the shard threads; transports started through pin() handles
+  // receive from here on.
+  void run();
+  void stop();
+
+  // Runs update() on every shard's thread.
+  void update();
+
+  std::size_t shard_count() const { return shards_.size(); }
+  UdpTransport &shard(std::size_t index);
+  boost::asio::io_context &shard_context(std::size_t index);
+  // A transport handle for one shard, for a room server that owns its
+  // transport. Only that room may start the shard; the handle must not outlive
+  // this object.
+  std::unique_ptr<ITransport> pin(std::size_t index);
+
+  boost::asio::ip::udp::endpoint local_endpoint() const;
+  ITransport::Counters sample_counters() const;
+  std::vector<ITransport::PeerRtt> sample_rtt() const;
+
+private:
+  struct Shard {
+    boost::asio::io_context io_context;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        work{io_context.get_executor()};
+    std::unique_ptr<UdpTransport> transport;
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace net::udp
@@ -3,11 +3,29 @@
 #include <boost/asio/post.hpp>
 #include <boost/endian/conversion.hpp>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
+#ifdef __linux__
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+#endif
+
 namespace net::udp {
 
 namespace {
@@ -21,32 +39,299 @@ std::string endpoint_key(const boost::asio::ip::udp::endpoint &endpoint) {
 }
 
 constexpr std::size_t kHeaderSize = sizeof(UdpHeader);
+constexpr std::size_t kConnectionIdSize = sizeof(std::uint32_t);
 constexpr std::size_t kMaxWindow = 32;
 constexpr std::uint32_t kMaxRetries = 5;
-const std::chrono::milliseconds kBaseRetransmit{50};
-const std::chrono::milliseconds kTtl{500};
 
-std::chrono::milliseconds backoff_for(std::uint32_t retries) {
-  double interval = static_cast<double>(kBaseRetransmit.count());
+constexpr std::size_t kMaxDatagramSize = PacketBuffer::kCapacity;
+// recvmmsg rounds per wakeup before yielding to other io_context work.
+constexpr std::size_t kMaxBatchesPerWakeup = 4;
+constexpr std::size_t kMaxBatchSize = 1024; // UIO_MAXIOV
+constexpr std::size_t kMaxGsoSegments = 64;
+constexpr std::size_t kMaxGsoBytes = 65000;
+constexpr std::size_t kMessageHeaderSize = 4;
+constexpr std::uint16_t kReliableMessage = 0x8000;
+// Set on messages from send_acked(), which are accepted even when stale.
+constexpr std::uint16_t kUnorderedMessage = 0x4000;
+// The length takes the low 14 bits, far more than a datagram holds.
+constexpr std::size_t kMaxMessageLength = 0x3FFF;
+// Bounded so the receiver can mark the messages it accepts in one word.
+constexpr std::size_t kMaxMessagesPerDatagram = 64;
+// With fragmentation, the last header byte says whether the datagram is a
+// whole payload or a fragment. A fragment's payload starts with the message
+// id, its index, the fragment count and the size of every fragment but the
+// last, each a big-endian 16-bit value.
+constexpr std::size_t kDatagramKindSize = 1;
+constexpr std::uint8_t kWholeDatagram = 0;
+constexpr std::uint8_t kFragmentDatagram = 1;
+constexpr std::size_t kFragmentHeaderSize = 8;
+// Reliable fragments a client may have waiting for the window.
+constexpr std::size_t kMaxQueuedFragments = 1024;
+// Reassembly buffers are large; grow the pool a few at a time.
+constexpr std::size_t kReassemblyBuffersPerSlab = 4;
+
+using QueuedPacket = UdpTransport::QueuedPacket;
+
+// Packets from first that can share one GSO send: same endpoint, same size,
+// except that the last one may be shorter.
+std::size_t gso_run_length(const std::vector<QueuedPacket> &packets,
+                           std::size_t first) {
+  const QueuedPacket &head = packets[first];
+  const std::size_t segment = head.data.size();
+  std::size_t total = segment;
+  std::size_t run = 1;
+  while (first + run < packets.size() && run < kMaxGsoSegments) {
+    const QueuedPacket &next = packets[first + run];
+    if (next.endpoint != head.endpoint || next.data.size() > segment ||
+        total + next.data.size() > kMaxGsoBytes) {
+      break;
+    }
+    total += next.data.size();
+    ++run;
+    if (next.data.size() < segment) {
+      break;
+    }
+  }
+  return run;
+}
+
+UdpTransport::Clock::duration backoff_for(UdpTransport::Clock::duration base,
+                                         std::uint32_t retries) {
+  double interval = static_cast<double>(base.count());
   for (std::uint32_t i = 0; i < retries; ++i) {
     interval *= 1.5;
   }
-  return std::chrono::milliseconds(static_cast<std::int64_t>(interval));
+  return UdpTransport::Clock::duration(static_cast<std::int64_t>(interval));
+}
+
+// An aggregated datagram's payload is a run of frames: a big-endian 16-bit
+// length whose top bit marks a reliable message and whose next bit marks an
+// unreliable one to deliver even if it is stale, the message's big-endian
+// 16-bit sequence number in its channel, then the message.
+struct MessageFrame {
+  bool reliable{false};
+  bool unordered{false};
+  std::uint16_t seq{0};
+  std::size_t offset{0};
+  std::size_t length{0};
+};
+
+void write_message_header(std::uint8_t *out, bool reliable, bool unordered,
+                          std::uint16_t seq, std::size_t length) {
+  const std::uint16_t length_be = boost::endian::native_to_big(
+      static_cast<std::uint16_t>(length | (reliable ? kReliableMessage : 0) |
+                                 (unordered ? kUnorderedMessage : 0)));
+  const std::uint16_t seq_be = boost::endian::native_to_big(seq);
+  std::memcpy(out, &length_be, sizeof(length_be));
+  std::memcpy(out + sizeof(length_be), &seq_be, sizeof(seq_be));
+}
+
+// Calls visit(index, frame) for each frame, up to kMaxMessagesPerDatagram.
+// Returns false if the frames do not add up to size.
+template <typename F>
+bool for_each_message(const std::uint8_t *data, std::size_t size, F &&visit) {
+  std::size_t offset = 0;
+  for (std::size_t index = 0;
+       index < kMaxMessagesPerDatagram && size - offset >= kMessageHeaderSize;
+       ++index) {
+    std::uint16_t length = 0;
+    std::uint16_t seq = 0;
+    std::memcpy(&length, data + offset, sizeof(length));
+    std::memcpy(&seq, data + offset + sizeof(length), sizeof(seq));
+    length = boost::endian::big_to_native(length);
+    MessageFrame frame;
+    frame.reliable = (length & kReliableMessage) != 0;
+    frame.unordered = (length & kUnorderedMessage) != 0;
+    frame.seq = boost::endian::big_to_native(seq);
+    frame.offset = offset + kMessageHeaderSize;
+    frame.length = length & kMaxMessageLength;
+    if (frame.length > size - frame.offset) {
+      return false;
+    }
+    visit(index, frame);
+    offset = frame.offset + frame.length;
+  }
+  return offset == size;
+}
+
+void write_fragment_header(std::uint8_t *out, std::uint16_t message_id,
+                           std::uint16_t index, std::uint16_t count,
+                           std::uint16_t fragment_size) {
+  const std::uint16_t fields[] = {message_id, index, count, fragment_size};
+  for (std::size_t i = 0; i < 4; ++i) {
+    const std::uint16_t field_be = boost::endian::native_to_big(fields[i]);
+    std::memcpy(out + i * sizeof(field_be), &field_be, sizeof(field_be));
+  }
+}
+
+std::uint16_t read_u16(const std::uint8_t *in) {
+  std::uint16_t value = 0;
+  std::memcpy(&value, in, sizeof(value));
+  return boost::endian::big_to_native(value);
+}
+
+double to_milliseconds(UdpTransport::Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Nearest-rank percentile; reorders values.
+double percentile(std::vector<float> &values, double p) {
+  const std::size_t rank = std::min(
+      values.size() - 1,
+      static_cast<std::size_t>(p * static_cast<double>(values.size())));
+  std::nth_element(values.begin(),
+                   values.begin() + static_cast<std::ptrdiff_t>(rank),
+                   values.end());
+  return values[rank];
+}
+} // namespace
+
+#ifdef __linux__
+// Scratch space for recvmmsg/sendmmsg. The receive side is only touched by the
+// io_context; the send side is guarded by flush_mutex.
+struct UdpTransport::BatchState {
+  union GsoControl {
+    char buffer[CMSG_SPACE(sizeof(std::uint16_t))];
+    cmsghdr align;
+  };
+
+  BatchState(std::size_t size, bool gso_enabled, PacketBufferPool &pool)
+      : batch_size(size), gso(gso_enabled), recv_packets(size),
+        recv_msgs(size), recv_iovecs(size), recv_addresses(size),
+        send_msgs(size), send_iovecs(size), send_controls(size),
+        send_counts(size), gso_buffers(size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      recv_msgs[i].msg_hdr.msg_iov = &recv_iovecs[i];
+      recv_msgs[i].msg_hdr.msg_iovlen = 1;
+      recv_msgs[i].msg_hdr.msg_name = &recv_addresses[i];
+      arm_receive(i, pool);
+    }
+  }
+
+  // Gives receive slot i a fresh pool buffer after its packet was handed on.
+  void arm_receive(std::size_t i, PacketBufferPool &pool) {
+    recv_packets[i] = pool.acquire();
+    recv_iovecs[i].iov_base = recv_packets[i].data();
+    recv_iovecs[i].iov_len = kMaxDatagramSize;
+  }
+
+  const std::size_t batch_size;
+  bool gso;
+
+  std::vector<PacketBuffer> recv_packets;
+  std::vector<mmsghdr> recv_msgs;
+  std::vector<iovec> recv_iovecs;
+  std::vector<sockaddr_storage> recv_addresses;
+
+  std::mutex queue_mutex;
+  std::vector<QueuedPacket> queue;
+
+  std::mutex flush_mutex;
+  std::vector<QueuedPacket> flushing;
+  std::vector<mmsghdr> send_msgs;
+  std::vector<iovec> send_iovecs;
+  std::vector<GsoControl> send_controls;
+  std::vector<std::size_t> send_counts; // packets carried by each message
+  std::vector<std::vector<std::uint8_t>> gso_buffers;
+};
+#else
+struct UdpTransport::BatchState {};
+#endif
+
+namespace {
+#ifdef __linux__
+// Classic BPF for the reuseport group: the socket index is the connection id
+// modulo the shard count. Packets with id 0 get an out-of-range index, which
+// makes the kernel fall back to its flow hash. A packet too short to carry an
+// id fails the load, which ends the program with 0 and sends it to shard 0.
+void attach_connection_id_steering(int fd, std::uint32_t shard_count) {
+  sock_filter code[] = {
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, kHeaderSize),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 2, 0),
+      BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, shard_count),
+      BPF_STMT(BPF_RET | BPF_A, 0),
+      BPF_STMT(BPF_RET | BPF_K, 0xffffffffu),
+  };
+  sock_fprog program{};
+  program.len = static_cast<unsigned short>(sizeof(code) / sizeof(code[0]));
+  program.filter = code;
+  if (::setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program,
+                   sizeof(program)) != 0) {
+    throw std::runtime_error(
+        std::string{"failed to attach reuseport filter: "} +
+        std::strerror(errno));
+  }
 }
+#endif
 } // namespace
 
 UdpTransport::UdpTransport(boost::asio::io_context &io_context,
-                           const boost::asio::ip::udp::endpoint &endpoint)
-    : io_context_(io_context), socket_(io_context) {
+                           const boost::asio::ip::udp::endpoint &endpoint,
+                           UdpTransportOptions options)
+    : io_context_(io_context), socket_(io_context),
+      connection_ids_(options.connection_ids),
+      header_size_(kHeaderSize +
+                   (options.connection_ids ? kConnectionIdSize : 0) +
+                   (options.fragmentation ? kDatagramKindSize : 0)),
+      shard_index_(options.shard_index),
+      shard_count_(std::max<std::uint32_t>(options.shard_count, 1)),
+      aggregate_messages_(options.aggregate_messages),
+      max_datagram_size_(std::clamp<std::size_t>(
+          options.max_datagram_size,
+          header_size_ + kMessageHeaderSize + kFragmentHeaderSize + 1,
+          kMaxDatagramSize)),
+      fragmentation_(options.fragmentation),
+      max_message_size_(options.max_message_size),
+      max_reassemblies_(options.max_reassemblies),
+      max_reassembly_bytes_(options.max_reassembly_bytes),
+      reassembly_timeout_(options.reassembly_timeout),
+      adaptive_rto_(options.adaptive_rto),
+      retransmit_interval_(options.retransmit_interval),
+      min_rto_(options.min_rto),
+      max_rto_(std::max(options.max_rto, options.min_rto)),
+      reliable_ttl_(options.reliable_ttl),
+      rtt_window_(std::max<std::size_t>(options.rtt_window, 1)),
+      reassembly_pool_(kReassemblyBuffersPerSlab,
+                       options.fragmentation ? options.max_message_size : 0) {
+  if (shard_index_ >= shard_count_) {
+    throw std::invalid_argument("UDP shard index out of range");
+  }
   boost::system::error_code ec;
   socket_.open(endpoint.protocol(), ec);
   if (ec) {
     throw std::runtime_error("failed to open UDP socket: " + ec.message());
   }
+#ifdef SO_REUSEPORT
+  if (options.reuse_port) {
+    using reuse_port = boost::asio::detail::socket_option::boolean<
+        SOL_SOCKET, SO_REUSEPORT>;
+    socket_.set_option(reuse_port(true), ec);
+    if (ec) {
+      throw std::runtime_error("failed to set SO_REUSEPORT: " + ec.message());
+    }
+  }
+#else
+  if (options.reuse_port) {
+    throw std::runtime_error("SO_REUSEPORT is not available");
+  }
+#endif
   socket_.bind(endpoint, ec);
   if (ec) {
     throw std::runtime_error("failed to bind UDP socket: " + ec.message());
   }
+#ifdef __linux__
+  if (options.reuse_port && options.connection_ids && shard_count_ > 1 &&
+      shard_index_ == 0) {
+    attach_connection_id_steering(socket_.native_handle(), shard_count_);
+  }
+  if (options.batched_io) {
+    batch_ = std::make_unique<BatchState>(
+        std::clamp<std::size_t>(options.batch_size, 1, kMaxBatchSize),
+        options.gso, pool_);
+  }
+#else
+  (void)options;
+#endif
 }
 
 UdpTransport::~UdpTransport() { stop(); }
@@ -75,9 +360,37 @@ net::ITransport::Counters UdpTransport::sample_counters() const {
   counters.dropped_duplicates_total = dropped_duplicates_total_.load();
   counters.dropped_old_total = dropped_old_total_.load();
   counters.dropped_window_total = dropped_window_total_.load();
+  counters.reassembly_timeouts_total = reassembly_timeouts_total_.load();
+  counters.dropped_reassembly_total = dropped_reassembly_total_.load();
+  counters.datagrams_sent_total = datagrams_sent_total_.load();
+  counters.datagrams_received_total = datagrams_received_total_.load();
+  counters.bytes_sent_total = bytes_sent_total_.load();
+  counters.bytes_received_total = bytes_received_total_.load();
   return counters;
 }
 
+std::vector<net::ITransport::PeerRtt> UdpTransport::sample_rtt() const {
+  std::vector<PeerRtt> peers;
+  std::vector<float> samples;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &entry : clients_) {
+    const ClientState &client = entry.value;
+    if (!client.rtt.has_sample) {
+      continue;
+    }
+    PeerRtt peer;
+    peer.endpoint = client.endpoint;
+    peer.srtt_ms = to_milliseconds(client.rtt.srtt);
+    peer.rttvar_ms = to_milliseconds(client.rtt.rttvar);
+    peer.rto_ms = to_milliseconds(client.rtt.rto);
+    samples = client.rtt.samples;
+    peer.p50_ms = percentile(samples, 0.5);
+    peer.p99_ms = percentile(samples, 0.99);
+    peers.push_back(peer);
+  }
+  return peers;
+}
+
 boost::asio::ip::udp::endpoint UdpTransport::local_endpoint() const {
   boost::system::error_code ec;
   const auto ep = socket_.local_endpoint(ec);
@@ -89,32 +402,86 @@ boost::asio::ip::udp::endpoint UdpTransport::local_endpoint() const {
 
 void UdpTransport::send(const Endpoint &endpoint,
                         std::vector<std::uint8_t> data, bool reliable) {
+  if (needs_fragments(data.size())) {
+    send_fragmented(endpoint, data.data(), data.size(), reliable);
+    return;
+  }
+  PacketBuffer payload = allocate_send_buffer();
+  if (data.size() > payload.tailroom()) {
+    log_drop("oversize", endpoint, 0);
+    return;
+  }
+  payload.assign(data.data(), data.size());
+  send(endpoint, std::move(payload), reliable);
+}
+
+PacketBuffer UdpTransport::allocate_send_buffer() {
+  return pool_.acquire(header_size_ +
+                       (aggregate_messages_ ? kMessageHeaderSize : 0));
+}
+
+void UdpTransport::set_rebind_handler(RebindHandler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rebind_handler_ = std::move(handler);
+}
+
+void UdpTransport::set_delivery_handler(DeliveryHandler handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  delivery_handler_ = std::move(handler);
+}
+
+void UdpTransport::send(const Endpoint &endpoint, PacketBuffer payload,
+                        bool reliable) {
+  send_payload(endpoint, std::move(payload), reliable, nullptr);
+}
+
+void UdpTransport::send_acked(const Endpoint &endpoint, PacketBuffer payload,
+                              std::uint64_t token) {
+  send_payload(endpoint, std::move(payload), false, &token);
+}
+
+void UdpTransport::send_payload(const Endpoint &endpoint, PacketBuffer payload,
+                                bool reliable, const std::uint64_t *token) {
+  if (needs_fragments(payload.size())) {
+    send_fragmented(endpoint, payload.data(), payload.size(), reliable);
+    return;
+  }
   const auto now = Clock::now();
-  std::shared_ptr<std::vector<std::uint8_t>> buffer;
+  PacketBuffer packet;
   boost::asio::ip::udp::endpoint endpoint_copy;
   bool drop_for_window = false;
+  bool drop_oversize = false;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     ClientState &client = ensure_client_locked(endpoint);
     endpoint_copy = client.endpoint;
-    const std::uint16_t seq = client.next_send_seq++;
     if (reliable && client.pending.size() >= kMaxWindow) {
       drop_for_window = true;
       dropped_window_total_.fetch_add(1);
+    } else if (aggregate_messages_) {
+      // Held until flush(), unless it filled the datagram before it.
+      QueuedPacket sealed;
+      drop_oversize = !append_message_locked(client, payload, reliable,
+                                             token != nullptr, sealed);
+      packet = std::move(sealed.data);
+      if (!drop_oversize && token) {
+        client.outgoing_tokens.push_back(*token);
+      }
     } else {
-      auto packet_buffer = compose_packet(client, seq, data);
+      const std::uint16_t seq = client.next_send_seq++;
+      if (payload.headroom() >= header_size_) {
+        // The header goes into the headroom in front of the payload.
+        packet = std::move(payload);
+        packet.push_front(header_size_);
+        write_header(client, seq, packet.data());
+      } else {
+        packet = compose_packet(client, seq, payload);
+      }
       if (reliable) {
-        PendingPacket pending;
-        pending.seq = seq;
-        pending.payload = data;
-        pending.first_sent = now;
-        pending.last_sent = now;
-        pending.next_send = now + backoff_for(0);
-        pending.retries = 0;
-        client.pending[seq] = std::move(pending);
+        add_pending_locked(client, seq, packet, now);
+      } else if (token) {
+        track_delivery_locked(client, seq, *token);
       }
-      buffer =
-          std::make_shared<std::vector<std::uint8_t>>(std::move(packet_buffer));
     }
   }
 
@@ -122,64 +489,390 @@ void UdpTransport::send(const Endpoint &endpoint,
     log_drop("window", endpoint, 0);
     return;
   }
+  if (drop_oversize) {
+    log_drop("oversize", endpoint, 0);
+    return;
+  }
 
-  if (buffer) {
-    post_send_buffer(buffer, endpoint_copy);
+  if (packet) {
+    dispatch(std::move(packet), endpoint_copy);
   }
 }
 
-void UdpTransport::update() {
+// Frames payload onto the client's coalesced datagram. When it does not fit
+// behind what is there, that datagram is sealed into sealed first. Returns
+// false for a message too large for any datagram.
+bool UdpTransport::append_message_locked(ClientState &client,
+                                         PacketBuffer &payload, bool reliable,
+                                         bool unordered,
+                                         QueuedPacket &sealed) {
+  const std::size_t length = payload.size();
+  const std::size_t frame_size = kMessageHeaderSize + length;
+  if (length > kMaxMessageLength ||
+      header_size_ + frame_size > kMaxDatagramSize) {
+    return false;
+  }
+  if (client.outgoing &&
+      (header_size_ + client.outgoing.size() + frame_size >
+           max_datagram_size_ ||
+       client.outgoing.tailroom() < frame_size ||
+       client.outgoing_messages == kMaxMessagesPerDatagram)) {
+    sealed = seal_outgoing_locked(client);
+  }
+
+  const std::uint16_t seq = reliable ? client.next_reliable_message++
+                                     : client.next_unreliable_message++;
+  if (!client.outgoing) {
+    outgoing_clients_.push_back(EndpointKey::from(client.endpoint));
+    if (payload && payload.headroom() >= header_size_ + kMessageHeaderSize) {
+      // The first message stays where the caller wrote it; the frame and
+      // datagram headers go into its headroom.
+      payload.push_front(kMessageHeaderSize);
+      write_message_header(payload.data(), reliable, unordered, seq, length);
+      client.outgoing = std::move(payload);
+    } else {
+      client.outgoing = pool_.acquire(header_size_);
+    }
+  }
+  if (payload) {
+    const std::size_t offset = client.outgoing.size();
+    client.outgoing.resize(offset + frame_size);
+    std::uint8_t *frame = client.outgoing.data() + offset;
+    write_message_header(frame, reliable, unordered, seq, length);
+    if (length > 0) {
+      std::memcpy(frame + kMessageHeaderSize, payload.data(), length);
+    }
+  }
+  ++client.outgoing_messages;
+  client.outgoing_reliable = client.outgoing_reliable || reliable;
+  client.outgoing_unreliable = client.outgoing_unreliable || !reliable;
+  return true;
+}
+
+// Turns the client's coalesced messages into a datagram. One that carries
+// reliable messages is tracked for retransmit with only those, since resending
+// stale unreliable ones would do no good.
+UdpTransport::QueuedPacket
+UdpTransport::seal_outgoing_locked(ClientState &client) {
+  PacketBuffer packet = std::move(client.outgoing);
+  const std::uint16_t seq = client.next_send_seq++;
+  packet.push_front(header_size_);
+  write_header(client, seq, packet.data());
+  if (client.outgoing_reliable) {
+    PacketBuffer retransmit = packet;
+    if (client.outgoing_unreliable) {
+      retransmit = pool_.acquire();
+      retransmit.assign(packet.data(), header_size_);
+      const std::uint8_t *frames = packet.data() + header_size_;
+      for_each_message(frames, packet.size() - header_size_,
+                       [&](std::size_t, const MessageFrame &frame) {
+                         if (!frame.reliable) {
+                           return;
+                         }
+                         const std::size_t start =
+                             frame.offset - kMessageHeaderSize;
+                         const std::size_t size =
+                             kMessageHeaderSize + frame.length;
+                         const std::size_t offset = retransmit.size();
+                         retransmit.resize(offset + size);
+                         std::memcpy(retransmit.data() + offset,
+                                     frames + start, size);
+                       });
+    }
+    add_pending_locked(client, seq, std::move(retransmit), Clock::now());
+  }
+  for (const std::uint64_t token : client.outgoing_tokens) {
+    track_delivery_locked(client, seq, token);
+  }
+  client.outgoing_tokens.clear();
+  client.outgoing_messages = 0;
+  client.outgoing_reliable = false;
+  client.outgoing_unreliable = false;
+  return QueuedPacket{std::move(packet), client.endpoint};
+}
+
+bool UdpTransport::needs_fragments(std::size_t payload_size) const {
+  return fragmentation_ &&
+         header_size_ + (aggregate_messages_ ? kMessageHeaderSize : 0) +
+                 payload_size >
+             max_datagram_size_;
+}
+
+// Splits a message into datagram-sized fragments. Unreliable ones go out
+// now; reliable ones join the client's queue and go out as the window
+// allows. A fragment is a message of its own on the receiving side, so
+// aggregation does not frame it.
+void UdpTransport::send_fragmented(const Endpoint &endpoint,
+                                   const std::uint8_t *data, std::size_t size,
+                                   bool reliable) {
+  if (size > max_message_size_) {
+    log_drop("oversize", endpoint, 0);
+    return;
+  }
   const auto now = Clock::now();
-  std::vector<std::shared_ptr<std::vector<std::uint8_t>>> buffers;
-  std::vector<boost::asio::ip::udp::endpoint> endpoints;
+  const std::size_t fragment_size =
+      max_datagram_size_ - header_size_ - kFragmentHeaderSize;
+  const std::size_t count = (size + fragment_size - 1) / fragment_size;
+  std::vector<QueuedPacket> ready;
+  bool drop_for_window = false;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto &pair : clients_) {
-      ClientState &client = pair.second;
-      std::vector<std::uint16_t> expired;
-      expire_pending_locked(client, now, expired);
-      for (auto seq : expired) {
-        client.pending.erase(seq);
+    ClientState &client = ensure_client_locked(endpoint);
+    if (count > 0xffff ||
+        (reliable &&
+         client.queued_fragments.size() + count > kMaxQueuedFragments)) {
+      drop_for_window = true;
+      dropped_window_total_.fetch_add(1);
+    } else {
+      const std::uint16_t message_id = client.next_fragmented_message++;
+      for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t offset = i * fragment_size;
+        const std::size_t length = std::min(fragment_size, size - offset);
+        PacketBuffer fragment = pool_.acquire(header_size_);
+        fragment.resize(kFragmentHeaderSize + length);
+        write_fragment_header(fragment.data(), message_id,
+                              static_cast<std::uint16_t>(i),
+                              static_cast<std::uint16_t>(count),
+                              static_cast<std::uint16_t>(fragment_size));
+        std::memcpy(fragment.data() + kFragmentHeaderSize, data + offset,
+                    length);
+        if (reliable) {
+          client.queued_fragments.push_back(std::move(fragment));
+        } else {
+          ready.push_back(QueuedPacket{
+              seal_fragment_locked(client, std::move(fragment), false, now),
+              client.endpoint});
+        }
       }
-      for (auto &pending_pair : client.pending) {
-        PendingPacket &pending = pending_pair.second;
-        if (pending.next_send <= now) {
-          auto resend_buffer =
-              compose_packet(client, pending.seq, pending.payload);
-          pending.last_sent = now;
-          ++pending.retries;
-          pending.next_send = now + backoff_for(pending.retries);
-          buffers.emplace_back(std::make_shared<std::vector<std::uint8_t>>(
-              std::move(resend_buffer)));
-          endpoints.push_back(client.endpoint);
-          reliable_retries_total_.fetch_add(1);
-          if (metrics_enabled_.load()) {
-            std::cout << "[DEBUG] retransmit seq=" << pending.seq
-                      << " retries=" << pending.retries
-                      << " endpoint=" << endpoint_key(client.endpoint)
-                      << std::endl;
-          }
+      if (reliable) {
+        if (!client.fragments_listed) {
+          client.fragments_listed = true;
+          fragment_clients_.push_back(EndpointKey::from(client.endpoint));
         }
+        pump_fragments_locked(client, now, ready);
+      }
+    }
+  }
+
+  if (drop_for_window) {
+    log_drop("window", endpoint, 0);
+    return;
+  }
+  for (QueuedPacket &packet : ready) {
+    dispatch(std::move(packet.data), packet.endpoint);
+  }
+}
+
+PacketBuffer UdpTransport::seal_fragment_locked(ClientState &client,
+                                                PacketBuffer fragment,
+                                                bool reliable,
+                                                Clock::time_point now) {
+  const std::uint16_t seq = client.next_send_seq++;
+  fragment.push_front(header_size_);
+  write_header(client, seq, fragment.data());
+  fragment.data()[header_size_ - kDatagramKindSize] = kFragmentDatagram;
+  if (reliable) {
+    add_pending_locked(client, seq, fragment, now).fragment = true;
+  }
+  return fragment;
+}
+
+// Sends queued reliable fragments while the client's window has room.
+void UdpTransport::pump_fragments_locked(ClientState &client,
+                                         Clock::time_point now,
+                                         std::vector<QueuedPacket> &out) {
+  while (!client.queued_fragments.empty() &&
+         client.pending.size() < kMaxWindow) {
+    PacketBuffer fragment = std::move(client.queued_fragments.front());
+    client.queued_fragments.pop_front();
+    out.push_back(QueuedPacket{
+        seal_fragment_locked(client, std::move(fragment), true, now),
+        client.endpoint});
+  }
+}
+
+// Seals every client's coalesced messages and sends them. Called with
+// update_mutex_ held.
+void UdpTransport::send_outgoing() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushing_clients_.swap(outgoing_clients_);
+    for (const EndpointKey &key : flushing_clients_) {
+      ClientState *client = clients_.find(key);
+      if (client && client->outgoing) {
+        sealed_.push_back(seal_outgoing_locked(*client));
       }
     }
+    flushing_clients_.clear();
   }
+  for (QueuedPacket &packet : sealed_) {
+    dispatch(std::move(packet.data), packet.endpoint);
+  }
+  sealed_.clear();
+}
 
-  for (std::size_t i = 0; i < buffers.size(); ++i) {
-    post_send_buffer(buffers[i], endpoints[i]);
+void UdpTransport::update() {
+  const auto now = Clock::now();
+  std::lock_guard<std::mutex> update_lock(update_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    due_timers_.clear();
+    retransmit_wheel_.advance(now, [this](const RetransmitTimer &timer) {
+      due_timers_.push_back(timer);
+    });
+    for (const RetransmitTimer &timer : due_timers_) {
+      handle_retransmit_timer_locked(timer, now);
+    }
+    // Acks since the last update may have made room for queued fragments.
+    std::size_t listed = 0;
+    for (const EndpointKey &key : fragment_clients_) {
+      ClientState *client = clients_.find(key);
+      if (!client || !client->fragments_listed) {
+        continue;
+      }
+      pump_fragments_locked(*client, now, due_packets_);
+      if (client->queued_fragments.empty()) {
+        client->fragments_listed = false;
+      } else {
+        fragment_clients_[listed++] = key;
+      }
+    }
+    fragment_clients_.resize(listed);
+    listed = 0;
+    for (const EndpointKey &key : reassembly_clients_) {
+      ClientState *client = clients_.find(key);
+      if (!client || !client->reassemblies_listed) {
+        continue;
+      }
+      expire_reassemblies_locked(*client, now);
+      if (client->reassemblies.empty()) {
+        client->reassemblies_listed = false;
+      } else {
+        reassembly_clients_[listed++] = key;
+      }
+    }
+    reassembly_clients_.resize(listed);
+  }
+
+  for (QueuedPacket &packet : due_packets_) {
+    dispatch(std::move(packet.data), packet.endpoint);
+  }
+  due_packets_.clear();
+  if (aggregate_messages_) {
+    send_outgoing();
+  }
+  flush_socket();
+}
+
+void UdpTransport::flush() {
+  if (aggregate_messages_) {
+    std::lock_guard<std::mutex> update_lock(update_mutex_);
+    send_outgoing();
+  }
+  flush_socket();
+}
+
+// Sends everything queued in batched mode; a no-op otherwise.
+void UdpTransport::flush_socket() {
+#ifdef __linux__
+  if (!batch_) {
+    return;
+  }
+  std::lock_guard<std::mutex> flush_lock(batch_->flush_mutex);
+  {
+    std::lock_guard<std::mutex> lock(batch_->queue_mutex);
+    batch_->flushing.swap(batch_->queue);
   }
+  if (!batch_->flushing.empty()) {
+    send_batched(0);
+    batch_->flushing.clear();
+  }
+#endif
 }
 
 UdpTransport::ClientState &UdpTransport::ensure_client_locked(
     const boost::asio::ip::udp::endpoint &endpoint) {
-  const std::string key = endpoint_key(endpoint);
-  auto [it, inserted] = clients_.try_emplace(key);
+  auto [client, inserted] = clients_.try_emplace(EndpointKey::from(endpoint));
   if (inserted) {
-    it->second.endpoint = endpoint;
-    it->second.next_send_seq = 1;
-  } else {
-    it->second.endpoint = endpoint;
+    client->endpoint = endpoint;
+    client->rtt.rto = retransmit_interval_;
   }
-  return it->second;
+  return *client;
+}
+
+// Finds the client a received packet belongs to, following its connection id
+// to a new address when the peer was rebound. Returns null for a packet that
+// names a known connection from a new address but is not newer than what that
+// connection already delivered, which is a replay rather than a rebinding.
+UdpTransport::ClientState *UdpTransport::receive_client_locked(
+    const Endpoint &endpoint, std::uint32_t connection_id, std::uint16_t seq,
+    Endpoint &rebound_from, bool &rebound) {
+  const EndpointKey key = EndpointKey::from(endpoint);
+  ClientState *client = clients_.find(key);
+  if (!client && connection_id != 0) {
+    if (const EndpointKey *known = connection_index_.find(connection_id)) {
+      const EndpointKey old_key = *known;
+      ClientState *old_client = clients_.find(old_key);
+      if (old_client && old_client->receive_state.has_last_seq &&
+          !is_seq_newer(seq, old_client->receive_state.last_seq)) {
+        return nullptr;
+      }
+      if (old_client) {
+        ClientState moved = std::move(*old_client);
+        clients_.erase(old_key);
+        rebound_from = moved.endpoint;
+        rebound = true;
+        moved.endpoint = endpoint;
+        client = clients_.try_emplace(key).first;
+        *client = std::move(moved);
+        *connection_index_.find(connection_id) = key;
+        for (auto &pair : client->pending) {
+          schedule_retransmit_locked(key, pair.second);
+        }
+        if (client->outgoing) {
+          outgoing_clients_.push_back(key);
+        }
+        if (client->fragments_listed) {
+          fragment_clients_.push_back(key);
+        }
+        if (client->reassemblies_listed) {
+          reassembly_clients_.push_back(key);
+        }
+        return client;
+      }
+      connection_index_.erase(connection_id);
+    }
+  }
+
+  if (!client) {
+    client = &ensure_client_locked(endpoint);
+  }
+  if (connection_ids_ && client->connection_id == 0) {
+    if (connection_id == 0) {
+      client->connection_id = allocate_connection_id_locked();
+      *connection_index_.try_emplace(client->connection_id).first = key;
+    } else if (!connection_index_.find(connection_id)) {
+      client->connection_id = connection_id;
+      *connection_index_.try_emplace(connection_id).first = key;
+    }
+  }
+  return client;
+}
+
+std::uint32_t UdpTransport::allocate_connection_id_locked() {
+  // Random rather than sequential so an off-path sender cannot guess a live id
+  // and steal the session by "rebinding" it.
+  // Rounded down to a multiple of the shard count plus this shard's index, so
+  // the reuseport filter steers it here; a draw that would wrap is redrawn.
+  std::uint32_t id = 0;
+  while (id == 0 || connection_index_.find(id)) {
+    const std::uint64_t draw = connection_id_rng_();
+    const std::uint64_t candidate = draw - draw % shard_count_ + shard_index_;
+    if (candidate <= std::numeric_limits<std::uint32_t>::max()) {
+      id = static_cast<std::uint32_t>(candidate);
+    }
+  }
+  return id;
 }
 
 bool UdpTransport::is_seq_newer(std::uint16_t lhs, std::uint16_t rhs) {
@@ -203,8 +896,16 @@ bool UdpTransport::is_seq_acked(std::uint16_t seq, std::uint16_t ack,
 }
 
 void UdpTransport::do_receive() {
+  if (batch_) {
+    do_receive_batch();
+    return;
+  }
+  if (!recv_packet_) {
+    recv_packet_ = pool_.acquire();
+  }
   socket_.async_receive_from(
-      boost::asio::buffer(recv_buffer_), remote_endpoint_,
+      boost::asio::buffer(recv_packet_.data(), kMaxDatagramSize),
+      remote_endpoint_,
       [this](boost::system::error_code ec, std::size_t bytes_transferred) {
         handle_receive(ec, bytes_transferred);
       });
@@ -219,40 +920,124 @@ void UdpTransport::handle_receive(boost::system::error_code ec,
     return;
   }
 
-  if (bytes_transferred < kHeaderSize) {
-    if (running_.load()) {
-      do_receive();
-    }
+  PacketBuffer packet = std::move(recv_packet_);
+  packet.resize(bytes_transferred);
+  handle_datagram(remote_endpoint_, std::move(packet));
+
+  if (running_.load()) {
+    do_receive();
+  }
+}
+
+void UdpTransport::handle_datagram(const Endpoint &endpoint,
+                                   PacketBuffer &&packet) {
+  datagrams_received_total_.fetch_add(1);
+  bytes_received_total_.fetch_add(packet.size());
+  if (packet.size() < header_size_) {
     return;
   }
 
   UdpHeader header{};
-  std::memcpy(&header, recv_buffer_.data(), kHeaderSize);
+  std::memcpy(&header, packet.data(), kHeaderSize);
   header.seq = boost::endian::big_to_native(header.seq);
   header.ack = boost::endian::big_to_native(header.ack);
   header.ack_bits = boost::endian::big_to_native(header.ack_bits);
+  std::uint32_t connection_id = 0;
+  if (connection_ids_) {
+    std::memcpy(&connection_id, packet.data() + kHeaderSize, kConnectionIdSize);
+    connection_id = boost::endian::big_to_native(connection_id);
+  }
+  const std::uint8_t kind = fragmentation_
+                                ? packet.data()[header_size_ - kDatagramKindSize]
+                                : kWholeDatagram;
 
-  std::vector<std::uint8_t> payload(
-      recv_buffer_.begin() + static_cast<std::ptrdiff_t>(kHeaderSize),
-      recv_buffer_.begin() + static_cast<std::ptrdiff_t>(bytes_transferred));
+  packet.pull_front(header_size_);
+  process_packet(endpoint, header, connection_id, kind, std::move(packet));
+}
+
+void UdpTransport::do_receive_batch() {
+  socket_.async_wait(
+      boost::asio::ip::udp::socket::wait_read,
+      [this](boost::system::error_code ec) { handle_receive_batch(ec); });
+}
+
+void UdpTransport::handle_receive_batch(boost::system::error_code ec) {
+  if (ec) {
+    if (running_.load() && ec != boost::asio::error::operation_aborted) {
+      do_receive_batch();
+    }
+    return;
+  }
 
-  process_packet(remote_endpoint_, header, std::move(payload));
+#ifdef __linux__
+  BatchState &batch = *batch_;
+  const int fd = socket_.native_handle();
+  for (std::size_t round = 0; round < kMaxBatchesPerWakeup; ++round) {
+    for (auto &msg : batch.recv_msgs) {
+      msg.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+    const int received =
+        ::recvmmsg(fd, batch.recv_msgs.data(),
+                   static_cast<unsigned int>(batch.batch_size), MSG_DONTWAIT,
+                   nullptr);
+    if (received <= 0) {
+      break;
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(received); ++i) {
+      const mmsghdr &msg = batch.recv_msgs[i];
+      Endpoint endpoint;
+      std::memcpy(endpoint.data(), msg.msg_hdr.msg_name,
+                  msg.msg_hdr.msg_namelen);
+      endpoint.resize(msg.msg_hdr.msg_namelen);
+      PacketBuffer packet = std::move(batch.recv_packets[i]);
+      packet.resize(std::min<std::size_t>(msg.msg_len, kMaxDatagramSize));
+      batch.arm_receive(i, pool_);
+      handle_datagram(endpoint, std::move(packet));
+    }
+    if (static_cast<std::size_t>(received) < batch.batch_size) {
+      break;
+    }
+  }
+#endif
 
+  // Replies produced while handling the batch leave together.
+  flush_socket();
   if (running_.load()) {
-    do_receive();
+    do_receive_batch();
   }
 }
 
 void UdpTransport::process_packet(const Endpoint &endpoint,
                                   const UdpHeader &header,
-                                  std::vector<std::uint8_t> &&payload) {
+                                  std::uint32_t connection_id,
+                                  std::uint8_t kind, PacketBuffer &&payload) {
   ReceiveHandler handler_copy;
+  RebindHandler rebind_copy;
+  DeliveryHandler delivery_copy;
+  std::vector<std::uint64_t> delivered;
+  Endpoint rebound_from;
+  bool rebound = false;
   bool drop_packet = false;
+  std::uint64_t accepted_messages = 0;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    ClientState &client = ensure_client_locked(endpoint);
+    ClientState *found = receive_client_locked(endpoint, connection_id,
+                                               header.seq, rebound_from,
+                                               rebound);
+    if (!found) {
+      log_drop("rebind", endpoint, header.seq);
+      return;
+    }
+    ClientState &client = *found;
+    if (rebound) {
+      rebind_copy = rebind_handler_;
+    }
     client.last_heard = Clock::now();
-    handle_ack(client, header.ack, header.ack_bits);
+    handle_ack(client, header.ack, header.ack_bits, client.last_heard,
+               delivered);
+    if (!delivered.empty()) {
+      delivery_copy = delivery_handler_;
+    }
     if (client.receive_state.has_last_seq) {
       if (!is_seq_newer(header.seq, client.receive_state.last_seq)) {
         const std::uint16_t diff = static_cast<std::uint16_t>(
@@ -261,7 +1046,9 @@ void UdpTransport::process_packet(const Endpoint &endpoint,
           drop_packet = true;
           dropped_duplicates_total_.fetch_add(1);
           log_drop("dup", endpoint, header.seq);
-        } else if (diff > 32) {
+        } else if (diff > 32 && kind != kFragmentDatagram) {
+          // A fragment is still useful however late; reassembly discards
+          // the ones it already has.
           drop_packet = true;
           dropped_old_total_.fetch_add(1);
           log_drop("old", endpoint, header.seq);
@@ -270,25 +1057,254 @@ void UdpTransport::process_packet(const Endpoint &endpoint,
     }
     if (!drop_packet) {
       update_receive_state(client.receive_state, header.seq);
+      if (kind == kFragmentDatagram) {
+        payload = reassemble_locked(client, payload, endpoint,
+                                    client.last_heard);
+        drop_packet = !payload;
+      } else if (aggregate_messages_) {
+        accepted_messages = accept_messages_locked(client, payload, endpoint);
+      }
       handler_copy = handler_;
     }
   }
 
-  if (!drop_packet && handler_copy) {
+  if (rebound && rebind_copy) {
+    rebind_copy(rebound_from, endpoint);
+  }
+  if (delivery_copy) {
+    for (const std::uint64_t token : delivered) {
+      delivery_copy(endpoint, token);
+    }
+  }
+  if (drop_packet || !handler_copy) {
+    return;
+  }
+  if (!aggregate_messages_ || kind == kFragmentDatagram) {
     handler_copy(endpoint, std::move(payload));
+    return;
   }
+  // Each message is a window onto the same buffer.
+  for_each_message(payload.data(), payload.size(),
+                   [&](std::size_t index, const MessageFrame &frame) {
+                     if ((accepted_messages >> index & 1u) == 0) {
+                       return;
+                     }
+                     PacketBuffer message = payload;
+                     message.pull_front(frame.offset);
+                     message.resize(frame.length);
+                     handler_copy(endpoint, std::move(message));
+                   });
+}
+
+// Picks the messages of an aggregated datagram to deliver: reliable ones not
+// delivered before, and unreliable ones newer than the last delivered. Returns
+// a bit per message, by position.
+std::uint64_t UdpTransport::accept_messages_locked(ClientState &client,
+                                                   const PacketBuffer &payload,
+                                                   const Endpoint &endpoint) {
+  std::uint64_t accepted = 0;
+  const bool well_formed = for_each_message(
+      payload.data(), payload.size(),
+      [&](std::size_t index, const MessageFrame &frame) {
+        ReceiveState &state = frame.reliable ? client.reliable_messages
+                                             : client.unreliable_messages;
+        if (frame.reliable && has_received(state, frame.seq)) {
+          dropped_duplicates_total_.fetch_add(1);
+          log_drop("dup-message", endpoint, frame.seq);
+          return;
+        }
+        if (frame.unordered) {
+          accepted |= std::uint64_t{1} << index;
+          return;
+        }
+        if (!frame.reliable && state.has_last_seq &&
+            !is_seq_newer(frame.seq, state.last_seq)) {
+          dropped_old_total_.fetch_add(1);
+          log_drop("old-message", endpoint, frame.seq);
+          return;
+        }
+        update_receive_state(state, frame.seq);
+        accepted |= std::uint64_t{1} << index;
+      });
+  if (!well_formed) {
+    log_drop("frame", endpoint, 0);
+  }
+  return accepted;
 }
 
 void UdpTransport::handle_ack(ClientState &client, std::uint16_t ack,
-                              std::uint32_t ack_bits) {
+                              std::uint32_t ack_bits, Clock::time_point now,
+                              std::vector<std::uint64_t> &delivered) {
+  for (TrackedSend &tracked : client.tracked) {
+    if (tracked.live && is_seq_acked(tracked.seq, ack, ack_bits)) {
+      tracked.live = false;
+      delivered.push_back(tracked.token);
+    }
+  }
+  // One sample per ack, from the newest packet it covers: older ones have also
+  // waited for the peer to get around to acking.
+  bool sampled = false;
+  Clock::time_point newest_sent{};
   auto it = client.pending.begin();
   while (it != client.pending.end()) {
     if (is_seq_acked(it->first, ack, ack_bits)) {
+      const PendingPacket &pending = it->second;
+      if (pending.retries == 0 &&
+          (!sampled || pending.first_sent > newest_sent)) {
+        sampled = true;
+        newest_sent = pending.first_sent;
+      }
+      retransmit_wheel_.cancel(pending.timer);
       it = client.pending.erase(it);
     } else {
       ++it;
     }
   }
+  if (sampled) {
+    add_rtt_sample_locked(client, now - newest_sent);
+  }
+}
+
+void UdpTransport::track_delivery_locked(ClientState &client,
+                                         std::uint16_t seq,
+                                         std::uint64_t token) {
+  if (client.tracked.empty()) {
+    client.tracked.resize(kMaxTrackedSends);
+  }
+  client.tracked[client.next_tracked] = TrackedSend{token, seq, true};
+  client.next_tracked = (client.next_tracked + 1) % kMaxTrackedSends;
+}
+
+// RFC 6298 section 2 with alpha = 1/8 and beta = 1/4; the clock granularity is
+// the retransmit wheel's 1 ms tick.
+void UdpTransport::add_rtt_sample_locked(ClientState &client,
+                                         Clock::duration sample) {
+  RttState &rtt = client.rtt;
+  if (!rtt.has_sample) {
+    rtt.has_sample = true;
+    rtt.srtt = sample;
+    rtt.rttvar = sample / 2;
+  } else {
+    const Clock::duration error =
+        rtt.srtt > sample ? rtt.srtt - sample : sample - rtt.srtt;
+    rtt.rttvar = (rtt.rttvar * 3 + error) / 4;
+    rtt.srtt = (rtt.srtt * 7 + sample) / 8;
+  }
+  if (adaptive_rto_) {
+    const Clock::duration rto =
+        rtt.srtt +
+        std::max<Clock::duration>(std::chrono::milliseconds(1), rtt.rttvar * 4);
+    rtt.rto = std::clamp<Clock::duration>(rto, min_rto_, max_rto_);
+  }
+
+  const float sample_ms = static_cast<float>(to_milliseconds(sample));
+  if (rtt.samples.size() < rtt_window_) {
+    rtt.samples.push_back(sample_ms);
+  } else {
+    rtt.samples[rtt.next_sample] = sample_ms;
+    rtt.next_sample = (rtt.next_sample + 1) % rtt_window_;
+  }
+}
+
+// Files a fragment into its message's reassembly. Returns the message once its
+// last fragment is in, and an empty handle otherwise.
+PacketBuffer UdpTransport::reassemble_locked(ClientState &client,
+                                             const PacketBuffer &payload,
+                                             const Endpoint &endpoint,
+                                             Clock::time_point now) {
+  if (payload.size() < kFragmentHeaderSize) {
+    log_drop("fragment", endpoint, 0);
+    return {};
+  }
+  const std::uint16_t message_id = read_u16(payload.data());
+  const std::uint16_t index = read_u16(payload.data() + 2);
+  const std::uint16_t count = read_u16(payload.data() + 4);
+  const std::size_t fragment_size = read_u16(payload.data() + 6);
+  const std::uint8_t *bytes = payload.data() + kFragmentHeaderSize;
+  const std::size_t length = payload.size() - kFragmentHeaderSize;
+  const bool last = index + 1 == count;
+  if (index >= count || fragment_size == 0 || length > fragment_size ||
+      (!last && length != fragment_size) ||
+      std::size_t{index} * fragment_size + length > max_message_size_ ||
+      std::size_t{count - 1u} * fragment_size >= max_message_size_) {
+    log_drop("fragment", endpoint, index);
+    return {};
+  }
+  if (has_received(client.completed_messages, message_id)) {
+    dropped_duplicates_total_.fetch_add(1);
+    return {};
+  }
+
+  auto it = std::find_if(
+      client.reassemblies.begin(), client.reassemblies.end(),
+      [message_id](const Reassembly &r) { return r.message_id == message_id; });
+  if (it == client.reassemblies.end()) {
+    if (client.reassemblies.size() >= max_reassemblies_ ||
+        reassembly_bytes_ + max_message_size_ > max_reassembly_bytes_) {
+      dropped_reassembly_total_.fetch_add(1);
+      log_drop("reassembly-cap", endpoint, index);
+      return {};
+    }
+    Reassembly &started = client.reassemblies.emplace_back();
+    started.message_id = message_id;
+    started.fragment_count = count;
+    started.fragment_size = fragment_size;
+    started.buffer = reassembly_pool_.acquire();
+    started.buffer.resize(std::min(std::size_t{count} * fragment_size,
+                                   max_message_size_));
+    started.received.assign((count + 63) / 64, 0);
+    started.started = now;
+    reassembly_bytes_ += max_message_size_;
+    if (!client.reassemblies_listed) {
+      client.reassemblies_listed = true;
+      reassembly_clients_.push_back(EndpointKey::from(client.endpoint));
+    }
+    it = client.reassemblies.end() - 1;
+  } else if (it->fragment_count != count ||
+             it->fragment_size != fragment_size) {
+    log_drop("fragment", endpoint, index);
+    return {};
+  }
+
+  Reassembly &reassembly = *it;
+  std::uint64_t &word = reassembly.received[index / 64];
+  const std::uint64_t bit = std::uint64_t{1} << (index % 64);
+  if (word & bit) {
+    dropped_duplicates_total_.fetch_add(1);
+    return {};
+  }
+  word |= bit;
+  std::memcpy(reassembly.buffer.data() + index * fragment_size, bytes, length);
+  if (last) {
+    reassembly.size = index * fragment_size + length;
+  }
+  if (++reassembly.fragments_received < count) {
+    return {};
+  }
+
+  PacketBuffer message = std::move(reassembly.buffer);
+  message.resize(reassembly.size);
+  update_receive_state(client.completed_messages, message_id);
+  reassembly_bytes_ -= max_message_size_;
+  *it = std::move(client.reassemblies.back());
+  client.reassemblies.pop_back();
+  return message;
+}
+
+void UdpTransport::expire_reassemblies_locked(ClientState &client,
+                                              Clock::time_point now) {
+  for (std::size_t i = 0; i < client.reassemblies.size();) {
+    Reassembly &reassembly = client.reassemblies[i];
+    if (now - reassembly.started < reassembly_timeout_) {
+      ++i;
+      continue;
+    }
+    reassembly_timeouts_total_.fetch_add(1);
+    log_drop("reassembly-timeout", client.endpoint, reassembly.message_id);
+    reassembly_bytes_ -= max_message_size_;
+    reassembly = std::move(client.reassemblies.back());
+    client.reassemblies.pop_back();
+  }
 }
 
 void UdpTransport::update_receive_state(ReceiveState &state,
@@ -338,58 +1354,280 @@ bool UdpTransport::has_received(const ReceiveState &state, std::uint16_t seq) {
   return (state.ack_bits & mask) != 0u;
 }
 
-std::vector<std::uint8_t>
-UdpTransport::compose_packet(const ClientState &client, std::uint16_t seq,
-                             const std::vector<std::uint8_t> &payload) const {
-  UdpHeader header{};
-  header.seq = boost::endian::native_to_big(seq);
+void UdpTransport::write_header(const ClientState &client, std::uint16_t seq,
+                                std::uint8_t *out) const {
+  const std::uint16_t seq_be = boost::endian::native_to_big(seq);
+  std::memcpy(out + offsetof(UdpHeader, seq), &seq_be, sizeof(seq_be));
+  write_ack(client, out);
+  if (connection_ids_) {
+    const std::uint32_t id = boost::endian::native_to_big(client.connection_id);
+    std::memcpy(out + kHeaderSize, &id, kConnectionIdSize);
+  }
+  if (fragmentation_) {
+    out[header_size_ - kDatagramKindSize] = kWholeDatagram;
+  }
+}
+
+// Fills the ack fields of a written header with what has been received from
+// the client so far.
+void UdpTransport::write_ack(const ClientState &client,
+                             std::uint8_t *header) const {
+  std::uint16_t ack = 0;
+  std::uint32_t ack_bits = 0;
   if (client.receive_state.has_last_seq) {
-    header.ack = boost::endian::native_to_big(client.receive_state.last_seq);
-    header.ack_bits =
-        boost::endian::native_to_big(client.receive_state.ack_bits);
-  } else {
-    header.ack = 0;
-    header.ack_bits = 0;
+    ack = boost::endian::native_to_big(client.receive_state.last_seq);
+    ack_bits = boost::endian::native_to_big(client.receive_state.ack_bits);
   }
+  std::memcpy(header + offsetof(UdpHeader, ack), &ack, sizeof(ack));
+  std::memcpy(header + offsetof(UdpHeader, ack_bits), &ack_bits,
+              sizeof(ack_bits));
+}
 
-  std::vector<std::uint8_t> buffer;
-  buffer.resize(kHeaderSize + payload.size());
-  std::memcpy(buffer.data(), &header, kHeaderSize);
+PacketBuffer UdpTransport::compose_packet(const ClientState &client,
+                                          std::uint16_t seq,
+                                          const PacketBuffer &payload) {
+  PacketBuffer packet = pool_.acquire();
+  packet.resize(header_size_ + payload.size());
+  write_header(client, seq, packet.data());
   if (!payload.empty()) {
-    std::memcpy(buffer.data() + static_cast<std::ptrdiff_t>(kHeaderSize),
-                payload.data(), payload.size());
+    std::memcpy(packet.data() + header_size_, payload.data(), payload.size());
   }
-  return buffer;
+  return packet;
 }
 
 void UdpTransport::post_send_buffer(
-    std::shared_ptr<std::vector<std::uint8_t>> buffer,
-    const boost::asio::ip::udp::endpoint &endpoint) {
-  boost::asio::post(io_context_, [this, buffer, endpoint]() {
-    if (!socket_.is_open()) {
+    PacketBuffer packet, const boost::asio::ip::udp::endpoint &endpoint) {
+  bool start_sending = false;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    send_queue_.push_back(QueuedPacket{std::move(packet), endpoint});
+    start_sending = !send_active_;
+    send_active_ = true;
+  }
+  if (start_sending) {
+    boost::asio::post(io_context_, [this]() { send_next(); });
+  }
+}
+
+// Runs on the io_context and keeps one async_send_to in flight until the queue
+// is empty.
+void UdpTransport::send_next() {
+  if (sending_index_ == sending_.size()) {
+    sending_.clear();
+    sending_index_ = 0;
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (send_queue_.empty() || !socket_.is_open()) {
+      send_queue_.clear();
+      send_active_ = false;
       return;
     }
-    socket_.async_send_to(boost::asio::buffer(*buffer), endpoint,
-                          [buffer](boost::system::error_code /*ec*/,
-                                   std::size_t /*bytes_sent*/) {});
-  });
-}
-
-void UdpTransport::expire_pending_locked(ClientState &client,
-                                         const Clock::time_point &now,
-                                         std::vector<std::uint16_t> &expired) {
-  for (const auto &pair : client.pending) {
-    const PendingPacket &pending = pair.second;
-    const bool ttl_expired = now - pending.first_sent >= kTtl;
-    const bool retries_exceeded = pending.retries >= kMaxRetries;
-    if (ttl_expired || retries_exceeded) {
-      expired.push_back(pair.first);
-      reliable_timeouts_total_.fetch_add(1);
-      if (metrics_enabled_.load()) {
-        std::cout << "[DEBUG] reliable timeout seq=" << pending.seq
-                  << " endpoint=" << endpoint_key(client.endpoint) << std::endl;
+    sending_.swap(send_queue_);
+  }
+
+  const QueuedPacket &packet = sending_[sending_index_];
+  socket_.async_send_to(
+      boost::asio::buffer(packet.data.data(), packet.data.size()),
+      packet.endpoint,
+      [this](boost::system::error_code /*ec*/, std::size_t /*bytes_sent*/) {
+        sending_[sending_index_++].data = PacketBuffer();
+        send_next();
+      });
+}
+
+void UdpTransport::dispatch(PacketBuffer &&packet, const Endpoint &endpoint) {
+  datagrams_sent_total_.fetch_add(1);
+  bytes_sent_total_.fetch_add(packet.size());
+#ifdef __linux__
+  if (batch_) {
+    std::lock_guard<std::mutex> lock(batch_->queue_mutex);
+    batch_->queue.push_back(QueuedPacket{std::move(packet), endpoint});
+    return;
+  }
+#endif
+  post_send_buffer(std::move(packet), endpoint);
+}
+
+// Sends batch_->flushing from index first with as few sendmmsg calls as the
+// batch size allows. Packets the kernel will not take right away go out through
+// the asynchronous path instead.
+void UdpTransport::send_batched(std::size_t first) {
+#ifdef __linux__
+  BatchState &batch = *batch_;
+  std::vector<QueuedPacket> &packets = batch.flushing;
+  const int fd = socket_.native_handle();
+  while (first < packets.size()) {
+    std::size_t messages = 0;
+    bool used_gso = false;
+    for (std::size_t next = first;
+         next < packets.size() && messages < batch.batch_size; ++messages) {
+      const std::size_t run = batch.gso ? gso_run_length(packets, next) : 1;
+      mmsghdr &msg = batch.send_msgs[messages];
+      iovec &iov = batch.send_iovecs[messages];
+      msg = mmsghdr{};
+      if (run > 1) {
+        std::vector<std::uint8_t> &joined = batch.gso_buffers[messages];
+        joined.clear();
+        joined.reserve(kMaxGsoBytes);
+        for (std::size_t i = next; i < next + run; ++i) {
+          const PacketBuffer &segment = packets[i].data;
+          joined.insert(joined.end(), segment.data(),
+                        segment.data() + segment.size());
+        }
+        iov.iov_base = joined.data();
+        iov.iov_len = joined.size();
+        auto &control = batch.send_controls[messages];
+        msg.msg_hdr.msg_control = control.buffer;
+        msg.msg_hdr.msg_controllen = sizeof(control.buffer);
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg.msg_hdr);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        const auto segment =
+            static_cast<std::uint16_t>(packets[next].data.size());
+        std::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+        used_gso = true;
+      } else {
+        iov.iov_base = packets[next].data.data();
+        iov.iov_len = packets[next].data.size();
       }
+      msg.msg_hdr.msg_name =
+          const_cast<sockaddr *>(packets[next].endpoint.data());
+      msg.msg_hdr.msg_namelen =
+          static_cast<socklen_t>(packets[next].endpoint.size());
+      msg.msg_hdr.msg_iov = &iov;
+      msg.msg_hdr.msg_iovlen = 1;
+      batch.send_counts[messages] = run;
+      next += run;
+    }
+
+    const int sent = ::sendmmsg(fd, batch.send_msgs.data(),
+                                static_cast<unsigned int>(messages),
+                                MSG_DONTWAIT);
+    if (sent < 0) {
+      const int error = errno;
+      if (used_gso && (error == EIO || error == EINVAL ||
+                       error == ENOPROTOOPT || error == EOPNOTSUPP)) {
+        // No GSO on this path; retry the same packets one per message.
+        batch.gso = false;
+        continue;
+      }
+      if (error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS ||
+          error == EINTR) {
+        break;
+      }
+      // The first message failed for good, as a lone async_send_to would.
+      first += batch.send_counts[0];
+      continue;
+    }
+    for (int i = 0; i < sent; ++i) {
+      first += batch.send_counts[static_cast<std::size_t>(i)];
+    }
+  }
+
+  for (; first < packets.size(); ++first) {
+    post_send_buffer(std::move(packets[first].data), packets[first].endpoint);
+  }
+#else
+  (void)first;
+#endif
+}
+
+UdpTransport::PendingPacket &
+UdpTransport::add_pending_locked(ClientState &client, std::uint16_t seq,
+                                 PacketBuffer packet, Clock::time_point now) {
+  PendingPacket &pending = client.pending[seq];
+  pending.seq = seq;
+  pending.packet = std::move(packet);
+  pending.first_sent = now;
+  pending.last_sent = now;
+  pending.next_send = now + backoff_for(client.rtt.rto, 0);
+  pending.retries = 0;
+  pending.fragment = false;
+  schedule_retransmit_locked(EndpointKey::from(client.endpoint), pending);
+  return pending;
+}
+
+// Arms the wheel for the pending packet's next retransmit, or for its expiry if
+// that comes first.
+void UdpTransport::schedule_retransmit_locked(const EndpointKey &key,
+                                              PendingPacket &pending) {
+  retransmit_wheel_.cancel(pending.timer);
+  Clock::time_point deadline =
+      std::min(pending.next_send, pending.first_sent + reliable_ttl_);
+  if (pending.retries >= kMaxRetries) {
+    deadline = pending.last_sent;
+  }
+  pending.timer =
+      retransmit_wheel_.schedule(deadline, RetransmitTimer{key, pending.seq});
+}
+
+void UdpTransport::handle_retransmit_timer_locked(const RetransmitTimer &timer,
+                                                  Clock::time_point now) {
+  ClientState *client = clients_.find(timer.client);
+  if (!client) {
+    return;
+  }
+  auto it = client->pending.find(timer.seq);
+  if (it == client->pending.end()) {
+    return;
+  }
+  PendingPacket &pending = it->second;
+  pending.timer = {};
+
+  if (now - pending.first_sent >= reliable_ttl_ ||
+      pending.retries >= kMaxRetries) {
+    reliable_timeouts_total_.fetch_add(1);
+    if (metrics_enabled_.load()) {
+      std::cout << "[DEBUG] reliable timeout seq=" << pending.seq
+                << " endpoint=" << endpoint_key(client->endpoint) << std::endl;
     }
+    client->pending.erase(it);
+    return;
+  }
+
+  if (!pending.packet.unique()) {
+    // The previous send still holds the buffer; patch a copy instead of
+    // writing under it.
+    PacketBuffer copy = pool_.acquire();
+    copy.assign(pending.packet.data(), pending.packet.size());
+    pending.packet = std::move(copy);
+  }
+  PendingPacket *resent = &pending;
+  if (pending.fragment) {
+    // By now the receiver's ack window may have moved past this sequence, so
+    // an ack for it would never come back; send it under a fresh one.
+    // Reassembly discards fragments it already has.
+    const std::uint16_t seq = client->next_send_seq++;
+    const std::uint16_t seq_be = boost::endian::native_to_big(seq);
+    std::memcpy(pending.packet.data() + offsetof(UdpHeader, seq), &seq_be,
+                sizeof(seq_be));
+    PendingPacket moved = std::move(pending);
+    client->pending.erase(it);
+    moved.seq = seq;
+    resent = &client->pending.emplace(seq, std::move(moved)).first->second;
+  }
+  RttState &rtt = client->rtt;
+  if (adaptive_rto_ && resent->retries == 0 &&
+      resent->first_sent >= rtt.backed_off_at) {
+    // RFC 6298 5.5: double the timeout for packets sent from now on. Only
+    // packets sent since the last backoff count, so a burst of losses doubles
+    // it once rather than once per packet. Without this, a path slower than
+    // the initial timeout would never yield a sample under Karn's rule.
+    rtt.rto = std::max<Clock::duration>(
+        rtt.rto, std::min<Clock::duration>(rtt.rto * 2, max_rto_));
+    rtt.backed_off_at = now;
+  }
+  write_ack(*client, resent->packet.data());
+  resent->last_sent = now;
+  ++resent->retries;
+  resent->next_send = now + backoff_for(client->rtt.rto, resent->retries);
+  schedule_retransmit_locked(timer.client, *resent);
+  due_packets_.push_back(QueuedPacket{resent->packet, client->endpoint});
+  reliable_retries_total_.fetch_add(1);
+  if (metrics_enabled_.load()) {
+    std::cout << "[DEBUG] retransmit seq=" << resent->seq
+              << " retries=" << resent->retries
+              << " endpoint=" << endpoint_key(client->endpoint) << std::endl;
   }
 }
 
@@ -1,19 +1,23 @@
 #pragma once
 
+#include "net/endpoint_key.h"
+#include "net/flat_map.h"
+#include "net/timer_wheel.h"
 #include "net/transport.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/udp.hpp>
 
-#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <random>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class UdpTransportTestPeer;
@@ -26,12 +30,71 @@ struct UdpHeader {
   std::uint32_t ack_bits{0};
 };
 
+struct UdpTransportOptions {
+  // Linux only; ignored elsewhere. Receives drain up to batch_size datagrams per
+  // wakeup with recvmmsg, and sends are queued until flush(), which update()
+  // and each receive batch call, and go out through sendmmsg.
+  bool batched_io{false};
+  std::size_t batch_size{64};
+  // In batched mode, runs of equal-sized packets to one endpoint go out as a
+  // single UDP GSO send when the kernel supports UDP_SEGMENT.
+  bool gso{true};
+  // Adds a 32-bit connection id to the header; both peers must agree. The side
+  // that first hears from a peer without one assigns it, and a newer packet
+  // carrying a known id from a new address moves that client there instead of
+  // creating another one, so NAT rebinding keeps the session.
+  bool connection_ids{false};
+  // Sets SO_REUSEPORT so several transports can share the port; see
+  // ShardedUdpTransport. Ids this transport assigns satisfy
+  // id % shard_count == shard_index, and with connection_ids and more than one
+  // shard the first shard attaches a reuseport filter that steers each packet
+  // to the socket at that index, so a rebound client stays on its shard.
+  bool reuse_port{false};
+  std::uint32_t shard_index{0};
+  std::uint32_t shard_count{1};
+  // Coalesces what send() is given for a client between flushes into
+  // datagrams of at most max_datagram_size bytes; both peers must agree. Each
+  // message is framed with its length and a sequence number of its own:
+  // reliable messages are delivered once, unreliable ones are dropped when a
+  // newer one already arrived (except those from send_acked()). A datagram
+  // that carries reliable messages is retransmitted with only those.
+  bool aggregate_messages{false};
+  std::size_t max_datagram_size{1200};
+  // Splits what would not fit one datagram of max_datagram_size into
+  // fragments; both peers must agree, and every datagram carries a byte that
+  // says which kind it is. Reliable fragments are acked one by one and resent
+  // under new sequence numbers, since reassembly drops duplicates; those past
+  // the reliable window wait for update(). The receiver reassembles messages
+  // of up to max_message_size bytes into pooled buffers, at most
+  // max_reassemblies at a time per client and max_reassembly_bytes across
+  // clients, and drops any not complete within reassembly_timeout.
+  bool fragmentation{false};
+  std::size_t max_message_size{64 * 1024};
+  std::size_t max_reassemblies{4};
+  std::size_t max_reassembly_bytes{8 * 1024 * 1024};
+  std::chrono::milliseconds reassembly_timeout{2000};
+  // Each client's retransmit timeout follows its measured round trip as in
+  // RFC 6298: SRTT + 4 * RTTVAR, clamped to [min_rto, max_rto], and doubled
+  // by retransmits until the next sample. retransmit_interval is the timeout
+  // until the first sample, and the only one with adaptive_rto off. Each
+  // retry waits 1.5x longer, and the packet is dropped once reliable_ttl has
+  // passed.
+  bool adaptive_rto{true};
+  std::chrono::milliseconds retransmit_interval{50};
+  std::chrono::milliseconds min_rto{20};
+  std::chrono::milliseconds max_rto{500};
+  std::chrono::milliseconds reliable_ttl{500};
+  // RTT samples kept per client for the percentiles in sample_rtt().
+  std::size_t rtt_window{64};
+};
+
 class UdpTransport : public net::ITransport {
 public:
   using Clock = std::chrono::steady_clock;
 
   UdpTransport(boost::asio::io_context &io_context,
-               const boost::asio::ip::udp::endpoint &endpoint);
+               const boost::asio::ip::udp::endpoint &endpoint,
+               UdpTransportOptions options = {});
   ~UdpTransport() override;
 
   void start(ReceiveHandler handler) override;
@@ -39,10 +102,23 @@ public:
 
   void send(const Endpoint &endpoint, std::vector<std::uint8_t> data,
             bool reliable) override;
+  PacketBuffer allocate_send_buffer() override;
+  void send(const Endpoint &endpoint, PacketBuffer payload,
+            bool reliable) override;
+  // Tracks up to kMaxTrackedSends per client; past that the oldest are
+  // forgotten. A message that has to be fragmented is sent untracked.
+  void send_acked(const Endpoint &endpoint, PacketBuffer payload,
+                  std::uint64_t token) override;
   void update() override;
+  void set_rebind_handler(RebindHandler handler) override;
+  void set_delivery_handler(DeliveryHandler handler) override;
+  // Seals the clients' coalesced messages into datagrams and, in batched
+  // mode, sends everything queued.
+  void flush() override;
 
   void set_metrics_enabled(bool enabled) override;
   Counters sample_counters() const override;
+  std::vector<PeerRtt> sample_rtt() const override;
 
   boost::asio::ip::udp::endpoint local_endpoint() const;
 
@@ -52,20 +128,99 @@ public:
     std::uint32_t ack_bits{0};
   };
 
+  // Karn's algorithm: only packets acked without a retransmit give samples,
+  // since an ack for a resent packet does not say which copy it answers.
+  struct RttState {
+    bool has_sample{false};
+    Clock::duration srtt{};
+    Clock::duration rttvar{};
+    Clock::duration rto{};
+    Clock::time_point backed_off_at{};
+    // Ring of the most recent samples, in milliseconds.
+    std::vector<float> samples;
+    std::size_t next_sample{0};
+  };
+
+  // What the retransmit wheel holds for each reliable packet in flight.
+  struct RetransmitTimer {
+    EndpointKey client;
+    std::uint16_t seq{0};
+  };
+  using RetransmitWheel = TimerWheel<RetransmitTimer>;
+
   struct PendingPacket {
     std::uint16_t seq{0};
-    std::vector<std::uint8_t> payload;
+    // The whole datagram as last sent; retransmits patch its ack fields.
+    PacketBuffer packet;
+    RetransmitWheel::TimerId timer{};
+    // Fragments are resent under a new sequence number.
+    bool fragment{false};
     Clock::time_point first_sent{};
     Clock::time_point last_sent{};
     Clock::time_point next_send{};
     std::uint32_t retries{0};
   };
 
+  // A composed datagram waiting for the socket.
+  struct QueuedPacket {
+    PacketBuffer data;
+    boost::asio::ip::udp::endpoint endpoint;
+  };
+
+  // A send_acked() token and the datagram that carried it.
+  struct TrackedSend {
+    std::uint64_t token{0};
+    std::uint16_t seq{0};
+    bool live{false};
+  };
+  static constexpr std::size_t kMaxTrackedSends = 64;
+
+  // A fragmented message being put back together; the buffer comes from the
+  // reassembly pool and holds fragment i at i * fragment_size.
+  struct Reassembly {
+    std::uint16_t message_id{0};
+    std::uint16_t fragment_count{0};
+    std::uint16_t fragments_received{0};
+    std::size_t fragment_size{0};
+    std::size_t size{0};
+    PacketBuffer buffer;
+    std::vector<std::uint64_t> received;
+    Clock::time_point started{};
+  };
+
   struct ClientState {
     Endpoint endpoint;
-    std::uint16_t next_send_seq{0};
+    std::uint32_t connection_id{0};
+    // From 1: a peer that has received nothing acks 0 with no bits set, which
+    // must not read as an ack of the first packet.
+    std::uint16_t next_send_seq{1};
     ReceiveState receive_state{};
     std::map<std::uint16_t, PendingPacket> pending;
+    RttState rtt{};
+    // Message aggregation: the datagram being filled (framed messages, with
+    // headroom for the header) and the per-channel message sequences.
+    PacketBuffer outgoing;
+    std::uint16_t outgoing_messages{0};
+    bool outgoing_reliable{false};
+    bool outgoing_unreliable{false};
+    std::uint16_t next_reliable_message{0};
+    std::uint16_t next_unreliable_message{0};
+    ReceiveState reliable_messages{};
+    ReceiveState unreliable_messages{};
+    // Fragmentation: reliable fragments waiting for room in the window, and
+    // the messages being reassembled; the ids of recently completed ones let
+    // late duplicates be dropped.
+    std::deque<PacketBuffer> queued_fragments;
+    std::uint16_t next_fragmented_message{0};
+    std::vector<Reassembly> reassemblies;
+    ReceiveState completed_messages{};
+    bool fragments_listed{false};
+    bool reassemblies_listed{false};
+    // send_acked() tokens in flight, a ring allocated on first use, and those
+    // of the coalesced datagram being filled.
+    std::vector<TrackedSend> tracked;
+    std::size_t next_tracked{0};
+    std::vector<std::uint64_t> outgoing_tokens;
     Clock::time_point last_heard{};
   };
 
@@ -76,34 +231,127 @@ public:
   static bool has_received(const ReceiveState &state, std::uint16_t seq);
 
 private:
+  struct BatchState;
+
   ClientState &
   ensure_client_locked(const boost::asio::ip::udp::endpoint &endpoint);
+  ClientState *receive_client_locked(const Endpoint &endpoint,
+                                     std::uint32_t connection_id,
+                                     std::uint16_t seq, Endpoint &rebound_from,
+                                     bool &rebound);
+  std::uint32_t allocate_connection_id_locked();
 
   void do_receive();
   void handle_receive(boost::system::error_code ec,
                       std::size_t bytes_transferred);
+  void handle_datagram(const Endpoint &endpoint, PacketBuffer &&packet);
+  void do_receive_batch();
+  void handle_receive_batch(boost::system::error_code ec);
   void process_packet(const Endpoint &endpoint, const UdpHeader &header,
-                      std::vector<std::uint8_t> &&payload);
+                      std::uint32_t connection_id, std::uint8_t kind,
+                      PacketBuffer &&payload);
+  std::uint64_t accept_messages_locked(ClientState &client,
+                                       const PacketBuffer &payload,
+                                       const Endpoint &endpoint);
+  void send_payload(const Endpoint &endpoint, PacketBuffer payload,
+                    bool reliable, const std::uint64_t *token);
+  void track_delivery_locked(ClientState &client, std::uint16_t seq,
+                             std::uint64_t token);
   void handle_ack(ClientState &client, std::uint16_t ack,
-                  std::uint32_t ack_bits);
+                  std::uint32_t ack_bits, Clock::time_point now,
+                  std::vector<std::uint64_t> &delivered);
+  void add_rtt_sample_locked(ClientState &client, Clock::duration sample);
 
-  std::vector<std::uint8_t>
-  compose_packet(const ClientState &client, std::uint16_t seq,
-                 const std::vector<std::uint8_t> &payload) const;
-  void post_send_buffer(std::shared_ptr<std::vector<std::uint8_t>> buffer,
+  void write_header(const ClientState &client, std::uint16_t seq,
+                    std::uint8_t *out) const;
+  void write_ack(const ClientState &client, std::uint8_t *header) const;
+  PacketBuffer compose_packet(const ClientState &client, std::uint16_t seq,
+                              const PacketBuffer &payload);
+  void post_send_buffer(PacketBuffer packet,
                         const boost::asio::ip::udp::endpoint &endpoint);
-  void expire_pending_locked(ClientState &client, const Clock::time_point &now,
-                             std::vector<std::uint16_t> &expired);
+  void send_next();
+  void dispatch(PacketBuffer &&packet, const Endpoint &endpoint);
+  void flush_socket();
+  void send_outgoing();
+  bool append_message_locked(ClientState &client, PacketBuffer &payload,
+                             bool reliable, bool unordered,
+                             QueuedPacket &sealed);
+  QueuedPacket seal_outgoing_locked(ClientState &client);
+  bool needs_fragments(std::size_t payload_size) const;
+  void send_fragmented(const Endpoint &endpoint, const std::uint8_t *data,
+                       std::size_t size, bool reliable);
+  PacketBuffer seal_fragment_locked(ClientState &client, PacketBuffer fragment,
+                                    bool reliable, Clock::time_point now);
+  void pump_fragments_locked(ClientState &client, Clock::time_point now,
+                             std::vector<QueuedPacket> &out);
+  PacketBuffer reassemble_locked(ClientState &client,
+                                 const PacketBuffer &payload,
+                                 const Endpoint &endpoint,
+                                 Clock::time_point now);
+  void expire_reassemblies_locked(ClientState &client, Clock::time_point now);
+  void send_batched(std::size_t first);
+  PendingPacket &add_pending_locked(ClientState &client, std::uint16_t seq,
+                                    PacketBuffer packet,
+                                    Clock::time_point now);
+  void schedule_retransmit_locked(const EndpointKey &key,
+                                  PendingPacket &pending);
+  void handle_retransmit_timer_locked(const RetransmitTimer &timer,
+                                      Clock::time_point now);
   void log_drop(const std::string &reason, const Endpoint &endpoint,
                 std::uint16_t seq);
 
   boost::asio::io_context &io_context_;
   boost::asio::ip::udp::socket socket_;
   ReceiveHandler handler_;
-  std::array<std::uint8_t, 2048> recv_buffer_{};
+  RebindHandler rebind_handler_;
+  DeliveryHandler delivery_handler_;
+  const bool connection_ids_;
+  const std::size_t header_size_;
+  const std::uint32_t shard_index_;
+  const std::uint32_t shard_count_;
+  const bool aggregate_messages_;
+  const std::size_t max_datagram_size_;
+  const bool fragmentation_;
+  const std::size_t max_message_size_;
+  const std::size_t max_reassemblies_;
+  const std::size_t max_reassembly_bytes_;
+  const std::chrono::milliseconds reassembly_timeout_;
+  const bool adaptive_rto_;
+  const std::chrono::milliseconds retransmit_interval_;
+  const std::chrono::milliseconds min_rto_;
+  const std::chrono::milliseconds max_rto_;
+  const std::chrono::milliseconds reliable_ttl_;
+  const std::size_t rtt_window_;
+  PacketBufferPool pool_;
+  PacketBufferPool reassembly_pool_;
+  PacketBuffer recv_packet_;
   boost::asio::ip::udp::endpoint remote_endpoint_;
-  std::mutex mutex_;
-  std::unordered_map<std::string, ClientState> clients_;
+  std::unique_ptr<BatchState> batch_;
+  // Asynchronous sends go out one at a time from the io_context so the queues
+  // keep their capacity and each send reuses the previous handler's memory.
+  std::mutex send_mutex_;
+  std::vector<QueuedPacket> send_queue_;
+  bool send_active_{false};
+  std::vector<QueuedPacket> sending_;
+  std::size_t sending_index_{0};
+  mutable std::mutex mutex_;
+  FlatMap<EndpointKey, ClientState, EndpointKeyHash> clients_;
+  FlatMap<std::uint32_t, EndpointKey> connection_index_;
+  RetransmitWheel retransmit_wheel_;
+  // update() and flush() scratch, reused between calls.
+  std::mutex update_mutex_;
+  std::vector<RetransmitTimer> due_timers_;
+  std::vector<QueuedPacket> due_packets_;
+  // Clients with coalesced messages waiting for flush(), and flush() scratch.
+  std::vector<EndpointKey> outgoing_clients_;
+  std::vector<EndpointKey> flushing_clients_;
+  std::vector<QueuedPacket> sealed_;
+  // Clients with queued fragments or reassemblies, for update() to visit;
+  // reassembly_bytes_ is what the reassemblies hold.
+  std::vector<EndpointKey> fragment_clients_;
+  std::vector<EndpointKey> reassembly_clients_;
+  std::size_t reassembly_bytes_{0};
+  std::mt19937 connection_id_rng_{std::random_device{}()};
   std::atomic<bool> running_{false};
   std::atomic<bool> metrics_enabled_{false};
   std::atomic<std::uint64_t> reliable_retries_total_{0};
@@ -111,6 +359,12 @@ private:
   std::atomic<std::uint64_t> dropped_duplicates_total_{0};
   std::atomic<std::uint64_t> dropped_old_total_{0};
   std::atomic<std::uint64_t> dropped_window_total_{0};
+  std::atomic<std::uint64_t> reassembly_timeouts_total_{0};
+  std::atomic<std::uint64_t> dropped_reassembly_total_{0};
+  std::atomic<std::uint64_t> datagrams_sent_total_{0};
+  std::atomic<std::uint64_t> datagrams_received_total_{0};
+  std::atomic<std::uint64_t> bytes_sent_total_{0};
+  std::atomic<std::uint64_t> bytes_received_total_{0};
 
   friend class ::UdpTransportTestPeer;
 };
@@ -0,0 +1,114 @@
+#include "bit_stream.h"
+
+#include <stdexcept>
+
+namespace mini::sync {
+
+namespace {
+constexpr unsigned kWidthBits = 5;
+
+[[nodiscard]] unsigned bit_width(std::uint32_t value) {
+  return value == 0 ? 0u
+                    : 32u - static_cast<unsigned>(__builtin_clz(value));
+}
+} // namespace
+
+BitWriter::BitWriter(std::size_t capacity_bytes) : buffer_(capacity_bytes) {}
+
+void BitWriter::write_bits(std::uint32_t value, unsigned bits) {
+  if (bits == 0) {
+    return;
+  }
+  const std::uint64_t mask = (std::uint64_t{1} << bits) - 1;
+  scratch_ |= (static_cast<std::uint64_t>(value) & mask) << scratch_bits_;
+  scratch_bits_ += bits;
+  if (scratch_bits_ >= 32) {
+    spill(4);
+  }
+}
+
+void BitWriter::write_varint(std::uint32_t value) {
+  while (value >= 0x80u) {
+    write_bits((value & 0x7Fu) | 0x80u, 8);
+    value >>= 7;
+  }
+  write_bits(value, 8);
+}
+
+void BitWriter::write_signed(std::int32_t value) {
+  const std::uint32_t encoded = zigzag_encode(value);
+  const unsigned width = bit_width(encoded);
+  if (width >= (1u << kWidthBits)) {
+    throw std::out_of_range("value too wide for a signed bit field");
+  }
+  write_bits(width, kWidthBits);
+  write_bits(encoded, width);
+}
+
+std::size_t BitWriter::bit_count() const {
+  return byte_offset_ * 8 + scratch_bits_;
+}
+
+std::vector<std::uint8_t> BitWriter::finish() {
+  spill((scratch_bits_ + 7) / 8);
+  buffer_.resize(byte_offset_);
+  return std::move(buffer_);
+}
+
+void BitWriter::spill(std::size_t bytes) {
+  if (byte_offset_ + bytes > buffer_.size()) {
+    throw std::length_error("bit stream overflow");
+  }
+  for (std::size_t i = 0; i < bytes; ++i) {
+    buffer_[byte_offset_++] = static_cast<std::uint8_t>(scratch_ & 0xFFu);
+    scratch_ >>= 8;
+  }
+  scratch_bits_ = scratch_bits_ > bytes * 8
+                      ? scratch_bits_ - static_cast<unsigned>(bytes * 8)
+                      : 0u;
+}
+
+BitReader::BitReader(const std::vector<std::uint8_t> &buffer)
+    : buffer_(buffer) {}
+
+std::uint32_t BitReader::read_bits(unsigned bits) {
+  if (bits == 0) {
+    return 0;
+  }
+  refill(bits);
+  const std::uint64_t mask = (std::uint64_t{1} << bits) - 1;
+  const auto value = static_cast<std::uint32_t>(scratch_ & mask);
+  scratch_ >>= bits;
+  scratch_bits_ -= bits;
+  return value;
+}
+
+std::uint32_t BitReader::read_varint() {
+  std::uint32_t value = 0;
+  for (unsigned shift = 0; shift < 35; shift += 7) {
+    const std::uint32_t group = read_bits(8);
+    value |= (group & 0x7Fu) << shift;
+    if ((group & 0x80u) == 0) {
+      return value;
+    }
+  }
+  throw std::out_of_range("varint longer than 32 bits");
+}
+
+std::int32_t BitReader::read_signed() {
+  const unsigned width = read_bits(kWidthBits);
+  return zigzag_decode(read_bits(width));
+}
+
+void BitReader::refill(unsigned bits) {
+  while (scratch_bits_ < bits) {
+    if (byte_offset_ >= buffer_.size()) {
+      throw std::out_of_range("bit stream underflow");
+    }
+    scratch_ |= static_cast<std::uint64_t>(buffer_[byte_offset_++])
+                << scratch_bits_;
+    scratch_bits_ += 8;
+  }
+}
+
+} // namespace mini::sync
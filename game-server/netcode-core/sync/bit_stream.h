@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mini::sync {
+
+// Packs values least significant bit first into a buffer sized up front, a
+// 64-bit word at a time. Writing past the capacity throws std::length_error.
+class BitWriter {
+public:
+  explicit BitWriter(std::size_t capacity_bytes);
+
+  // bits is 0..32; bits of value above that are ignored.
+  void write_bits(std::uint32_t value, unsigned bits);
+  // 7 bits per group, low groups first, each followed by a continuation bit.
+  void write_varint(std::uint32_t value);
+  // A 5-bit width, then the zigzag-encoded value in that many bits. value
+  // must be within +/-2^30, so the zigzag form fits 31 bits.
+  void write_signed(std::int32_t value);
+
+  [[nodiscard]] std::size_t bit_count() const;
+
+  // Returns the bytes written, padded with zero bits to a whole byte.
+  std::vector<std::uint8_t> finish();
+
+private:
+  void spill(std::size_t bytes);
+
+  std::vector<std::uint8_t> buffer_;
+  std::size_t byte_offset_{0};
+  std::uint64_t scratch_{0};
+  unsigned scratch_bits_{0};
+};
+
+// Reads what BitWriter wrote. Reading past the end throws std::out_of_range.
+class BitReader {
+public:
+  explicit BitReader(const std::vector<std::uint8_t> &buffer);
+
+  std::uint32_t read_bits(unsigned bits);
+  std::uint32_t read_varint();
+  std::int32_t read_signed();
+
+private:
+  void refill(unsigned bits);
+
+  const std::vector<std::uint8_t> &buffer_;
+  std::size_t byte_offset_{0};
+  std::uint64_t scratch_{0};
+  unsigned scratch_bits_{0};
+};
+
+[[nodiscard]] constexpr std::uint32_t zigzag_encode(std::int32_t value) {
+  return (static_cast<std::uint32_t>(value) << 1) ^
+         static_cast<std::uint32_t>(value >> 31);
+}
+
+[[nodiscard]] constexpr std::int32_t zigzag_decode(std::uint32_t value) {
+  return static_cast<std::int32_t>(value >> 1) ^
+         -static_cast<std::int32_t>(value & 1u);
+}
+
+} // namespace mini::sync
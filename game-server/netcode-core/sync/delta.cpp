@@ -1,155 +1,118 @@
 #include "delta.h"
 
+#include "bit_stream.h"
+
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
-#include <stdexcept>
 
 namespace mini::sync {
 
 namespace {
-void append_u32(std::vector<std::uint8_t> &buffer, std::uint32_t value) {
-  for (int i = 0; i < 4; ++i) {
-    buffer.push_back(static_cast<std::uint8_t>((value >> (i * 8)) & 0xFFu));
-  }
-}
-
-void append_i16(std::vector<std::uint8_t> &buffer, std::int16_t value) {
-  const auto unsigned_value = static_cast<std::uint16_t>(value);
-  buffer.push_back(static_cast<std::uint8_t>(unsigned_value & 0xFFu));
-  buffer.push_back(static_cast<std::uint8_t>((unsigned_value >> 8) & 0xFFu));
-}
-
-void append_i8(std::vector<std::uint8_t> &buffer, std::int8_t value) {
-  buffer.push_back(static_cast<std::uint8_t>(value));
-}
-
-void append_f32(std::vector<std::uint8_t> &buffer, float value) {
-  std::uint32_t bits;
-  std::memcpy(&bits, &value, sizeof(float));
-  append_u32(buffer, bits);
-}
-
-std::uint32_t read_u32(const std::vector<std::uint8_t> &buffer, std::size_t &offset) {
-  if (offset + 4 > buffer.size()) {
-    throw std::out_of_range("buffer underflow while reading u32");
-  }
-  std::uint32_t value = 0;
-  for (int i = 0; i < 4; ++i) {
-    value |= static_cast<std::uint32_t>(buffer[offset + i]) << (i * 8);
-  }
-  offset += 4;
-  return value;
-}
-
-float read_f32(const std::vector<std::uint8_t> &buffer, std::size_t &offset) {
-  const std::uint32_t bits = read_u32(buffer, offset);
-  float value;
-  std::memcpy(&value, &bits, sizeof(float));
-  return value;
-}
-
-std::int16_t read_i16(const std::vector<std::uint8_t> &buffer,
-                      std::size_t &offset) {
-  if (offset + 2 > buffer.size()) {
-    throw std::out_of_range("buffer underflow while reading i16");
-  }
-  const std::uint16_t value = static_cast<std::uint16_t>(buffer[offset]) |
-                              (static_cast<std::uint16_t>(buffer[offset + 1])
-                               << 8);
-  offset += 2;
-  return static_cast<std::int16_t>(value);
-}
-
-std::int8_t read_i8(const std::vector<std::uint8_t> &buffer, std::size_t &offset) {
-  if (offset >= buffer.size()) {
-    throw std::out_of_range("buffer underflow while reading i8");
-  }
-  return static_cast<std::int8_t>(buffer[offset++]);
-}
-
-void write_state(std::vector<std::uint8_t> &buffer, const core::WorldState &state) {
-  append_f32(buffer, static_cast<float>(state.ball_x));
-  append_f32(buffer, static_cast<float>(state.ball_y));
-  append_f32(buffer, static_cast<float>(state.ball_vx));
-  append_f32(buffer, static_cast<float>(state.ball_vy));
-  append_f32(buffer, static_cast<float>(state.left_paddle_y));
-  append_f32(buffer, static_cast<float>(state.right_paddle_y));
-  append_u32(buffer, state.left_score);
-  append_u32(buffer, state.right_score);
-  append_i8(buffer, static_cast<std::int8_t>(state.left_direction));
-  append_i8(buffer, static_cast<std::int8_t>(state.right_direction));
-}
-
-core::WorldState read_state(const std::vector<std::uint8_t> &buffer,
-                            std::size_t &offset) {
-  core::WorldState state{};
-  state.ball_x = static_cast<double>(read_f32(buffer, offset));
-  state.ball_y = static_cast<double>(read_f32(buffer, offset));
-  state.ball_vx = static_cast<double>(read_f32(buffer, offset));
-  state.ball_vy = static_cast<double>(read_f32(buffer, offset));
-  state.left_paddle_y = static_cast<double>(read_f32(buffer, offset));
-  state.right_paddle_y = static_cast<double>(read_f32(buffer, offset));
-  state.left_score = read_u32(buffer, offset);
-  state.right_score = read_u32(buffer, offset);
-  state.left_direction = read_i8(buffer, offset);
-  state.right_direction = read_i8(buffer, offset);
-  return state;
-}
-
-void write_delta(std::vector<std::uint8_t> &buffer, const core::WorldState &base,
-                 const core::WorldState &state) {
-  append_f32(buffer, static_cast<float>(state.ball_x - base.ball_x));
-  append_f32(buffer, static_cast<float>(state.ball_y - base.ball_y));
-  append_f32(buffer, static_cast<float>(state.ball_vx - base.ball_vx));
-  append_f32(buffer, static_cast<float>(state.ball_vy - base.ball_vy));
-  append_f32(buffer,
-             static_cast<float>(state.left_paddle_y - base.left_paddle_y));
-  append_f32(buffer,
-             static_cast<float>(state.right_paddle_y - base.right_paddle_y));
-  append_i16(buffer, static_cast<std::int16_t>(state.left_score -
-                                               base.left_score));
-  append_i16(buffer, static_cast<std::int16_t>(state.right_score -
-                                               base.right_score));
-  append_i8(buffer, static_cast<std::int8_t>(state.left_direction));
-  append_i8(buffer, static_cast<std::int8_t>(state.right_direction));
+// Quantized fields in wire order; the scores and directions follow them.
+enum Field : unsigned {
+  kBallX,
+  kBallY,
+  kBallVx,
+  kBallVy,
+  kLeftPaddleY,
+  kRightPaddleY,
+  kQuantizedFieldCount,
+  kLeftScore = kQuantizedFieldCount,
+  kRightScore,
+  kLeftDirection,
+  kRightDirection,
+  kFieldCount
+};
+
+constexpr unsigned kDirectionBits = 2;
+// Quantized values are clamped so that the difference of any two still fits
+// BitWriter::write_signed.
+constexpr std::int32_t kMaxQuantized = (1 << 29) - 1;
+// Widest encodings: six width-prefixed values, two 5-byte varints and the
+// directions, plus the delta mask.
+constexpr std::size_t kMaxEncodedBytes =
+    (kFieldCount + kQuantizedFieldCount * (5 + 31) + 2 * 40 +
+     2 * kDirectionBits + 7) /
+    8;
+
+using QuantizedFields = std::array<std::int32_t, kQuantizedFieldCount>;
+
+std::int32_t quantize(double value, double step) {
+  const double scaled = std::round(value / step);
+  return static_cast<std::int32_t>(std::clamp(
+      scaled, -static_cast<double>(kMaxQuantized),
+      static_cast<double>(kMaxQuantized)));
+}
+
+QuantizedFields quantize_state(const core::WorldState &state,
+                               const Quantization &quantization) {
+  return {quantize(state.ball_x, quantization.position_step),
+          quantize(state.ball_y, quantization.position_step),
+          quantize(state.ball_vx, quantization.velocity_step),
+          quantize(state.ball_vy, quantization.velocity_step),
+          quantize(state.left_paddle_y, quantization.position_step),
+          quantize(state.right_paddle_y, quantization.position_step)};
+}
+
+void dequantize_state(const QuantizedFields &fields,
+                      const Quantization &quantization,
+                      core::WorldState &state) {
+  state.ball_x = fields[kBallX] * quantization.position_step;
+  state.ball_y = fields[kBallY] * quantization.position_step;
+  state.ball_vx = fields[kBallVx] * quantization.velocity_step;
+  state.ball_vy = fields[kBallVy] * quantization.velocity_step;
+  state.left_paddle_y = fields[kLeftPaddleY] * quantization.position_step;
+  state.right_paddle_y = fields[kRightPaddleY] * quantization.position_step;
+}
+
+void write_direction(BitWriter &writer, int direction) {
+  writer.write_bits(
+      static_cast<std::uint32_t>(std::clamp(direction, -1, 1) + 1),
+      kDirectionBits);
+}
+
+int read_direction(BitReader &reader) {
+  return static_cast<int>(reader.read_bits(kDirectionBits)) - 1;
+}
+
+std::int32_t score_change(std::uint32_t base, std::uint32_t score) {
+  return static_cast<std::int32_t>(score - base);
 }
-
-core::WorldState apply_delta_to_state(const core::WorldState &base,
-                                      const std::vector<std::uint8_t> &buffer,
-                                      std::size_t &offset) {
-  core::WorldState state = base;
-  state.ball_x += static_cast<double>(read_f32(buffer, offset));
-  state.ball_y += static_cast<double>(read_f32(buffer, offset));
-  state.ball_vx += static_cast<double>(read_f32(buffer, offset));
-  state.ball_vy += static_cast<double>(read_f32(buffer, offset));
-  state.left_paddle_y += static_cast<double>(read_f32(buffer, offset));
-  state.right_paddle_y += static_cast<double>(read_f32(buffer, offset));
-  state.left_score = static_cast<std::uint32_t>(
-      static_cast<std::int64_t>(base.left_score) + read_i16(buffer, offset));
-  state.right_score = static_cast<std::uint32_t>(
-      static_cast<std::int64_t>(base.right_score) + read_i16(buffer, offset));
-  state.left_direction = read_i8(buffer, offset);
-  state.right_direction = read_i8(buffer, offset);
-  return state;
-}
-
 } // namespace
 
+DeltaCodec::DeltaCodec(Quantization quantization)
+    : quantization_(quantization) {}
+
 std::vector<std::uint8_t>
 DeltaCodec::encode_keyframe(const core::WorldState &state) const {
-  std::vector<std::uint8_t> buffer;
-  buffer.reserve(34);
-  write_state(buffer, state);
-  return buffer;
+  BitWriter writer(kMaxEncodedBytes);
+  for (const std::int32_t value : quantize_state(state, quantization_)) {
+    writer.write_signed(value);
+  }
+  writer.write_varint(state.left_score);
+  writer.write_varint(state.right_score);
+  write_direction(writer, state.left_direction);
+  write_direction(writer, state.right_direction);
+  return writer.finish();
 }
 
 core::WorldState
 DeltaCodec::decode_keyframe(const std::vector<std::uint8_t> &data,
                             std::uint64_t tick) const {
-  std::size_t offset = 0;
-  auto state = read_state(data, offset);
+  BitReader reader(data);
+  QuantizedFields fields{};
+  for (std::int32_t &value : fields) {
+    value = reader.read_signed();
+  }
+  core::WorldState state{};
+  dequantize_state(fields, quantization_, state);
+  state.left_score = reader.read_varint();
+  state.right_score = reader.read_varint();
+  state.left_direction = read_direction(reader);
+  state.right_direction = read_direction(reader);
   state.tick = tick;
   return state;
 }
@@ -157,18 +120,82 @@ DeltaCodec::decode_keyframe(const std::vector<std::uint8_t> &data,
 std::vector<std::uint8_t>
 DeltaCodec::encode_delta(const core::WorldState &base,
                          const core::WorldState &state) const {
-  std::vector<std::uint8_t> buffer;
-  buffer.reserve(28);
-  write_delta(buffer, base, state);
-  return buffer;
+  const QuantizedFields from = quantize_state(base, quantization_);
+  const QuantizedFields to = quantize_state(state, quantization_);
+  std::uint32_t changed = 0;
+  for (unsigned field = 0; field < kQuantizedFieldCount; ++field) {
+    if (from[field] != to[field]) {
+      changed |= 1u << field;
+    }
+  }
+  if (state.left_score != base.left_score) {
+    changed |= 1u << kLeftScore;
+  }
+  if (state.right_score != base.right_score) {
+    changed |= 1u << kRightScore;
+  }
+  if (state.left_direction != base.left_direction) {
+    changed |= 1u << kLeftDirection;
+  }
+  if (state.right_direction != base.right_direction) {
+    changed |= 1u << kRightDirection;
+  }
+
+  BitWriter writer(kMaxEncodedBytes);
+  writer.write_bits(changed, kFieldCount);
+  for (unsigned field = 0; field < kQuantizedFieldCount; ++field) {
+    if (changed & (1u << field)) {
+      writer.write_signed(to[field] - from[field]);
+    }
+  }
+  if (changed & (1u << kLeftScore)) {
+    writer.write_varint(
+        zigzag_encode(score_change(base.left_score, state.left_score)));
+  }
+  if (changed & (1u << kRightScore)) {
+    writer.write_varint(
+        zigzag_encode(score_change(base.right_score, state.right_score)));
+  }
+  if (changed & (1u << kLeftDirection)) {
+    write_direction(writer, state.left_direction);
+  }
+  if (changed & (1u << kRightDirection)) {
+    write_direction(writer, state.right_direction);
+  }
+  return writer.finish();
 }
 
 core::WorldState
 DeltaCodec::apply_delta(const core::WorldState &base,
                         const std::vector<std::uint8_t> &delta,
                         std::uint64_t tick) const {
-  std::size_t offset = 0;
-  auto state = apply_delta_to_state(base, delta, offset);
+  BitReader reader(delta);
+  const std::uint32_t changed = reader.read_bits(kFieldCount);
+  QuantizedFields fields = quantize_state(base, quantization_);
+  for (unsigned field = 0; field < kQuantizedFieldCount; ++field) {
+    if (changed & (1u << field)) {
+      // Wraps rather than overflows on a corrupt delta.
+      fields[field] = static_cast<std::int32_t>(
+          static_cast<std::uint32_t>(fields[field]) +
+          static_cast<std::uint32_t>(reader.read_signed()));
+    }
+  }
+  core::WorldState state = base;
+  dequantize_state(fields, quantization_, state);
+  if (changed & (1u << kLeftScore)) {
+    state.left_score += static_cast<std::uint32_t>(
+        zigzag_decode(reader.read_varint()));
+  }
+  if (changed & (1u << kRightScore)) {
+    state.right_score += static_cast<std::uint32_t>(
+        zigzag_decode(reader.read_varint()));
+  }
+  if (changed & (1u << kLeftDirection)) {
+    state.left_direction = read_direction(reader);
+  }
+  if (changed & (1u << kRightDirection)) {
+    state.right_direction = read_direction(reader);
+  }
   state.tick = tick;
   return state;
 }
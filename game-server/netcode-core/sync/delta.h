@@ -7,8 +7,21 @@
 
 namespace mini::sync {
 
+// Positions and velocities travel as whole multiples of these steps, so
+// the decoded state is within half a step of the encoded one. Encoder and
+// decoder must use the same steps.
+struct Quantization {
+  double position_step{1.0 / 64.0};
+  double velocity_step{1.0 / 16.0};
+};
+
+// Bit-packed state encoding. A keyframe carries every field; a delta starts
+// with a mask of the fields that differ from the base and carries only those,
+// as differences of their quantized values.
 class DeltaCodec {
 public:
+  explicit DeltaCodec(Quantization quantization = {});
+
   std::vector<std::uint8_t>
   encode_keyframe(const core::WorldState &state) const;
 
@@ -22,6 +35,11 @@ public:
   core::WorldState apply_delta(const core::WorldState &base,
                                const std::vector<std::uint8_t> &delta,
                                std::uint64_t tick) const;
+
+  const Quantization &quantization() const { return quantization_; }
+
+private:
+  Quantization quantization_;
 };
 
 } // namespace mini::sync
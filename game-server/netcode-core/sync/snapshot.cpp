@@ -7,7 +7,9 @@ namespace mini::sync {
 
 SnapshotGenerator::SnapshotGenerator(std::uint32_t keyframe_interval,
                                      std::size_t history_size)
-    : keyframe_interval_(keyframe_interval), history_size_(history_size) {}
+    : keyframe_interval_(keyframe_interval), history_size_(history_size) {
+  tick_cache_.reserve(history_size_ + 1);
+}
 
 EncodedSnapshot SnapshotGenerator::encode(const core::WorldState &state) {
   const bool should_emit_keyframe =
@@ -58,6 +60,42 @@ EncodedSnapshot SnapshotGenerator::encode_keyframe(
   return encoded;
 }
 
+void SnapshotGenerator::begin_tick(const core::WorldState &state) {
+  store_state(state);
+  const auto history_span = static_cast<std::uint64_t>(history_size_);
+  const auto min_tick = state.tick >= history_span ? state.tick - history_span
+                                                   : 0ULL;
+  prune_history(min_tick);
+  tick_state_ = state;
+  tick_cache_.clear();
+}
+
+const EncodedSnapshot &
+SnapshotGenerator::encode_for(std::optional<std::uint64_t> baseline_tick) {
+  std::optional<core::WorldState> base_state;
+  if (baseline_tick && *baseline_tick < tick_state_.tick &&
+      tick_state_.tick - *baseline_tick <= history_size_) {
+    base_state = find_state(*baseline_tick);
+  }
+  const bool is_keyframe = !base_state.has_value();
+  const std::uint64_t base_tick =
+      is_keyframe ? tick_state_.tick : *baseline_tick;
+  for (const EncodedSnapshot &cached : tick_cache_) {
+    if (cached.is_keyframe == is_keyframe && cached.base_tick == base_tick) {
+      return cached;
+    }
+  }
+
+  EncodedSnapshot &encoded = tick_cache_.emplace_back();
+  encoded.tick = tick_state_.tick;
+  encoded.is_keyframe = is_keyframe;
+  encoded.base_tick = base_tick;
+  encoded.payload = is_keyframe
+                        ? codec_.encode_keyframe(tick_state_)
+                        : codec_.encode_delta(*base_state, tick_state_);
+  return encoded;
+}
+
 std::optional<core::WorldState>
 SnapshotGenerator::find_state(std::uint64_t tick) const {
   const auto it = std::find_if(history_.begin(), history_.end(),
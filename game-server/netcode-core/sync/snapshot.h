@@ -26,6 +26,20 @@ public:
 
   EncodedSnapshot encode_keyframe(const core::WorldState &state);
 
+  // Per-client encoding: begin_tick() records the tick's state, then
+  // encode_for() encodes it against the tick a client last acknowledged. That
+  // is a delta while the baseline is at most history_size ticks old and still
+  // in the history, and a keyframe otherwise (or with no baseline). Clients
+  // with the same baseline share one encoding; the reference stays valid
+  // until the next begin_tick().
+  void begin_tick(const core::WorldState &state);
+  const EncodedSnapshot &
+  encode_for(std::optional<std::uint64_t> baseline_tick);
+  // Encodings encode_for() has made since begin_tick().
+  [[nodiscard]] std::size_t tick_encodings() const {
+    return tick_cache_.size();
+  }
+
   [[nodiscard]] std::optional<core::WorldState>
   find_state(std::uint64_t tick) const;
 
@@ -39,6 +53,10 @@ private:
   std::uint64_t last_keyframe_tick_{0};
   bool has_keyframe_{false};
   DeltaCodec codec_{};
+  core::WorldState tick_state_{};
+  // Reserved for one keyframe and a delta per history entry, so it never
+  // reallocates under the references encode_for() hands out.
+  std::vector<EncodedSnapshot> tick_cache_;
 };
 
 class SnapshotDecoder {